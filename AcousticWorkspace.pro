@@ -3,5 +3,10 @@
 # -------------------------------------------------
 TARGET = AcousticWorkspace
 TEMPLATE = subdirs
-SUBDIRS = application.pro \
-    plugins
+SUBDIRS = core \
+    application \
+    plugins \
+    tests
+application.file = application.pro
+application.depends = core
+tests.depends = core plugins
@@ -3,7 +3,7 @@
 # -------------------------------------------------
 TARGET = AcousticWorkspace
 TEMPLATE = app
-QT += script widgets core gui
+QT += script widgets core gui concurrent
 CONFIG += qwt
 SOURCES += main.cpp \
     mainwindow.cpp \
@@ -15,28 +15,21 @@ SOURCES += main.cpp \
     comparisonwidget.cpp \
     plotdisplayareawidget.cpp \
     regressiondialog.cpp \
-    regression.cpp \
     regressionitems.cpp \
-    intervalannotation.cpp \
     intervaldisplaywidget.cpp \
     plotviewwidget.cpp \
-    spectrogramdata.cpp \
-    waveformdata.cpp \
     curvesettingsdialog.cpp \
     datamanagerdialog.cpp \
     datasourcetreewidget.cpp \
     indexedaction.cpp \
     dataentrydialog.cpp \
-    sound.cpp \
-    soundview.cpp \
-    curveparameters.cpp \
-    plotparameters.cpp \
-    spectrogramparameters.cpp \
-    interval.cpp \
     comparisoncreationdialog.cpp \
-    comparisonschema.cpp
+    scriptbuffer.cpp \
+    replotscheduler.cpp \
+    streamingwidget.cpp \
+    waveformseries.cpp \
+    spectrogramraster.cpp
 HEADERS += mainwindow.h \
-    interfaces.h \
     plotmanagerdialog.h \
     plotviewtreewidget.h \
     textdisplaydialog.h \
@@ -46,28 +39,25 @@ HEADERS += mainwindow.h \
     comparisonwidget.h \
     plotdisplayareawidget.h \
     regressiondialog.h \
-    regression.h \
-    intervalannotation.h \
     intervaldisplaywidget.h \
     plotviewwidget.h \
     indexedaction.h \
-    spectrogramdata.h \
-    waveformdata.h \
     datasourcetreewidget.h \
     curvesettingsdialog.h \
     datamanagerdialog.h \
     dataentrydialog.h \
-    sound.h \
-    soundview.h \
-    curveparameters.h \
-    plotparameters.h \
-    spectrogramparameters.h \
-    interval.h \
     comparisoncreationdialog.h \
-    comparisonschema.h
+    scriptbuffer.h \
+    replotscheduler.h \
+    streamingwidget.h \
+    waveformseries.h \
+    spectrogramraster.h
+LIBS += -L$$OUT_PWD/core \
+    -lawcore
 LIBS += -L./ \
     -llibsndfile-1 \
     -lfftw3 \
+    -lfftw3_threads \
     -lm \
     -lgsl
 
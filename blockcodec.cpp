@@ -0,0 +1,264 @@
+#include "blockcodec.h"
+#include "interfaces.h"
+
+#include <QIODevice>
+#include <QVector>
+#include <QtEndian>
+#include <QtDebug>
+
+#include <string.h>
+#include <limits>
+
+namespace {
+
+//! \brief Size in bytes of the header of an array: the number of values (64 bits) and the number of blocks (32 bits)
+const int ArrayHeaderSize = 12;
+
+//! \brief Size in bytes of the header of a block: filter (8 bits), compressed flag (8 bits), padding (16 bits), number of values (32 bits), number of stored bytes (32 bits)
+const int BlockHeaderSize = 12;
+
+//! \brief The number of blocks that BlockCodec::encode() holds in memory at once when it writes to a device, and that BlockCodec::decode() holds when it reads
+const int ChunkBlocks = 64;
+
+//! \brief One block of an array, as it is encoded or decoded
+struct Block
+{
+    quint64 first;
+    quint32 count;
+    QByteArray bytes;
+    bool ok;
+};
+
+}
+
+int BlockCodec::blockSize()
+{
+    return 65536;
+}
+
+QByteArray BlockCodec::encode(const double *values, quint64 n, BlockCodec::Compression compression, bool *ok)
+{
+    if( ok != 0 ) { *ok = true; }
+    const quint64 largest = std::numeric_limits<int>::max();
+
+    if( compression == BlockCodec::Uncompressed && n * sizeof(double) > largest ) { qDebug() << "BlockCodec::encode:" << n << "values are too many to be stored uncompressed."; if( ok != 0 ) { *ok = false; } return QByteArray(); }
+
+    QVector<QByteArray> blocks = encodeBlocks(values, n, compression);
+    if( compression == BlockCodec::Uncompressed )
+        return blocks.isEmpty() ? QByteArray() : blocks.first();
+
+    quint64 size = ArrayHeaderSize;
+    for(int i=0; i<blocks.count(); i++)
+        size += blocks.at(i).size();
+    if( size > largest ) { qDebug() << "BlockCodec::encode:" << n << "values do not compress to less than 2 GB."; if( ok != 0 ) { *ok = false; } return QByteArray(); }
+
+    QByteArray bytes;
+    bytes.reserve( (int)size );
+    bytes.resize(ArrayHeaderSize);
+    qToLittleEndian<quint64>(n, bytes.data());
+    qToLittleEndian<quint32>(blocks.count(), bytes.data() + 8);
+    for(int i=0; i<blocks.count(); i++)
+        bytes.append(blocks.at(i));
+    return bytes;
+}
+
+bool BlockCodec::encode(QIODevice *device, const double *values, quint64 n, BlockCodec::Compression compression)
+{
+    if( compression != BlockCodec::Uncompressed )
+    {
+        QByteArray header(ArrayHeaderSize, 0);
+        qToLittleEndian<quint64>(n, header.data());
+        qToLittleEndian<quint32>( (n + blockSize() - 1) / blockSize(), header.data() + 8 );
+        if( device->write(header) != header.size() ) { return false; }
+    }
+
+    // a whole number of blocks at a time, so that the blocks are the same as if the values were encoded at once
+    const quint64 chunk = (quint64)ChunkBlocks * blockSize();
+    for(quint64 first=0; first<n; first += chunk)
+    {
+        QVector<QByteArray> blocks = encodeBlocks(values + first, qMin(chunk, n - first), compression);
+        for(int i=0; i<blocks.count(); i++)
+            if( device->write(blocks.at(i)) != blocks.at(i).size() ) { return false; }
+    }
+    return true;
+}
+
+QVector<QByteArray> BlockCodec::encodeBlocks(const double *values, quint64 n, BlockCodec::Compression compression)
+{
+    if( compression == BlockCodec::Uncompressed )
+    {
+        QByteArray bytes( (int)(n * sizeof(double)), Qt::Uninitialized );
+        for(quint64 i=0; i<n; i++)
+        {
+            quint64 bits;
+            memcpy(&bits, values+i, sizeof(double));
+            qToLittleEndian<quint64>(bits, bytes.data() + i*sizeof(double));
+        }
+        return QVector<QByteArray>() << bytes;
+    }
+
+    QVector<Block> blocks;
+    for(quint64 first=0; first<n; first += blockSize())
+    {
+        Block block;
+        block.first = first;
+        block.count = qMin<quint64>(blockSize(), n - first);
+        block.ok = true;
+        blocks << block;
+    }
+
+    parallelMap(blocks, [values,compression](Block &block) {
+        if( compression == BlockCodec::Fast )
+        {
+            block.bytes = BlockCodec::encodeBlock(values + block.first, block.count, BlockCodec::DeltaShuffle, 1);
+        }
+        else
+        {
+            // noisy data (e.g., log spectra) may compress better without the delta filter
+            QByteArray delta = BlockCodec::encodeBlock(values + block.first, block.count, BlockCodec::DeltaShuffle, 9);
+            QByteArray shuffle = BlockCodec::encodeBlock(values + block.first, block.count, BlockCodec::Shuffle, 9);
+            block.bytes = delta.size() <= shuffle.size() ? delta : shuffle;
+        }
+    });
+
+    QVector<QByteArray> bytes;
+    for(int i=0; i<blocks.count(); i++)
+        bytes << blocks.at(i).bytes;
+    return bytes;
+}
+
+bool BlockCodec::decode(QIODevice *device, double *values, quint64 n, BlockCodec::Compression compression)
+{
+    if( compression == BlockCodec::Uncompressed )
+    {
+        // read straight into the array, since a QByteArray cannot hold more than 2 GB
+        qint64 size = n * sizeof(double);
+        if( device->read( (char*)values, size ) != size ) { qDebug() << "BlockCodec::decode: the binary file is too short."; return false; }
+        for(quint64 i=0; i<n; i++)
+        {
+            quint64 bits = qFromLittleEndian<quint64>( (const uchar*)(values+i) );
+            memcpy(values+i, &bits, sizeof(double));
+        }
+        return true;
+    }
+
+    QByteArray header = device->read(ArrayHeaderSize);
+    if( header.size() != ArrayHeaderSize ) { qDebug() << "BlockCodec::decode: the binary file is too short."; return false; }
+    quint64 count = qFromLittleEndian<quint64>(header.constData());
+    quint32 nBlocks = qFromLittleEndian<quint32>(header.constData() + 8);
+    if( count != n ) { qDebug() << "BlockCodec::decode: expected" << n << "values, but the binary file has" << count; return false; }
+
+    // reading is sequential; decoding is done in parallel afterward, a whole number of blocks at a time, so that the values may be in a mapped file larger than memory
+    QVector<Block> blocks;
+    quint64 first = 0;
+    for(quint32 i=0; i<nBlocks; i++)
+    {
+        Block block;
+        block.bytes = device->read(BlockHeaderSize);
+        if( block.bytes.size() != BlockHeaderSize ) { qDebug() << "BlockCodec::decode: the binary file is too short."; return false; }
+        block.first = first;
+        block.count = qFromLittleEndian<quint32>(block.bytes.constData() + 4);
+        quint32 stored = qFromLittleEndian<quint32>(block.bytes.constData() + 8);
+        block.bytes.append( device->read(stored) );
+        if( block.bytes.size() != BlockHeaderSize + (int)stored ) { qDebug() << "BlockCodec::decode: the binary file is too short."; return false; }
+        if( first + block.count > n ) { qDebug() << "BlockCodec::decode: a block extends past the end of the array."; return false; }
+        block.ok = false;
+        first += block.count;
+        blocks << block;
+
+        if( blocks.count() < ChunkBlocks && i+1 < nBlocks ) { continue; }
+
+        parallelMap(blocks, [values](Block &block) {
+            block.ok = BlockCodec::decodeBlock(block.bytes, values + block.first, block.count);
+            block.bytes.clear();
+        });
+        for(int j=0; j<blocks.count(); j++)
+            if( !blocks.at(j).ok )
+                return false;
+        blocks.clear();
+    }
+    if( first != n ) { qDebug() << "BlockCodec::decode: the blocks hold" << first << "values, but" << n << "were expected."; return false; }
+    return true;
+}
+
+QByteArray BlockCodec::encodeBlock(const double *values, quint32 n, BlockCodec::Filter filter, int level)
+{
+    QByteArray filtered( (int)(n * sizeof(double)), Qt::Uninitialized );
+    uchar *out = (uchar*)filtered.data();
+    quint64 previous = 0;
+    for(quint32 i=0; i<n; i++)
+    {
+        quint64 bits;
+        memcpy(&bits, values+i, sizeof(double));
+        if( filter == BlockCodec::DeltaShuffle )
+        {
+            quint64 difference = bits - previous;
+            previous = bits;
+            bits = difference;
+        }
+        // byte k of every value goes in the k-th plane, least significant byte first
+        for(int k=0; k<8; k++)
+            out[k*n + i] = (uchar)( bits >> (8*k) );
+    }
+
+    QByteArray payload = qCompress(filtered, level);
+    bool compressed = payload.size() < filtered.size();
+    if( !compressed )
+        payload = filtered;
+
+    QByteArray block(BlockHeaderSize, 0);
+    block[0] = (char)filter;
+    block[1] = (char)compressed;
+    qToLittleEndian<quint32>(n, block.data() + 4);
+    qToLittleEndian<quint32>(payload.size(), block.data() + 8);
+    block.append(payload);
+    return block;
+}
+
+bool BlockCodec::decodeBlock(const QByteArray &block, double *values, quint32 n)
+{
+    BlockCodec::Filter filter = (BlockCodec::Filter)block.at(0);
+    bool compressed = block.at(1);
+    QByteArray payload = block.mid(BlockHeaderSize);
+    QByteArray filtered = compressed ? qUncompress(payload) : payload;
+    if( (quint64)filtered.size() != n * sizeof(double) ) { qDebug() << "BlockCodec::decodeBlock: a block of the binary file is damaged."; return false; }
+
+    const uchar *in = (const uchar*)filtered.constData();
+    quint64 previous = 0;
+    for(quint32 i=0; i<n; i++)
+    {
+        quint64 bits = 0;
+        for(int k=0; k<8; k++)
+            bits |= ((quint64)in[k*n + i]) << (8*k);
+        if( filter == BlockCodec::DeltaShuffle )
+        {
+            bits += previous;
+            previous = bits;
+        }
+        memcpy(values+i, &bits, sizeof(double));
+    }
+    return true;
+}
+
+QString BlockCodec::compressionToString(BlockCodec::Compression compression)
+{
+    switch(compression)
+    {
+    case BlockCodec::Fast:
+        return "zlib-fast";
+    case BlockCodec::Small:
+        return "zlib-small";
+    default:
+        return "none";
+    }
+}
+
+BlockCodec::Compression BlockCodec::compressionFromString(const QString &str)
+{
+    if( str == "zlib-fast" )
+        return BlockCodec::Fast;
+    else if( str == "zlib-small" )
+        return BlockCodec::Small;
+    else
+        return BlockCodec::Uncompressed;
+}
@@ -0,0 +1,72 @@
+/*!
+  \class BlockCodec
+  \ingroup Data
+  \brief Encodes arrays of doubles as independently compressed blocks, for the binary file of a project.
+
+  An encoded array begins with the number of values and the number of blocks. Each block then has a small header (compression, filter, number of values, number of stored bytes) followed by its payload. Every block holds at most blockSize() values and can be decoded on its own, so a reader can skip to any block using the headers alone, and the blocks of an array can be decoded in parallel.
+
+  Before compression, the values of a block are filtered to make them more compressible. The delta filter replaces each value's bit pattern with its difference (as a 64-bit integer) from the previous one; for smooth curves and regularly spaced time or frequency vectors most of the high-order bytes then become zero. The shuffle filter groups the first bytes of every value together, then the second bytes, and so on, which brings the slowly-varying sign and exponent bytes together. Both filters are exactly reversible.
+
+  Compression uses zlib through qCompress(), which is part of Qt.
+
+  All values are stored little-endian.
+*/
+
+#ifndef BLOCKCODEC_H
+#define BLOCKCODEC_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+class BlockCodec
+{
+public:
+    //! \brief How the binary data of a project are stored
+    enum Compression {
+        Uncompressed, //!< The values are stored as raw doubles, as in projects from before compression was introduced
+        Fast, //!< Blocks are compressed with the fastest zlib setting
+        Small //!< Blocks are compressed with the strongest zlib setting, and the better of the two filters is kept for each block
+    };
+
+    //! \brief The filter applied to a block before compression
+    enum Filter { NoFilter = 0, Shuffle = 1, DeltaShuffle = 2 };
+
+    //! \brief Return the number of values in a full block
+    static int blockSize();
+
+    //! \brief Return \a n values starting at \a values encoded with \a compression. For Uncompressed these are simply the raw values.
+    /*!
+      A QByteArray holds less than 2 GB, so larger arrays cannot be encoded; an empty array is returned, and \a ok (if given) is set to false.
+      */
+    static QByteArray encode(const double *values, quint64 n, BlockCodec::Compression compression, bool *ok = 0);
+
+    //! \brief Write \a n values starting at \a values, encoded with \a compression, to \a device. Returns false if they could not be written.
+    /*!
+      The result is the same as writing the result of the other overload, but the values are encoded a few blocks at a time, so that they need not fit in memory, and there is no limit on their number. This is for values in a file that is mapped into memory.
+      */
+    static bool encode(QIODevice *device, const double *values, quint64 n, BlockCodec::Compression compression);
+
+    //! \brief Read an array of \a n values, encoded with \a compression, from \a device into \a values. Returns false if the data are damaged.
+    static bool decode(QIODevice *device, double *values, quint64 n, BlockCodec::Compression compression);
+
+    //! \brief Return the string used for \a compression in project files
+    static QString compressionToString(BlockCodec::Compression compression);
+
+    //! \brief Return the compression corresponding to the string \a str from a project file
+    static BlockCodec::Compression compressionFromString(const QString &str);
+
+private:
+    //! \brief Return the encoded blocks of the \a n values starting at \a values, which are encoded in parallel. For Uncompressed this is the raw values, as one block.
+    static QVector<QByteArray> encodeBlocks(const double *values, quint64 n, BlockCodec::Compression compression);
+
+    //! \brief Return \a n values starting at \a values, filtered with \a filter and compressed at zlib level \a level, including the block header
+    static QByteArray encodeBlock(const double *values, quint32 n, BlockCodec::Filter filter, int level);
+
+    //! \brief Decode the block \a block, including its header, into \a values, which has room for \a n values
+    static bool decodeBlock(const QByteArray &block, double *values, quint32 n);
+};
+
+#endif // BLOCKCODEC_H
@@ -0,0 +1,120 @@
+#include "blockmeasureadapter.h"
+
+#include "framecollector.h"
+#include "waveformdata.h"
+#include "spectrogramdata.h"
+#include "pluginproxy.h"
+
+#include <QtDebug>
+
+namespace {
+
+//! \brief The state of a run of an adapted measure: the input collected so far
+class AdapterState : public BlockState
+{
+public:
+    int measure;
+    BlockSink *output;
+    FrameCollector input;
+};
+
+//! \brief Run measure \a measure of \a plugin on \a source, and collect whatever \a plugin emits through \a created
+template<class Plugin, class Source, class Output>
+QList<QObject*> collectOutputs(Plugin *plugin, void (Plugin::*created)(Output*), int measure, Source *source)
+{
+    QList<QObject*> outputs;
+    QMetaObject::Connection connection = QObject::connect(plugin, created, [&outputs](Output *data) { outputs << data; });
+    plugin->calculate(measure, source);
+    QObject::disconnect(connection);
+    return outputs;
+}
+
+}
+
+BlockMeasureAdapter::BlockMeasureAdapter(AbstractMeasurement *plugin, Derivation::Type type) :
+    mPlugin(plugin),
+    mType(type)
+{
+}
+
+AbstractBlockMeasure* BlockMeasureAdapter::blockMeasure(AbstractMeasurement *plugin)
+{
+    // a proxy does not know whether its plugin can process blocks until the plugin has been loaded
+    PluginProxy *proxy = dynamic_cast<PluginProxy*>(plugin);
+    if( proxy != 0 )
+        return qobject_cast<AbstractBlockMeasure*>( proxy->instance() );
+    return qobject_cast<AbstractBlockMeasure*>(plugin);
+}
+
+BlockState* BlockMeasureAdapter::begin(int i, const BlockFormat &input, BlockSink *output)
+{
+    bool sourceIsSpectrogram = mType == Derivation::Spectrogram2Waveform || mType == Derivation::Spectrogram2Spectrogram;
+    if( !sourceIsSpectrogram && input.width != 1 ) { qDebug() << "BlockMeasureAdapter: the measure takes a waveform, but the input is" << input.width << "values wide."; return 0; }
+
+    AdapterState *state = new AdapterState;
+    state->measure = i;
+    state->output = output;
+    state->input.setFormat(input);
+    return state;
+}
+
+qint64 BlockMeasureAdapter::lookahead(const BlockState *state) const
+{
+    Q_UNUSED(state);
+    return -1;
+}
+
+qint64 BlockMeasureAdapter::latency(const BlockState *state) const
+{
+    Q_UNUSED(state);
+    return -1;
+}
+
+void BlockMeasureAdapter::processBlock(BlockState *state, const FrameBlock &input)
+{
+    static_cast<AdapterState*>(state)->input.write(input);
+}
+
+void BlockMeasureAdapter::finish(BlockState *state)
+{
+    AdapterState *s = static_cast<AdapterState*>(state);
+
+    QList<QObject*> outputs;
+    switch(mType)
+    {
+    case Derivation::Waveform2Waveform:
+    case Derivation::Waveform2Spectrogram:
+    {
+        WaveformData *source = s->input.takeWaveform();
+        if( source == 0 ) { return; }
+        if( mType == Derivation::Waveform2Waveform )
+            outputs = collectOutputs(static_cast<AbstractWaveform2WaveformMeasure*>(mPlugin), &AbstractWaveform2WaveformMeasure::waveformCreated, s->measure, source);
+        else
+            outputs = collectOutputs(static_cast<AbstractWaveform2SpectrogramMeasure*>(mPlugin), &AbstractWaveform2SpectrogramMeasure::spectrogramCreated, s->measure, source);
+        delete source;
+        break;
+    }
+    case Derivation::Spectrogram2Waveform:
+    case Derivation::Spectrogram2Spectrogram:
+    {
+        SpectrogramData *source = s->input.takeSpectrogram();
+        if( source == 0 ) { return; }
+        if( mType == Derivation::Spectrogram2Waveform )
+            outputs = collectOutputs(static_cast<AbstractSpectrogram2WaveformMeasure*>(mPlugin), &AbstractSpectrogram2WaveformMeasure::waveformCreated, s->measure, source);
+        else
+            outputs = collectOutputs(static_cast<AbstractSpectrogram2SpectrogramMeasure*>(mPlugin), &AbstractSpectrogram2SpectrogramMeasure::spectrogramCreated, s->measure, source);
+        delete source;
+        break;
+    }
+    }
+
+    if( outputs.isEmpty() ) { return; }
+    if( outputs.count() > 1 ) { qDebug() << "BlockMeasureAdapter: the measure created" << outputs.count() << "objects; only the first is passed on."; }
+
+    if( WaveformData *waveform = qobject_cast<WaveformData*>(outputs.first()) )
+        FrameCollector::send(waveform, s->output);
+    else if( SpectrogramData *spectrogram = qobject_cast<SpectrogramData*>(outputs.first()) )
+        FrameCollector::send(spectrogram, s->output);
+
+    qDeleteAll(outputs);
+}
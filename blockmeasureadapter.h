@@ -0,0 +1,35 @@
+/*!
+  \class BlockMeasureAdapter
+  \ingroup Plugin
+  \brief Runs a measure of a plugin that only implements one of the whole-data interfaces as an AbstractBlockMeasure.
+
+  The adapter collects the whole input of a run, and in finish() creates a WaveformData or SpectrogramData from it, calls the plugin's calculate() and writes the frames of the object the plugin creates. This lets every existing plugin take part in a BlockPipeline, but it does not bound memory: a run needs all of its input (lookahead() and latency() are -1). Plugins that implement AbstractBlockMeasure themselves are used without an adapter; see blockMeasure().
+*/
+
+#ifndef BLOCKMEASUREADAPTER_H
+#define BLOCKMEASUREADAPTER_H
+
+#include "interfaces.h"
+#include "derivation.h"
+
+class BlockMeasureAdapter : public AbstractBlockMeasure
+{
+public:
+    //! \brief Adapt \a plugin, which implements the interface that corresponds to \a type
+    BlockMeasureAdapter(AbstractMeasurement *plugin, Derivation::Type type);
+
+    //! \brief Return the block interface of \a plugin, or 0 if it does not implement one
+    static AbstractBlockMeasure* blockMeasure(AbstractMeasurement *plugin);
+
+    BlockState* begin(int i, const BlockFormat &input, BlockSink *output);
+    qint64 lookahead(const BlockState *state) const;
+    qint64 latency(const BlockState *state) const;
+    void processBlock(BlockState *state, const FrameBlock &input);
+    void finish(BlockState *state);
+
+private:
+    AbstractMeasurement *mPlugin;
+    Derivation::Type mType;
+};
+
+#endif // BLOCKMEASUREADAPTER_H
@@ -0,0 +1,139 @@
+#include "blockpipeline.h"
+
+#include "blockmeasureadapter.h"
+
+#include <QtDebug>
+
+BlockPipeline::Stage::Stage() :
+    measure(0),
+    adapter(0),
+    index(0),
+    next(0),
+    state(0),
+    failed(false)
+{
+}
+
+BlockPipeline::Stage::~Stage()
+{
+    delete state;
+    delete adapter;
+}
+
+void BlockPipeline::Stage::setFormat(const BlockFormat &format)
+{
+    delete state;
+    input = format;
+    state = measure->begin(index, format, next);
+    failed = state == 0;
+    if( failed ) { qDebug() << "BlockPipeline: a stage could not be begun on input of width" << format.width; }
+}
+
+void BlockPipeline::Stage::write(const FrameBlock &block)
+{
+    if( state != 0 )
+        measure->processBlock(state, block);
+}
+
+BlockPipeline::BlockPipeline()
+{
+}
+
+BlockPipeline::~BlockPipeline()
+{
+    qDeleteAll(maStages);
+}
+
+void BlockPipeline::addStage(AbstractMeasurement *plugin, Derivation::Type type, int i)
+{
+    Stage *stage = new Stage;
+    stage->measure = BlockMeasureAdapter::blockMeasure(plugin);
+    if( stage->measure == 0 )
+    {
+        stage->adapter = new BlockMeasureAdapter(plugin, type);
+        stage->measure = stage->adapter;
+    }
+    stage->index = i;
+    stage->next = &mOutput;
+
+    if( !maStages.isEmpty() )
+        maStages.last()->next = stage;
+    maStages << stage;
+}
+
+int BlockPipeline::stageCount() const
+{
+    return maStages.count();
+}
+
+void BlockPipeline::setFormat(const BlockFormat &format)
+{
+    for(int i=0; i<maStages.count(); i++)
+    {
+        delete maStages.at(i)->state;
+        maStages.at(i)->state = 0;
+        maStages.at(i)->failed = false;
+    }
+
+    if( maStages.isEmpty() )
+        mOutput.setFormat(format);
+    else
+        maStages.first()->setFormat(format);
+}
+
+void BlockPipeline::write(const FrameBlock &block)
+{
+    if( maStages.isEmpty() )
+        mOutput.write(block);
+    else
+        maStages.first()->write(block);
+}
+
+void BlockPipeline::finish()
+{
+    // each stage writes the rest of its output to the next before that one finishes
+    for(int i=0; i<maStages.count(); i++)
+    {
+        Stage *stage = maStages.at(i);
+        if( stage->state != 0 )
+            stage->measure->finish(stage->state);
+    }
+}
+
+bool BlockPipeline::succeeded() const
+{
+    for(int i=0; i<maStages.count(); i++)
+        if( maStages.at(i)->failed )
+            return false;
+    return true;
+}
+
+double BlockPipeline::lookahead() const
+{
+    return delay(false);
+}
+
+double BlockPipeline::latency() const
+{
+    return delay(true);
+}
+
+double BlockPipeline::delay(bool latency) const
+{
+    double total = 0;
+    for(int i=0; i<maStages.count(); i++)
+    {
+        const Stage *stage = maStages.at(i);
+        if( stage->state == 0 || stage->input.frameRate <= 0 ) { return -1; }
+
+        qint64 frames = latency ? stage->measure->latency(stage->state) : stage->measure->lookahead(stage->state);
+        if( frames < 0 ) { return -1; }
+        total += frames / stage->input.frameRate;
+    }
+    return total;
+}
+
+FrameCollector* BlockPipeline::output()
+{
+    return &mOutput;
+}
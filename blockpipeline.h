@@ -0,0 +1,83 @@
+/*!
+  \class BlockPipeline
+  \ingroup Plugin
+  \brief A chain of block measures, each of which processes the output of the one before as it is written.
+
+  A pipeline is itself a BlockSink: the input is given with setFormat() and write() (e.g., by FrameCollector::send()), and finish() ends the run. Each stage is begun when the stage before it announces the format of its output, and its output goes straight to the next stage, so that no intermediate result is ever held as a whole unless a stage needs it (as the stages run through a BlockMeasureAdapter do). The output of the last stage is kept in output().
+
+  Plugins that implement AbstractBlockMeasure are used directly; the rest through a BlockMeasureAdapter. The plugins' parameters are used as they are when the pipeline is begun.
+
+  Sound::runDerivation() runs measures of spectrograms in a backing file through a pipeline.
+*/
+
+#ifndef BLOCKPIPELINE_H
+#define BLOCKPIPELINE_H
+
+#include <QList>
+
+#include "interfaces.h"
+#include "derivation.h"
+#include "framecollector.h"
+
+class BlockMeasureAdapter;
+
+class BlockPipeline : public BlockSink
+{
+public:
+    BlockPipeline();
+    ~BlockPipeline();
+
+    //! \brief Add a stage that runs measure \a i of \a plugin, which implements the interface that corresponds to \a type
+    void addStage(AbstractMeasurement *plugin, Derivation::Type type, int i);
+
+    //! \brief Return the number of stages
+    int stageCount() const;
+
+    //! \brief Begin a run on input of format \a format. Reimplemented from BlockSink.
+    void setFormat(const BlockFormat &format);
+
+    //! \brief Pass the next frames of the input through the stages. Reimplemented from BlockSink.
+    void write(const FrameBlock &block);
+
+    //! \brief Finish each stage in turn, once the whole input has been written
+    void finish();
+
+    //! \brief Return false if a stage could not be begun on the input it was given
+    bool succeeded() const;
+
+    //! \brief Return the input that the stages need after the time of an output frame, in seconds, or -1 if a stage needs the whole of its input or has not been begun
+    double lookahead() const;
+
+    //! \brief Return the longest time that an input frame may wait before all the output that depends on it has been written, in seconds, or -1 if a stage writes nothing before it finishes or has not been begun
+    double latency() const;
+
+    //! \brief Return the output of the last stage
+    FrameCollector* output();
+
+private:
+    //! \brief One stage of the pipeline; as a sink, it receives the output of the stage before
+    class Stage : public BlockSink
+    {
+    public:
+        Stage();
+        ~Stage();
+        void setFormat(const BlockFormat &format);
+        void write(const FrameBlock &block);
+
+        AbstractBlockMeasure *measure;
+        BlockMeasureAdapter *adapter;
+        int index;
+        BlockSink *next;
+        BlockFormat input;
+        BlockState *state;
+        bool failed;
+    };
+
+    //! \brief Sum the lookahead (\a latency false) or the latency of the stages, in seconds
+    double delay(bool latency) const;
+
+    QList<Stage*> maStages;
+    FrameCollector mOutput;
+};
+
+#endif // BLOCKPIPELINE_H
@@ -7,6 +7,7 @@
 #include "intervalannotation.h"
 #include "waveformdata.h"
 #include "comparisonschema.h"
+#include "spectrogramdata.h"
 
 ComparisonCreationDialog::ComparisonCreationDialog(QList<Sound*> sounds, QWidget *parent) :
     QDialog(parent),
@@ -15,17 +16,25 @@ ComparisonCreationDialog::ComparisonCreationDialog(QList<Sound*> sounds, QWidget
 {
     ui->setupUi(this);
 
+    ui->stretchAlgorithmCombo->addItems( QStringList() << "Linear warp" << "Accumulated" << "Dynamic time warping" );
+
     populatePrimarySounds();
 
     connect(ui->primarySoundCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(populatePrimaryIntervals()));
     connect(ui->secondarySoundCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(populateSecondaryIntervals()));
     connect(ui->primarySoundCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(populateSecondarySounds()));
-    connect(ui->intervalAlignmentBox, SIGNAL(toggled(bool)), this, SLOT(setIntervalAlignment(bool)));
+    connect(ui->primarySoundCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(populatePrimaryFeatures()));
+    connect(ui->secondarySoundCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(populateSecondaryFeatures()));
+    connect(ui->intervalAlignmentBox, SIGNAL(toggled(bool)), this, SLOT(updateAlignmentControls()));
+    connect(ui->stretchAlgorithmCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(updateAlignmentControls()));
+    connect(ui->stretchAlgorithmCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(populatePrimaryFeatures()));
+    connect(ui->stretchAlgorithmCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(populateSecondaryFeatures()));
 
     connect(ui->secondarySoundCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(layoutComparisonWidgets()));
 
     populatePrimarySounds();
     layoutComparisonWidgets();
+    updateAlignmentControls();
 }
 
 ComparisonCreationDialog::~ComparisonCreationDialog()
@@ -36,10 +45,28 @@ ComparisonCreationDialog::~ComparisonCreationDialog()
 ComparisonSchema ComparisonCreationDialog::comparisonSchema() const
 {
     ComparisonSchema schema;
-    schema.setIntervalComparison( ui->intervalAlignmentBox->isChecked() );
-    schema.setIntervals( primarySound()->intervals()->at( ui->primaryIntervalCombo->currentData().toInt() ), secondarySound()->intervals()->at( ui->secondaryIntervalCombo->currentData().toInt() ) );
+    const IntervalAnnotation *pInterval = 0, *sInterval = 0;
+    if( primarySound() != 0 && ui->primaryIntervalCombo->currentIndex() > -1 )
+        pInterval = primarySound()->intervals()->at( ui->primaryIntervalCombo->currentIndex() );
+    if( secondarySound() != 0 && ui->secondaryIntervalCombo->currentIndex() > -1 )
+        sInterval = secondarySound()->intervals()->at( ui->secondaryIntervalCombo->currentIndex() );
+    schema.setIntervalComparison( ui->intervalAlignmentBox->isChecked() && pInterval != 0 && sInterval != 0 );
+    schema.setIntervals( pInterval, sInterval );
     schema.setStretchAlgorithm( ui->stretchAlgorithmCombo->currentText() );
 
+    // the feature combos list spectrograms for dynamic time warping, and the spectral change curves of the secondary sound for the accumulated algorithm
+    int pFeatures = ui->primaryFeatureCombo->currentData().toInt();
+    int sFeatures = ui->secondaryFeatureCombo->currentData().toInt();
+    if( ui->stretchAlgorithmCombo->currentText() == "Accumulated" )
+    {
+        if( secondarySound() != 0 && sFeatures > -1 )
+            schema.setChangeCurve( secondarySound()->waveformData()->at(sFeatures) );
+    }
+    else if( primarySound() != 0 && secondarySound() != 0 && pFeatures > -1 && sFeatures > -1 )
+    {
+        schema.setAlignmentSpectrograms( primarySound()->spectrogramData()->at(pFeatures), secondarySound()->spectrogramData()->at(sFeatures) );
+    }
+
     const QList<WaveformData *> *pWaveforms = primaryWaveforms();
     const QList<WaveformData *> *sWaveforms = secondaryWaveforms();
     for( int i=0; i<pWaveforms->count(); i++ )
@@ -102,11 +129,49 @@ void ComparisonCreationDialog::populateSecondaryIntervals()
     }
 }
 
-void ComparisonCreationDialog::setIntervalAlignment(bool value)
+void ComparisonCreationDialog::populatePrimaryFeatures()
+{
+    populateFeatures( ui->primaryFeatureCombo, primarySound() );
+}
+
+void ComparisonCreationDialog::populateSecondaryFeatures()
+{
+    populateFeatures( ui->secondaryFeatureCombo, secondarySound() );
+}
+
+void ComparisonCreationDialog::populateFeatures(QComboBox *combo, const Sound *sound)
+{
+    combo->clear();
+    if( ui->stretchAlgorithmCombo->currentText() == "Accumulated" )
+    {
+        combo->addItem(tr("<None>"), -1);
+        for(int i=0; sound != 0 && i<sound->waveformData()->count(); i++)
+        {
+            combo->addItem( sound->waveformData()->at(i)->name(), i );
+        }
+        return;
+    }
+
+    combo->addItem(tr("<Paired curves>"), -1);
+    if( sound != 0 )
+    {
+        for(int i=0; i<sound->spectrogramData()->count(); i++)
+        {
+            combo->addItem( sound->spectrogramData()->at(i)->name(), i );
+        }
+    }
+}
+
+void ComparisonCreationDialog::updateAlignmentControls()
 {
-    ui->primaryIntervalCombo->setEnabled(value);
-    ui->secondaryIntervalCombo->setEnabled(value);
-    ui->stretchAlgorithmCombo->setEnabled(value);
+    // dynamic time warping does not need interval annotations
+    bool dtw = ui->stretchAlgorithmCombo->currentText() == "Dynamic time warping";
+    bool accumulated = ui->stretchAlgorithmCombo->currentText() == "Accumulated";
+    ui->primaryIntervalCombo->setEnabled( ui->intervalAlignmentBox->isChecked() && !dtw );
+    ui->secondaryIntervalCombo->setEnabled( ui->intervalAlignmentBox->isChecked() && !dtw );
+    ui->primaryFeatureCombo->setEnabled(dtw);
+    // the accumulated algorithm warps the secondary sound by its own spectral change
+    ui->secondaryFeatureCombo->setEnabled( dtw || ( accumulated && ui->intervalAlignmentBox->isChecked() ) );
 }
 
 void ComparisonCreationDialog::layoutComparisonWidgets()
@@ -30,11 +30,14 @@ private slots:
     void populateSecondarySounds();
     void populatePrimaryIntervals();
     void populateSecondaryIntervals();
-    void setIntervalAlignment(bool value);
+    void populatePrimaryFeatures();
+    void populateSecondaryFeatures();
+    void updateAlignmentControls();
     void layoutComparisonWidgets();
 
 private:
     QComboBox * secondaryCurveCombo();
+    void populateFeatures(QComboBox *combo, const Sound *sound);
     const QList<WaveformData *> *primaryWaveforms() const;
     const QList<WaveformData *> *secondaryWaveforms() const;
     const Sound *primarySound() const;
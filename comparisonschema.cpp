@@ -1,6 +1,10 @@
 #include "comparisonschema.h"
 
-ComparisonSchema::ComparisonSchema()
+ComparisonSchema::ComparisonSchema() :
+    mIntervalComparison(false),
+    mIntervals(0,0),
+    mAlignmentSpectrograms(0,0),
+    mChangeCurve(0)
 {
 }
 
@@ -34,6 +38,26 @@ void ComparisonSchema::setStretchAlgorithm(const QString &value)
     mStretchAlgorithm = value;
 }
 
+QPair<const SpectrogramData*,const SpectrogramData*> ComparisonSchema::alignmentSpectrograms() const
+{
+    return mAlignmentSpectrograms;
+}
+
+void ComparisonSchema::setAlignmentSpectrograms(const SpectrogramData *first, const SpectrogramData *second)
+{
+    mAlignmentSpectrograms = QPair<const SpectrogramData*,const SpectrogramData*>(first,second);
+}
+
+const WaveformData *ComparisonSchema::changeCurve() const
+{
+    return mChangeCurve;
+}
+
+void ComparisonSchema::setChangeCurve(const WaveformData *curve)
+{
+    mChangeCurve = curve;
+}
+
 WaveformPairList ComparisonSchema::waveforms() const
 {
     return mWaveforms;
@@ -6,6 +6,7 @@
 #include "waveformdata.h"
 
 class IntervalAnnotation;
+class SpectrogramData;
 
 class ComparisonSchema
 {
@@ -24,11 +25,21 @@ public:
     QString stretchAlgorithm() const;
     void setStretchAlgorithm(const QString &value);
 
+    //! \brief Return the spectrograms whose frames are aligned by dynamic time warping. If they are null, the paired curves are aligned instead.
+    QPair<const SpectrogramData*,const SpectrogramData*> alignmentSpectrograms() const;
+    void setAlignmentSpectrograms(const SpectrogramData *first, const SpectrogramData *second);
+
+    //! \brief Return the spectral change curve of the secondary sound, by which the "Accumulated" algorithm warps it, or 0 if none was chosen
+    const WaveformData* changeCurve() const;
+    void setChangeCurve(const WaveformData *curve);
+
 private:
     WaveformPairList mWaveforms;
     bool mIntervalComparison;
     QPair<const IntervalAnnotation*,const IntervalAnnotation*> mIntervals;
     QString mStretchAlgorithm;
+    QPair<const SpectrogramData*,const SpectrogramData*> mAlignmentSpectrograms;
+    const WaveformData *mChangeCurve;
 };
 
 #endif // COMPARISONSCHEMA_H
@@ -10,6 +10,9 @@
 #include "interval.h"
 #include "intervaldisplaywidget.h"
 #include "sound.h"
+#include "timewarp.h"
+#include "dtwaligner.h"
+#include "spectrogramdata.h"
 
 #include <QVBoxLayout>
 #include <QInputDialog>
@@ -43,13 +46,21 @@ ComparisonWidget::ComparisonWidget(ComparisonSchema schema, QWidget *parent) :
 
     mPrimaryInterval = schema.intervals().first;
     mSecondaryIntervals.append( schema.intervals().second );
-    warpSecondaryCurvesLinear(0);
+    // there is one change curve (or 0) for each secondary sound
+    mSecondaryChangeCurves.append( schema.changeCurve() );
+    if( schema.stretchAlgorithm() == "Dynamic time warping" )
+        warpSecondaryCurvesDtw(0);
+    else if( schema.intervalComparison() && schema.stretchAlgorithm() == "Accumulated" )
+        warpSecondaryCurvesAccumulated(0);
+    else if( schema.intervalComparison() )
+        warpSecondaryCurvesLinear(0);
 
     /// @todo this bit of trickery is a way to get the annotation at the top
     PlotViewWidget *pvw = new PlotViewWidget( mPrimaryCurves.at(0)->name() );
     pvw->addCurveData( mPrimaryCurves.at(0), false, QColor(Qt::blue) );
     pvw->addCurveData( mSecondaryCurves.first().at(0), false, QColor(Qt::red) );
-    addAnnotation( new IntervalDisplayWidget( schema.intervals().first, pvw, this ) );
+    if( schema.intervals().first != 0 )
+        addAnnotation( new IntervalDisplayWidget( schema.intervals().first, pvw, this ) );
     addPlotView( pvw, tr("This never shows up") );
 
     for( int i=1; i< mPrimaryCurves.count(); i++ )
@@ -120,7 +131,10 @@ ComparisonWidget::ComparisonWidget(ComparisonSchema schema, QWidget *parent) :
 
 ComparisonWidget::~ComparisonWidget()
 {
-    // quite a bit to do here
+    // the plots show these copies but do not own them; the curves of later secondaries belong to their sounds
+    qDeleteAll(mPrimaryCurves);
+    if( !mSecondaryCurves.isEmpty() )
+        qDeleteAll(mSecondaryCurves.first());
 }
 
 QString ComparisonWidget::createWindowTitle() const
@@ -251,7 +265,11 @@ void  ComparisonWidget::addSecondary()
             items << sec->waveformData()->at(i)->name();
         item = QInputDialog::getItem(this, tr("Acoustic Workspace"),tr("Choose the waveform that contains the spectral change information"), items, 0, false, &ok);
         if(!ok) { return; }
-        mSecondaryChangeMetrics << items.indexOf(item);
+        mSecondaryChangeCurves << sec->waveformData()->at(items.indexOf(item));
+    }
+    else
+    {
+        mSecondaryChangeCurves << 0;
     }
 
     mSecondaryCurves << list;
@@ -271,148 +289,131 @@ void  ComparisonWidget::addSecondary()
     drawCurves();
 }
 
-void ComparisonWidget::warpPrimaryCurvesLinear()
+QList< QList<WaveformData*> > ComparisonWidget::groupByTimeGrid(const QList<WaveformData *> &curves)
 {
-    for(int i=0; i<mPrimaryCurves.count(); i++) // for all curves
+    QList< QList<WaveformData*> > groups;
+    QList< QVector<double> > grids;
+    for(int i=0; i<curves.count(); i++)
     {
-        WaveformData *curve = mPrimaryCurves.at(i);
+        WaveformData *curve = curves.at(i);
+        if(curve==0) { continue; }
 
-        double *newTimes = (double*)malloc(sizeof(double)*curve->size());
+        int j;
+        for(j=0; j<grids.count(); j++)
+            if( grids.at(j).constData() == curve->xData().constData() || grids.at(j) == curve->xData() )
+                break;
 
-        for(int j=0; j<mPrimaryInterval->maIntervals.count(); j++) // for all intervals
+        if( j == grids.count() )
         {
-            int intervalLeftFrames = curve->getSampleFromTime( mPrimaryInterval->maIntervals.at(j)->mLeft );
-            int intervalRightFrames = curve->getSampleFromTime( mPrimaryInterval->maIntervals.at(j)->mRight );
-            double intervalLeftSeconds = mPrimaryInterval->maIntervals.at(j)->mLeft;
-
-            double primaryLeftSeconds = curve->xData().at(intervalLeftFrames);
-            double primaryLength = mPrimaryInterval->maIntervals.at(j)->mRight - mPrimaryInterval->maIntervals.at(j)->mLeft;
-            double frameLengthSeconds = curve->xData().at(intervalRightFrames) - curve->xData().at(intervalLeftFrames);
-
-            for(int k=intervalLeftFrames; k <= intervalRightFrames; k++)
-                *(newTimes+k) = intervalLeftSeconds + (curve->xData().at(k)-primaryLeftSeconds)*(primaryLength/frameLengthSeconds);
+            grids << curve->xData();
+            groups << QList<WaveformData*>();
         }
-        curve->setXData(newTimes);
+        groups[j] << curve;
     }
+    return groups;
 }
 
-void ComparisonWidget::warpSecondaryCurvesLinear(int index)
+void ComparisonWidget::applyWarp(const TimeWarp &warp, const QList<WaveformData *> &group)
 {
-    //    qDebug() << "ComparisonWidget::warpSecondaryCurvesLinear";
+    // every curve in the group gets the same (implicitly shared) vector of times
+    QVector<double> times = warp.map( group.first()->xData() );
+    for(int i=0; i<group.count(); i++)
+        group.at(i)->setTimes(times);
+}
 
-    // for all curves
-    for(int i=0; i<mSecondaryCurves.at(index).count(); i++)
+void ComparisonWidget::warpPrimaryCurvesLinear()
+{
+    QList< QList<WaveformData*> > groups = groupByTimeGrid(mPrimaryCurves);
+    for(int i=0; i<groups.count(); i++) // for each time grid
     {
-        WaveformData *curve = mSecondaryCurves.at(index).at(i);
-        const IntervalAnnotation *secondaryInterval = mSecondaryIntervals.at(index);
-        if(curve==0) { continue;}
+        const WaveformData *curve = groups.at(i).first();
 
-        double *newTimes = (double*)malloc(sizeof(double)*curve->size());
-        // for all intervals
-        for(int j=0; j<mPrimaryInterval->maIntervals.count(); j++)
+        // move the sample at or before each boundary onto the boundary
+        TimeWarp warp;
+        for(int j=0; j<mPrimaryInterval->count(); j++) // for all intervals
         {
-            double primaryIntervalLeftSeconds = mPrimaryInterval->maIntervals.at(j)->mLeft;
-
-            size_t secondaryIntervalLeftFrames = curve->getSampleFromTime( secondaryInterval->maIntervals.at(j)->mLeft );
-            size_t secondaryIntervalRightFrames = curve->getSampleFromTime( secondaryInterval->maIntervals.at(j)->mRight );
-
-            double secondaryLeftSeconds = curve->xData().at(secondaryIntervalLeftFrames);
-            double primaryIntervalLength = mPrimaryInterval->maIntervals.at(j)->mRight - mPrimaryInterval->maIntervals.at(j)->mLeft;
-            double frameLengthSeconds = curve->xData().at(secondaryIntervalRightFrames) - curve->xData().at(secondaryIntervalLeftFrames);
-
-            for(size_t k=secondaryIntervalLeftFrames; k <= secondaryIntervalRightFrames; k++)
-                *(newTimes + k) = primaryIntervalLeftSeconds + (curve->xData().at(k)-secondaryLeftSeconds)*(primaryIntervalLength/frameLengthSeconds);
+            warp.addKnot( curve->xData().at( curve->getSampleFromTime( mPrimaryInterval->at(j).mLeft ) ), mPrimaryInterval->at(j).mLeft );
+            warp.addKnot( curve->xData().at( curve->getSampleFromTime( mPrimaryInterval->at(j).mRight ) ), mPrimaryInterval->at(j).mRight );
         }
-
-        curve->setXData(newTimes);
+        applyWarp(warp, groups.at(i));
     }
 }
 
-void ComparisonWidget::warpPrimaryCurvesAccumulated()
+void ComparisonWidget::warpSecondaryCurvesLinear(int index)
 {
-    qDebug() << "ComparisonWidget::warpPrimaryCurvesAccumulated";
-
-    // for all curves
-    for(int i=0; i<mPrimaryCurves.count(); i++)
-    {
-        WaveformData *curve = mPrimaryCurves.at(i);
-
-        double *newTimes = (double*)malloc(sizeof(double)*curve->size());
+    const IntervalAnnotation *secondaryInterval = mSecondaryIntervals.at(index);
+    TimeWarp warp = TimeWarp::fromIntervals(secondaryInterval, mPrimaryInterval);
 
-        // for all intervals
-        for(int j=0; j<mPrimaryInterval->maIntervals.count(); j++)
-        {
-            int intervalLeftFrames = curve->getSampleFromTime( mPrimaryInterval->maIntervals.at(j)->mLeft );
-            int intervalRightFrames = curve->getSampleFromTime( mPrimaryInterval->maIntervals.at(j)->mRight );
-            double intervalLeftSeconds = mPrimaryInterval->maIntervals.at(j)->mLeft;
-
-            double *peChange = (double*)malloc(sizeof(double)*(intervalRightFrames-intervalLeftFrames+1));
-            *(peChange+0) = mPrimary->waveformData()->at(mPrimaryChangeMetric)->yData().at(intervalLeftFrames);
-            for(int k=intervalLeftFrames+1; k <= intervalRightFrames; k++)
-                *(peChange+k-intervalLeftFrames) = *(peChange+k-intervalLeftFrames-1) + mPrimary->waveformData()->at(mPrimaryChangeMetric)->yData().at(k);
-
-            for(int k=0; k < intervalRightFrames-intervalLeftFrames+1; k++)
-                *(peChange+k) = *(peChange+k) / *(peChange+intervalRightFrames-intervalLeftFrames);
-
-
-            double frameLengthSeconds = mPrimaryInterval->maIntervals.at(j)->mRight - mPrimaryInterval->maIntervals.at(j)->mLeft;
+    QList< QList<WaveformData*> > groups = groupByTimeGrid(mSecondaryCurves.at(index));
+    for(int i=0; i<groups.count(); i++)
+        applyWarp(warp, groups.at(i));
+}
 
-            for(int k=intervalLeftFrames; k <= intervalRightFrames; k++)
-            {
-                *(newTimes+k) = intervalLeftSeconds + (*(peChange+k-intervalLeftFrames)*frameLengthSeconds);
-                //		qDebug() << k << intervalLeftSeconds + (*(peChange+k-intervalLeftFrames)*frameLengthSeconds);
-                //		curve->setXDataAt(k, intervalLeftSeconds + (*(peChange+k-intervalLeftFrames)*frameLengthSeconds) );
-            }
-            free(peChange);
-        }
-        curve->setXData(newTimes);
+void ComparisonWidget::warpPrimaryCurvesAccumulated()
+{
+    TimeWarp warp = TimeWarp::fromAccumulatedChange(mPrimaryInterval, mPrimaryInterval, mPrimary->waveformData()->at(mPrimaryChangeMetric));
 
-        for(size_t j=0; j<curve->size(); j++)
-            qDebug() << j << curve->xData().at(j);
-    }
+    QList< QList<WaveformData*> > groups = groupByTimeGrid(mPrimaryCurves);
+    for(int i=0; i<groups.count(); i++)
+        applyWarp(warp, groups.at(i));
 }
 
 void ComparisonWidget::warpSecondaryCurvesAccumulated(int index)
 {
-    qDebug() << "ComparisonWidget::warpSecondaryCurvesAccumulated";
-
-    // for all curves
-    for(int i=0; i<mSecondaryCurves.at(index).count(); i++)
+    if( index >= mSecondaryChangeCurves.count() || mSecondaryChangeCurves.at(index) == 0 )
     {
-        WaveformData *curve = mSecondaryCurves.at(index).at(i);
-        const IntervalAnnotation *secondaryInterval = mSecondaryIntervals.at(index);
-        if(curve==0) { continue;}
-
-        double *newTimes = (double*)malloc(sizeof(double)*curve->size());
-
-        // for all intervals
-        for(int j=0; j<secondaryInterval->maIntervals.count(); j++)
-        {
-            int intervalLeftFrames = curve->getSampleFromTime( secondaryInterval->maIntervals.at(j)->mLeft );
-            int intervalRightFrames = curve->getSampleFromTime( secondaryInterval->maIntervals.at(j)->mRight );
-            double intervalLeftSeconds = mPrimaryInterval->maIntervals.at(j)->mLeft;
-
-            double *peChange = (double*)malloc(sizeof(double)*(intervalRightFrames-intervalLeftFrames+1));
-            *(peChange+0) = curve->yData().at(intervalLeftFrames);
-            for(int k=intervalLeftFrames+1; k <= intervalRightFrames; k++)
-                *(peChange+k-intervalLeftFrames) = *(peChange+k-intervalLeftFrames-1) + curve->yData().at(k);
+        qDebug() << "ComparisonWidget::warpSecondaryCurvesAccumulated: no spectral change curve for secondary sound" << index << "; using a linear warp";
+        warpSecondaryCurvesLinear(index);
+        return;
+    }
 
-            for(int k=0; k < intervalRightFrames-intervalLeftFrames+1; k++)
-                *(peChange+k) = *(peChange+k) / *(peChange+intervalRightFrames-intervalLeftFrames);
+    TimeWarp warp = TimeWarp::fromAccumulatedChange(mSecondaryIntervals.at(index), mPrimaryInterval, mSecondaryChangeCurves.at(index));
 
-            double frameLengthSeconds = mPrimaryInterval->maIntervals.at(j)->mRight - mPrimaryInterval->maIntervals.at(j)->mLeft;
+    QList< QList<WaveformData*> > groups = groupByTimeGrid(mSecondaryCurves.at(index));
+    for(int i=0; i<groups.count(); i++)
+        applyWarp(warp, groups.at(i));
+}
 
-            for(int k=intervalLeftFrames; k <= intervalRightFrames; k++)
+void ComparisonWidget::warpSecondaryCurvesDtw(int index)
+{
+    DtwAligner aligner;
+    QPair<const SpectrogramData*,const SpectrogramData*> spectrograms = mSchema.alignmentSpectrograms();
+    bool ok;
+    if( index == 0 && spectrograms.first != 0 && spectrograms.second != 0 )
+    {
+        ok = aligner.setFeatures( spectrograms.second, spectrograms.first );
+    }
+    else
+    {
+        const QList<WaveformData*> &secondary = mSecondaryCurves.at(index);
+        int sparsest = -1;
+        for(int i=0; i<secondary.count() && i<mPrimaryCurves.count(); i++)
+            if( secondary.at(i) != 0 && ( sparsest == -1 || secondary.at(i)->xData().count() < secondary.at(sparsest)->xData().count() ) )
+                sparsest = i;
+
+        QList<const WaveformData*> from, to;
+        for(int i=0; sparsest != -1 && i<secondary.count() && i<mPrimaryCurves.count(); i++)
+        {
+            if( secondary.at(i) != 0 && secondary.at(i)->xData() == secondary.at(sparsest)->xData() )
             {
-                *(newTimes+k) = intervalLeftSeconds + (*(peChange+k-intervalLeftFrames)*frameLengthSeconds);
+                from << secondary.at(i);
+                to << mPrimaryCurves.at(i);
             }
-            free(peChange);
         }
-        curve->setXData(newTimes);
+        ok = aligner.setFeatures( from, to );
+    }
 
-        for(size_t j=0; j<curve->size(); j++)
-            qDebug() << j << curve->xData().at(j);
+    if( !ok )
+    {
+        qDebug() << "ComparisonWidget::warpSecondaryCurvesDtw: there are no features to align secondary sound" << index << "with";
+        return;
     }
+
+    TimeWarp warp = aligner.warp();
+
+    QList< QList<WaveformData*> > groups = groupByTimeGrid(mSecondaryCurves.at(index));
+    for(int i=0; i<groups.count(); i++)
+        applyWarp(warp, groups.at(i));
 }
 
 void ComparisonWidget::drawCurves()
@@ -19,6 +19,7 @@ class QwtPointArrayData;
 class PlotDisplayAreaWidget;
 class IntervalAnnotation;
 class QColor;
+class TimeWarp;
 
 #include "plotdisplayareawidget.h"
 #include "comparisonschema.h"
@@ -56,6 +57,18 @@ private:
       */
     void warpSecondaryCurvesAccumulated(int index);
 
+    //! \brief  Stretch the samples of the secondary curves by dynamic time warping
+    /*!
+      Aligns the secondary sound with the primary sound by dynamic time warping (see DtwAligner), and maps the times of the secondary curves along the alignment path. No interval annotation is needed. The features that are aligned are the frames of the spectrograms chosen in the schema, or, if there are none, the paired curves on the sparsest time grid of the secondary sound (which excludes the waveform itself whenever there are other curves).
+      */
+    void warpSecondaryCurvesDtw(int index);
+
+    //! \brief Split \a curves into groups of curves with the same time vector. Null pointers are skipped.
+    static QList< QList<WaveformData*> > groupByTimeGrid(const QList<WaveformData*> &curves);
+
+    //! \brief Map the times of the curves in \a group, which share a time vector, with \a warp. The mapping is computed once for the group.
+    static void applyWarp(const TimeWarp &warp, const QList<WaveformData*> &group);
+
     //! \brief Adds plots to the PlotDisplayWidget object for each comparison
     void drawCurves();
 
@@ -71,7 +84,7 @@ private:
     QList<QColor> colors;
 
     int mWarpAlgorithm, mPrimaryChangeMetric;
-    QList<int> mSecondaryChangeMetrics;
+    QList<const WaveformData*> mSecondaryChangeCurves;
 
     PlotDisplayAreaWidget *mDisplayWidget;
 
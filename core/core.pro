@@ -0,0 +1,67 @@
+# -------------------------------------------------
+# The data classes, project input and output, analysis and plugin host.
+# Only QtCore is used, so that batch tools and tests can link the library
+# without QtWidgets or Qwt; they also need fftw, gsl and libsndfile.
+# -------------------------------------------------
+TARGET = awcore
+TEMPLATE = lib
+CONFIG += staticlib
+QT = core concurrent
+INCLUDEPATH += ..
+SOURCES += ../regression.cpp \
+    ../intervalannotation.cpp \
+    ../spectrogramdata.cpp \
+    ../waveformdata.cpp \
+    ../sound.cpp \
+    ../soundview.cpp \
+    ../curveparameters.cpp \
+    ../plotparameters.cpp \
+    ../spectrogramparameters.cpp \
+    ../interval.cpp \
+    ../comparisonschema.cpp \
+    ../derivation.cpp \
+    ../projectwriter.cpp \
+    ../blockcodec.cpp \
+    ../textgridreader.cpp \
+    ../timewarp.cpp \
+    ../dtwaligner.cpp \
+    ../pairwisecomparison.cpp \
+    ../ringbuffer.cpp \
+    ../streamsource.cpp \
+    ../streaminganalyser.cpp \
+    ../framecollector.cpp \
+    ../blockmeasureadapter.cpp \
+    ../blockpipeline.cpp \
+    ../taskscheduler.cpp \
+    ../pluginhost.cpp \
+    ../pluginlibrary.cpp \
+    ../pluginproxy.cpp
+HEADERS += ../interfaces.h \
+    ../regression.h \
+    ../intervalannotation.h \
+    ../spectrogramdata.h \
+    ../waveformdata.h \
+    ../sound.h \
+    ../soundview.h \
+    ../curveparameters.h \
+    ../plotparameters.h \
+    ../spectrogramparameters.h \
+    ../interval.h \
+    ../comparisonschema.h \
+    ../derivation.h \
+    ../projectwriter.h \
+    ../blockcodec.h \
+    ../textgridreader.h \
+    ../timewarp.h \
+    ../dtwaligner.h \
+    ../pairwisecomparison.h \
+    ../ringbuffer.h \
+    ../streamsource.h \
+    ../streaminganalyser.h \
+    ../framecollector.h \
+    ../blockmeasureadapter.h \
+    ../blockpipeline.h \
+    ../taskscheduler.h \
+    ../pluginhost.h \
+    ../pluginlibrary.h \
+    ../pluginproxy.h
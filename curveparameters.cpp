@@ -5,29 +5,37 @@ CurveParameters::CurveParameters()
 
 }
 
-CurveParameters::CurveParameters(QPen pen, QwtPlotCurve::CurveStyle curveStyle, bool antialiased) :
-    mPen(pen),
-    mCurveStyle(curveStyle),
-    mAntialiased(antialiased)
+quint32 CurveParameters::rgb(int r, int g, int b)
 {
+    return ( (quint32)(r & 0xff) << 16 ) | ( (quint32)(g & 0xff) << 8 ) | (quint32)(b & 0xff);
 }
 
-QPen CurveParameters::pen() const
+quint32 CurveParameters::lineColor() const
 {
-    return mPen;
+    return mLineColor;
 }
 
-void CurveParameters::setPen(const QPen &value)
+void CurveParameters::setLineColor(quint32 value)
 {
-    mPen = value;
+    mLineColor = value;
 }
 
-QwtPlotCurve::CurveStyle CurveParameters::curveStyle() const
+int CurveParameters::lineWidth() const
+{
+    return mLineWidth;
+}
+
+void CurveParameters::setLineWidth(int value)
+{
+    mLineWidth = value;
+}
+
+int CurveParameters::curveStyle() const
 {
     return mCurveStyle;
 }
 
-void CurveParameters::setCurveStyle(const QwtPlotCurve::CurveStyle &value)
+void CurveParameters::setCurveStyle(int value)
 {
     mCurveStyle = value;
 }
@@ -41,24 +49,24 @@ void CurveParameters::setAntialiased(bool value)
     mAntialiased = value;
 }
 
-QBrush CurveParameters::symbolBrush() const
+quint32 CurveParameters::symbolFillColor() const
 {
-    return mSymbolBrush;
+    return mSymbolFillColor;
 }
 
-void CurveParameters::setSymbolBrush(const QBrush &value)
+void CurveParameters::setSymbolFillColor(quint32 value)
 {
-    mSymbolBrush = value;
+    mSymbolFillColor = value;
 }
 
-QPen CurveParameters::symbolPen() const
+quint32 CurveParameters::symbolColor() const
 {
-    return mSymbolPen;
+    return mSymbolColor;
 }
 
-void CurveParameters::setSymbolPen(const QPen &value)
+void CurveParameters::setSymbolColor(quint32 value)
 {
-    mSymbolPen = value;
+    mSymbolColor = value;
 }
 int CurveParameters::symbolSize() const
 {
@@ -70,12 +78,12 @@ void CurveParameters::setSymbolSize(int value)
     mSymbolSize = value;
 }
 
-QwtSymbol::Style CurveParameters::symbolStyle() const
+int CurveParameters::symbolStyle() const
 {
     return mSymbolStyle;
 }
 
-void CurveParameters::setSymbolStyle(const QwtSymbol::Style &value)
+void CurveParameters::setSymbolStyle(int value)
 {
     mSymbolStyle = value;
 }
@@ -97,11 +105,3 @@ void CurveParameters::setWaveformData(WaveformData *value)
 {
     mWaveformData = value;
 }
-
-
-
-
-
-
-
-
@@ -1,42 +1,48 @@
 #ifndef CURVEPARAMETERS_H
 #define CURVEPARAMETERS_H
 
-#include <QPen>
-#include <QBrush>
-
-#include <qwt_plot_curve.h>
-#include <qwt_plot_item.h>
-#include <qwt_symbol.h>
+#include <QtGlobal>
 
 class WaveformData;
 
+/*!
+  \class CurveParameters
+  \ingroup Data
+  \brief The display settings of a curve in a saved plot.
+
+  The colours are RGB triplets (0xRRGGBB), and the styles are the values of QwtPlotCurve::CurveStyle and QwtSymbol::Style, so that the settings can be read from a project without a display. SoundWidget turns them into pens and symbols.
+*/
 class CurveParameters
 {
 public:
     CurveParameters();
-    /// @todo probably delete this
-    CurveParameters(QPen pen, QwtPlotCurve::CurveStyle curveStyle, bool antialiased);
 
-    QPen pen() const;
-    void setPen(const QPen &value);
+    //! \brief Return the RGB triplet of the red, green and blue components \a r, \a g and \a b
+    static quint32 rgb(int r, int g, int b);
+
+    quint32 lineColor() const;
+    void setLineColor(quint32 value);
+
+    int lineWidth() const;
+    void setLineWidth(int value);
 
-    QwtPlotCurve::CurveStyle curveStyle() const;
-    void setCurveStyle(const QwtPlotCurve::CurveStyle &value);
+    int curveStyle() const;
+    void setCurveStyle(int value);
 
     bool antialiased() const;
     void setAntialiased(bool value);
 
-    QBrush symbolBrush() const;
-    void setSymbolBrush(const QBrush &value);
+    quint32 symbolFillColor() const;
+    void setSymbolFillColor(quint32 value);
 
-    QPen symbolPen() const;
-    void setSymbolPen(const QPen &value);
+    quint32 symbolColor() const;
+    void setSymbolColor(quint32 value);
 
     int symbolSize() const;
     void setSymbolSize(int value);
 
-    QwtSymbol::Style symbolStyle() const;
-    void setSymbolStyle(const QwtSymbol::Style &value);
+    int symbolStyle() const;
+    void setSymbolStyle(int value);
 
     bool isSecondary() const;
     void setIsSecondary(bool value);
@@ -47,15 +53,16 @@ public:
 private:
     WaveformData *mWaveformData;
 
-    QPen mPen;
-    QwtPlotCurve::CurveStyle mCurveStyle;
+    quint32 mLineColor;
+    int mLineWidth;
+    int mCurveStyle;
     bool mAntialiased;
     bool mIsSecondary;
 
-    QBrush mSymbolBrush;
-    QPen mSymbolPen;
+    quint32 mSymbolFillColor;
+    quint32 mSymbolColor;
     int mSymbolSize;
-    QwtSymbol::Style mSymbolStyle;
+    int mSymbolStyle;
 
 };
 
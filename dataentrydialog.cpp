@@ -8,6 +8,8 @@
 
 #include <QtDebug>
 
+#include "interfaces.h"
+
 DataEntryDialog::DataEntryDialog(const QStringList* f, QList<QVariant>* v, QString label, QWidget *parent = 0) :
     QDialog(parent)
 {
@@ -67,3 +69,20 @@ void DataEntryDialog::accept()
     }
     QDialog::accept();
 }
+
+bool DataEntryDialog::editParameters(AbstractMeasurement *plugin, QWidget *parent)
+{
+    QStringList labels = plugin->parameterLabels();
+    if( labels.isEmpty() ) { return true; }
+
+    QList<QVariant> values;
+    for(int i=0; i<labels.count(); i++)
+        values << plugin->parameter(labels.at(i));
+
+    DataEntryDialog dew(&labels, &values, "", parent);
+    if( dew.exec() != QDialog::Accepted ) { return false; }
+
+    for(int i=0; i<labels.count(); i++)
+        plugin->setParameter(labels.at(i), dew.values()->at(i));
+    return true;
+}
@@ -16,6 +16,7 @@
 #include <QVariant>
 
 class QStringList;
+class AbstractMeasurement;
 
 class DataEntryDialog : public QDialog
 {
@@ -32,6 +33,12 @@ public:
     QList<QLineEdit*> *edits();
     QList<QVariant> *values();
 
+    //! \brief Show the settings of \a plugin in a dialog, and change them to the values entered. Return false if the dialog is rejected.
+    /*!
+      This is the settings dialog of every plugin; the plugins themselves only describe their settings (see AbstractMeasurement), so that they do not depend on QtWidgets. A plugin without settings is not shown.
+      */
+    static bool editParameters(AbstractMeasurement *plugin, QWidget *parent = 0);
+
 signals:
 
 public slots:
@@ -6,6 +6,9 @@
 #include "interfaces.h"
 #include "pluginviewtreewidget.h"
 #include "datasourcetreewidget.h"
+#include "dataentrydialog.h"
+#include "derivation.h"
+#include "sound.h"
 
 #include <QtDebug>
 #include <QtWidgets>
@@ -13,13 +16,14 @@
 #include <QStringList>
 #include <QGridLayout>
 
-DataManagerDialog::DataManagerDialog(QList<AbstractWaveform2WaveformMeasure*> *w2wPlugins, QList<AbstractWaveform2SpectrogramMeasure*> *w2sPlugins, QList<AbstractSpectrogram2WaveformMeasure*> *s2wPlugins, QList<AbstractSpectrogram2SpectrogramMeasure*> *s2sPlugins, QList<WaveformData*> *wfd, QList<SpectrogramData*> *spd, QWidget *parent) :
+DataManagerDialog::DataManagerDialog(QList<AbstractWaveform2WaveformMeasure*> *w2wPlugins, QList<AbstractWaveform2SpectrogramMeasure*> *w2sPlugins, QList<AbstractSpectrogram2WaveformMeasure*> *s2wPlugins, QList<AbstractSpectrogram2SpectrogramMeasure*> *s2sPlugins, Sound *sound, QWidget *parent) :
 	QDialog(parent)
 {
     setSizeGripEnabled(true);
 
-    maWaveformData = wfd;
-    maSpectrogramData = spd;
+    mSound = sound;
+    maWaveformData = sound->waveformData();
+    maSpectrogramData = sound->spectrogramData();
 
     mW2wPlugins = w2wPlugins;
     mW2sPlugins = w2sPlugins;
@@ -30,6 +34,8 @@ DataManagerDialog::DataManagerDialog(QList<AbstractWaveform2WaveformMeasure*> *w
 
     mWaveformTree = new DataSourceTreeWidget("waveform",this); mWaveformTree->setHeaderHidden(true);
     mSpectrogramTree = new DataSourceTreeWidget("spectrogram",this); mSpectrogramTree->setHeaderHidden(true);
+    mWaveformTree->setDerivationSettingsEnabled(true);
+    mSpectrogramTree->setDerivationSettingsEnabled(true);
 
     mW2wTree = new PluginViewTreeWidget("waveform"); mW2wTree->setHeaderHidden(true);
     mW2sTree = new PluginViewTreeWidget("waveform"); mW2sTree->setHeaderHidden(true);
@@ -77,6 +83,9 @@ DataManagerDialog::DataManagerDialog(QList<AbstractWaveform2WaveformMeasure*> *w
     connect(mWaveformTree,SIGNAL(renameItemSignal(int)),this,SLOT(renameWaveform(int)));
     connect(mSpectrogramTree,SIGNAL(renameItemSignal(int)),this,SLOT(renameSpectrogram(int)));
 
+    connect(mWaveformTree,SIGNAL(derivationSettingsItemSignal(int)),this,SLOT(waveformDerivationSettings(int)));
+    connect(mSpectrogramTree,SIGNAL(derivationSettingsItemSignal(int)),this,SLOT(spectrogramDerivationSettings(int)));
+
     setLayout(glayout);
     setWindowTitle("Acoustic Workspace Data Manager");
 
@@ -156,49 +165,49 @@ void DataManagerDialog::populateSpectrogramTree()
 
 void DataManagerDialog::w2wDrop(int from, int toPlugin, int toSubplugin)
 {
-    mW2wPlugins->at(toPlugin)->settings(toSubplugin);
+    DataEntryDialog::editParameters(mW2wPlugins->at(toPlugin), this);
 
     if(toSubplugin < mW2wPlugins->at(toPlugin)->names().length())
-	mW2wPlugins->at(toPlugin)->calculate(toSubplugin,maWaveformData->at(from));
+	mSound->calculate(mW2wPlugins->at(toPlugin),toSubplugin,maWaveformData->at(from));
     else if(toSubplugin == mW2wPlugins->at(toPlugin)->names().length())
 	for(int i=0; i<mW2wPlugins->at(toPlugin)->names().length(); i++)
-	    mW2wPlugins->at(toPlugin)->calculate(i,maWaveformData->at(from));
+	    mSound->calculate(mW2wPlugins->at(toPlugin),i,maWaveformData->at(from));
     populateWaveformTree();
 }
 
 void DataManagerDialog::w2sDrop(int from, int toPlugin, int toSubplugin)
 {
-    mW2sPlugins->at(toPlugin)->settings(toSubplugin);
+    DataEntryDialog::editParameters(mW2sPlugins->at(toPlugin), this);
 
     if(toSubplugin < mW2sPlugins->at(toPlugin)->names().length())
-	mW2sPlugins->at(toPlugin)->calculate(toSubplugin,maWaveformData->at(from));
+	mSound->calculate(mW2sPlugins->at(toPlugin),toSubplugin,maWaveformData->at(from));
     else if(toSubplugin == mW2sPlugins->at(toPlugin)->names().length())
 	for(int i=0; i<mW2sPlugins->at(toPlugin)->names().length(); i++)
-	    mW2sPlugins->at(toPlugin)->calculate(i,maWaveformData->at(from));
+	    mSound->calculate(mW2sPlugins->at(toPlugin),i,maWaveformData->at(from));
     populateSpectrogramTree();
 }
 
 void DataManagerDialog::s2wDrop(int from, int toPlugin, int toSubplugin)
 {
-    mS2wPlugins->at(toPlugin)->settings(toSubplugin);
+    DataEntryDialog::editParameters(mS2wPlugins->at(toPlugin), this);
 
     if(toSubplugin < mS2wPlugins->at(toPlugin)->names().length())
-	mS2wPlugins->at(toPlugin)->calculate(toSubplugin,maSpectrogramData->at(from));
+	mSound->calculate(mS2wPlugins->at(toPlugin),toSubplugin,maSpectrogramData->at(from));
     else if(toSubplugin == mS2wPlugins->at(toPlugin)->names().length())
 	for(int i=0; i<mS2wPlugins->at(toPlugin)->names().length(); i++)
-	    mS2wPlugins->at(toPlugin)->calculate(i,maSpectrogramData->at(from));
+	    mSound->calculate(mS2wPlugins->at(toPlugin),i,maSpectrogramData->at(from));
     populateWaveformTree();
 }
 
 void DataManagerDialog::s2sDrop(int from, int toPlugin, int toSubplugin)
 {
-    mS2sPlugins->at(toPlugin)->settings(toSubplugin);
+    DataEntryDialog::editParameters(mS2sPlugins->at(toPlugin), this);
 
     if(toSubplugin < mS2sPlugins->at(toPlugin)->names().length())
-	mS2sPlugins->at(toPlugin)->calculate(toSubplugin,maSpectrogramData->at(from));
+	mSound->calculate(mS2sPlugins->at(toPlugin),toSubplugin,maSpectrogramData->at(from));
     else if(toSubplugin == mS2sPlugins->at(toPlugin)->names().length())
 	for(int i=0; i<mS2sPlugins->at(toPlugin)->names().length(); i++)
-	    mS2sPlugins->at(toPlugin)->calculate(i,maSpectrogramData->at(from));
+	    mSound->calculate(mS2sPlugins->at(toPlugin),i,maSpectrogramData->at(from));
     populateSpectrogramTree();
 }
 
@@ -243,3 +252,46 @@ void DataManagerDialog::renameSpectrogram(int index)
 	mSpectrogramTree->topLevelItem(index)->setText(0,text);
     }
 }
+
+bool DataManagerDialog::editDerivationSettings(QObject *data)
+{
+    Derivation *derivation = mSound->derivationOf(data);
+    if( derivation == 0 )
+    {
+	QMessageBox::information(this, tr("Derivation settings"), tr("This item was not created by a plugin, so it has no settings to change."));
+	return false;
+    }
+    if( derivation->plugin() == 0 )
+    {
+	QMessageBox::warning(this, tr("Derivation settings"), tr("The plugin %1 is not loaded, so this item cannot be recomputed.").arg(derivation->pluginScriptName()));
+	return false;
+    }
+
+    QStringList labels = derivation->parameterLabels();
+    QList<QVariant> values = derivation->parameterValues();
+    DataEntryDialog dew(&labels, &values, derivation->pluginScriptName() + ": " + derivation->measure(), this);
+    if( dew.exec() != QDialog::Accepted )
+	return false;
+
+    mSound->setDerivationParameters(derivation, *dew.values());
+    mSound->recalculateStale();
+    return true;
+}
+
+void DataManagerDialog::waveformDerivationSettings(int index)
+{
+    if( editDerivationSettings(maWaveformData->at(index)) )
+    {
+	populateWaveformTree();
+	populateSpectrogramTree();
+    }
+}
+
+void DataManagerDialog::spectrogramDerivationSettings(int index)
+{
+    if( editDerivationSettings(maSpectrogramData->at(index)) )
+    {
+	populateWaveformTree();
+	populateSpectrogramTree();
+    }
+}
@@ -3,6 +3,8 @@
     \brief A dialog class for managing project data.
 
     This dialog provides a user interface that allows users to rename or delete spectrograms and waveforms. Users can also create new spectrograms and waveforms by dragging existing ones onto plugins that will make new ones.
+
+    New data is created through Sound::calculate, so the project remembers how it was derived. The settings a waveform or spectrogram was derived with can be changed from the context menu; only that item and the data derived from it are then recomputed.
   */
 
 
@@ -22,6 +24,7 @@ class PlotViewWidget;
 class WaveformData;
 class PluginViewTreeWidget;
 class DataSourceTreeWidget;
+class Sound;
 
 class AbstractWaveform2WaveformMeasure;
 class AbstractWaveform2SpectrogramMeasure;
@@ -32,7 +35,7 @@ class DataManagerDialog : public QDialog
 {
     Q_OBJECT
 public:
-    DataManagerDialog(QList<AbstractWaveform2WaveformMeasure*> *w2wPlugins, QList<AbstractWaveform2SpectrogramMeasure*> *w2sPlugins, QList<AbstractSpectrogram2WaveformMeasure*> *s2wPlugins, QList<AbstractSpectrogram2SpectrogramMeasure*> *s2sPlugins, QList<WaveformData*> *wfd, QList<SpectrogramData*> *spd, QWidget *parent = 0);
+    DataManagerDialog(QList<AbstractWaveform2WaveformMeasure*> *w2wPlugins, QList<AbstractWaveform2SpectrogramMeasure*> *w2sPlugins, QList<AbstractSpectrogram2WaveformMeasure*> *s2wPlugins, QList<AbstractSpectrogram2SpectrogramMeasure*> *s2sPlugins, Sound *sound, QWidget *parent = 0);
 
 private slots:
     //! \brief Populates the tree that displays waveform-to-waveform plugins
@@ -84,6 +87,12 @@ public slots:
     //! \brief Prompts the user to enter a new name for the \a index-th spectrogram, and renames the spectrogram
     void renameSpectrogram(int index);
 
+    //! \brief Lets the user change the settings the \a index-th waveform was derived with, and recomputes the stale data
+    void waveformDerivationSettings(int index);
+
+    //! \brief Lets the user change the settings the \a index-th spectrogram was derived with, and recomputes the stale data
+    void spectrogramDerivationSettings(int index);
+
 signals:
     //! \brief Emitted when a user tried to delete a waveform using the context menu (in another widget)
     void removeWaveform(int index);
@@ -95,11 +104,15 @@ private:
     DataSourceTreeWidget *mWaveformTree, *mSpectrogramTree;
     void drawProsodyViewTree();
 
+    //! \brief Shows a DataEntryDialog for the settings of the derivation that produced \a data, returning true if the settings were changed
+    bool editDerivationSettings(QObject *data);
+
     QList<AbstractWaveform2WaveformMeasure*> *mW2wPlugins;
     QList<AbstractWaveform2SpectrogramMeasure*> *mW2sPlugins;
     QList<AbstractSpectrogram2WaveformMeasure*> *mS2wPlugins;
     QList<AbstractSpectrogram2SpectrogramMeasure*> *mS2sPlugins;
 
+    Sound *mSound;
     QList<WaveformData*> *maWaveformData;
     QList<SpectrogramData*> *maSpectrogramData;
 };
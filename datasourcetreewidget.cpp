@@ -6,7 +6,7 @@
 #include <QContextMenuEvent>
 #include <QtDebug>
 
-DataSourceTreeWidget::DataSourceTreeWidget(QString mime, QWidget *parent) : QTreeWidget(parent), mMimeIdString(mime)
+DataSourceTreeWidget::DataSourceTreeWidget(QString mime, QWidget *parent) : QTreeWidget(parent), mMimeIdString(mime), mDerivationSettingsEnabled(false)
 {
     setDragEnabled(true);
     setDragDropMode(QAbstractItemView::DragOnly);
@@ -15,6 +15,8 @@ DataSourceTreeWidget::DataSourceTreeWidget(QString mime, QWidget *parent) : QTre
     connect(mRemoveAction,SIGNAL(triggered()),this,SLOT(remove()));
     mRenameAction = new QAction(tr("Rename"),this);
     connect(mRenameAction,SIGNAL(triggered()),this,SLOT(rename()));
+    mDerivationSettingsAction = new QAction(tr("Derivation settings..."),this);
+    connect(mDerivationSettingsAction,SIGNAL(triggered()),this,SLOT(derivationSettings()));
 }
 
 QStringList DataSourceTreeWidget::mimeTypes() const
@@ -45,9 +47,19 @@ void DataSourceTreeWidget::contextMenuEvent ( QContextMenuEvent * event )
     QMenu menu(this);
     menu.addAction(mRenameAction);
     menu.addAction(mRemoveAction);
+    if(mDerivationSettingsEnabled)
+    {
+	menu.addSeparator();
+	menu.addAction(mDerivationSettingsAction);
+    }
     menu.exec(event->globalPos());
 }
 
+void DataSourceTreeWidget::setDerivationSettingsEnabled(bool enabled)
+{
+    mDerivationSettingsEnabled = enabled;
+}
+
 void DataSourceTreeWidget::remove()
 {
     QTreeWidgetItem *target = currentItem();
@@ -72,3 +84,15 @@ void DataSourceTreeWidget::rename()
     }
 }
 
+
+void DataSourceTreeWidget::derivationSettings()
+{
+    QTreeWidgetItem *target = currentItem();
+    if(target==0) { return; }
+
+    int index;
+    if( (index = indexOfTopLevelItem(target)) != -1 )
+    {
+	emit derivationSettingsItemSignal(index);
+    }
+}
@@ -31,6 +31,9 @@ public:
     //! \brief Provides a context menu when an item is right-clicked
     void contextMenuEvent ( QContextMenuEvent * event );
 
+    //! \brief Sets whether the context menu offers to change the settings that an item was derived with
+    void setDerivationSettingsEnabled(bool enabled);
+
 signals:
     //! \brief Emitted when a user wants to remove the \a i-th item
     void removeItemSignal(int i);
@@ -38,6 +41,9 @@ signals:
     //! \brief Emitted when a user wants to rename the \a i-th item
     void renameItemSignal(int i);
 
+    //! \brief Emitted when a user wants to change the settings the \a i-th item was derived with
+    void derivationSettingsItemSignal(int i);
+
 private slots:
     //! \brief Detects which item is currently selected, emitting removeItemSignal if appropriate
     void remove();
@@ -45,9 +51,13 @@ private slots:
     //! \brief Detects which item is currently selected, emitting renameItemSignal if appropriate
     void rename();
 
+    //! \brief Detects which item is currently selected, emitting derivationSettingsItemSignal if appropriate
+    void derivationSettings();
+
 private:
     QString mMimeIdString;
-    QAction *mRemoveAction, *mRenameAction;
+    QAction *mRemoveAction, *mRenameAction, *mDerivationSettingsAction;
+    bool mDerivationSettingsEnabled;
 };
 
 #endif // DATASOURCETREE_H
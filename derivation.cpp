@@ -0,0 +1,138 @@
+#include "derivation.h"
+
+#include "interfaces.h"
+
+Derivation::Derivation(Derivation::Type type, QObject *source, AbstractMeasurement *plugin, const QString &pluginScriptName, const QString &measure) :
+    mType(type),
+    mSource(source),
+    mPlugin(plugin),
+    mPluginScriptName(pluginScriptName),
+    mMeasure(measure),
+    mStale(false)
+{
+}
+
+Derivation::Type Derivation::type() const
+{
+    return mType;
+}
+
+bool Derivation::sourceIsSpectrogram() const
+{
+    return mType == Derivation::Spectrogram2Waveform || mType == Derivation::Spectrogram2Spectrogram;
+}
+
+bool Derivation::producesSpectrograms() const
+{
+    return mType == Derivation::Waveform2Spectrogram || mType == Derivation::Spectrogram2Spectrogram;
+}
+
+QObject *Derivation::source() const
+{
+    return mSource;
+}
+
+void Derivation::setSource(QObject *source)
+{
+    mSource = source;
+}
+
+AbstractMeasurement *Derivation::plugin() const
+{
+    return mPlugin;
+}
+
+void Derivation::setPlugin(AbstractMeasurement *plugin)
+{
+    mPlugin = plugin;
+}
+
+QString Derivation::pluginScriptName() const
+{
+    return mPluginScriptName;
+}
+
+QString Derivation::measure() const
+{
+    return mMeasure;
+}
+
+QStringList Derivation::parameterLabels() const
+{
+    return maParameterLabels;
+}
+
+QList<QVariant> Derivation::parameterValues() const
+{
+    return maParameterValues;
+}
+
+void Derivation::setParameter(const QString &label, const QVariant &value)
+{
+    int index = maParameterLabels.indexOf(label);
+    if(index == -1)
+    {
+        maParameterLabels << label;
+        maParameterValues << value;
+    }
+    else
+    {
+        maParameterValues[index] = value;
+    }
+}
+
+void Derivation::recordParameters(const AbstractMeasurement *plugin)
+{
+    maParameterLabels.clear();
+    maParameterValues.clear();
+    QStringList labels = plugin->parameterLabels();
+    for(int i=0; i<labels.count(); i++)
+        setParameter(labels.at(i), plugin->parameter(labels.at(i)));
+}
+
+QList<QObject *> *Derivation::outputs()
+{
+    return &maOutputs;
+}
+
+const QList<QObject *> *Derivation::outputs() const
+{
+    return &maOutputs;
+}
+
+bool Derivation::isStale() const
+{
+    return mStale;
+}
+
+void Derivation::setStale(bool stale)
+{
+    mStale = stale;
+}
+
+QString Derivation::typeToString(Derivation::Type type)
+{
+    switch(type)
+    {
+    case Derivation::Waveform2Spectrogram:
+        return "waveform-to-spectrogram";
+    case Derivation::Spectrogram2Waveform:
+        return "spectrogram-to-waveform";
+    case Derivation::Spectrogram2Spectrogram:
+        return "spectrogram-to-spectrogram";
+    default:
+        return "waveform-to-waveform";
+    }
+}
+
+Derivation::Type Derivation::typeFromString(const QString &str)
+{
+    if( str == "waveform-to-spectrogram" )
+        return Derivation::Waveform2Spectrogram;
+    else if( str == "spectrogram-to-waveform" )
+        return Derivation::Spectrogram2Waveform;
+    else if( str == "spectrogram-to-spectrogram" )
+        return Derivation::Spectrogram2Spectrogram;
+    else
+        return Derivation::Waveform2Waveform;
+}
@@ -0,0 +1,97 @@
+/*!
+  \class Derivation
+  \ingroup Data
+  \brief A record of how waveforms or spectrograms were derived from another waveform or spectrogram.
+
+  A Derivation stores the source data, the plugin and measure that were applied to it, the plugin settings that were in effect, and the data objects that the measure produced. Sound keeps these records as a graph, so that when a source or a setting changes only the affected descendants need to be recomputed.
+
+  The plugin is stored both as a pointer and as its script name. The pointer is not known when a project is read from a file; Sound::resolvePlugins() fills it in from the script name.
+*/
+
+#ifndef DERIVATION_H
+#define DERIVATION_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+class QObject;
+class AbstractMeasurement;
+
+class Derivation
+{
+public:
+    enum Type { Waveform2Waveform, Waveform2Spectrogram, Spectrogram2Waveform, Spectrogram2Spectrogram };
+
+    //! \brief Create a record of \a measure of the plugin \a plugin (with script name \a pluginScriptName) being applied to \a source
+    Derivation(Derivation::Type type, QObject *source, AbstractMeasurement *plugin, const QString &pluginScriptName, const QString &measure);
+
+    //! \brief Return the type of the derivation
+    Derivation::Type type() const;
+
+    //! \brief Return true if the source of the derivation is a SpectrogramData object
+    bool sourceIsSpectrogram() const;
+
+    //! \brief Return true if the outputs of the derivation are SpectrogramData objects
+    bool producesSpectrograms() const;
+
+    //! \brief Return the data object the measure was applied to
+    QObject *source() const;
+
+    //! \brief Set the data object the measure is applied to
+    void setSource(QObject *source);
+
+    //! \brief Return the plugin that performs the measure, or 0 if it has not been resolved
+    AbstractMeasurement *plugin() const;
+
+    //! \brief Set the plugin that performs the measure
+    void setPlugin(AbstractMeasurement *plugin);
+
+    //! \brief Return the script name of the plugin that performs the measure
+    QString pluginScriptName() const;
+
+    //! \brief Return the name of the measure
+    QString measure() const;
+
+    //! \brief Return the labels of the recorded plugin settings
+    QStringList parameterLabels() const;
+
+    //! \brief Return the values of the recorded plugin settings, in the same order as parameterLabels()
+    QList<QVariant> parameterValues() const;
+
+    //! \brief Record the setting \a label with value \a value, replacing any existing value
+    void setParameter(const QString &label, const QVariant &value);
+
+    //! \brief Record the current settings of \a plugin
+    void recordParameters(const AbstractMeasurement *plugin);
+
+    //! \brief Return a pointer to the list of data objects produced by the measure
+    QList<QObject*> *outputs();
+    const QList<QObject*> *outputs() const;
+
+    //! \brief Return true if the outputs need to be recomputed
+    bool isStale() const;
+
+    //! \brief Set whether the outputs need to be recomputed
+    void setStale(bool stale);
+
+    //! \brief Return the string used for \a type in project files
+    static QString typeToString(Derivation::Type type);
+
+    //! \brief Return the type corresponding to the string \a str from a project file
+    static Derivation::Type typeFromString(const QString &str);
+
+private:
+    Derivation::Type mType;
+    QObject *mSource;
+    AbstractMeasurement *mPlugin;
+    QString mPluginScriptName;
+    QString mMeasure;
+    QStringList maParameterLabels;
+    QList<QVariant> maParameterValues;
+    QList<QObject*> maOutputs;
+    bool mStale;
+};
+
+#endif // DERIVATION_H
@@ -0,0 +1,395 @@
+#include "dtwaligner.h"
+
+#include "spectrogramdata.h"
+#include "waveformdata.h"
+#include "interfaces.h"
+
+#include <QtDebug>
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+DtwAligner::DtwAligner() :
+    mRadius(8),
+    mBandWidth(0.1)
+{
+}
+
+DtwAligner::Features DtwAligner::features(const SpectrogramData *spectrogram)
+{
+    Features features;
+    int nFrames = spectrogram->getNTimeSteps();
+    features.dims = spectrogram->getNFrequencyBins();
+    features.values.resize( nFrames * features.dims );
+    memcpy( features.values.data(), spectrogram->pdata(), sizeof(double) * nFrames * features.dims );
+    features.times.resize( nFrames );
+    for(int i=0; i<nFrames; i++)
+        features.times[i] = spectrogram->getTimeFromIndex(i);
+
+    normalise(&features);
+    return features;
+}
+
+DtwAligner::Features DtwAligner::features(const QList<const WaveformData *> &curves)
+{
+    Features features;
+    if( curves.isEmpty() ) { return features; }
+
+    features.times = curves.first()->xData();
+    features.dims = curves.count();
+    int nFrames = features.times.count();
+    features.values.resize( nFrames * features.dims );
+
+    for(int d=0; d<features.dims; d++)
+    {
+        // the sample at or before each time step; the times of both are sorted, so one pass suffices
+        const QVector<double> &x = curves.at(d)->xData();
+        const QVector<double> &y = curves.at(d)->yData();
+        int j = 0;
+        for(int i=0; i<nFrames; i++)
+        {
+            while( j+1 < x.count() && x.at(j+1) <= features.times.at(i) ) { j++; }
+            features.values[i*features.dims + d] = y.isEmpty() ? 0 : y.at(j);
+        }
+    }
+
+    normalise(&features);
+    return features;
+}
+
+bool DtwAligner::setFeatures(const Features &from, const Features &to)
+{
+    if( from.dims != to.dims )
+    {
+        qDebug() << "DtwAligner::setFeatures: the features have" << from.dims << "and" << to.dims << "dimensions";
+        return false;
+    }
+    mFrom = from;
+    mTo = to;
+    return true;
+}
+
+bool DtwAligner::setFeatures(const SpectrogramData *from, const SpectrogramData *to)
+{
+    if( from->getNFrequencyBins() != to->getNFrequencyBins() )
+    {
+        qDebug() << "DtwAligner::setFeatures: the spectrograms" << from->name() << "and" << to->name() << "have different numbers of frequency bins";
+        return false;
+    }
+    return setFeatures( features(from), features(to) );
+}
+
+bool DtwAligner::setFeatures(const QList<const WaveformData *> &from, const QList<const WaveformData *> &to)
+{
+    if( from.isEmpty() || from.count() != to.count() )
+    {
+        qDebug() << "DtwAligner::setFeatures: the feature tracks must be paired";
+        return false;
+    }
+    return setFeatures( features(from), features(to) );
+}
+
+void DtwAligner::setRadius(int radius)
+{
+    mRadius = qMax(radius, 1);
+}
+
+int DtwAligner::radius() const
+{
+    return mRadius;
+}
+
+void DtwAligner::setBandWidth(double proportion)
+{
+    mBandWidth = proportion;
+}
+
+double DtwAligner::bandWidth() const
+{
+    return mBandWidth;
+}
+
+QVector<QPair<int, int> > DtwAligner::path(double *distance) const
+{
+    if( mFrom.count() == 0 || mTo.count() == 0 )
+        return QVector< QPair<int,int> >();
+
+    // halve the resolution until the sounds are short enough to be aligned exhaustively
+    QList<Features> fromLevels, toLevels;
+    fromLevels << mFrom;
+    toLevels << mTo;
+    while( fromLevels.last().count() > mRadius + 2 && toLevels.last().count() > mRadius + 2 )
+    {
+        fromLevels << coarsen( fromLevels.last() );
+        toLevels << coarsen( toLevels.last() );
+    }
+
+    int level = fromLevels.count() - 1;
+    int rows = fromLevels.at(level).count();
+    int columns = toLevels.at(level).count();
+
+    Window window;
+    window.lo.fill(0, rows);
+    window.hi.fill(columns-1, rows);
+    limitToBand(&window, rows, columns);
+    QVector< QPair<int,int> > path = align( fromLevels.at(level), toLevels.at(level), window, level == 0 ? distance : 0 );
+
+    for(level--; level >= 0; level--)
+    {
+        rows = fromLevels.at(level).count();
+        columns = toLevels.at(level).count();
+        path = align( fromLevels.at(level), toLevels.at(level), project(path, rows, columns), level == 0 ? distance : 0 );
+    }
+
+    if( distance != 0 )
+        *distance /= mFrom.count() + mTo.count();
+    return path;
+}
+
+TimeWarp DtwAligner::warp() const
+{
+    return warp( path() );
+}
+
+TimeWarp DtwAligner::warp(const QVector<QPair<int, int> > &p) const
+{
+    TimeWarp warp;
+    int i = 0;
+    while( i < p.count() )
+    {
+        int frame = p.at(i).first;
+        double sum = 0;
+        int n = 0;
+        for(; i < p.count() && p.at(i).first == frame; i++, n++)
+            sum += mTo.times.at( p.at(i).second );
+        warp.addKnot( mFrom.times.at(frame), sum / n );
+    }
+    return warp;
+}
+
+void DtwAligner::normalise(Features *features)
+{
+    int nFrames = features->count();
+    int dims = features->dims;
+    double *values = features->values.data();
+    for(int d=0; d<dims; d++)
+    {
+        double sum = 0, sumOfSquares = 0;
+        int n = 0;
+        for(int i=0; i<nFrames; i++)
+        {
+            double value = values[i*dims + d];
+            if( qIsNaN(value) ) { continue; }
+            sum += value;
+            sumOfSquares += value * value;
+            n++;
+        }
+        double mean = n > 0 ? sum / n : 0;
+        double variance = n > 0 ? sumOfSquares / n - mean * mean : 0;
+        double scale = variance > 0 ? 1.0 / sqrt(variance) : 0;
+
+        for(int i=0; i<nFrames; i++)
+        {
+            double &value = values[i*dims + d];
+            value = qIsNaN(value) ? 0 : (value - mean) * scale;
+        }
+    }
+}
+
+DtwAligner::Features DtwAligner::coarsen(const Features &features)
+{
+    Features coarse;
+    coarse.dims = features.dims;
+    int nFrames = (features.count() + 1) / 2;
+    coarse.times.resize(nFrames);
+    coarse.values.resize(nFrames * coarse.dims);
+
+    for(int i=0; i<nFrames; i++)
+    {
+        const double *first = features.frame(2*i);
+        double *frame = coarse.values.data() + i*coarse.dims;
+        if( 2*i+1 < features.count() )
+        {
+            const double *second = features.frame(2*i+1);
+            for(int d=0; d<coarse.dims; d++)
+                frame[d] = 0.5 * (first[d] + second[d]);
+            coarse.times[i] = 0.5 * (features.times.at(2*i) + features.times.at(2*i+1));
+        }
+        else // an odd frame at the end
+        {
+            memcpy(frame, first, sizeof(double) * coarse.dims);
+            coarse.times[i] = features.times.at(2*i);
+        }
+    }
+    return coarse;
+}
+
+DtwAligner::Window DtwAligner::project(const QVector<QPair<int, int> > &coarsePath, int rows, int columns) const
+{
+    // each cell of the coarse path covers two rows and two columns at this level
+    Window cover;
+    cover.lo.fill(columns, rows);
+    cover.hi.fill(-1, rows);
+    for(int k=0; k<coarsePath.count(); k++)
+    {
+        int lo = 2 * coarsePath.at(k).second;
+        int hi = qMin(lo + 1, columns - 1);
+        for(int r = 2 * coarsePath.at(k).first; r < 2 * coarsePath.at(k).first + 2 && r < rows; r++)
+        {
+            cover.lo[r] = qMin(cover.lo.at(r), lo);
+            cover.hi[r] = qMax(cover.hi.at(r), hi);
+        }
+    }
+
+    // widen by the radius in both directions
+    Window window;
+    window.lo.resize(rows);
+    window.hi.resize(rows);
+    for(int r=0; r<rows; r++)
+    {
+        int lo = columns, hi = -1;
+        for(int k = qMax(r - mRadius, 0); k <= qMin(r + mRadius, rows - 1); k++)
+        {
+            lo = qMin(lo, cover.lo.at(k));
+            hi = qMax(hi, cover.hi.at(k));
+        }
+        window.lo[r] = qMax(lo - mRadius, 0);
+        window.hi[r] = qMin(hi + mRadius, columns - 1);
+    }
+
+    limitToBand(&window, rows, columns);
+    return window;
+}
+
+void DtwAligner::limitToBand(Window *window, int rows, int columns) const
+{
+    if( mBandWidth < 1 && rows > 1 )
+    {
+        int width = qMax( (int)ceil( mBandWidth * qMax(rows, columns) ), 1 );
+        double slope = (double)(columns - 1) / (rows - 1);
+        for(int r=0; r<rows; r++)
+        {
+            int centre = (int)floor( r * slope + 0.5 );
+            int lo = qMax( window->lo.at(r), centre - width );
+            int hi = qMin( window->hi.at(r), centre + width );
+            // where the projected path strays outside the band, the band gives way
+            if( lo <= hi )
+            {
+                window->lo[r] = lo;
+                window->hi[r] = hi;
+            }
+        }
+    }
+    makeConnected(window, columns);
+}
+
+void DtwAligner::makeConnected(Window *window, int columns)
+{
+    int rows = window->lo.count();
+    window->lo[0] = 0;
+    window->hi[rows-1] = columns - 1;
+
+    // widening only, make both edges non-decreasing, and let each row start no later than the one before ends
+    for(int r=rows-2; r>=0; r--)
+        window->lo[r] = qMin( window->lo.at(r), window->lo.at(r+1) );
+    for(int r=1; r<rows; r++)
+    {
+        window->hi[r] = qMax( window->hi.at(r), window->hi.at(r-1) );
+        window->lo[r] = qMin( window->lo.at(r), window->hi.at(r-1) + 1 );
+    }
+}
+
+QVector<QPair<int, int> > DtwAligner::align(const Features &a, const Features &b, const Window &window, double *total)
+{
+    int rows = a.count();
+    int dims = a.dims;
+    const QVector<int> &lo = window.lo;
+    const QVector<int> &hi = window.hi;
+
+    // the cells of each row are stored one after the other
+    QVector<int> offsets(rows + 1);
+    offsets[0] = 0;
+    for(int r=0; r<rows; r++)
+        offsets[r+1] = offsets.at(r) + hi.at(r) - lo.at(r) + 1;
+
+    double *cost = (double*)malloc(sizeof(double) * offsets.at(rows));
+    if( cost == 0 )
+    {
+        qDebug() << "DtwAligner::align: could not allocate" << offsets.at(rows) << "cells";
+        if( total != 0 ) { *total = std::numeric_limits<double>::quiet_NaN(); }
+        return QVector< QPair<int,int> >();
+    }
+
+    // local distances, which are independent of each other
+    parallelFor(0, rows, 0, [&](qint64 first, qint64 last) {
+        for(int r=first; r<last; r++)
+        {
+            const double *x = a.frame(r);
+            double *c = cost + offsets.at(r);
+            for(int j=lo.at(r); j<=hi.at(r); j++)
+            {
+                const double *y = b.frame(j);
+                double sum = 0;
+                for(int d=0; d<dims; d++)
+                    sum += (x[d] - y[d]) * (x[d] - y[d]);
+                *c++ = sqrt(sum);
+            }
+        }
+    });
+
+    const double infinity = std::numeric_limits<double>::infinity();
+    auto accumulated = [&](int r, int j) -> double {
+        if( r < 0 || j < lo.at(r) || j > hi.at(r) ) { return infinity; }
+        return cost[ offsets.at(r) + j - lo.at(r) ];
+    };
+
+    // accumulated costs, in place
+    for(int r=0; r<rows; r++)
+    {
+        double *c = cost + offsets.at(r);
+        for(int j=lo.at(r); j<=hi.at(r); j++, c++)
+        {
+            double best;
+            if( r == 0 && j == 0 )
+                best = 0;
+            else
+                best = qMin( qMin( accumulated(r-1, j-1), accumulated(r-1, j) ), j > lo.at(r) ? *(c-1) : infinity );
+            *c += best;
+        }
+    }
+
+    if( total != 0 )
+        *total = cost[ offsets.at(rows) - 1 ];
+
+    // trace the path back from the last cell
+    QVector< QPair<int,int> > path;
+    path.reserve( rows + b.count() );
+    int r = rows - 1, j = b.count() - 1;
+    path << QPair<int,int>(r, j);
+    while( r > 0 || j > 0 )
+    {
+        double diagonal = accumulated(r-1, j-1);
+        double up = accumulated(r-1, j);
+        double left = j > 0 ? accumulated(r, j-1) : infinity;
+        if( diagonal <= up && diagonal <= left )
+        {
+            r--;
+            j--;
+        }
+        else if( up <= left )
+        {
+            r--;
+        }
+        else
+        {
+            j--;
+        }
+        path << QPair<int,int>(r, j);
+    }
+    free(cost);
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
@@ -0,0 +1,122 @@
+/*! \class DtwAligner
+    \ingroup Data
+    \brief Aligns two sounds by dynamic time warping of their feature tracks.
+
+    Each sound is described by a sequence of feature frames, e.g., the columns of a spectrogram, or the values of several curves (cepstral coefficients, formants, ...) at each time step. Every dimension is normalised to zero mean and unit variance within its sound, so that the two sounds can be compared even if they were recorded at different levels. The distance between two frames is the Euclidean distance.
+
+    The alignment follows FastDTW (Salvador & Chan 2007): the tracks are repeatedly halved in length by averaging pairs of frames, the coarsest pair is aligned exhaustively, and the path found at each level is projected onto the next finer one and widened by radius() frames. Only the cells inside that window are computed, so time and memory grow linearly with the length of the sounds rather than with its square. At every level the window is further limited to a Sakoe-Chiba band around the diagonal, so that the path cannot wander off to match, e.g., the silence at the start of one sound with the silence at the end of the other.
+
+    The local distances of each level are computed in parallel, one row of the window at a time; the accumulation of costs, which depends on the previous row, is done in a single pass.
+
+    The result is a TimeWarp that maps times of the first sound (the one being warped) onto times of the second.
+  */
+
+#ifndef DTWALIGNER_H
+#define DTWALIGNER_H
+
+#include <QList>
+#include <QVector>
+#include <QPair>
+
+#include "timewarp.h"
+
+class SpectrogramData;
+class WaveformData;
+
+class DtwAligner
+{
+public:
+    //! \brief A sequence of frames of \a dims normalised values each, stored frame by frame, with the time of each frame
+    /*!
+      Features are implicitly shared, so they can be computed once per sound and then aligned with the features of many others.
+      */
+    struct Features
+    {
+        Features() : dims(0) {}
+        int count() const { return times.count(); }
+        const double *frame(int i) const { return values.constData() + i*dims; }
+
+        QVector<double> values;
+        QVector<double> times;
+        int dims;
+    };
+
+    DtwAligner();
+
+    //! \brief Return the frames of \a spectrogram as features
+    static Features features(const SpectrogramData *spectrogram);
+
+    //! \brief Return the values of \a curves as features, one dimension per curve. The time steps are those of the first curve; the other curves are sampled at those times. Returns empty features if \a curves is empty.
+    static Features features(const QList<const WaveformData*> &curves);
+
+    //! \brief Use \a from and \a to as the feature tracks. Returns false if they do not have the same number of dimensions.
+    bool setFeatures(const Features &from, const Features &to);
+
+    //! \brief Use the frames of \a from and \a to as the feature tracks. Returns false if the spectrograms do not have the same number of frequency bins.
+    bool setFeatures(const SpectrogramData *from, const SpectrogramData *to);
+
+    //! \brief Use the curves of \a from and \a to as the feature tracks; curve \a i of one sound is compared with curve \a i of the other. Returns false if the lists are empty or of different lengths.
+    /*!
+      The time steps of each sound are those of its first curve; the other curves are sampled at those times.
+      */
+    bool setFeatures(const QList<const WaveformData*> &from, const QList<const WaveformData*> &to);
+
+    //! \brief Set the half-width of the search window around the projected path, in frames (default 8)
+    void setRadius(int radius);
+
+    //! \brief Return the half-width of the search window around the projected path, in frames
+    int radius() const;
+
+    //! \brief Set the half-width of the Sakoe-Chiba band as a proportion of the length of the longer sound (default 0.1). A value of 1 or more removes the band.
+    void setBandWidth(double proportion);
+
+    //! \brief Return the half-width of the Sakoe-Chiba band as a proportion of the length of the longer sound
+    double bandWidth() const;
+
+    //! \brief Align the two feature tracks and return the path, as pairs of frame indices (from, to) that runs from the first frames to the last ones. Returns an empty path if no features have been set.
+    /*!
+      If \a distance is not null, it is set to the total distance along the path divided by the combined number of frames of the two sounds, so that distances between pairs of sounds of different lengths can be compared.
+      */
+    QVector< QPair<int,int> > path(double *distance = 0) const;
+
+    //! \brief Align the two feature tracks and return the warp that maps times of the first sound onto times of the second
+    /*!
+      Where the path matches one frame of the first sound with several frames of the second, the frame is mapped onto their mean time.
+      */
+    TimeWarp warp() const;
+
+    //! \brief Return the warp for \a path, as returned by path()
+    TimeWarp warp(const QVector< QPair<int,int> > &path) const;
+
+private:
+    //! \brief The cells considered at one level: the columns lo[i]..hi[i] of each row \a i
+    struct Window
+    {
+        QVector<int> lo;
+        QVector<int> hi;
+    };
+
+    //! \brief Normalise each dimension of \a features to zero mean and unit variance. Undefined (NaN) values are set to the mean.
+    static void normalise(Features *features);
+
+    //! \brief Return \a features at half the time resolution, by averaging pairs of frames
+    static Features coarsen(const Features &features);
+
+    //! \brief Return the window for the path \a coarsePath, projected from the next coarser level and widened by radius(), limited to the band
+    Window project(const QVector< QPair<int,int> > &coarsePath, int rows, int columns) const;
+
+    //! \brief Limit \a window to the Sakoe-Chiba band, while keeping every row non-empty
+    void limitToBand(Window *window, int rows, int columns) const;
+
+    //! \brief Widen \a window where necessary so that a path from the first cell to the last one exists
+    static void makeConnected(Window *window, int columns);
+
+    //! \brief Return the path of lowest cost through \a window. If \a cost is not null, it is set to the total cost of the path.
+    static QVector< QPair<int,int> > align(const Features &a, const Features &b, const Window &window, double *cost = 0);
+
+    Features mFrom, mTo;
+    int mRadius;
+    double mBandWidth;
+};
+
+#endif // DTWALIGNER_H
@@ -0,0 +1,135 @@
+#include "framecollector.h"
+
+#include "waveformdata.h"
+#include "spectrogramdata.h"
+
+#include <QtDebug>
+
+#include <stdlib.h>
+#include <string.h>
+
+FrameCollector::FrameCollector()
+{
+}
+
+void FrameCollector::setFormat(const BlockFormat &format)
+{
+    mFormat = format;
+    maTimes.clear();
+    maValues.clear();
+}
+
+void FrameCollector::write(const FrameBlock &block)
+{
+    if( block.width != mFormat.width ) { qDebug() << "FrameCollector: a block of width" << block.width << "was written to a stream of width" << mFormat.width; return; }
+
+    int frames = maTimes.size();
+    maTimes.resize( frames + block.count );
+    memcpy( maTimes.data() + frames, block.times, sizeof(double)*block.count );
+
+    int values = maValues.size();
+    maValues.resize( values + block.count * block.width );
+    memcpy( maValues.data() + values, block.values, sizeof(double)*block.count*block.width );
+}
+
+const BlockFormat &FrameCollector::format() const
+{
+    return mFormat;
+}
+
+qint64 FrameCollector::count() const
+{
+    return maTimes.size();
+}
+
+WaveformData* FrameCollector::takeWaveform()
+{
+    if( maTimes.isEmpty() || mFormat.width != 1 ) { return 0; }
+
+    WaveformData *data = new WaveformData( mFormat.name, maTimes, maValues, (size_t)qRound( mFormat.frameRate ) );
+    maTimes.clear();
+    maValues.clear();
+    return data;
+}
+
+SpectrogramData* FrameCollector::takeSpectrogram()
+{
+    if( maTimes.isEmpty() ) { return 0; }
+
+    // SpectrogramData takes ownership of malloc'd arrays
+    int frames = maTimes.size();
+    double *times = (double*)malloc(sizeof(double)*frames);
+    double *values = (double*)malloc(sizeof(double)*maValues.size());
+    double *frequencies = (double*)malloc(sizeof(double)*mFormat.width);
+    if( times == 0 || values == 0 || frequencies == 0 ) { qDebug() << "FrameCollector: memory allocation error."; free(times); free(values); free(frequencies); return 0; }
+
+    memcpy( times, maTimes.constData(), sizeof(double)*frames );
+    memcpy( values, maValues.constData(), sizeof(double)*maValues.size() );
+    for(int i=0; i<mFormat.width; i++)
+        frequencies[i] = i < mFormat.frequencies.size() ? mFormat.frequencies.at(i) : i;
+
+    maTimes.clear();
+    maValues.clear();
+    return new SpectrogramData( mFormat.name, values, times, frames, frequencies, mFormat.width, mFormat.windowLength, mFormat.timeStep );
+}
+
+BlockFormat FrameCollector::formatOf(const WaveformData *data)
+{
+    BlockFormat format;
+    format.frameRate = data->getSamplingFrequency();
+    format.name = data->name();
+    return format;
+}
+
+BlockFormat FrameCollector::formatOf(const SpectrogramData *data)
+{
+    BlockFormat format;
+    format.width = data->getNFrequencyBins();
+    format.frameRate = 1.0 / data->getTimeStep();
+    format.frequencies = data->frequencies();
+    format.windowLength = data->getWindowLength();
+    format.timeStep = data->getTimeStep();
+    format.name = data->name();
+    return format;
+}
+
+void FrameCollector::send(const WaveformData *data, BlockSink *sink, qint64 blockSize)
+{
+    sink->setFormat( formatOf(data) );
+
+    const double *times = data->xData().constData();
+    const double *values = data->yData().constData();
+    qint64 total = data->getNSamples();
+    for(qint64 first=0; first<total; first += blockSize)
+    {
+        FrameBlock block;
+        block.times = times + first;
+        block.values = values + first;
+        block.count = qMin( blockSize, total - first );
+        sink->write(block);
+    }
+}
+
+void FrameCollector::send(const SpectrogramData *data, BlockSink *sink, qint64 blockSize)
+{
+    sink->setFormat( formatOf(data) );
+
+    // the times are copied a block at a time, so that those of a spectrogram in a backing file are read as they are needed
+    QVector<double> times;
+    const double *values = data->pdata();
+    int width = data->getNFrequencyBins();
+    qint64 total = data->getNTimeSteps();
+    for(qint64 first=0; first<total; first += blockSize)
+    {
+        times.resize( qMin( blockSize, total - first ) );
+        for(int i=0; i<times.size(); i++)
+            times[i] = data->getTimeFromIndex(first + i);
+
+        FrameBlock block;
+        block.times = times.constData();
+        block.values = values + first*width;
+        block.count = qMin( blockSize, total - first );
+        block.width = width;
+        sink->write(block);
+    }
+}
@@ -0,0 +1,62 @@
+/*!
+  \class FrameCollector
+  \ingroup Data
+  \brief A BlockSink that keeps the frames written to it, and turns them into a WaveformData or SpectrogramData object.
+
+  It also does the opposite: send() writes the frames of an existing data object to a sink, a block at a time. Between them, the two let block measures (see AbstractBlockMeasure) be run on the data classes of the rest of the program.
+*/
+
+#ifndef FRAMECOLLECTOR_H
+#define FRAMECOLLECTOR_H
+
+#include <QVector>
+
+#include "interfaces.h"
+
+class WaveformData;
+class SpectrogramData;
+
+class FrameCollector : public BlockSink
+{
+public:
+    //! \brief The number of frames in the blocks written by send()
+    enum { DefaultBlockSize = 4096 };
+
+    FrameCollector();
+
+    //! \brief Set the format of the frames that follow. Reimplemented from BlockSink.
+    void setFormat(const BlockFormat &format);
+
+    //! \brief Keep the frames of \a block. Reimplemented from BlockSink.
+    void write(const FrameBlock &block);
+
+    //! \brief Return the format of the frames collected
+    const BlockFormat &format() const;
+
+    //! \brief Return the number of frames collected
+    qint64 count() const;
+
+    //! \brief Return a new waveform with the frames collected, or 0 if there are none or they are more than one value wide. The caller takes ownership. The collector is emptied.
+    WaveformData* takeWaveform();
+
+    //! \brief Return a new spectrogram with the frames collected, or 0 if there are none. The caller takes ownership. The collector is emptied.
+    SpectrogramData* takeSpectrogram();
+
+    //! \brief Return the format of the frames of \a data
+    static BlockFormat formatOf(const WaveformData *data);
+
+    //! \brief Return the format of the frames of \a data
+    static BlockFormat formatOf(const SpectrogramData *data);
+
+    //! \brief Set the format of \a sink, and write the samples of \a data to it in blocks of \a blockSize
+    static void send(const WaveformData *data, BlockSink *sink, qint64 blockSize = DefaultBlockSize);
+
+    //! \brief Set the format of \a sink, and write the time steps of \a data to it in blocks of \a blockSize
+    static void send(const SpectrogramData *data, BlockSink *sink, qint64 blockSize = DefaultBlockSize);
+
+private:
+    BlockFormat mFormat;
+    QVector<double> maTimes, maValues;
+};
+
+#endif // FRAMECOLLECTOR_H
@@ -5,8 +5,13 @@
 #include <QList>
 #include <QStringList>
 #include <QVariant>
+#include <QVector>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QCoreApplication>
 
-#include <qwt_series_data.h>
+#include <functional>
 
 class WaveformData;
 class SpectrogramData;
@@ -15,14 +20,47 @@ class SpectrogramData;
     \ingroup Plugin
     \brief Base class for other abstract measurement classes
 
-    This class provides the pure virtual function \a fn settings, which is used by all measurement plugins.
+    This class provides the settings of a plugin, which are used by all measurement plugins. A plugin lists its settings in settingsLabels and their default values in settingsValues, in its constructor; parameterLabels(), parameter() and setParameter() work on those lists unless the plugin reimplements them.
+
+    Plugins do not show anything themselves, so that they can be run without a display. The application edits their settings in a dialog built from parameterLabels() and parameter(), and shows the text that they emit with reportCreated() and the progress that they emit with progressChanged().
+
+    A plugin also declares its name, script name, measures and settings in the JSON metadata of its library (see PluginLibrary), so that the application can list its measures without loading it.
+
+    The measures of plugins that declare metadata may be run on worker threads (e.g., on every channel of a sound at once), so they must not create widgets. Plugins without metadata, which were written before plugins stopped showing dialogs of their own, are always run on the GUI thread.
   */
 class AbstractMeasurement: public QObject
 {
     Q_OBJECT
 public:
-    //! \brief Display the settings dialog box for measurement \a i
-    virtual void settings(int i) = 0;
+    //! \brief Return the labels of the settings that can be changed with setParameter
+    virtual QStringList parameterLabels() const { return settingsLabels; }
+
+    //! \brief Return the current value of the setting with label \a label, or an invalid QVariant if there is no such setting
+    virtual QVariant parameter(QString label) const
+    {
+        int index = settingsLabels.indexOf(label);
+        return index != -1 ? settingsValues.at(index) : QVariant();
+    }
+
+    //! \brief Change the setting with label \a label to \a value. Labels of settings that the plugin does not have are ignored.
+    virtual void setParameter(QString label, QVariant value)
+    {
+        int index = settingsLabels.indexOf(label);
+        if(index != -1)
+            settingsValues[index] = value;
+    }
+
+signals:
+    //! \brief Emitted with a report of a calculation (e.g., a table of results) that has the title \a title and the text \a text
+    void reportCreated(QString title, QString text);
+
+    //! \brief Emitted during a long calculation, when \a done of its \a total steps are finished. The last emission of a calculation has \a done equal to \a total.
+    void progressChanged(int done, int total);
+
+protected:
+    //! \brief The labels of the plugin's settings, and their values in the same order
+    QStringList settingsLabels;
+    QList<QVariant> settingsValues;
 };
 
 /*! \class AbstractWaveform2WaveformMeasure
@@ -46,12 +84,6 @@ public:
     //! \brief Return the list of names of the measures defined by the plugin
     virtual QStringList	names() const = 0;
 
-    //! \brief Display the settings dialog box for measurement \a i
-    virtual void settings(int i) = 0;
-
-    //! \brief Change the setting with label \a label to \a value
-    virtual void setParameter(QString label, QVariant value) = 0;
-
     //! \brief Return a list of pointers to WaveformData objects calculated by measurement \a i, from \a data
     virtual void calculate(int i, WaveformData *data) = 0;
 
@@ -84,12 +116,6 @@ public slots:
     //! \brief Return the list of names of the measures defined by the plugin
     virtual QStringList	names() const = 0;
 
-    //! \brief Display the settings dialog box for measurement \a i
-    virtual void settings(int i) = 0;
-
-    //! \brief Change the setting with label \a label to \a value
-    virtual void setParameter(QString label, QVariant value) = 0;
-
     //! \brief Return a list of pointers to SpectrogramData objects calculated by measurement \a i, from \a data
     virtual void calculate(int i, WaveformData *data) = 0;
 
@@ -121,12 +147,6 @@ public:
     //! \brief Return the list of names of the measures defined by the plugin
     virtual QStringList	names() const = 0;
 
-    //! \brief Display the settings dialog box for measurement \a i
-    virtual void settings(int i) = 0;
-
-    //! \brief Change the setting with label \a label to \a value
-    virtual void setParameter(QString label, QVariant value) = 0;
-
     //! \brief Return a list of pointers to WaveformData objects calculated by measurement \a i, from \a data
     virtual void calculate(int i, SpectrogramData *data) = 0;
 
@@ -158,12 +178,6 @@ public:
     //! \brief Return the list of names of the measures defined by the plugin
     virtual QStringList	names() const = 0;
 
-    //! \brief Display the settings dialog box for measurement \a i
-    virtual void settings(int i) = 0;
-
-    //! \brief Change the setting with label \a label to \a value
-    virtual void setParameter(QString label, QVariant value) = 0;
-
     //! \brief Return a list of pointers to SpectrogramData objects calculated by measurement \a i, from \a data
     virtual void calculate(int i, SpectrogramData *data) = 0;
 
@@ -174,11 +188,255 @@ signals:
     void spectrogramCreated(SpectrogramData *data);
 };
 
+/*! \struct BlockFormat
+    \ingroup Plugin
+    \brief Describes the frames of a stream processed by an AbstractBlockMeasure
+
+    A frame is one sample of a waveform (\a width is 1) or one time step of a spectrogram (\a width is the number of frequency bins, whose frequencies are in \a frequencies).
+  */
+struct BlockFormat
+{
+    BlockFormat() : width(1), frameRate(0), windowLength(0), timeStep(0) {}
+
+    //! \brief The number of values in each frame
+    int width;
+
+    //! \brief The number of frames per second
+    double frameRate;
+
+    //! \brief The frequencies of the values of a frame, for spectrogram streams
+    QVector<double> frequencies;
+
+    //! \brief The window length and time step of a spectrogram stream, in seconds
+    double windowLength, timeStep;
+
+    //! \brief The name the stream should have when it is stored
+    QString name;
+};
+
+/*! \struct FrameBlock
+    \ingroup Plugin
+    \brief A run of \a count consecutive frames of a stream, with their times
+
+    The \a width values of each frame follow one another in \a values. The block does not own its arrays, which need only be valid for the duration of the call it is passed to.
+  */
+struct FrameBlock
+{
+    FrameBlock() : times(0), values(0), count(0), width(1) {}
+
+    const double *times;
+    const double *values;
+    qint64 count;
+    int width;
+};
+
+/*! \class BlockState
+    \ingroup Plugin
+    \brief Base class for the state of one run of an AbstractBlockMeasure
+
+    A block measure keeps everything that a run carries from one block to the next in an object of a subclass of its own, so that one plugin instance can take part in several runs at the same time.
+  */
+class BlockState
+{
+public:
+    virtual ~BlockState() {}
+};
+
+/*! \class BlockSink
+    \ingroup Plugin
+    \brief Receives the output of an AbstractBlockMeasure
+  */
+class BlockSink
+{
+public:
+    virtual ~BlockSink() {}
+
+    //! \brief Set the format of the frames that follow. This is called once, before the first call to write().
+    virtual void setFormat(const BlockFormat &format) = 0;
+
+    //! \brief Receive the next frames of the output
+    virtual void write(const FrameBlock &block) = 0;
+};
+
+/*! \class AbstractBlockMeasure
+    \ingroup Plugin
+    \brief Interface of plugins that can process their input one block at a time
+
+    The measures of the other interfaces take a whole WaveformData or SpectrogramData and create a whole output object, so the whole of both must be held in memory, and a measure cannot start before the one it depends on has finished. A plugin that also implements this interface can be run on a stream: begin() starts a run of a measure and returns its state, processBlock() is called for each consecutive block of input and writes whatever output is complete, and finish() writes the rest. Measures chained in this way (see BlockPipeline) hold only the frames that their windows still need.
+
+    This interface is not a QObject, so that a plugin can implement it alongside one of the other interfaces (the names, settings and parameters of its measures are those of the other interface). Plugins that do not implement it can still be run on a stream through a BlockMeasureAdapter, which collects the whole input and calls calculate().
+  */
+class AbstractBlockMeasure
+{
+public:
+    virtual ~AbstractBlockMeasure() {}
+
+    //! \brief Start a run of measure \a i on frames of format \a input, whose output goes to \a output. Return the state of the run, which the caller deletes after finish(), or 0 if the measure cannot process such input.
+    virtual BlockState* begin(int i, const BlockFormat &input, BlockSink *output) = 0;
+
+    //! \brief Return the number of input frames after the time of an output frame that are needed to calculate it, or -1 if the run needs all of its input first
+    virtual qint64 lookahead(const BlockState *state) const = 0;
+
+    //! \brief Return the largest number of frames that may arrive after an input frame before all of the output that depends on it has been written, or -1 if nothing is written before finish()
+    virtual qint64 latency(const BlockState *state) const = 0;
+
+    //! \brief Process the next frames of the input, and write the output that they complete to the run's sink
+    virtual void processBlock(BlockState *state, const FrameBlock &input) = 0;
+
+    //! \brief Write the rest of the output, once the whole input has been processed
+    virtual void finish(BlockState *state) = 0;
+};
+
+/*! \class CancellationToken
+    \ingroup Plugin
+    \brief A flag with which the tasks of one or more TaskGroup objects can be cancelled
+
+    Tasks that have not started when the token is cancelled are skipped. Tasks that run for a long time should check isCancelled() now and then, and return early.
+  */
+class CancellationToken
+{
+public:
+    CancellationToken() : mCancelled(0) {}
+
+    //! \brief Cancel the tasks that use this token
+    void cancel() { mCancelled.storeRelease(1); }
+
+    //! \brief Return true if cancel() has been called
+    bool isCancelled() const { return mCancelled.loadAcquire() != 0; }
+
+private:
+    QAtomicInt mCancelled;
+};
+
+/*! \class TaskGroup
+    \ingroup Plugin
+    \brief Tasks that are queued with AbstractTaskScheduler::run() and waited for together with AbstractTaskScheduler::wait()
+  */
+class TaskGroup
+{
+public:
+    explicit TaskGroup(CancellationToken *token = 0) : mToken(token), mPending(0) {}
+
+    //! \brief Return true if the group's cancellation token has been cancelled
+    bool isCancelled() const { return mToken != 0 && mToken->isCancelled(); }
+
+    //! \brief Return true if every task of the group has finished or been skipped
+    bool isDone() const { return mPending.loadAcquire() == 0; }
+
+    //! \brief Count a task that has been queued. This is called by the scheduler.
+    void taskQueued() { mPending.fetchAndAddRelaxed(1); }
+
+    //! \brief Count a task that has finished or been skipped, and wake the threads blocked in waitUntilDone() if it was the last. This is called by the scheduler.
+    void taskFinished()
+    {
+        // under the lock, so that a thread that sees the group done cannot delete it while the waiters are being woken
+        QMutexLocker locker(&mMutex);
+        if( mPending.fetchAndSubRelease(1) == 1 )
+            mDone.wakeAll();
+    }
+
+    //! \brief Block until every task of the group has finished or been skipped. This is called by the scheduler, which calls it last in AbstractTaskScheduler::wait() even if isDone() is true, so that the group is not deleted while its last task is being counted.
+    void waitUntilDone()
+    {
+        QMutexLocker locker(&mMutex);
+        while( !isDone() )
+            mDone.wait(&mMutex);
+    }
+
+private:
+    CancellationToken *mToken;
+    QAtomicInt mPending;
+    QMutex mMutex;
+    QWaitCondition mDone;
+
+    TaskGroup(const TaskGroup &);
+    TaskGroup &operator=(const TaskGroup &);
+};
+
+/*! \class AbstractTaskScheduler
+    \ingroup Plugin
+    \brief Interface of the task scheduler that the application shares among its plugins, project input and output, and drawing
+
+    If every plugin started threads of its own, they would compete for the processor with one another and with the rest of the program, especially when several measures or several sounds are computed at once. Instead, the application has a single scheduler with a fixed number of threads, and everything that can be done in parallel is queued on it as tasks. A thread that waits for tasks runs other tasks meanwhile, so a task can itself wait for tasks (e.g., a measure that is recomputed in parallel with others, and splits its frames among tasks) without the number of busy threads exceeding concurrency().
+
+    Plugins obtain the scheduler with taskScheduler(), or just call parallelFor(), which runs serially when there is no scheduler.
+  */
+class AbstractTaskScheduler
+{
+public:
+    virtual ~AbstractTaskScheduler() {}
+
+    //! \brief Return the number of threads that run tasks, which is the limit on the concurrency of the application
+    virtual int concurrency() const = 0;
+
+    //! \brief Queue \a task as a part of \a group
+    virtual void run(TaskGroup *group, const std::function<void()> &task) = 0;
+
+    //! \brief Return once every task of \a group has finished or been skipped, running queued tasks in the meantime
+    virtual void wait(TaskGroup *group) = 0;
+
+    //! \brief Call \a body for consecutive ranges of at most \a grain numbers, from \a begin up to \a end, in parallel, and return once every range has been done. A \a grain less than 1 lets the scheduler choose.
+    virtual void parallelFor(qint64 begin, qint64 end, qint64 grain, const std::function<void(qint64,qint64)> &body, CancellationToken *token = 0) = 0;
+};
+
 QT_BEGIN_NAMESPACE
 Q_DECLARE_INTERFACE(AbstractWaveform2WaveformMeasure,"acousticworkspace.qt.abstractwaveform2waveformmeasure/1.0")
 Q_DECLARE_INTERFACE(AbstractWaveform2SpectrogramMeasure,"acousticworkspace.qt.abstractwaveform2spectrogrammeasure/1.0")
 Q_DECLARE_INTERFACE(AbstractSpectrogram2WaveformMeasure,"acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0")
 Q_DECLARE_INTERFACE(AbstractSpectrogram2SpectrogramMeasure,"acousticworkspace.qt.abstractspectrogram2spectrogrammeasure/1.0")
+Q_DECLARE_INTERFACE(AbstractBlockMeasure,"acousticworkspace.qt.abstractblockmeasure/1.0")
+Q_DECLARE_INTERFACE(AbstractTaskScheduler,"acousticworkspace.qt.abstracttaskscheduler/1.0")
 QT_END_NAMESPACE
 
+//! \brief Return the application's task scheduler, which is kept in its "taskScheduler" property, or 0 if it has none (e.g., when a plugin is used outside the application)
+inline AbstractTaskScheduler* taskScheduler()
+{
+    if( QCoreApplication::instance() == 0 ) { return 0; }
+    return qobject_cast<AbstractTaskScheduler*>( QCoreApplication::instance()->property("taskScheduler").value<QObject*>() );
+}
+
+//! \brief Call \a body for consecutive ranges of at most \a grain numbers from \a begin up to \a end, on the application's task scheduler if there is one, and otherwise one after another
+inline void parallelFor(qint64 begin, qint64 end, qint64 grain, const std::function<void(qint64,qint64)> &body, CancellationToken *token = 0)
+{
+    AbstractTaskScheduler *scheduler = taskScheduler();
+    if( scheduler != 0 ) { scheduler->parallelFor(begin, end, grain, body, token); return; }
+
+    if( grain < 1 ) { grain = end - begin; }
+    for(qint64 first=begin; first<end && ( token == 0 || !token->isCancelled() ); first += grain)
+        body(first, qMin(end, first + grain));
+}
+
+//! \brief Call \a function for every item of \a sequence (a QList or QVector), each as a task of its own; this is QtConcurrent::blockingMap() on the application's task scheduler. Items whose tasks have not started when \a token is cancelled are skipped.
+template<class Sequence, class Function>
+void parallelMap(Sequence &sequence, Function function, CancellationToken *token = 0)
+{
+    typename Sequence::iterator items = sequence.begin();
+    parallelFor(0, sequence.size(), 1, [&](qint64 first, qint64 last) {
+        for(qint64 i=first; i<last; i++)
+            function( *(items + i) );
+    }, token);
+}
+
+//! \brief Queue \a task as a part of \a group on the application's task scheduler, and return at once; if there is no scheduler, run it now. This is QtConcurrent::run() on the scheduler.
+/*!
+  The owner of \a group must call waitForTasks() before it deletes anything that \a task uses, e.g., in its destructor. A task that reports back to a QObject does so with a queued QMetaObject::invokeMethod().
+  */
+inline void runTask(TaskGroup *group, const std::function<void()> &task)
+{
+    AbstractTaskScheduler *scheduler = taskScheduler();
+    if( scheduler != 0 ) { scheduler->run(group, task); return; }
+    if( !group->isCancelled() )
+        task();
+}
+
+//! \brief Return once every task that runTask() has queued as a part of \a group has finished or been skipped
+inline void waitForTasks(TaskGroup *group)
+{
+    AbstractTaskScheduler *scheduler = taskScheduler();
+    if( scheduler != 0 )
+        scheduler->wait(group);
+    else // e.g., while the scheduler is running the last tasks before it stops
+        group->waitUntilDone();
+}
+
 #endif // INTERFACES_H
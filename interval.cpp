@@ -1,6 +1,7 @@
 #include "interval.h"
 
 Interval::Interval()
+    : mLeft(0), mRight(0)
 {
 }
 
@@ -9,7 +10,7 @@ Interval::Interval(QString label, double left, double right)
 {
 }
 
-bool Interval::inRange(double start, double end)
+bool Interval::inRange(double start, double end) const
 {
     if( end < mLeft || start > mRight )
         return false;
@@ -17,11 +18,11 @@ bool Interval::inRange(double start, double end)
         return true;
 }
 
-Interval* Interval::clip(double start, double end)
+Interval Interval::clip(double start, double end) const
 {
     if( mLeft > start )
         start = mLeft;
     if( end > mRight )
         end = mRight;
-    return new Interval(mLabel,start,end);
+    return Interval(mLabel,start,end);
 }
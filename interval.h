@@ -17,10 +17,10 @@ public:
     Interval(QString label, double left, double right);
 
     //! \brief Return true if the interval overlaps with the range [\a start,\a end], otherwise return false.
-    bool inRange(double start, double end);
+    bool inRange(double start, double end) const;
 
     //! \brief Return an interval identical to the current one, but clipped to the range [\a start,\a end].
-    Interval* clip(double start, double end);
+    Interval clip(double start, double end) const;
 
     QString mLabel;
     double mLeft, mRight;
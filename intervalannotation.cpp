@@ -1,22 +1,28 @@
 #include "intervalannotation.h"
 
-#include "interval.h"
-
-#include <QFile>
-#include <QTextStream>
-#include <QString>
 #include <QtDebug>
-#include <QRegExp>
 
-IntervalAnnotation::IntervalAnnotation()
+#include <algorithm>
+
+namespace {
+
+bool startsAfter(double time, const Interval &interval)
+{
+    return time < interval.mLeft;
+}
+
+}
+
+IntervalAnnotation::IntervalAnnotation() :
+    mPointTier(false)
 {
 }
 
-QString IntervalAnnotation::toString()
+QString IntervalAnnotation::toString() const
 {
     QString ret;
     for(int i=0; i<maIntervals.count(); i++)
-	ret += maIntervals.at(i)->mLabel + " ";
+	ret += maIntervals.at(i).mLabel + " ";
     return ret;
 }
 
@@ -24,7 +30,7 @@ bool IntervalAnnotation::operator==(const IntervalAnnotation &other) const
 {
     if( maIntervals.count() != other.maIntervals.count() ) { return false; }
     for(int i=0; i< maIntervals.count(); i++)
-	if( maIntervals.at(i)->mLabel != other.maIntervals.at(i)->mLabel )
+	if( maIntervals.at(i).mLabel != other.maIntervals.at(i).mLabel )
 	    return false;
     return true;
 }
@@ -33,3 +39,45 @@ bool IntervalAnnotation::operator!=(const IntervalAnnotation &other) const
 {
   return !(*this == other);
 }
+
+int IntervalAnnotation::count() const
+{
+    return maIntervals.count();
+}
+
+const Interval &IntervalAnnotation::at(int i) const
+{
+    return maIntervals.at(i);
+}
+
+void IntervalAnnotation::append(const Interval &interval)
+{
+    if( maIntervals.isEmpty() || maIntervals.last().mLeft <= interval.mLeft )
+    {
+        maIntervals.append(interval);
+        maMaxRight.append( maMaxRight.isEmpty() ? interval.mRight : qMax(maMaxRight.last(), interval.mRight) );
+        return;
+    }
+
+    // out of order: insert it in place, and bring the running maximum up to date from there
+    int index = std::upper_bound(maIntervals.constBegin(), maIntervals.constEnd(), interval.mLeft, startsAfter) - maIntervals.constBegin();
+    maIntervals.insert(index, interval);
+    maMaxRight.resize(maIntervals.count());
+    for(int i=index; i<maIntervals.count(); i++)
+        maMaxRight[i] = i == 0 ? maIntervals.at(i).mRight : qMax(maMaxRight.at(i-1), maIntervals.at(i).mRight);
+}
+
+void IntervalAnnotation::reserve(int n)
+{
+    maIntervals.reserve(n);
+    maMaxRight.reserve(n);
+}
+
+void IntervalAnnotation::range(double start, double end, int *first, int *last) const
+{
+    // intervals before *first all end before start; intervals from *last on all begin after end
+    *first = std::lower_bound(maMaxRight.constBegin(), maMaxRight.constEnd(), start) - maMaxRight.constBegin();
+    *last = std::upper_bound(maIntervals.constBegin(), maIntervals.constEnd(), end, startsAfter) - maIntervals.constBegin();
+    if( *last < *first )
+        *last = *first;
+}
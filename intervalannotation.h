@@ -2,16 +2,18 @@
     \ingroup Annotation
     \brief A data class for representing multiple time-domain annotations.
 
-    The class represents the an interval annotation tier with a list of Interval objects. There are convenience functions to convert the tier to a string, clip the interval, and check for equality (of labels) with other tiers.
+    The class represents the an interval annotation tier with a list of Interval objects. There are convenience functions to convert the tier to a string, and check for equality (of labels) with other tiers.
+
+    The intervals are stored by value in a contiguous array, sorted by their left edges. Alongside it the class keeps the running maximum of the right edges, so that the intervals overlapping a time range can be found with two binary searches (see range()). This keeps drawing a long tier cheap, since only the visible intervals are visited.
   */
 
 #ifndef INTERVALANNOTATION_H
 #define INTERVALANNOTATION_H
 
-#include <QList>
+#include <QVector>
 #include <QString>
 
-class Interval;
+#include "interval.h"
 
 class IntervalAnnotation
 {
@@ -19,7 +21,7 @@ public:
     IntervalAnnotation();
 
     //! \brief Return a string consisted of all of the labels of the intervals on the tier, delimited by a space.
-    QString toString();
+    QString toString() const;
 
     //! \brief Return true if the \a other has the same number of intervals and same labels as \a this, otherwise return false.
     bool operator==(const IntervalAnnotation &other) const;
@@ -27,11 +29,34 @@ public:
     //! \brief Return false if the \a other has the same number of intervals and same labels as \a this, otherwise return true.
     bool operator!=(const IntervalAnnotation &other) const;
 
+    //! \brief Return the number of intervals on the tier
+    int count() const;
+
+    //! \brief Return the interval at index \a i. Intervals are sorted by their left edges.
+    const Interval & at(int i) const;
+
+    //! \brief Add \a interval to the tier. This is cheapest when intervals are added in order, as they are when a tier is read from a file.
+    void append(const Interval &interval);
+
+    //! \brief Reserve space for \a n intervals
+    void reserve(int n);
+
+    //! \brief Find the intervals that overlap the range [\a start,\a end]
+    /*!
+      On return, every interval that overlaps the range has an index i with \a *first <= i < \a *last. If the intervals of the tier do not overlap one another, as in any tier from Praat, then every interval in that span overlaps the range. The search takes O(log n) time and allocates nothing.
+      */
+    void range(double start, double end, int *first, int *last) const;
+
     QString mName;
-    QList<Interval*> maIntervals;
 
-    //! \brief Return an interval tier identical to the current one, but clipped to the range [\a start,\a end].
-    QList<Interval*> clip(double start, double end);
+    //! \brief True if the tier holds points rather than intervals. Each point is stored as an Interval with equal left and right edges.
+    bool mPointTier;
+
+private:
+    QVector<Interval> maIntervals;
+
+    //! \brief Element i is the greatest right edge of the intervals 0 through i
+    QVector<double> maMaxRight;
 };
 
 #endif // INTERVALANNOTATION_H
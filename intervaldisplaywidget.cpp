@@ -46,20 +46,28 @@ void IntervalDisplayWidget::paintEvent(QPaintEvent *event)
     painter.setBrush(noBrush);
     painter.setPen(simpleBlack);
 
-    for(int i=0; i<mAnnotation->maIntervals.count(); i++)
+    // only the intervals in view are visited
+    int first, last;
+    mAnnotation->range(left, right, &first, &last);
+    for(int i=first; i<last; i++)
     {
-	if(mAnnotation->maIntervals.at(i)->inRange(left, right))
-	{
-	    Interval *clipped = mAnnotation->maIntervals.at(i)->clip(left, right);
-	    int L, R;
-	    L = pLeft + (clipped->mLeft-left) * scale;
-	    R = pLeft + (clipped->mRight-left) * scale;
+	const Interval &interval = mAnnotation->at(i);
+	if(!interval.inRange(left, right)) { continue; }
+
+	int L, R;
+	L = pLeft + (qMax(interval.mLeft,left)-left) * scale;
+	R = pLeft + (qMin(interval.mRight,right)-left) * scale;
 
+	if(mAnnotation->mPointTier)
+	{
+	    painter.drawLine(L, 0, L, pHeight-1);
+	    painter.drawText(QRect(L+2, 0, width()-L-2, pHeight-1),Qt::AlignLeft|Qt::AlignVCenter,interval.mLabel);
+	}
+	else
+	{
 	    QRect drawingRect(L, 0, R-L, pHeight-1);
 	    painter.drawRect(drawingRect);
-	    painter.drawText(drawingRect,Qt::AlignHCenter|Qt::AlignVCenter,clipped->mLabel);
-
-	    delete clipped;
+	    painter.drawText(drawingRect,Qt::AlignHCenter|Qt::AlignVCenter,interval.mLabel);
 	}
     }
 }
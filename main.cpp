@@ -12,8 +12,13 @@
 #include <QtWidgets/QApplication>
 #include "mainwindow.h"
 
+#include <fftw3.h>
+
 int main(int argc, char *argv[])
 {
+    // plugins create FFTW plans, and stale results are recomputed by several plugins at once
+    fftw_make_planner_thread_safe();
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
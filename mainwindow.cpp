@@ -2,7 +2,6 @@
 #include "ui_mainwindow.h"
 
 #include <QDebug>
-#include <QPluginLoader>
 #include <QApplication>
 #include <QAction>
 #include <QMenuBar>
@@ -10,6 +9,9 @@
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QFileDialog>
+#include <QVector>
+#include <QStatusBar>
+#include <QProgressDialog>
 
 #include "sound.h"
 #include "soundwidget.h"
@@ -17,6 +19,11 @@
 #include "interfaces.h"
 #include "waveformdata.h"
 #include "comparisoncreationdialog.h"
+#include "pairwisecomparison.h"
+#include "projectwriter.h"
+#include "taskscheduler.h"
+#include "pluginhost.h"
+#include "textdisplaydialog.h"
 
 #include "sndfile.h"
 
@@ -25,18 +32,27 @@ MainWindow::MainWindow(QWidget *parent)
       ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
-    loadPlugins();
+
+    // the plugins, project input and output, and drawing all queue their parallel work here
+    new TaskScheduler(QThread::idealThreadCount(), this);
+
+    mPlugins = new PluginHost(this);
+    connect(mPlugins, SIGNAL(reportCreated(QString,QString)), this, SLOT(showReport(QString,QString)));
+    connect(mPlugins, SIGNAL(progressChanged(int,int)), this, SLOT(showProgress(int,int)));
+    mPlugins->loadPlugins();
 
     connect(ui->actionOpen_Sound, SIGNAL(triggered()), this, SLOT(openSound()));
     connect(ui->actionImport_sound_to_create_waveform, SIGNAL(triggered()), this, SLOT(importSoundFile()) );
     connect(ui->actionSave_Sound, SIGNAL(triggered()), this, SLOT(save()) );
     connect(ui->actionSave_Sound_As, SIGNAL(triggered()), this, SLOT(saveAs()) );
     connect(ui->actionNew_comparison, SIGNAL(triggered()), this, SLOT(newComparisonWindow()) );
+    connect(ui->actionAll_pairs_comparison, SIGNAL(triggered()), this, SLOT(allPairsComparison()) );
 }
 
 
 MainWindow::~MainWindow()
 {
+    // closing the sounds cancels their refinement and any comparison of them; saves that are still running finish writing their files when the task scheduler, a child of the window, is deleted, since it runs every queued task before it stops
     qDeleteAll(mSounds);
 }
 
@@ -60,7 +76,7 @@ void MainWindow::save()
     Sound * sound = currentSound();
     if( sound != 0 )
     {
-        sound->writeProjectToFile( sound->filename() );
+        showSaveProgress( sound->writeProjectToFile( sound->filename() ), sound->filename() );
     }
 }
 
@@ -72,11 +88,43 @@ void MainWindow::saveAs()
         QString filename = QFileDialog::getSaveFileName(this, tr("Open Sound"), "", tr("Sound files (*.*)"));
         if(!filename.isNull())
         {
-            sound->writeProjectToFile( filename );
+            QStringList options;
+            options << tr("None") << tr("Fast") << tr("Small");
+            bool ok;
+            QString option = QInputDialog::getItem(this, tr("Save Sound"), tr("Compression of the binary data"), options, (int)sound->compression(), false, &ok);
+            if(!ok) { return; }
+            sound->setCompression( (BlockCodec::Compression)options.indexOf(option) );
+
+            showSaveProgress( sound->writeProjectToFile( filename ), filename );
         }
     }
 }
 
+void MainWindow::showSaveProgress(ProjectWriter *writer, const QString &filename)
+{
+    if( writer == 0 )
+    {
+        statusBar()->showMessage(tr("%1 is already being saved.").arg(filename), 5000);
+        return;
+    }
+
+    QString name = QFileInfo(filename).fileName();
+    connect(writer, &ProjectWriter::progress, this, [this,name](int percent) {
+        statusBar()->showMessage(tr("Saving %1 (%2%)").arg(name).arg(percent));
+    });
+    connect(writer, &ProjectWriter::finished, this, [this,name](bool success, const QString &error) {
+        if( success )
+        {
+            statusBar()->showMessage(tr("Saved %1").arg(name), 5000);
+        }
+        else
+        {
+            statusBar()->clearMessage();
+            QMessageBox::critical(this, tr("Error"), tr("%1 could not be saved. The previously saved version is unchanged.\n\n%2").arg(name).arg(error));
+        }
+    });
+}
+
 void MainWindow::importSoundFile()
 {
     QString fileName = QFileDialog::getOpenFileName(this, tr("Open Sound"), "", tr("Sound files (*.*)"));
@@ -102,16 +150,13 @@ void MainWindow::loadSound(const QString &fileName)
         return;
     }
 
-    if(sndInfo.channels > 1)
-    {
-        QMessageBox::warning(0,"Warning","The file has more than one channel, but only the first channel is going to be read.");
-    }
-
-    double *data = (double*)malloc(sizeof(double)*sndInfo.frames);
-    Q_CHECK_PTR(data);
-    if( sf_read_double(sndFile,data,sndInfo.frames) != sndInfo.frames )
+    // libsndfile delivers the samples interleaved, one frame (a sample from each channel) at a time
+    double *interleaved = (double*)malloc(sizeof(double)*sndInfo.frames*sndInfo.channels);
+    Q_CHECK_PTR(interleaved);
+    if( sf_readf_double(sndFile,interleaved,sndInfo.frames) != sndInfo.frames )
     {
         QMessageBox::critical(0,"Error","There was some kind of error in reading the file (not enough data).");
+        free(interleaved);
         sf_close(sndFile);
         return;
     }
@@ -125,10 +170,36 @@ void MainWindow::loadSound(const QString &fileName)
         *(times+i) = ((double)i)/sndInfo.samplerate;;
     }
 
+    // de-interleave into one buffer per channel in a single pass over the frames
+    QVector<double*> channelData(sndInfo.channels);
+    for(int c=0; c < sndInfo.channels; c++)
+    {
+        channelData[c] = (double*)malloc(sizeof(double)*sndInfo.frames);
+        Q_CHECK_PTR(channelData[c]);
+    }
+    const double *frame = interleaved;
+    for(quint32 i=0; i < sndInfo.frames; i++, frame += sndInfo.channels)
+    {
+        for(int c=0; c < sndInfo.channels; c++)
+        {
+            channelData[c][i] = frame[c];
+        }
+    }
+    free(interleaved);
+
     QFileInfo info(fileName);
-    WaveformData *sound = new WaveformData(info.fileName(),times,data,sndInfo.frames,sndInfo.samplerate);
+    QList<WaveformData*> channels;
+    for(int c=0; c < sndInfo.channels; c++)
+    {
+        QString name = info.fileName();
+        if(sndInfo.channels > 1)
+            name += " [" + Sound::channelLabel(c) + "]";
+        channels << new WaveformData(name,times,channelData[c],sndInfo.frames,sndInfo.samplerate);
+        free(channelData[c]); // WaveformData keeps its own copy of the samples
+    }
+    free(times);
 
-    Sound * newSound = new Sound(sound);
+    Sound * newSound = new Sound(channels);
     mSounds.append( newSound );
 }
 
@@ -140,66 +211,53 @@ Sound *MainWindow::currentSound()
     return w->sound();
 }
 
-void MainWindow::loadPlugins()
+QList<AbstractWaveform2WaveformMeasure *> *MainWindow::w2w()
 {
-    QDir pluginsDir;
-    QStringList pluginFileNames;
-
-    foreach (QObject *plugin, QPluginLoader::staticInstances())
-	loadPlugin(plugin);
-
-    pluginsDir = QDir(qApp->applicationDirPath());
-
-#if defined(Q_OS_WIN)
-    if (pluginsDir.dirName().toLower() == "debug" || pluginsDir.dirName().toLower() == "release")
-	pluginsDir.cdUp();
-#elif defined(Q_OS_MAC)
-    if (pluginsDir.dirName() == "MacOS") {
-	pluginsDir.cdUp();
-	pluginsDir.cdUp();
-	pluginsDir.cdUp();
-    }
-#endif
-    pluginsDir.cd("plugins");
-
-    foreach (QString fileName, pluginsDir.entryList(QDir::Files)) {
-	QPluginLoader loader(pluginsDir.absoluteFilePath(fileName));
+    return mPlugins->w2w();
+}
 
-    QObject *plugin = loader.instance();
-	if (plugin) {
-	    loadPlugin(plugin);
-	    pluginFileNames += fileName;
-	}
-//    else
-//    {
-//        if( fileName.right(3) == "dll" )
-//        qDebug() << fileName << loader.errorString();
-//    }
-    }
+QList<AbstractWaveform2SpectrogramMeasure *> *MainWindow::w2s()
+{
+    return mPlugins->w2s();
 }
 
-void MainWindow::loadPlugin(QObject *plugin)
+QList<AbstractSpectrogram2WaveformMeasure *> *MainWindow::s2w()
 {
-    AbstractWaveform2WaveformMeasure *wm = qobject_cast<AbstractWaveform2WaveformMeasure*>(plugin);
-    if (wm)
-	mW2wPlugins << wm;
+    return mPlugins->s2w();
+}
 
-    AbstractWaveform2SpectrogramMeasure *sm = qobject_cast<AbstractWaveform2SpectrogramMeasure*>(plugin);
-    if (sm)
-	mW2sPlugins << sm;
+QList<AbstractSpectrogram2SpectrogramMeasure *> *MainWindow::s2s()
+{
+    return mPlugins->s2s();
+}
 
-    AbstractSpectrogram2WaveformMeasure *sw = qobject_cast<AbstractSpectrogram2WaveformMeasure*>(plugin);
-    if (sw)
-	mS2wPlugins << sw;
+void MainWindow::showReport(QString title, QString text)
+{
+    TextDisplayDialog *dlg = new TextDisplayDialog(text, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    dlg->setWindowTitle(title);
+    dlg->show();
+}
 
-    AbstractSpectrogram2SpectrogramMeasure *ss = qobject_cast<AbstractSpectrogram2SpectrogramMeasure*>(plugin);
-    if (ss)
-	mS2sPlugins << ss;
+void MainWindow::showProgress(int done, int total)
+{
+    if( done >= total )
+    {
+        delete mProgress;
+        return;
+    }
+    if( mProgress == 0 )
+    {
+        mProgress = new QProgressDialog(tr("Calculating..."), QString(), 0, total, this);
+        mProgress->setWindowModality(Qt::WindowModal);
+    }
+    mProgress->setMaximum(total);
+    mProgress->setValue(done);
 }
 
 void MainWindow::newSoundWindow(Sound *snd)
 {
-    SoundWidget *tmp = new SoundWidget(snd, &mW2wPlugins,&mW2sPlugins,&mS2wPlugins,&mS2sPlugins,this);
+    SoundWidget *tmp = new SoundWidget(snd, mPlugins->w2w(), mPlugins->w2s(), mPlugins->s2w(), mPlugins->s2s(), this);
     ui->mdiArea->addSubWindow(tmp);
     ui->mdiArea->subWindowList().last()->setAttribute(Qt::WA_DeleteOnClose);
     tmp->show();
@@ -239,6 +297,44 @@ void MainWindow::newComparisonWindow()
 //    tmp->show();
 }
 
+void MainWindow::allPairsComparison()
+{
+    if( mSounds.count() < 2 )
+    {
+        QMessageBox::critical(this, tr("Error"), tr("You need at least two sounds to make a comparison."));
+        return;
+    }
+
+    bool ok;
+    QString names = QInputDialog::getText(this, tr("All-pairs comparison"), tr("Curves to align the sounds on, separated by commas"), QLineEdit::Normal, PairwiseComparison::commonCurveNames(mSounds).join(", "), &ok);
+    if(!ok) { return; }
+    QStringList curveNames;
+    foreach(QString name, names.split(',', QString::SkipEmptyParts))
+        curveNames << name.trimmed();
+    if( curveNames.isEmpty() ) { return; }
+
+    QString filename = QFileDialog::getSaveFileName(this, tr("Save Distance Matrix"), "", tr("Text files (*.txt)"));
+    if( filename.isNull() ) { return; }
+
+    PairwiseComparison *comparison = new PairwiseComparison(mSounds, curveNames, filename);
+    QString name = QFileInfo(filename).fileName();
+    connect(comparison, &PairwiseComparison::progress, this, [this,name](int percent) {
+        statusBar()->showMessage(tr("Comparing sounds for %1 (%2%)").arg(name).arg(percent));
+    });
+    connect(comparison, &PairwiseComparison::finished, this, [this,name](bool success, const QString &error) {
+        if( success )
+        {
+            statusBar()->showMessage(tr("Saved %1").arg(name), 5000);
+        }
+        else
+        {
+            statusBar()->clearMessage();
+            QMessageBox::critical(this, tr("Error"), tr("The comparison could not be saved.\n\n%1").arg(error));
+        }
+    });
+    comparison->start();
+}
+
 QList<SoundWidget*>* MainWindow::soundWindows()
 {
     QList<SoundWidget*> *sounds = new QList<SoundWidget*>;
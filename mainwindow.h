@@ -30,10 +30,14 @@ class AbstractSpectrogram2WaveformMeasure;
 class AbstractSpectrogram2SpectrogramMeasure;
 class QXmlStreamReader;
 class Sound;
+class ProjectWriter;
+class PluginHost;
+class QProgressDialog;
 
 
 #include <QList>
 #include <QDir>
+#include <QPointer>
 
 class SoundWidget;
 
@@ -50,16 +54,16 @@ public:
     ~MainWindow();
 
     //! \brief Returns a pointer to a list of pointers to the plugins that make waveforms from waveforms
-    inline QList<AbstractWaveform2WaveformMeasure*>* w2w() { return &mW2wPlugins; }
+    QList<AbstractWaveform2WaveformMeasure*>* w2w();
 
     //! \brief Returns a pointer to a list of pointers to the plugins that make spectrograms from waveforms
-    inline QList<AbstractWaveform2SpectrogramMeasure*>* w2s() { return &mW2sPlugins; }
+    QList<AbstractWaveform2SpectrogramMeasure*>* w2s();
 
     //! \brief Returns a pointer to a list of pointers to the plugins that make waveforms from spectrograms
-    inline QList<AbstractSpectrogram2WaveformMeasure*>* s2w() { return &mS2wPlugins; }
+    QList<AbstractSpectrogram2WaveformMeasure*>* s2w();
 
     //! \brief Returns a pointer to a list of pointers to the plugins that make spectrograms from spectrograms
-    inline QList<AbstractSpectrogram2SpectrogramMeasure*>* s2s() { return &mS2sPlugins; }
+    QList<AbstractSpectrogram2SpectrogramMeasure*>* s2s();
 
 private slots:
     void openSound();
@@ -75,6 +79,15 @@ private slots:
     //! \brief Create a new sound-comparison child window
     void newComparisonWindow();
 
+    //! \brief Prompts the user for curves and a file, and writes matrices of distances between all pairs of open sounds
+    void allPairsComparison();
+
+    //! \brief Show the report \a text of a plugin in a window with the title \a title
+    void showReport(QString title, QString text);
+
+    //! \brief Show the progress of a plugin's calculation in a progress dialog, which is closed when \a done reaches \a total
+    void showProgress(int done, int total);
+
 private:
     //! \brief Return a pointer to a list of pointers to SoundWidget objects.
     QList<SoundWidget*>* soundWindows();
@@ -84,16 +97,11 @@ private:
 
     Sound * currentSound();
 
-    //! \brief Reads the plugins from the application's plugins folder, invoking loadPlugin for each one
-    void loadPlugins();
-
-    //! \brief Adds the passed plugin to the appropriate array, depending on the successful outcome of qobject_cast
-    void loadPlugin(QObject *plugin);
+    //! \brief Report the progress and outcome of the save of \a filename by \a writer in the status bar
+    void showSaveProgress(ProjectWriter *writer, const QString & filename);
 
-    QList<AbstractWaveform2WaveformMeasure*> mW2wPlugins;
-    QList<AbstractWaveform2SpectrogramMeasure*> mW2sPlugins;
-    QList<AbstractSpectrogram2WaveformMeasure*> mS2wPlugins;
-    QList<AbstractSpectrogram2SpectrogramMeasure*> mS2sPlugins;
+    PluginHost *mPlugins;
+    QPointer<QProgressDialog> mProgress;
 
     Ui::MainWindow *ui;
 
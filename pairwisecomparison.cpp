@@ -0,0 +1,215 @@
+#include "pairwisecomparison.h"
+
+#include "sound.h"
+#include "waveformdata.h"
+#include "interfaces.h"
+
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QtDebug>
+
+#include <limits>
+#include <math.h>
+
+PairwiseComparison::PairwiseComparison(const QList<Sound *> &sounds, const QStringList &curveNames, const QString &filename, QObject *parent) :
+    QObject(parent),
+    mFilename(filename),
+    mCompleted(0)
+{
+    // gather the curves here, on the GUI thread, so that the comparison does not depend on the sounds afterwards
+    QVector< QList<const WaveformData*> > curves( sounds.count() );
+    for(int i=0; i<sounds.count(); i++)
+    {
+        maNames << sounds.at(i)->name();
+        connect(sounds.at(i), SIGNAL(destroyed()), this, SLOT(cancel()));
+        const QList<WaveformData*> *waveforms = static_cast<const Sound*>(sounds.at(i))->waveformData();
+        for(int j=0; j<curveNames.count(); j++)
+        {
+            for(int k=0; k<waveforms->count(); k++)
+            {
+                if( waveforms->at(k)->name() == curveNames.at(j) )
+                {
+                    curves[i] << waveforms->at(k);
+                    break;
+                }
+            }
+        }
+        if( curves.at(i).count() != curveNames.count() )
+        {
+            qDebug() << "PairwiseComparison: the sound" << sounds.at(i)->name() << "does not have all of the curves" << curveNames;
+            curves[i].clear();
+        }
+    }
+
+    maFeatures.resize( sounds.count() );
+    DtwAligner::Features *features = maFeatures.data();
+    QVector<int> indices( sounds.count() );
+    for(int i=0; i<indices.count(); i++)
+        indices[i] = i;
+    parallelMap(indices, [features,&curves](int &i) {
+        features[i] = DtwAligner::features( curves.at(i) );
+    });
+
+    for(int i=0; i<sounds.count(); i++)
+    {
+        for(int j=i+1; j<sounds.count(); j++)
+        {
+            Pair pair;
+            pair.first = i;
+            pair.second = j;
+            pair.distance = std::numeric_limits<double>::quiet_NaN();
+            pair.timingDeviation = std::numeric_limits<double>::quiet_NaN();
+            maPairs << pair;
+        }
+    }
+}
+
+PairwiseComparison::~PairwiseComparison()
+{
+    mCancel.cancel();
+    waitForTasks(&mTasks);
+}
+
+QString PairwiseComparison::timingFileName() const
+{
+    QFileInfo info(mFilename);
+    QString name = info.completeBaseName() + "-timing";
+    if( !info.suffix().isEmpty() )
+        name += "." + info.suffix();
+    return info.dir().filePath(name);
+}
+
+int PairwiseComparison::pairCount() const
+{
+    return maPairs.count();
+}
+
+void PairwiseComparison::start()
+{
+    runTask(&mTasks, [this]() {
+        bool success = compare();
+        QMetaObject::invokeMethod(this, "done", Qt::QueuedConnection, Q_ARG(bool, success));
+    });
+}
+
+void PairwiseComparison::cancel()
+{
+    mCancel.cancel();
+}
+
+QStringList PairwiseComparison::commonCurveNames(const QList<Sound *> &sounds)
+{
+    QStringList names;
+    for(int i=0; i<sounds.count(); i++)
+    {
+        const QList<WaveformData*> *waveforms = static_cast<const Sound*>(sounds.at(i))->waveformData();
+        QStringList soundNames;
+        for(int k=1; k<waveforms->count(); k++) // skip the waveform
+            soundNames << waveforms->at(k)->name();
+
+        if( i == 0 )
+        {
+            names = soundNames;
+        }
+        else
+        {
+            for(int j=names.count()-1; j>=0; j--)
+                if( !soundNames.contains(names.at(j)) )
+                    names.removeAt(j);
+        }
+    }
+    return names;
+}
+
+bool PairwiseComparison::compare()
+{
+    parallelMap(maPairs, [this](Pair &pair) {
+        align(pair);
+        pairCompleted();
+    }, &mCancel);
+    if( mCancel.isCancelled() )
+    {
+        mError = tr("The comparison was cancelled, because one of the sounds was closed.");
+        return false;
+    }
+
+    int n = maNames.count();
+    QVector<double> distances( n*n, 0.0 );
+    QVector<double> timing( n*n, 0.0 );
+    for(int k=0; k<maPairs.count(); k++)
+    {
+        const Pair &pair = maPairs.at(k);
+        distances[pair.first*n + pair.second] = distances[pair.second*n + pair.first] = pair.distance;
+        timing[pair.first*n + pair.second] = timing[pair.second*n + pair.first] = pair.timingDeviation;
+    }
+    for(int i=0; i<n; i++)
+    {
+        if( maFeatures.at(i).count() == 0 )
+            distances[i*n + i] = timing[i*n + i] = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return writeMatrix(mFilename, distances) && writeMatrix(timingFileName(), timing);
+}
+
+void PairwiseComparison::align(Pair &pair) const
+{
+    const DtwAligner::Features &from = maFeatures.at(pair.first);
+    const DtwAligner::Features &to = maFeatures.at(pair.second);
+    if( from.count() == 0 || to.count() == 0 ) { return; }
+
+    DtwAligner aligner;
+    if( !aligner.setFeatures(from, to) ) { return; }
+    QVector< QPair<int,int> > path = aligner.path( &pair.distance );
+    TimeWarp warp = aligner.warp(path);
+
+    // compare the warp with a linear stretch of one sound onto the other
+    double fromStart = from.times.first(), toStart = to.times.first();
+    double fromDuration = from.times.last() - fromStart;
+    double slope = fromDuration > 0 ? (to.times.last() - toStart) / fromDuration : 0;
+    QVector<double> mapped = warp.map(from.times);
+    double sum = 0;
+    for(int i=0; i<mapped.count(); i++)
+    {
+        double deviation = mapped.at(i) - ( toStart + (from.times.at(i) - fromStart) * slope );
+        sum += deviation * deviation;
+    }
+    pair.timingDeviation = sqrt( sum / mapped.count() );
+}
+
+bool PairwiseComparison::writeMatrix(const QString &filename, const QVector<double> &values)
+{
+    int n = maNames.count();
+    QByteArray text;
+    for(int i=0; i<n; i++)
+        text += '\t' + maNames.at(i).toUtf8();
+    text += '\n';
+    for(int i=0; i<n; i++)
+    {
+        text += maNames.at(i).toUtf8();
+        for(int j=0; j<n; j++)
+            text += '\t' + QByteArray::number( values.at(i*n + j), 'g', 8 );
+        text += '\n';
+    }
+
+    QSaveFile file(filename);
+    if( !file.open(QIODevice::WriteOnly | QIODevice::Text) || file.write(text) != text.size() || !file.commit() )
+    {
+        mError = tr("The file %1 could not be saved: %2").arg(filename).arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+void PairwiseComparison::pairCompleted()
+{
+    emit progress( 100 * (mCompleted.fetchAndAddRelaxed(1) + 1) / qMax(maPairs.count(), 1) );
+}
+
+void PairwiseComparison::done(bool success)
+{
+    if( !success )
+        qDebug() << mError;
+    emit finished(success, mError);
+    deleteLater();
+}
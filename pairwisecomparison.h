@@ -0,0 +1,95 @@
+/*!
+  \class PairwiseComparison
+  \ingroup Data
+  \brief Aligns every pair of a set of sounds and writes matrices of distances between them.
+
+  Where ComparisonWidget displays one primary sound against one or more secondaries, a PairwiseComparison is meant for studies of variation across many productions: it aligns every pair of sounds by dynamic time warping (see DtwAligner), using the curves with the given names as features, and summarises each alignment with two numbers:
+  - the distance, which is the distance between the aligned feature frames, normalised by the combined length of the two sounds;
+  - the timing deviation, which is the root mean square difference, in seconds, between the alignment and a linear stretch of one sound onto the other.
+
+  The features of each sound are extracted once, on the GUI thread, when the comparison is created, so the sounds may change or be closed while the comparison runs. The pairs are then aligned on the application's task scheduler; each pair is a task of its own, so pairs of long and short sounds balance out across the workers. Closing any of the sounds cancels the comparison: the pairs that have not been aligned yet are skipped, and no files are written.
+
+  The two matrices are written as tab-separated text, with the names of the sounds in the first row and column. The distances go to the file given to the constructor, and the timing deviations to a file with "-timing" added to its base name. Sounds that lack any of the curves have undefined (nan) entries.
+
+  The object deletes itself after emitting finished().
+*/
+
+#ifndef PAIRWISECOMPARISON_H
+#define PAIRWISECOMPARISON_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QStringList>
+
+#include "dtwaligner.h"
+#include "interfaces.h"
+
+class Sound;
+
+class PairwiseComparison : public QObject
+{
+    Q_OBJECT
+public:
+    //! \brief Create a comparison of \a sounds on the curves named \a curveNames, to be written to \a filename
+    PairwiseComparison(const QList<Sound*> &sounds, const QStringList &curveNames, const QString &filename, QObject *parent = 0);
+    ~PairwiseComparison();
+
+    //! \brief Return the name of the file to which the timing deviations are written
+    QString timingFileName() const;
+
+    //! \brief Return the number of pairs that will be aligned
+    int pairCount() const;
+
+    //! \brief Start the comparison in the background
+    void start();
+
+    //! \brief Return the names of the curves that all of \a sounds have, except for their first curve, which is the waveform
+    static QStringList commonCurveNames(const QList<Sound*> &sounds);
+
+public slots:
+    //! \brief Cancel the comparison; finished() reports it as failed
+    void cancel();
+
+signals:
+    //! \brief Reports progress of the comparison, in percent
+    void progress(int percent);
+
+    //! \brief Emitted when the comparison has finished. If \a success is false, \a error describes the problem.
+    void finished(bool success, const QString &error);
+
+private slots:
+    void done(bool success);
+
+private:
+    //! \brief One pair of sounds, and the summaries of their alignment
+    struct Pair
+    {
+        int first, second;
+        double distance;
+        double timingDeviation;
+    };
+
+    //! \brief Align all pairs and write the matrices; runs on a worker thread
+    bool compare();
+
+    //! \brief Align the sounds of \a pair and fill in its summaries
+    void align(Pair &pair) const;
+
+    //! \brief Write the matrix of \a values, which are stored row by row, to \a filename
+    bool writeMatrix(const QString &filename, const QVector<double> &values);
+
+    //! \brief Count one more completed pair, and report the progress
+    void pairCompleted();
+
+    QStringList maNames;
+    QVector<DtwAligner::Features> maFeatures;
+    QVector<Pair> maPairs;
+    QString mFilename;
+    QString mError;
+    QAtomicInt mCompleted;
+    CancellationToken mCancel;
+    TaskGroup mTasks;
+};
+
+#endif // PAIRWISECOMPARISON_H
@@ -6,6 +6,7 @@
 
 #include "plotviewwidget.h"
 #include "intervaldisplaywidget.h"
+#include "replotscheduler.h"
 
 PlotDisplayAreaWidget::PlotDisplayAreaWidget(QWidget *parent) :
 	QWidget(parent)
@@ -23,6 +24,7 @@ PlotDisplayAreaWidget::PlotDisplayAreaWidget(QWidget *parent) :
     QVBoxLayout *mainLayout = new QVBoxLayout;
 
     mScrollAreaWidget = new QWidget;
+    mReplotScheduler = new ReplotScheduler(this);
 
     QHBoxLayout *controlLayout = new QHBoxLayout;
 
@@ -55,6 +57,8 @@ PlotDisplayAreaWidget::PlotDisplayAreaWidget(QWidget *parent) :
     scrollArea->setWidget(mScrollAreaWidget);
     scrollArea->setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Expanding);
     scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    // plots that were skipped while out of view are replotted when they are scrolled into view
+    connect(scrollArea->verticalScrollBar(),SIGNAL(valueChanged(int)),mReplotScheduler,SLOT(wake()));
 
     mainLayout->addLayout(controlLayout,0);
     mainLayout->addWidget(scrollArea,1);
@@ -92,6 +96,7 @@ void PlotDisplayAreaWidget::addPlotView(PlotViewWidget *pr, QString name)
     maPlotViewWidgets << pr;
     maProsodyNames << name;
     maPlotViewWidgets.last()->setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Fixed);
+    maPlotViewWidgets.last()->setReplotScheduler(mReplotScheduler);
 
     connect(this,SIGNAL(timeAxisChanged(double,double)),maPlotViewWidgets.last(),SLOT(setHorizontalAxis(double,double)));
 
@@ -179,4 +184,5 @@ void PlotDisplayAreaWidget::setSliderFromWindow()
 void PlotDisplayAreaWidget::resizeEvent(QResizeEvent *event)
 {
     mScrollAreaWidget->resize(event->size().width()-mBorder,(mProsodyHeight+mProsodySpacing)*maPlotViewWidgets.count());
+    mReplotScheduler->wake();
 }
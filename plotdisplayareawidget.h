@@ -4,6 +4,8 @@
   \brief A widget that manages multiple PlotViewWidget objects.
 
   The class manages several PlotViewWidget objects, which are kept in \a aPlotViewWidgets. From a UI perspective, the class also has the layout code, and also manages the time slider and time-navigation buttons.
+
+  The plots are replotted through a shared ReplotScheduler, so that moving the slider redraws each visible plot at most once per display frame.
 */
 
 #ifndef PLOTDISPLAYWIDGET_H
@@ -15,6 +17,7 @@ class PlotViewWidget;
 class QVBoxLayout;
 class QwtSlider;
 class IntervalDisplayWidget;
+class ReplotScheduler;
 
 class PlotDisplayAreaWidget : public QWidget
 {
@@ -67,6 +70,7 @@ public slots:
 private:
     QVBoxLayout *mVerticalLayout;
     QWidget *mScrollAreaWidget;
+    ReplotScheduler *mReplotScheduler;
     QwtSlider *mSlider;
     int mProsodyHeight, mProsodySpacing, mBorder;
     double mTMin, mTMax, mLeftPos, mRightPos, mWindowWidth;
@@ -1,5 +1,7 @@
 #include "plotviewwidget.h"
 #include "waveformdata.h"
+#include "waveformseries.h"
+#include "spectrogramraster.h"
 #include <qwt_plot_curve.h>
 #include <qwt_text_label.h>
 #include <qwt_color_map.h>
@@ -12,6 +14,7 @@
 #include <QMouseEvent>
 #include <QContextMenuEvent>
 #include <QMenu>
+#include <QPainter>
 #include <QMouseEvent>
 
 #include "textdisplaydialog.h"
@@ -20,15 +23,98 @@
 
 #include "curvesettingsdialog.h"
 #include "spectrogramsettingsdialog.h"
+#include "replotscheduler.h"
 #include <qwt_plot.h>
 
 void PlotViewWidget::setHorizontalAxis(double left, double right)
 {
     setAxisScale((int)QwtPlot::xBottom,left,right,0.0f);
-    replot();
+    for(int i=0; i<maSpectrogramData.count(); i++)
+        maSpectrogramData.at(i)->setRegionOfInterest(left, right);
+    scheduleReplot();
 }
 
-PlotViewWidget::PlotViewWidget(QString name, QWidget *parent) : QwtPlot(parent), mLabel(name), mWidgetHeight(200), mSecondaryAxis(false)
+void PlotViewWidget::spectrogramFramesChanged(double fromTime, double toTime)
+{
+    SpectrogramData *data = qobject_cast<SpectrogramData*>(sender());
+    bool shown = false;
+    for(int i=0; i<maSpectrogramData.count(); i++)
+    {
+        if( maSpectrogramData.at(i) != data ) { continue; }
+        // a spectrogram that has grown covers a longer time, and perhaps a wider range of values
+        static_cast<SpectrogramRaster*>( maSpectrograms.at(i)->data() )->updateIntervals();
+        maSpectrograms.at(i)->invalidateCache();
+        shown = true;
+    }
+
+    // frames that are scrolled out of view do not need a replot
+    if( !shown || toTime < axisScaleDiv(QwtPlot::xBottom).lowerBound() || fromTime > axisScaleDiv(QwtPlot::xBottom).upperBound() ) { return; }
+    scheduleReplot();
+}
+
+void PlotViewWidget::scheduleReplot()
+{
+    if( mScheduler != 0 )
+        mScheduler->schedule(this);
+    else
+        replot();
+}
+
+void PlotViewWidget::setReplotScheduler(ReplotScheduler *scheduler)
+{
+    mScheduler = scheduler;
+}
+
+void PlotViewWidget::showEvent(QShowEvent *event)
+{
+    QwtPlot::showEvent(event);
+    if( mScheduler != 0 )
+        mScheduler->wake();
+}
+
+void PlotViewWidget::prepareCanvasImage()
+{
+    updateAxes();
+    for(int axis=0; axis<QwtPlot::axisCnt; axis++)
+        maCanvasMaps[axis] = canvasMap(axis);
+    mCanvasRect = canvas()->contentsRect();
+    mCanvasSize = canvas()->size();
+    mCanvasPixelRatio = canvas()->devicePixelRatio();
+    mCanvasImage = QImage();
+
+    // the image is drawn by a worker of the task scheduler, alongside the other plots; threads of Qwt's own would compete with the workers
+    for(int i=0; i<maSpectrograms.count(); i++)
+        maSpectrograms.at(i)->setRenderThreadCount( 1 );
+}
+
+void PlotViewWidget::renderCanvasImage()
+{
+    QImage image( mCanvasSize * mCanvasPixelRatio, QImage::Format_ARGB32_Premultiplied );
+    image.setDevicePixelRatio( mCanvasPixelRatio );
+    image.fill( Qt::transparent );
+
+    QPainter painter(&image);
+    drawItems( &painter, mCanvasRect, maCanvasMaps );
+    painter.end();
+
+    mCanvasImage = image;
+}
+
+void PlotViewWidget::drawCanvas(QPainter *painter)
+{
+    // the image is used once; any later redraw (e.g., after a resize) draws the items again
+    QImage image = mCanvasImage;
+    mCanvasImage = QImage();
+    for(int i=0; i<maSpectrograms.count(); i++)
+        maSpectrograms.at(i)->setRenderThreadCount( 0 );
+
+    if( !image.isNull() && image.size() == canvas()->size() * canvas()->devicePixelRatio() )
+        painter->drawImage( QPointF(0,0), image );
+    else
+        QwtPlot::drawCanvas(painter);
+}
+
+PlotViewWidget::PlotViewWidget(QString name, QWidget *parent) : QwtPlot(parent), mLabel(name), mWidgetHeight(200), mSecondaryAxis(false), mCanvasPixelRatio(1)
 {
     QSizePolicy sizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     setSizePolicy(sizePolicy);
@@ -60,15 +146,16 @@ QwtPlotCurve * PlotViewWidget::addCurveData(WaveformData *curveData, bool second
     QwtPlotCurve *waveCurve = new QwtPlotCurve("dummy");
     waveCurve->setRenderHint(QwtPlotItem::RenderAntialiased);
     waveCurve->setPen(QPen(col));
-    waveCurve->setSamples( curveData );
+    waveCurve->setSamples( new WaveformSeries(curveData) );
     maCurves << waveCurve;
     waveCurve->attach(this);
 
     if( !mSecondaryAxis || maCurves.length() == 0 ) // no secondary axis or just one plot
     {
-        replot();
+        // the autoscaled left axis is computed without drawing anything
+        updateAxes();
         setAxisScaleDiv(QwtPlot::yRight, axisScaleDiv(QwtPlot::yLeft));
-        replot();
+        scheduleReplot();
     }
     else
     {
@@ -83,20 +170,20 @@ QwtPlotCurve * PlotViewWidget::addCurveData(WaveformData *curveData, bool second
         }
     }
 
-    repaint();
+    scheduleReplot();
     return waveCurve;
 }
 
 QwtPlotSpectrogram * PlotViewWidget::addSpectrogramData(SpectrogramData *spectrogramData)
 {
     QwtPlotSpectrogram *spectrogram = new QwtPlotSpectrogram();
-    spectrogram->setRenderThreadCount( 0 ); // use system specific thread count
+    spectrogram->setRenderThreadCount( 0 ); // use system specific thread count, except when the canvas is rendered on a worker (see prepareCanvasImage())
 
     QwtLinearColorMap * colorMap = new QwtLinearColorMap(Qt::white, Qt::black);
     spectrogram->setColorMap(colorMap);
 
     spectrogram->setCachePolicy( QwtPlotRasterItem::PaintCache );
-    spectrogram->setData( spectrogramData );
+    spectrogram->setData( new SpectrogramRaster(spectrogramData) );
 
     QRectF r = spectrogramData->boundingRect();
     setAxisScale( QwtPlot::yLeft , 0, 5000, 1000);
@@ -107,10 +194,12 @@ QwtPlotSpectrogram * PlotViewWidget::addSpectrogramData(SpectrogramData *spectro
     spectrogram->setAlpha(100);
 
     maSpectrogramData << spectrogramData;
+    spectrogramData->setRegionOfInterest( axisScaleDiv(QwtPlot::xBottom).lowerBound(), axisScaleDiv(QwtPlot::xBottom).upperBound() );
+    connect( spectrogramData, SIGNAL(framesChanged(double,double)), this, SLOT(spectrogramFramesChanged(double,double)) );
 
     maSpectrograms << spectrogram;
     spectrogram->attach( this );
-    repaint();
+    scheduleReplot();
 
     return spectrogram;
 }
@@ -124,10 +213,45 @@ void PlotViewWidget::removeItemAt(int i)
 
     if( !mSecondaryAxis || maCurves.length() == 1 ) // no secondary axis or just one plot
     {
-        replot();
+        updateAxes();
         setAxisScaleDiv(QwtPlot::yRight, axisScaleDiv(QwtPlot::yLeft));
-        replot();
+        scheduleReplot();
+    }
+}
+
+void PlotViewWidget::replaceCurveData(WaveformData *oldData, WaveformData *newData)
+{
+    bool changed = false;
+    for(int i=0; i<maWaveformData.count(); i++)
+    {
+        if( maWaveformData.at(i) != oldData ) { continue; }
+        // the curve deletes the series of oldData, but not oldData itself
+        maCurves.at(i)->setSamples( new WaveformSeries(newData) );
+        maWaveformData[i] = newData;
+        changed = true;
+    }
+    if(changed)
+        scheduleReplot();
+}
+
+void PlotViewWidget::replaceSpectrogramData(SpectrogramData *oldData, SpectrogramData *newData)
+{
+    bool changed = false;
+    for(int i=0; i<maSpectrogramData.count(); i++)
+    {
+        if( maSpectrogramData.at(i) != oldData ) { continue; }
+
+        // the item deletes the raster of oldData, but not oldData itself
+        maSpectrograms.at(i)->setData( new SpectrogramRaster(newData) );
+        maSpectrograms.at(i)->invalidateCache();
+        disconnect( oldData, SIGNAL(framesChanged(double,double)), this, SLOT(spectrogramFramesChanged(double,double)) );
+        maSpectrogramData[i] = newData;
+        newData->setRegionOfInterest( axisScaleDiv(QwtPlot::xBottom).lowerBound(), axisScaleDiv(QwtPlot::xBottom).upperBound() );
+        connect( newData, SIGNAL(framesChanged(double,double)), this, SLOT(spectrogramFramesChanged(double,double)) );
+        changed = true;
     }
+    if(changed)
+        scheduleReplot();
 }
 
 void PlotViewWidget::toggleCurveAxisAssociation(int index)
@@ -142,7 +266,7 @@ void PlotViewWidget::toggleCurveAxisAssociation(int index)
     {
         maCurves.at(index)->setYAxis(QwtPlot::yLeft);
     }
-    replot();
+    scheduleReplot();
 }
 
 void PlotViewWidget::mouseMoveEvent ( QMouseEvent * event )
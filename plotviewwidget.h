@@ -11,16 +11,20 @@
 
 #include <QWidget>
 #include <QList>
+#include <QPointer>
+#include <QImage>
 
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h>
 #include <qwt_plot_spectrogram.h>
+#include <qwt_scale_map.h>
 
 #include "waveformdata.h"
 #include "spectrogramdata.h"
 
 class QMouseEvent;
 class QHBoxLayout;
+class ReplotScheduler;
 
 class PlotViewWidget : public QwtPlot
 {
@@ -74,6 +78,12 @@ public:
     //! \brief Remove the \a i-th plot item (curve or spectrogram)
     void removeItemAt(int i);
 
+    //! \brief Display \a newData in place of \a oldData, in every curve that shows \a oldData. The curve keeps its settings.
+    void replaceCurveData(WaveformData *oldData, WaveformData *newData);
+
+    //! \brief Display \a newData in place of \a oldData, in every spectrogram that shows \a oldData
+    void replaceSpectrogramData(SpectrogramData *oldData, SpectrogramData *newData);
+
     //! \brief Display a context menu. Reimplemented from QWidget
     void contextMenuEvent ( QContextMenuEvent * event );
 
@@ -86,10 +96,28 @@ public:
     //! \brief Launch the CurveSettingsDialog for the first curve, or the SpectrogramSettingsDialog for the first spectrogram if there is no curve
     void mouseDoubleClickEvent ( QMouseEvent *event );
 
+    //! \brief Have \a scheduler carry out the replots of this plot. Without a scheduler, the plot is replotted immediately.
+    void setReplotScheduler(ReplotScheduler *scheduler);
+
+    //! \brief Bring the axes up to date, and record what renderCanvasImage() needs to know about the canvas. Call this on the GUI thread.
+    void prepareCanvasImage();
+
+    //! \brief Draw the plot items into an offscreen image, which the next redraw of the canvas uses instead of drawing them again
+    /*!
+      This function does not touch any widget, so it may be called on a worker thread, provided that the plot is not changed in the meantime. prepareCanvasImage() must be called first.
+      */
+    void renderCanvasImage();
+
 public slots:
-    //! \brief Set the left and right bounds of the plot to \a left and \a right
+    //! \brief Set the left and right bounds of the plot to \a left and \a right. The plot is redrawn in the next frame.
     void setHorizontalAxis(double left, double right);
 
+    //! \brief Replot in the next frame (see ReplotScheduler). Several requests before then result in a single replot.
+    void scheduleReplot();
+
+    //! \brief Redraw a spectrogram whose frames from \a fromTime to \a toTime have been replaced, if any of them are in view
+    void spectrogramFramesChanged(double fromTime, double toTime);
+
     //! \brief Set whether the plot has a secondary axis
     void setHasSecondaryAxis(bool hasSecondaryAxis);
 
@@ -112,6 +140,12 @@ public slots:
     void launchSpectrogramSettings(int index);
 
 protected:
+    //! \brief Let the scheduler know that the plot may have come into view. Reimplemented from QWidget
+    void showEvent(QShowEvent *event);
+
+    //! \brief Draw the image made by renderCanvasImage(), if there is one that fits the canvas, and otherwise draw the items. Reimplemented from QwtPlot
+    void drawCanvas(QPainter *painter);
+
     QString mLabel;
     int mWidgetHeight;
     QHBoxLayout *mHlayout;
@@ -123,6 +157,15 @@ protected:
 
     QList<QwtPlotCurve*> maCurves;
     QList<QwtPlotSpectrogram*> maSpectrograms;
+
+    QPointer<ReplotScheduler> mScheduler;
+
+    //! \brief The state of the canvas recorded by prepareCanvasImage(), and the image drawn by renderCanvasImage()
+    QwtScaleMap maCanvasMaps[QwtPlot::axisCnt];
+    QRectF mCanvasRect;
+    QSize mCanvasSize;
+    int mCanvasPixelRatio;
+    QImage mCanvasImage;
 };
 
 #endif // PROSODYINTERFACE_H
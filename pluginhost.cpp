@@ -0,0 +1,181 @@
+#include "pluginhost.h"
+
+#include "interfaces.h"
+#include "pluginlibrary.h"
+#include "pluginproxy.h"
+
+#include <QCoreApplication>
+#include <QPluginLoader>
+#include <QStandardPaths>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QtDebug>
+
+PluginHost::PluginHost(QObject *parent) :
+    QObject(parent)
+{
+}
+
+QDir PluginHost::pluginsDirectory()
+{
+    QDir pluginsDir = QDir(qApp->applicationDirPath());
+
+#if defined(Q_OS_WIN)
+    if (pluginsDir.dirName().toLower() == "debug" || pluginsDir.dirName().toLower() == "release")
+	pluginsDir.cdUp();
+#elif defined(Q_OS_MAC)
+    if (pluginsDir.dirName() == "MacOS") {
+	pluginsDir.cdUp();
+	pluginsDir.cdUp();
+	pluginsDir.cdUp();
+    }
+#endif
+    pluginsDir.cd("plugins");
+    return pluginsDir;
+}
+
+void PluginHost::loadPlugins()
+{
+    foreach (QObject *plugin, QPluginLoader::staticInstances())
+	addPlugin(plugin);
+
+    loadPlugins( pluginsDirectory() );
+}
+
+void PluginHost::loadPlugins(const QDir &dir)
+{
+    QJsonObject index;
+    QFile indexFile( indexFileName() );
+    if( indexFile.open(QIODevice::ReadOnly) )
+    {
+	index = QJsonDocument::fromJson( indexFile.readAll() ).object();
+	indexFile.close();
+    }
+
+    // the entries of other folders are kept; those of files in this one are replaced, so that files that have gone are dropped
+    QJsonObject updated = index;
+    foreach (QString fileName, index.keys())
+	if (QFileInfo(fileName).absolutePath() == dir.absolutePath())
+	    updated.remove(fileName);
+
+    foreach (QString fileName, dir.entryList(QDir::Files)) {
+	QString path = dir.absoluteFilePath(fileName);
+	QJsonObject entry;
+	QJsonObject data = metaData(path, index, &entry);
+	updated.insert(path, entry);
+
+	// not a plugin
+	if (data.isEmpty())
+	    continue;
+
+	if (PluginLibrary::isComplete(data.value("MetaData").toObject()) && addProxy(path, data))
+	    continue;
+
+	// a plugin without metadata has to be loaded to find out what it measures
+	QPluginLoader loader(path);
+	QObject *plugin = loader.instance();
+	if (plugin)
+	    addPlugin(plugin);
+    }
+
+    if( updated == index ) { return; }
+    QDir().mkpath( QFileInfo(indexFile).absolutePath() );
+    if( !indexFile.open(QIODevice::WriteOnly) ) { qDebug() << "PluginHost: could not write the plugin index" << indexFile.fileName(); return; }
+    indexFile.write( QJsonDocument(updated).toJson() );
+}
+
+QString PluginHost::indexFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/plugins.json";
+}
+
+QJsonObject PluginHost::metaData(const QString &fileName, const QJsonObject &index, QJsonObject *updated)
+{
+    QFileInfo info(fileName);
+    double size = info.size();
+    double modified = info.lastModified().toMSecsSinceEpoch();
+
+    QJsonObject entry = index.value(fileName).toObject();
+    if( !entry.isEmpty() && entry.value("size").toDouble() == size && entry.value("modified").toDouble() == modified )
+    {
+	*updated = entry;
+	return entry.value("metaData").toObject();
+    }
+
+    // this reads the metadata from the file without loading the library
+    QJsonObject data = QPluginLoader(fileName).metaData();
+    updated->insert("size", size);
+    updated->insert("modified", modified);
+    updated->insert("metaData", data);
+    return data;
+}
+
+bool PluginHost::addProxy(const QString &fileName, const QJsonObject &metaData)
+{
+    QString iid = metaData.value("IID").toString();
+    PluginLibrary *library = new PluginLibrary(fileName, iid, metaData.value("MetaData").toObject(), this);
+
+    QObject *proxy = 0;
+    if (iid == qobject_interface_iid<AbstractWaveform2WaveformMeasure*>())
+	proxy = new Waveform2WaveformProxy(library, this);
+    else if (iid == qobject_interface_iid<AbstractWaveform2SpectrogramMeasure*>())
+	proxy = new Waveform2SpectrogramProxy(library, this);
+    else if (iid == qobject_interface_iid<AbstractSpectrogram2WaveformMeasure*>())
+	proxy = new Spectrogram2WaveformProxy(library, this);
+    else if (iid == qobject_interface_iid<AbstractSpectrogram2SpectrogramMeasure*>())
+	proxy = new Spectrogram2SpectrogramProxy(library, this);
+
+    if( proxy == 0 || !addPlugin(proxy) )
+    {
+	delete proxy;
+	delete library;
+	return false;
+    }
+    return true;
+}
+
+bool PluginHost::addPlugin(QObject *plugin)
+{
+    bool added = false;
+
+    AbstractWaveform2WaveformMeasure *wm = qobject_cast<AbstractWaveform2WaveformMeasure*>(plugin);
+    if (wm) { mW2wPlugins << wm; added = true; }
+
+    AbstractWaveform2SpectrogramMeasure *sm = qobject_cast<AbstractWaveform2SpectrogramMeasure*>(plugin);
+    if (sm) { mW2sPlugins << sm; added = true; }
+
+    AbstractSpectrogram2WaveformMeasure *sw = qobject_cast<AbstractSpectrogram2WaveformMeasure*>(plugin);
+    if (sw) { mS2wPlugins << sw; added = true; }
+
+    AbstractSpectrogram2SpectrogramMeasure *ss = qobject_cast<AbstractSpectrogram2SpectrogramMeasure*>(plugin);
+    if (ss) { mS2sPlugins << ss; added = true; }
+
+    if( !added ) { return false; }
+
+    // by signature, since each plugin library has its own copy of the meta-object of AbstractMeasurement
+    connect(plugin, SIGNAL(reportCreated(QString,QString)), this, SIGNAL(reportCreated(QString,QString)));
+    connect(plugin, SIGNAL(progressChanged(int,int)), this, SIGNAL(progressChanged(int,int)));
+    return true;
+}
+
+QList<AbstractWaveform2WaveformMeasure *> *PluginHost::w2w()
+{
+    return &mW2wPlugins;
+}
+
+QList<AbstractWaveform2SpectrogramMeasure *> *PluginHost::w2s()
+{
+    return &mW2sPlugins;
+}
+
+QList<AbstractSpectrogram2WaveformMeasure *> *PluginHost::s2w()
+{
+    return &mS2wPlugins;
+}
+
+QList<AbstractSpectrogram2SpectrogramMeasure *> *PluginHost::s2s()
+{
+    return &mS2sPlugins;
+}
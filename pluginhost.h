@@ -0,0 +1,77 @@
+/*!
+  \class PluginHost
+  \ingroup Plugin
+  \brief Loads the measurement plugins and sorts them by the kinds of data they take and make.
+
+  The host depends on QtCore only, so that a batch tool can load the plugins and run them without a display.
+
+  Plugins that declare their metadata (see PluginLibrary) are not loaded at startup: the host puts a PluginProxy in the lists in their place, and the library is loaded when one of its measures is first run. The metadata of each file in the plugins folder is kept in an index (see indexFileName()), together with the size and modification time of the file, so that files that have not changed are not even opened. Plugins without metadata are loaded at once, as before. The plugins do not show anything themselves; the host passes on the reports and progress that they emit, for the application to display (or not).
+*/
+
+#ifndef PLUGINHOST_H
+#define PLUGINHOST_H
+
+#include <QObject>
+#include <QList>
+#include <QDir>
+#include <QJsonObject>
+
+class AbstractWaveform2WaveformMeasure;
+class AbstractWaveform2SpectrogramMeasure;
+class AbstractSpectrogram2WaveformMeasure;
+class AbstractSpectrogram2SpectrogramMeasure;
+
+class PluginHost : public QObject
+{
+    Q_OBJECT
+public:
+    PluginHost(QObject *parent = 0);
+
+    //! \brief Return the folder of plugins, which is the plugins folder next to the application (or next to its bundle, on the Mac)
+    static QDir pluginsDirectory();
+
+    //! \brief Load the static plugins, and each plugin in pluginsDirectory()
+    void loadPlugins();
+
+    //! \brief Add each plugin in \a dir, loading only those without metadata. Files that are not plugins are skipped.
+    void loadPlugins(const QDir &dir);
+
+    //! \brief Return the file in which the metadata of the plugin files is cached between sessions
+    static QString indexFileName();
+
+    //! \brief Add \a plugin to the lists of the interfaces that it implements, and return false if it implements none of them
+    bool addPlugin(QObject *plugin);
+
+    //! \brief Return a pointer to a list of pointers to the plugins that make waveforms from waveforms
+    QList<AbstractWaveform2WaveformMeasure*>* w2w();
+
+    //! \brief Return a pointer to a list of pointers to the plugins that make spectrograms from waveforms
+    QList<AbstractWaveform2SpectrogramMeasure*>* w2s();
+
+    //! \brief Return a pointer to a list of pointers to the plugins that make waveforms from spectrograms
+    QList<AbstractSpectrogram2WaveformMeasure*>* s2w();
+
+    //! \brief Return a pointer to a list of pointers to the plugins that make spectrograms from spectrograms
+    QList<AbstractSpectrogram2SpectrogramMeasure*>* s2s();
+
+signals:
+    //! \brief Emitted when a plugin has made the report \a text, with the title \a title
+    void reportCreated(QString title, QString text);
+
+    //! \brief Emitted when a plugin has finished \a done of the \a total steps of a calculation
+    void progressChanged(int done, int total);
+
+private:
+    //! \brief Return the metadata of the plugin file \a fileName (as returned by QPluginLoader::metaData()), from \a index if the file has not changed since it was recorded there. \a updated receives the entry for the file.
+    static QJsonObject metaData(const QString &fileName, const QJsonObject &index, QJsonObject *updated);
+
+    //! \brief Add a proxy for the library \a fileName, whose metadata is \a metaData, and return false if it implements none of the interfaces
+    bool addProxy(const QString &fileName, const QJsonObject &metaData);
+
+    QList<AbstractWaveform2WaveformMeasure*> mW2wPlugins;
+    QList<AbstractWaveform2SpectrogramMeasure*> mW2sPlugins;
+    QList<AbstractSpectrogram2WaveformMeasure*> mS2wPlugins;
+    QList<AbstractSpectrogram2SpectrogramMeasure*> mS2sPlugins;
+};
+
+#endif // PLUGINHOST_H
@@ -0,0 +1,94 @@
+#include "pluginlibrary.h"
+
+#include <QPluginLoader>
+#include <QJsonArray>
+#include <QtDebug>
+
+PluginLibrary::PluginLibrary(const QString &fileName, const QString &iid, const QJsonObject &metaData, QObject *parent) :
+    QObject(parent),
+    mFileName(fileName),
+    mIid(iid),
+    mInstance(0),
+    mAttempted(false)
+{
+    mName = metaData.value("name").toString();
+    mScriptName = metaData.value("scriptName").toString();
+
+    QJsonArray measures = metaData.value("measures").toArray();
+    for(int i=0; i<measures.count(); i++)
+        maNames << measures.at(i).toString();
+
+    QJsonArray parameters = metaData.value("parameters").toArray();
+    for(int i=0; i<parameters.count(); i++)
+    {
+        QJsonObject parameter = parameters.at(i).toObject();
+        maParameterLabels << parameter.value("label").toString();
+        maParameterValues << parameter.value("value").toVariant();
+    }
+}
+
+bool PluginLibrary::isComplete(const QJsonObject &metaData)
+{
+    return metaData.value("name").isString() && metaData.value("scriptName").isString() && metaData.value("measures").isArray();
+}
+
+QString PluginLibrary::fileName() const
+{
+    return mFileName;
+}
+
+QString PluginLibrary::iid() const
+{
+    return mIid;
+}
+
+QString PluginLibrary::name() const
+{
+    return mName;
+}
+
+QString PluginLibrary::scriptName() const
+{
+    return mScriptName;
+}
+
+QStringList PluginLibrary::names() const
+{
+    return maNames;
+}
+
+QStringList PluginLibrary::parameterLabels() const
+{
+    return maParameterLabels;
+}
+
+QList<QVariant> PluginLibrary::parameterValues() const
+{
+    return maParameterValues;
+}
+
+bool PluginLibrary::isLoaded() const
+{
+    QMutexLocker locker(&mMutex);
+    return mInstance != 0;
+}
+
+QObject *PluginLibrary::instance()
+{
+    QMutexLocker locker(&mMutex);
+    if( mAttempted ) { return mInstance; }
+    mAttempted = true;
+
+    QPluginLoader loader(mFileName);
+    mInstance = loader.instance();
+    if( mInstance == 0 )
+    {
+        qDebug() << "PluginLibrary: could not load" << mFileName << ":" << loader.errorString();
+        return 0;
+    }
+
+    // a measure may first be run by a worker thread; the plugin object belongs with the host
+    if( mInstance->thread() != thread() )
+        mInstance->moveToThread(thread());
+    return mInstance;
+}
@@ -0,0 +1,78 @@
+/*!
+  \class PluginLibrary
+  \ingroup Plugin
+  \brief A plugin file whose metadata is known, but which is only loaded when it is first needed
+
+  Each plugin declares its name, script name, measures and settings in a JSON file that is compiled into the library with Q_PLUGIN_METADATA, e.g.:
+  \code
+  {
+      "name": "RMS Library",
+      "scriptName": "rmsLibrary",
+      "measures": [ "RMS" ],
+      "parameters": [ { "label": "Window length (ms)", "value": 7.5 } ]
+  }
+  \endcode
+  That is enough to build the menus and dialogs of the application, so the library itself is not loaded (and its plugin object not created) until instance() is called, which PluginProxy does when a measure is first run.
+*/
+
+#ifndef PLUGINLIBRARY_H
+#define PLUGINLIBRARY_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVariant>
+#include <QJsonObject>
+#include <QMutex>
+
+class PluginLibrary : public QObject
+{
+    Q_OBJECT
+public:
+    //! \brief A library in the file \a fileName, which implements the interface \a iid and has the metadata \a metaData (the "MetaData" object of QPluginLoader::metaData())
+    PluginLibrary(const QString &fileName, const QString &iid, const QJsonObject &metaData, QObject *parent = 0);
+
+    //! \brief Return true if \a metaData, the "MetaData" object of a plugin, has everything that a PluginLibrary needs
+    static bool isComplete(const QJsonObject &metaData);
+
+    //! \brief Return the name of the library's file
+    QString fileName() const;
+
+    //! \brief Return the interface that the library implements
+    QString iid() const;
+
+    //! \brief Return the name of the plugin library
+    QString name() const;
+
+    //! \brief Return the name the plugin should have for use in scripting
+    QString scriptName() const;
+
+    //! \brief Return the list of names of the measures defined by the plugin
+    QStringList names() const;
+
+    //! \brief Return the labels of the plugin's settings
+    QStringList parameterLabels() const;
+
+    //! \brief Return the default values of the plugin's settings, in the order of parameterLabels()
+    QList<QVariant> parameterValues() const;
+
+    //! \brief Return true if the library has been loaded
+    bool isLoaded() const;
+
+    //! \brief Return the plugin object, loading the library if it has not been loaded yet, or 0 if it cannot be loaded. This may be called from any thread.
+    QObject* instance();
+
+private:
+    QString mFileName;
+    QString mIid;
+    QString mName;
+    QString mScriptName;
+    QStringList maNames;
+    QStringList maParameterLabels;
+    QList<QVariant> maParameterValues;
+
+    mutable QMutex mMutex;
+    QObject *mInstance;
+    bool mAttempted;
+};
+
+#endif // PLUGINLIBRARY_H
@@ -0,0 +1,328 @@
+#include "pluginproxy.h"
+
+#include "pluginlibrary.h"
+
+#include <QtDebug>
+
+PluginProxy::PluginProxy(PluginLibrary *library) :
+    mLibrary(library),
+    mInstance(0),
+    mMeasurement(0),
+    mAttached(false)
+{
+    maParameterLabels = library->parameterLabels();
+    maParameterValues = library->parameterValues();
+}
+
+PluginLibrary *PluginProxy::library() const
+{
+    return mLibrary;
+}
+
+QObject *PluginProxy::instance()
+{
+    QMutexLocker locker(&mMutex);
+    if( mAttached ) { return mInstance; }
+    mAttached = true;
+
+    QObject *instance = mLibrary->instance();
+    if( instance == 0 ) { return 0; }
+
+    mMeasurement = attach(instance);
+    if( mMeasurement == 0 )
+    {
+        qDebug() << "PluginProxy:" << mLibrary->fileName() << "does not implement" << mLibrary->iid();
+        return 0;
+    }
+
+    for(int i=0; i<maParameterLabels.count(); i++)
+        mMeasurement->setParameter(maParameterLabels.at(i), maParameterValues.at(i));
+
+    mInstance = instance;
+    return mInstance;
+}
+
+void PluginProxy::forwardSignals(QObject *from, QObject *to, const char *created)
+{
+    // by signature, since the plugin's library has its own copy of the meta-object of the interface; directly, since whoever runs a measure may be collecting its output in the same thread
+    QObject::connect(from, created, to, created, Qt::DirectConnection);
+    QObject::connect(from, SIGNAL(reportCreated(QString,QString)), to, SIGNAL(reportCreated(QString,QString)), Qt::DirectConnection);
+    QObject::connect(from, SIGNAL(progressChanged(int,int)), to, SIGNAL(progressChanged(int,int)), Qt::DirectConnection);
+}
+
+QStringList PluginProxy::proxyParameterLabels() const
+{
+    QMutexLocker locker(&mMutex);
+    if( mMeasurement != 0 ) { return mMeasurement->parameterLabels(); }
+    return maParameterLabels;
+}
+
+QVariant PluginProxy::proxyParameter(QString label) const
+{
+    QMutexLocker locker(&mMutex);
+    if( mMeasurement != 0 ) { return mMeasurement->parameter(label); }
+    int index = maParameterLabels.indexOf(label);
+    if( index == -1 ) { return QVariant(); }
+    return maParameterValues.at(index);
+}
+
+void PluginProxy::proxySetParameter(QString label, QVariant value)
+{
+    QMutexLocker locker(&mMutex);
+    if( mMeasurement != 0 ) { mMeasurement->setParameter(label, value); return; }
+    int index = maParameterLabels.indexOf(label);
+    if( index != -1 )
+        maParameterValues[index] = value;
+}
+
+Waveform2WaveformProxy::Waveform2WaveformProxy(PluginLibrary *library, QObject *parent) :
+    PluginProxy(library),
+    mPlugin(0)
+{
+    setParent(parent);
+}
+
+AbstractWaveform2WaveformMeasure* Waveform2WaveformProxy::copy() const
+{
+    if( const_cast<Waveform2WaveformProxy*>(this)->instance() == 0 ) { return 0; }
+    return mPlugin->copy();
+}
+
+QString Waveform2WaveformProxy::name() const
+{
+    return library()->name();
+}
+
+QString Waveform2WaveformProxy::scriptName() const
+{
+    return library()->scriptName();
+}
+
+QStringList Waveform2WaveformProxy::names() const
+{
+    return library()->names();
+}
+
+void Waveform2WaveformProxy::calculate(int i, WaveformData *data)
+{
+    if( instance() == 0 ) { return; }
+    mPlugin->calculate(i, data);
+}
+
+void Waveform2WaveformProxy::calculate(QString name, WaveformData *data)
+{
+    if( instance() == 0 ) { return; }
+    mPlugin->calculate(name, data);
+}
+
+QStringList Waveform2WaveformProxy::parameterLabels() const
+{
+    return proxyParameterLabels();
+}
+
+QVariant Waveform2WaveformProxy::parameter(QString label) const
+{
+    return proxyParameter(label);
+}
+
+void Waveform2WaveformProxy::setParameter(QString label, QVariant value)
+{
+    proxySetParameter(label, value);
+}
+
+AbstractMeasurement *Waveform2WaveformProxy::attach(QObject *instance)
+{
+    mPlugin = qobject_cast<AbstractWaveform2WaveformMeasure*>(instance);
+    if( mPlugin == 0 ) { return 0; }
+    forwardSignals(instance, this, SIGNAL(waveformCreated(WaveformData*)));
+    return mPlugin;
+}
+
+Waveform2SpectrogramProxy::Waveform2SpectrogramProxy(PluginLibrary *library, QObject *parent) :
+    PluginProxy(library),
+    mPlugin(0)
+{
+    setParent(parent);
+}
+
+AbstractWaveform2SpectrogramMeasure* Waveform2SpectrogramProxy::copy() const
+{
+    if( const_cast<Waveform2SpectrogramProxy*>(this)->instance() == 0 ) { return 0; }
+    return mPlugin->copy();
+}
+
+QString Waveform2SpectrogramProxy::name() const
+{
+    return library()->name();
+}
+
+QString Waveform2SpectrogramProxy::scriptName() const
+{
+    return library()->scriptName();
+}
+
+QStringList Waveform2SpectrogramProxy::names() const
+{
+    return library()->names();
+}
+
+void Waveform2SpectrogramProxy::calculate(int i, WaveformData *data)
+{
+    if( instance() == 0 ) { return; }
+    mPlugin->calculate(i, data);
+}
+
+void Waveform2SpectrogramProxy::calculate(QString name, WaveformData *data)
+{
+    if( instance() == 0 ) { return; }
+    mPlugin->calculate(name, data);
+}
+
+QStringList Waveform2SpectrogramProxy::parameterLabels() const
+{
+    return proxyParameterLabels();
+}
+
+QVariant Waveform2SpectrogramProxy::parameter(QString label) const
+{
+    return proxyParameter(label);
+}
+
+void Waveform2SpectrogramProxy::setParameter(QString label, QVariant value)
+{
+    proxySetParameter(label, value);
+}
+
+AbstractMeasurement *Waveform2SpectrogramProxy::attach(QObject *instance)
+{
+    mPlugin = qobject_cast<AbstractWaveform2SpectrogramMeasure*>(instance);
+    if( mPlugin == 0 ) { return 0; }
+    forwardSignals(instance, this, SIGNAL(spectrogramCreated(SpectrogramData*)));
+    return mPlugin;
+}
+
+Spectrogram2WaveformProxy::Spectrogram2WaveformProxy(PluginLibrary *library, QObject *parent) :
+    PluginProxy(library),
+    mPlugin(0)
+{
+    setParent(parent);
+}
+
+AbstractSpectrogram2WaveformMeasure* Spectrogram2WaveformProxy::copy() const
+{
+    if( const_cast<Spectrogram2WaveformProxy*>(this)->instance() == 0 ) { return 0; }
+    return mPlugin->copy();
+}
+
+QString Spectrogram2WaveformProxy::name() const
+{
+    return library()->name();
+}
+
+QString Spectrogram2WaveformProxy::scriptName() const
+{
+    return library()->scriptName();
+}
+
+QStringList Spectrogram2WaveformProxy::names() const
+{
+    return library()->names();
+}
+
+void Spectrogram2WaveformProxy::calculate(int i, SpectrogramData *data)
+{
+    if( instance() == 0 ) { return; }
+    mPlugin->calculate(i, data);
+}
+
+void Spectrogram2WaveformProxy::calculate(QString name, SpectrogramData *data)
+{
+    if( instance() == 0 ) { return; }
+    mPlugin->calculate(name, data);
+}
+
+QStringList Spectrogram2WaveformProxy::parameterLabels() const
+{
+    return proxyParameterLabels();
+}
+
+QVariant Spectrogram2WaveformProxy::parameter(QString label) const
+{
+    return proxyParameter(label);
+}
+
+void Spectrogram2WaveformProxy::setParameter(QString label, QVariant value)
+{
+    proxySetParameter(label, value);
+}
+
+AbstractMeasurement *Spectrogram2WaveformProxy::attach(QObject *instance)
+{
+    mPlugin = qobject_cast<AbstractSpectrogram2WaveformMeasure*>(instance);
+    if( mPlugin == 0 ) { return 0; }
+    forwardSignals(instance, this, SIGNAL(waveformCreated(WaveformData*)));
+    return mPlugin;
+}
+
+Spectrogram2SpectrogramProxy::Spectrogram2SpectrogramProxy(PluginLibrary *library, QObject *parent) :
+    PluginProxy(library),
+    mPlugin(0)
+{
+    setParent(parent);
+}
+
+AbstractSpectrogram2SpectrogramMeasure* Spectrogram2SpectrogramProxy::copy() const
+{
+    if( const_cast<Spectrogram2SpectrogramProxy*>(this)->instance() == 0 ) { return 0; }
+    return mPlugin->copy();
+}
+
+QString Spectrogram2SpectrogramProxy::name() const
+{
+    return library()->name();
+}
+
+QString Spectrogram2SpectrogramProxy::scriptName() const
+{
+    return library()->scriptName();
+}
+
+QStringList Spectrogram2SpectrogramProxy::names() const
+{
+    return library()->names();
+}
+
+void Spectrogram2SpectrogramProxy::calculate(int i, SpectrogramData *data)
+{
+    if( instance() == 0 ) { return; }
+    mPlugin->calculate(i, data);
+}
+
+void Spectrogram2SpectrogramProxy::calculate(QString name, SpectrogramData *data)
+{
+    if( instance() == 0 ) { return; }
+    mPlugin->calculate(name, data);
+}
+
+QStringList Spectrogram2SpectrogramProxy::parameterLabels() const
+{
+    return proxyParameterLabels();
+}
+
+QVariant Spectrogram2SpectrogramProxy::parameter(QString label) const
+{
+    return proxyParameter(label);
+}
+
+void Spectrogram2SpectrogramProxy::setParameter(QString label, QVariant value)
+{
+    proxySetParameter(label, value);
+}
+
+AbstractMeasurement *Spectrogram2SpectrogramProxy::attach(QObject *instance)
+{
+    mPlugin = qobject_cast<AbstractSpectrogram2SpectrogramMeasure*>(instance);
+    if( mPlugin == 0 ) { return 0; }
+    forwardSignals(instance, this, SIGNAL(spectrogramCreated(SpectrogramData*)));
+    return mPlugin;
+}
@@ -0,0 +1,177 @@
+/*!
+  \class PluginProxy
+  \ingroup Plugin
+  \brief Stands in for a plugin whose library has not been loaded yet
+
+  PluginHost puts a proxy in its lists in place of each plugin that declares its metadata (see PluginLibrary). The names, measures and settings of the proxy come from the metadata, so the menus and settings dialogs can be shown without loading anything. The first time a measure is run (or the plugin is copied, or used as an AbstractBlockMeasure) the proxy loads the library, passes on the settings that have been made in the meantime, and forwards every later call to the plugin. The signals of the plugin are re-emitted by the proxy, in the thread in which the plugin emitted them.
+
+  There is one subclass for each of the plugin interfaces. A PluginProxy is not a QObject itself; use dynamic_cast to find out whether a plugin is a proxy.
+*/
+
+#ifndef PLUGINPROXY_H
+#define PLUGINPROXY_H
+
+#include <QMutex>
+
+#include "interfaces.h"
+
+class PluginLibrary;
+
+class PluginProxy
+{
+public:
+    PluginProxy(PluginLibrary *library);
+    virtual ~PluginProxy() {}
+
+    //! \brief Return the library of the plugin
+    PluginLibrary* library() const;
+
+    //! \brief Return the plugin object, loading the library if it has not been loaded yet, or 0 if it cannot be loaded. This may be called from any thread.
+    QObject* instance();
+
+protected:
+    //! \brief Keep a pointer to the interface of \a instance, and forward its signals. Return the interface, or 0 if \a instance does not implement it.
+    virtual AbstractMeasurement* attach(QObject *instance) = 0;
+
+    //! \brief Re-emit the signal \a created of \a from, and the signals of AbstractMeasurement, from \a to
+    static void forwardSignals(QObject *from, QObject *to, const char *created);
+
+    //! \brief Return the labels of the settings, from the plugin if it has been loaded and otherwise from the metadata
+    QStringList proxyParameterLabels() const;
+
+    //! \brief Return the value of the setting \a label
+    QVariant proxyParameter(QString label) const;
+
+    //! \brief Change the setting \a label to \a value; if the plugin has not been loaded, the value is passed on when it is
+    void proxySetParameter(QString label, QVariant value);
+
+private:
+    PluginLibrary *mLibrary;
+
+    mutable QMutex mMutex;
+    QObject *mInstance;
+    AbstractMeasurement *mMeasurement;
+    bool mAttached;
+
+    //! \brief The settings made before the plugin was loaded
+    QStringList maParameterLabels;
+    QList<QVariant> maParameterValues;
+};
+
+/*! \class Waveform2WaveformProxy
+    \ingroup Plugin
+    \brief A PluginProxy for an AbstractWaveform2WaveformMeasure
+  */
+class Waveform2WaveformProxy : public AbstractWaveform2WaveformMeasure, public PluginProxy
+{
+    Q_OBJECT
+    Q_INTERFACES(AbstractWaveform2WaveformMeasure)
+public:
+    Waveform2WaveformProxy(PluginLibrary *library, QObject *parent = 0);
+    AbstractWaveform2WaveformMeasure* copy() const;
+
+public slots:
+    QString name() const;
+    QString scriptName() const;
+    QStringList names() const;
+    void calculate(int i, WaveformData *data);
+    void calculate(QString name, WaveformData *data);
+    QStringList parameterLabels() const;
+    QVariant parameter(QString label) const;
+    void setParameter(QString label, QVariant value);
+
+protected:
+    AbstractMeasurement* attach(QObject *instance);
+
+private:
+    AbstractWaveform2WaveformMeasure *mPlugin;
+};
+
+/*! \class Waveform2SpectrogramProxy
+    \ingroup Plugin
+    \brief A PluginProxy for an AbstractWaveform2SpectrogramMeasure
+  */
+class Waveform2SpectrogramProxy : public AbstractWaveform2SpectrogramMeasure, public PluginProxy
+{
+    Q_OBJECT
+    Q_INTERFACES(AbstractWaveform2SpectrogramMeasure)
+public:
+    Waveform2SpectrogramProxy(PluginLibrary *library, QObject *parent = 0);
+    AbstractWaveform2SpectrogramMeasure* copy() const;
+
+public slots:
+    QString name() const;
+    QString scriptName() const;
+    QStringList names() const;
+    void calculate(int i, WaveformData *data);
+    void calculate(QString name, WaveformData *data);
+    QStringList parameterLabels() const;
+    QVariant parameter(QString label) const;
+    void setParameter(QString label, QVariant value);
+
+protected:
+    AbstractMeasurement* attach(QObject *instance);
+
+private:
+    AbstractWaveform2SpectrogramMeasure *mPlugin;
+};
+
+/*! \class Spectrogram2WaveformProxy
+    \ingroup Plugin
+    \brief A PluginProxy for an AbstractSpectrogram2WaveformMeasure
+  */
+class Spectrogram2WaveformProxy : public AbstractSpectrogram2WaveformMeasure, public PluginProxy
+{
+    Q_OBJECT
+    Q_INTERFACES(AbstractSpectrogram2WaveformMeasure)
+public:
+    Spectrogram2WaveformProxy(PluginLibrary *library, QObject *parent = 0);
+    AbstractSpectrogram2WaveformMeasure* copy() const;
+
+public slots:
+    QString name() const;
+    QString scriptName() const;
+    QStringList names() const;
+    void calculate(int i, SpectrogramData *data);
+    void calculate(QString name, SpectrogramData *data);
+    QStringList parameterLabels() const;
+    QVariant parameter(QString label) const;
+    void setParameter(QString label, QVariant value);
+
+protected:
+    AbstractMeasurement* attach(QObject *instance);
+
+private:
+    AbstractSpectrogram2WaveformMeasure *mPlugin;
+};
+
+/*! \class Spectrogram2SpectrogramProxy
+    \ingroup Plugin
+    \brief A PluginProxy for an AbstractSpectrogram2SpectrogramMeasure
+  */
+class Spectrogram2SpectrogramProxy : public AbstractSpectrogram2SpectrogramMeasure, public PluginProxy
+{
+    Q_OBJECT
+    Q_INTERFACES(AbstractSpectrogram2SpectrogramMeasure)
+public:
+    Spectrogram2SpectrogramProxy(PluginLibrary *library, QObject *parent = 0);
+    AbstractSpectrogram2SpectrogramMeasure* copy() const;
+
+public slots:
+    QString name() const;
+    QString scriptName() const;
+    QStringList names() const;
+    void calculate(int i, SpectrogramData *data);
+    void calculate(QString name, SpectrogramData *data);
+    QStringList parameterLabels() const;
+    QVariant parameter(QString label) const;
+    void setParameter(QString label, QVariant value);
+
+protected:
+    AbstractMeasurement* attach(QObject *instance);
+
+private:
+    AbstractSpectrogram2SpectrogramMeasure *mPlugin;
+};
+
+#endif // PLUGINPROXY_H
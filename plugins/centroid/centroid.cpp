@@ -1,11 +1,23 @@
-#include <QtGui>
+#include <QtCore>
 #include <QtDebug>
 
 #include "centroid.h"
-#include <dataentrydialog.h>
 #include <spectrogramdata.h>
 #include <waveformdata.h>
 
+namespace {
+
+//! \brief The state of a run of the centroid measure on a stream of spectrogram frames
+class CentroidBlockState : public BlockState
+{
+public:
+    BlockSink *output;
+    QVector<double> frequencies;
+    int begin, end;
+};
+
+}
+
 CentroidPlugin::CentroidPlugin()
 {
 //    sound = data;
@@ -43,19 +55,6 @@ CentroidPlugin* CentroidPlugin::copy() const
     return new CentroidPlugin();
 }
 
-void CentroidPlugin::settings(int i)
-{
-    Q_UNUSED(i);
-    DataEntryDialog dew(&settingsLabels, &settingsValues, "", 0);
-    if( dew.exec() == QDialog::Accepted)
-    {
-	for(int i=0; i<settingsValues.count(); i++)
-	{
-        settingsValues.replace(i, dew.values()->at(i));
-	}
-    }
-}
-
 void CentroidPlugin::calculate(QString name, SpectrogramData *data)
 {
     int index = pluginnames.indexOf(name);
@@ -91,9 +90,72 @@ void CentroidPlugin::calculate(int index, SpectrogramData *data)
     emit waveformCreated(new WaveformData("Centroid F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString(),times,values,nframes,0));
 }
 
-void CentroidPlugin::setParameter(QString label, QVariant value)
+BlockState* CentroidPlugin::begin(int i, const BlockFormat &input, BlockSink *output)
 {
-    int index = settingsLabels.indexOf(label);
-    if(index != -1)
-	settingsValues[index] = value;
+    Q_UNUSED(i);
+    if( input.width < 2 || input.frequencies.size() != input.width ) { qDebug() << "CentroidPlugin: the input of a block run must be spectrogram frames."; return 0; }
+
+    CentroidBlockState *state = new CentroidBlockState;
+    state->output = output;
+    state->frequencies = input.frequencies;
+
+    // the same bins as SpectrogramData::frequencyBinBelow() and frequencyBinAbove() give calculate()
+    double from = settingsValues.at(0).toDouble();
+    double to = settingsValues.at(1).toDouble();
+    state->begin = input.width - 1;
+    state->end = input.width - 1;
+    for(int j=input.width-1; j>=0; j--)
+    {
+        if( input.frequencies.at(j) > from ) { state->begin = qMax(0, j-1); }
+        if( input.frequencies.at(j) > to ) { state->end = j; }
+    }
+
+    BlockFormat format;
+    format.frameRate = input.frameRate;
+    format.name = "Centroid F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString();
+    output->setFormat(format);
+
+    return state;
+}
+
+qint64 CentroidPlugin::lookahead(const BlockState *state) const
+{
+    Q_UNUSED(state);
+    return 0;
+}
+
+qint64 CentroidPlugin::latency(const BlockState *state) const
+{
+    Q_UNUSED(state);
+    return 0;
+}
+
+void CentroidPlugin::processBlock(BlockState *state, const FrameBlock &input)
+{
+    CentroidBlockState *s = static_cast<CentroidBlockState*>(state);
+
+    QVector<double> values(input.count);
+    for(qint64 i=0; i<input.count; i++)
+    {
+        const double *frame = input.values + i*input.width;
+        double tmp = 0, sum = 0.0f;
+        for(int j=s->begin; j<s->end; j++)
+        {
+            tmp += s->frequencies.at(j) * frame[j];
+            sum += frame[j];
+        }
+        values[i] = tmp / sum;
+    }
+
+    FrameBlock block;
+    block.times = input.times;
+    block.values = values.constData();
+    block.count = input.count;
+    s->output->write(block);
+}
+
+void CentroidPlugin::finish(BlockState *state)
+{
+    // every frame is measured as it arrives
+    Q_UNUSED(state);
 }
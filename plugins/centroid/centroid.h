@@ -11,11 +11,11 @@
 class WaveformData;
 class SpectrogramData;
 
-class CentroidPlugin : public AbstractSpectrogram2WaveformMeasure
+class CentroidPlugin : public AbstractSpectrogram2WaveformMeasure, public AbstractBlockMeasure
 {
     Q_OBJECT
-    Q_INTERFACES(AbstractSpectrogram2WaveformMeasure)
-    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0")
+    Q_INTERFACES(AbstractSpectrogram2WaveformMeasure AbstractBlockMeasure)
+    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0" FILE "centroid.json")
 
 public:
     CentroidPlugin();
@@ -26,16 +26,18 @@ public slots:
     QString name() const;
     QString scriptName() const;
     QStringList names() const;
-    void settings(int i);
-    void setParameter(QString label, QVariant value);
     void calculate(int index, SpectrogramData *data);
     void calculate(QString name, SpectrogramData *data);
 
+public:
+    BlockState* begin(int i, const BlockFormat &input, BlockSink *output);
+    qint64 lookahead(const BlockState *state) const;
+    qint64 latency(const BlockState *state) const;
+    void processBlock(BlockState *state, const FrameBlock &input);
+    void finish(BlockState *state);
+
 private:
     QStringList pluginnames;
-
-    QStringList settingsLabels;
-    QList<QVariant> settingsValues;
 };
 
 #endif
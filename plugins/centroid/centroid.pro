@@ -1,5 +1,6 @@
 TEMPLATE = lib
-CONFIG += plugin qwt
+CONFIG += plugin
+QT = core
 INCLUDEPATH += ../..
 TARGET = $$qtLibraryTarget(aw_centroid)
 DESTDIR = ..
@@ -10,11 +11,11 @@ HEADERS += \
     ../../interfaces.h \
     ../../waveformdata.h \
     ../../spectrogramdata.h \
-    ../../dataentrydialog.h \
     centroid.h
 
 SOURCES += \
     ../../waveformdata.cpp \
     ../../spectrogramdata.cpp \
-    ../../dataentrydialog.cpp \
     centroid.cpp
+
+OTHER_FILES += centroid.json
@@ -1,5 +1,6 @@
 TEMPLATE = lib
-CONFIG += plugin qwt
+CONFIG += plugin
+QT = core
 INCLUDEPATH += ../..
 TARGET = $$qtLibraryTarget(aw_cepstrum)
 DESTDIR = ..
@@ -11,11 +12,13 @@ HEADERS += \
     ../../interfaces.h \
     ../../waveformdata.h \
     ../../spectrogramdata.h \
-    ../../dataentrydialog.h \
-    cepstrum.h
+    cepstrum.h \
+    cepstrumengine.h
 
 SOURCES += \
     ../../waveformdata.cpp \
     ../../spectrogramdata.cpp \
-    ../../dataentrydialog.cpp \
-    cepstrum.cpp
+    cepstrum.cpp \
+    cepstrumengine.cpp
+
+OTHER_FILES += cepstrum.json
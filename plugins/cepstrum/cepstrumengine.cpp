@@ -0,0 +1,72 @@
+#include "cepstrumengine.h"
+
+#include <QtDebug>
+
+#include <math.h>
+#include <fftw3.h>
+
+#include <spectrogramdata.h>
+
+// number of frames transformed by one execution of the batched plan
+static const quint32 framesPerBlock = 1024;
+
+quint32 CepstrumEngine::coefficientCount(const SpectrogramData *data, quint32 nCoefficients)
+{
+    return qMin(nCoefficients, data->getNFrequencyBins());
+}
+
+double* CepstrumEngine::cepstrum(const SpectrogramData *data, quint32 nCoefficients, double lifter)
+{
+    quint32 nFrames = data->getNTimeSteps();
+    int nBins = data->getNFrequencyBins();
+    nCoefficients = coefficientCount(data, nCoefficients);
+
+    double *coeff = (double*)malloc(sizeof(double)*nFrames*nCoefficients);
+    if(coeff==NULL) { qDebug() << "Memory allocation error (cepstral coefficients)."; return 0; }
+    if(nFrames == 0 || nCoefficients == 0) { return coeff; }
+
+    // REDFT10 is unnormalized (Y_k = 2 sum x_j cos(pi (j+1/2) k / n)); the 1/2n scale and the lifter are folded into one weight per coefficient
+    double *weight = (double*)malloc(sizeof(double)*nCoefficients);
+    if(weight==NULL) { qDebug() << "Memory allocation error (cepstral weights)."; free(coeff); return 0; }
+    for(quint32 i=0; i<nCoefficients; i++)
+    {
+	*(weight+i) = 1.0 / (2.0*nBins);
+	if(lifter > 0)
+	    *(weight+i) *= 1.0 + (lifter/2.0) * sin( M_PI * i / lifter );
+    }
+
+    quint32 blockFrames = qMin(nFrames, framesPerBlock);
+    double *out = (double*)fftw_malloc(sizeof(double)*blockFrames*nBins);
+    if(out==NULL) { qDebug() << "Memory allocation error (cepstrum buffer)."; free(weight); free(coeff); return 0; }
+
+    // the spectrogram is row-major, so frame j starts at j*nBins; the plans are unaligned so that they can be executed on any block
+    fftw_r2r_kind kind = FFTW_REDFT10;
+    double *in = data->pdata();
+    fftw_plan blockPlan = fftw_plan_many_r2r(1, &nBins, blockFrames, in, NULL, 1, nBins, out, NULL, 1, nBins, &kind, FFTW_ESTIMATE | FFTW_UNALIGNED | FFTW_PRESERVE_INPUT);
+    fftw_plan remainderPlan = 0;
+    quint32 remainder = nFrames % blockFrames;
+    if(remainder != 0)
+	remainderPlan = fftw_plan_many_r2r(1, &nBins, remainder, in, NULL, 1, nBins, out, NULL, 1, nBins, &kind, FFTW_ESTIMATE | FFTW_UNALIGNED | FFTW_PRESERVE_INPUT);
+
+    for(quint32 start = 0; start < nFrames; start += blockFrames)
+    {
+	quint32 count = qMin(blockFrames, nFrames - start);
+	fftw_execute_r2r( count == blockFrames ? blockPlan : remainderPlan, in + (size_t)start*nBins, out );
+
+	for(quint32 j=0; j<count; j++)
+	{
+	    const double *row = out + (size_t)j*nBins;
+	    double *dest = coeff + (size_t)(start+j)*nCoefficients;
+	    for(quint32 i=0; i<nCoefficients; i++)
+		*(dest+i) = *(row+i) * *(weight+i);
+	}
+    }
+
+    fftw_destroy_plan(blockPlan);
+    if(remainderPlan != 0)
+	fftw_destroy_plan(remainderPlan);
+    fftw_free(out);
+    free(weight);
+
+    return coeff;
+}
@@ -0,0 +1,35 @@
+/*!
+  \class CepstrumEngine
+  \ingroup Plugin
+  \brief Computes cepstral coefficients for every frame of a spectrogram at once.
+
+  The rows of a SpectrogramData object are log spectra, which are real and symmetric, so their cepstrum is the DCT-II of each row. The engine makes one batched FFTW_REDFT10 plan with fftw_plan_many_r2r and runs it directly over the spectrogram's row-major storage, a block of frames at a time, instead of copying each row and running a complex FFT on it.
+
+  The engine is shared by the cepstrum and cepstrum spectrogram plugins.
+*/
+
+#ifndef CEPSTRUMENGINE_H
+#define CEPSTRUMENGINE_H
+
+#include <QtGlobal>
+
+class SpectrogramData;
+
+class CepstrumEngine
+{
+public:
+    //! \brief Compute the first \a nCoefficients cepstral coefficients of every frame of \a data
+    /*!
+      The coefficients are scaled so that the 0th coefficient is the mean of the frame.
+      \param data The spectrogram
+      \param nCoefficients The number of coefficients per frame. This is reduced to the number of frequency bins if it is larger.
+      \param lifter If greater than zero, coefficient n is multiplied by 1 + (lifter/2) sin(pi n / lifter), as is done for MFCCs
+      \return A malloc'd row-major array of getNTimeSteps() x \a nCoefficients values, which the caller must free, or 0 if memory could not be allocated
+      */
+    static double* cepstrum(const SpectrogramData *data, quint32 nCoefficients, double lifter);
+
+    //! \brief Return the number of coefficients cepstrum() will produce for \a data when \a nCoefficients are requested
+    static quint32 coefficientCount(const SpectrogramData *data, quint32 nCoefficients);
+};
+
+#endif // CEPSTRUMENGINE_H
@@ -14,7 +14,7 @@ class CepstrumSpectrogramPlugin : public AbstractSpectrogram2SpectrogramMeasure
 {
     Q_OBJECT
     Q_INTERFACES(AbstractSpectrogram2SpectrogramMeasure)
-    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2spectrogrammeasure/1.0")
+    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2spectrogrammeasure/1.0" FILE "cepstrum_spectrogram.json")
 
 public:
     CepstrumSpectrogramPlugin();
@@ -23,18 +23,13 @@ public:
 
     QString name() const;
     QStringList names() const;
-    void settings(int i);
     void calculate(int index, SpectrogramData *data);
 
     QString scriptName() const;
     void calculate(QString name, SpectrogramData *data);
-    void setParameter(QString label, QVariant value);
 
 private:
     QStringList pluginnames;
-
-    QStringList settingsLabels;
-    QList<QVariant> settingsValues;
 };
 
 #endif
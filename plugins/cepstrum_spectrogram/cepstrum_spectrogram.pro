@@ -1,6 +1,7 @@
 TEMPLATE = lib
-CONFIG += plugin qwt
-INCLUDEPATH += ../..
+CONFIG += plugin
+QT = core
+INCLUDEPATH += ../.. ../cepstrum
 TARGET = $$qtLibraryTarget(aw_cepstrum_spectrogram)
 DESTDIR = ..
 LIBS += -lm \
@@ -10,10 +11,12 @@ LIBS += -lm \
 HEADERS += \
     ../../interfaces.h \
     ../../spectrogramdata.h \
-    ../../dataentrydialog.h \
-    cepstrum_spectrogram.h
+    cepstrum_spectrogram.h \
+    ../cepstrum/cepstrumengine.h
 
 SOURCES += \
     ../../spectrogramdata.cpp \
-    ../../dataentrydialog.cpp \
-    cepstrum_spectrogram.cpp
+    cepstrum_spectrogram.cpp \
+    ../cepstrum/cepstrumengine.cpp
+
+OTHER_FILES += cepstrum_spectrogram.json
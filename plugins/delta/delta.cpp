@@ -0,0 +1,89 @@
+#include <QtCore>
+#include <QtDebug>
+
+#include "delta.h"
+#include "deltafilter.h"
+#include <spectrogramdata.h>
+
+DeltaPlugin::DeltaPlugin()
+{
+    pluginnames << "Delta";
+    pluginnames << "Delta-Delta";
+
+    settingsLabels << "N frames";
+    settingsValues << 2;
+}
+
+QString DeltaPlugin::scriptName() const
+{
+    return "deltaLibrary";
+}
+
+QString DeltaPlugin::name() const
+{
+    return "Delta Library";
+}
+
+QStringList DeltaPlugin::names() const
+{
+    return pluginnames;
+}
+
+DeltaPlugin* DeltaPlugin::copy() const
+{
+    // this needs to be better
+    return new DeltaPlugin();
+}
+
+void DeltaPlugin::calculate(QString name, SpectrogramData *data)
+{
+    int index = pluginnames.indexOf(name);
+    if(index != -1)
+	calculate(index, data);
+}
+
+double* DeltaPlugin::delta(const double *in, quint32 nFrames, quint32 nBins, int N) const
+{
+    double *out = (double*)malloc(sizeof(double)*nFrames*nBins);
+    if(out==NULL) { qDebug() << "Memory allocation error (delta)."; return 0; }
+
+    DeltaFilter filter(N);
+    DeltaFilter::forEachBlock(nFrames, [&](quint32 first, quint32 count) {
+	filter.apply(in, nFrames, nBins, 0, nBins-1, first, count, out + (size_t)first*nBins);
+    });
+    return out;
+}
+
+void DeltaPlugin::calculate(int index, SpectrogramData *data)
+{
+    if(index < 0 || index >= pluginnames.count()) { return; }
+
+    quint32 nFrames = data->getNTimeSteps();
+    quint32 nBins = data->getNFrequencyBins();
+    int N = settingsValues.at(0).toInt();
+    if(nFrames == 0 || nBins == 0 || N < 1) { return; }
+
+    double *spec = delta(data->pdata(), nFrames, nBins, N);
+    if(spec==0) { return; }
+
+    // delta-delta is the delta filter applied to the deltas
+    if(index == 1)
+    {
+	double *deltadelta = delta(spec, nFrames, nBins, N);
+	free(spec);
+	if(deltadelta==0) { return; }
+	spec = deltadelta;
+    }
+
+    double *times = (double*)malloc(sizeof(double)*nFrames);
+    for(quint32 i=0; i<nFrames; i++)
+	*(times+i) = data->getTimeFromIndex(i);
+
+    double *frequencies = (double*)malloc(sizeof(double)*nBins);
+    for(quint32 i=0; i<nBins; i++)
+	*(frequencies+i) = data->getFrequencyFromIndex(i);
+
+    QString suggested_label = pluginnames.at(index) + " " + data->name() + " N:" + settingsValues.at(0).toString();
+
+    emit spectrogramCreated(new SpectrogramData(suggested_label, spec, times, nFrames, frequencies, nBins, data->getWindowLength(), data->getTimeStep()));
+}
@@ -0,0 +1,38 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <QObject>
+
+#include <QStringList>
+#include <QVariant>
+
+#include "interfaces.h"
+
+class SpectrogramData;
+
+class DeltaPlugin : public AbstractSpectrogram2SpectrogramMeasure
+{
+    Q_OBJECT
+    Q_INTERFACES(AbstractSpectrogram2SpectrogramMeasure)
+    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2spectrogrammeasure/1.0" FILE "delta.json")
+
+public:
+    DeltaPlugin();
+    ~DeltaPlugin() {}
+    DeltaPlugin* copy() const;
+
+    QString name() const;
+    QStringList names() const;
+    void calculate(int index, SpectrogramData *data);
+
+    QString scriptName() const;
+    void calculate(QString name, SpectrogramData *data);
+
+private:
+    QStringList pluginnames;
+
+    //! \brief Return a malloc'd spectrogram-shaped array with the deltas of every frame of \a in
+    double* delta(const double *in, quint32 nFrames, quint32 nBins, int N) const;
+};
+
+#endif
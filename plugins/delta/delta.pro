@@ -0,0 +1,21 @@
+TEMPLATE = lib
+CONFIG += plugin
+QT = core
+INCLUDEPATH += ../.. ../spectralchange
+TARGET = $$qtLibraryTarget(aw_delta)
+DESTDIR = ..
+LIBS += -lm \
+    -L./ 
+
+HEADERS += \
+    ../../interfaces.h \
+    ../../spectrogramdata.h \
+    ../spectralchange/deltafilter.h \
+    delta.h
+
+SOURCES += \
+    ../../spectrogramdata.cpp \
+    ../spectralchange/deltafilter.cpp \
+    delta.cpp
+
+OTHER_FILES += delta.json
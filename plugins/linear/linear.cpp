@@ -1,23 +1,32 @@
-#include <QtGui>
+#include <QtCore>
 #include <QtDebug>
 
+
 #include "linear.h"
-#include <dataentrydialog.h>
-#include "gsl/gsl_fit.h"
+#include "spectraltilt.h"
 #include <waveformdata.h>
 #include <spectrogramdata.h>
 
+// number of frames processed by one task
+static const quint32 framesPerBlock = 256;
+
 LinearPlugin::LinearPlugin()
 {
 //    sound = data;
 
     pluginnames << "Slope";
     pluginnames << "Intercept";
+    pluginnames << "Residual";
+    pluginnames << "Slope, Intercept & Residual";
 
     settingsLabels << "From (Hz)";
     settingsValues << 1000;
     settingsLabels << "To (Hz)";
     settingsValues << 5000;
+    settingsLabels << "Robust (Huber) fit (0 or 1)";
+    settingsValues << 0;
+    settingsLabels << "Huber tuning constant";
+    settingsValues << 1.345;
 }
 
 QString LinearPlugin::name() const
@@ -41,19 +50,6 @@ LinearPlugin* LinearPlugin::copy() const
     return new LinearPlugin();
 }
 
-void LinearPlugin::settings(int i)
-{
-    Q_UNUSED(i);
-    DataEntryDialog dew(&settingsLabels, &settingsValues, "", 0);
-    if( dew.exec() == QDialog::Accepted)
-    {
-	for(int i=0; i<settingsValues.count(); i++)
-	{
-	    settingsValues.replace(i, dew.values()->at(i));
-	}
-    }
-}
-
 void LinearPlugin::calculate(QString name, SpectrogramData *data)
 {
     int index = pluginnames.indexOf(name);
@@ -63,50 +59,75 @@ void LinearPlugin::calculate(QString name, SpectrogramData *data)
 
 void LinearPlugin::calculate(int index, SpectrogramData *data)
 {
-    size_t nframes = data->getNTimeSteps();
-    double c0, c1, cov00, cov01, cov11, sumsq;
-    double *values = (double*)malloc(sizeof(double)*nframes);
-    double *times = (double*)malloc(sizeof(double)*nframes);
-
-    int startindex = data->frequencyBinBelow(settingsValues.at(0).toInt());
-    int length = data->frequencyBinBelow(settingsValues.at(1).toInt()) - data->frequencyBinBelow(settingsValues.at(0).toInt());
-    if(length<2)
+    if(index < 0 || index >= pluginnames.count()) { return; }
+
+    quint32 nframes = data->getNTimeSteps();
+    quint32 nbins = data->getNFrequencyBins();
+
+    quint32 startindex = data->frequencyBinBelow(settingsValues.at(0).toInt());
+    quint32 length = data->frequencyBinBelow(settingsValues.at(1).toInt()) - data->frequencyBinBelow(settingsValues.at(0).toInt());
+    if(length<2 || startindex+length > nbins)
     {
 	qDebug() << "length is less than 2 somehow";
 	return;
     }
 
-    qDebug() << data->frequencyBinBelow(settingsValues.at(0).toInt()) << data->frequencyBinBelow(settingsValues.at(1).toInt()) << startindex << length;
+    bool robust = settingsValues.at(2).toInt() != 0;
+    double k = settingsValues.at(3).toDouble();
 
-    switch(index)
-    {
-    case 0: // slope
-	for(quint32 i=0; i<nframes; i++)
-	{
-	    gsl_fit_linear(data->pfrequencies()+startindex, 1, data->pdata() + data->getNFrequencyBins() *i, 1, length, &c0, &c1, &cov00, &cov01, &cov11, &sumsq);
-	    *(times+i) = data->getTimeFromIndex(i);
-	    *(values+i) = c1;
-	}
-	emit waveformCreated( new WaveformData("Slope F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString(),times,values,nframes,0) );
-	break;
-    case 1: // intercept
-	for(quint32 i=0; i<nframes; i++)
+    double *slopes = (double*)malloc(sizeof(double)*nframes);
+    double *intercepts = (double*)malloc(sizeof(double)*nframes);
+    double *residuals = (double*)malloc(sizeof(double)*nframes);
+    if(slopes==NULL || intercepts==NULL || residuals==NULL) { qDebug() << "Memory allocation error (slopes, intercepts, residuals)."; free(slopes); free(intercepts); free(residuals); return; }
+
+    // the frequency axis is the same for every frame, so its statistics are computed once
+    SpectralTilt tilt(data->pfrequencies()+startindex, length);
+
+    QList<quint32> blocks;
+    for(quint32 first=0; first<nframes; first += framesPerBlock)
+	blocks << first;
+
+    parallelMap(blocks, [&](const quint32 &first) {
+	quint32 count = qMin(framesPerBlock, nframes-first);
+	double *scratch = robust ? (double*)malloc(sizeof(double)*2*length) : 0;
+	for(quint32 i=first; i<first+count; i++)
 	{
-	    gsl_fit_linear(data->pfrequencies()+startindex, 1, data->pdata() + data->getNFrequencyBins()*i, 1, length, &c0, &c1, &cov00, &cov01, &cov11, &sumsq);
-	    *(times+i) = data->getTimeFromIndex(i);
-	    *(values+i) = c0;
+	    const double *y = data->pdata() + (size_t)i*nbins + startindex;
+	    if(robust)
+		tilt.fitHuber(y, k, 20, scratch, slopes+i, intercepts+i, residuals+i);
+	    else
+		tilt.fit(y, slopes+i, intercepts+i, residuals+i);
 	}
-	emit waveformCreated( new WaveformData("Intercept F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString(),times,values,nframes,0) );
-	break;
-    default:
-	break;
+	free(scratch);
+    });
+
+    QString range = QString(robust ? "Huber " : "") + "F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString();
+
+    if(index == 0 || index == 3)
+    {
+	emit waveformCreated( new WaveformData("Slope "+range,frameTimes(data),slopes,nframes,0) );
+	slopes = 0;
     }
+    if(index == 1 || index == 3)
+    {
+	emit waveformCreated( new WaveformData("Intercept "+range,frameTimes(data),intercepts,nframes,0) );
+	intercepts = 0;
+    }
+    if(index == 2 || index == 3)
+    {
+	emit waveformCreated( new WaveformData("Residual "+range,frameTimes(data),residuals,nframes,0) );
+	residuals = 0;
+    }
+
+    free(slopes);
+    free(intercepts);
+    free(residuals);
 }
 
-void LinearPlugin::setParameter(QString label, QVariant value)
+double* LinearPlugin::frameTimes(const SpectrogramData *data)
 {
-    int index = settingsLabels.indexOf(label);
-    if(index != -1)
-	settingsValues[index] = value;
+    double *times = (double*)malloc(sizeof(double)*data->getNTimeSteps());
+    for(quint32 i=0; i<data->getNTimeSteps(); i++)
+	*(times+i) = data->getTimeFromIndex(i);
+    return times;
 }
-
@@ -15,7 +15,7 @@ class LinearPlugin : public AbstractSpectrogram2WaveformMeasure
 {
     Q_OBJECT
     Q_INTERFACES(AbstractSpectrogram2WaveformMeasure)
-    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0")
+    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0" FILE "linear.json")
 
 public:
     LinearPlugin();
@@ -25,17 +25,15 @@ public:
 public slots:
     QString name() const;
     QStringList names() const;
-    void settings(int i);
     void calculate(int index, SpectrogramData *data);
     void calculate(QString name, SpectrogramData *data);
-    void setParameter(QString label, QVariant value);
     QString scriptName() const;
 
 private:
     QStringList pluginnames;
 
-    QStringList settingsLabels;
-    QList<QVariant> settingsValues;
+    //! \brief Return a malloc'd array of the frame times of \a data
+    static double* frameTimes(const SpectrogramData *data);
 };
 
 #endif
@@ -1,22 +1,23 @@
 TEMPLATE = lib
-CONFIG += plugin qwt
+CONFIG += plugin
+QT = core
 INCLUDEPATH += ../..
 TARGET = $$qtLibraryTarget(aw_linear)
 DESTDIR = ..
 LIBS += -lm \
-    -L./ \
-    -lgsl \
-    -lgslcblas
+    -L./
 
 HEADERS += \
     ../../interfaces.h \
     ../../waveformdata.h \
     ../../spectrogramdata.h \
-    ../../dataentrydialog.h \
-    linear.h
+    linear.h \
+    spectraltilt.h
 
 SOURCES += \
     ../../waveformdata.cpp \
     ../../spectrogramdata.cpp \
-    ../../dataentrydialog.cpp \
-    linear.cpp
+    linear.cpp \
+    spectraltilt.cpp
+
+OTHER_FILES += linear.json
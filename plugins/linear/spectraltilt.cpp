@@ -0,0 +1,107 @@
+#include "spectraltilt.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+SpectralTilt::SpectralTilt(const double *x, quint32 length) : mLength(length), mX(x)
+{
+    mMeanX = 0;
+    for(quint32 j=0; j<mLength; j++)
+	mMeanX += *(x+j);
+    mMeanX /= mLength;
+
+    mCentered = (double*)malloc(sizeof(double)*mLength);
+    mSxx = 0;
+    for(quint32 j=0; j<mLength; j++)
+    {
+	*(mCentered+j) = *(x+j) - mMeanX;
+	mSxx += *(mCentered+j) * *(mCentered+j);
+    }
+}
+
+SpectralTilt::~SpectralTilt()
+{
+    free(mCentered);
+}
+
+quint32 SpectralTilt::length() const
+{
+    return mLength;
+}
+
+void SpectralTilt::fit(const double *y, double *slope, double *intercept, double *residual) const
+{
+    double sy = 0, syy = 0, sxy = 0;
+    for(quint32 j=0; j<mLength; j++)
+    {
+	sy += *(y+j);
+	syy += *(y+j) * *(y+j);
+	sxy += *(mCentered+j) * *(y+j);
+    }
+
+    double meanY = sy / mLength;
+    *slope = sxy / mSxx;
+    *intercept = meanY - *slope * mMeanX;
+
+    // residual sum of squares = Syy - slope * Sxy
+    double ss = (syy - sy*meanY) - *slope * sxy;
+    *residual = mLength > 2 && ss > 0 ? sqrt( ss / (mLength-2) ) : 0;
+}
+
+void SpectralTilt::fitHuber(const double *y, double k, int iterations, double *scratch, double *slope, double *intercept, double *residual) const
+{
+    double *r = scratch;
+    double *w = scratch + mLength;
+
+    fit(y, slope, intercept, residual);
+
+    for(int it=0; it<iterations; it++)
+    {
+	// robust scale from the median absolute residual
+	for(quint32 j=0; j<mLength; j++)
+	    *(r+j) = fabs( *(y+j) - (*intercept + *slope * *(mX+j)) );
+	for(quint32 j=0; j<mLength; j++)
+	    *(w+j) = *(r+j);
+	std::nth_element(w, w + mLength/2, w + mLength);
+	double scale = *(w + mLength/2) / 0.6745;
+	if(scale <= 0) { break; }
+
+	double cutoff = k * scale;
+	double sw = 0, swx = 0, swy = 0;
+	for(quint32 j=0; j<mLength; j++)
+	{
+	    *(w+j) = *(r+j) <= cutoff ? 1.0 : cutoff / *(r+j);
+	    sw += *(w+j);
+	    swx += *(w+j) * *(mX+j);
+	    swy += *(w+j) * *(y+j);
+	}
+	double mx = swx / sw;
+	double my = swy / sw;
+
+	double sxx = 0, sxy = 0;
+	for(quint32 j=0; j<mLength; j++)
+	{
+	    double dx = *(mX+j) - mx;
+	    sxx += *(w+j) * dx * dx;
+	    sxy += *(w+j) * dx * ( *(y+j) - my );
+	}
+	if(sxx <= 0) { break; }
+
+	double newSlope = sxy / sxx;
+	double newIntercept = my - newSlope * mx;
+	bool converged = fabs(newSlope - *slope) <= 1e-10 * (1 + fabs(*slope)) && fabs(newIntercept - *intercept) <= 1e-10 * (1 + fabs(*intercept));
+	*slope = newSlope;
+	*intercept = newIntercept;
+
+	double ss = 0;
+	for(quint32 j=0; j<mLength; j++)
+	{
+	    double e = *(y+j) - (*intercept + *slope * *(mX+j));
+	    ss += *(w+j) * e * e;
+	}
+	*residual = mLength > 2 ? sqrt( ss / (sw * (mLength-2) / mLength) ) : 0;
+
+	if(converged) { break; }
+    }
+}
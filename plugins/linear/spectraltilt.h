@@ -0,0 +1,48 @@
+/*!
+  \class SpectralTilt
+  \ingroup Plugin
+  \brief Fits straight lines to the frames of a spectrogram.
+
+  Every frame of a spectrogram has the same frequency axis, so everything that depends only on x (the mean frequency, the centered frequencies and their sum of squares) is computed once, when the object is constructed. An ordinary least-squares fit of a frame is then one pass over its values.
+
+  A robust fit is also available. It uses Huber's M-estimator, computed by iteratively reweighted least squares.
+*/
+
+#ifndef SPECTRALTILT_H
+#define SPECTRALTILT_H
+
+#include <QtGlobal>
+
+class SpectralTilt
+{
+public:
+    //! \brief Precompute the statistics of the \a length frequencies \a x
+    SpectralTilt(const double *x, quint32 length);
+    ~SpectralTilt();
+
+    //! \brief Return the number of points in each fit
+    quint32 length() const;
+
+    //! \brief Fit a least-squares line to the \a length values \a y
+    /*!
+      \param residual Receives the standard error of the fit, sqrt(SS / (n-2))
+      */
+    void fit(const double *y, double *slope, double *intercept, double *residual) const;
+
+    //! \brief Fit a line to the \a length values \a y with Huber's M-estimator
+    /*!
+      Points whose residual is more than \a k robust standard deviations (the median absolute residual / 0.6745) from the line are down-weighted. The least-squares fit is the starting point.
+      \param scratch Space for 2 * length() values
+      \param residual Receives the weighted standard error of the fit
+      */
+    void fitHuber(const double *y, double k, int iterations, double *scratch, double *slope, double *intercept, double *residual) const;
+
+private:
+    quint32 mLength;
+    const double *mX;
+    double *mCentered;
+    double mMeanX;
+    double mSxx;
+};
+
+#endif // SPECTRALTILT_H
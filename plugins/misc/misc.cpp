@@ -1,14 +1,15 @@
-#include <QtGui>
+#include <QtCore>
 #include <QtDebug>
 
+#include <algorithm>
+
 #include "misc.h"
-#include <dataentrydialog.h>
-#include "gsl/gsl_fit.h"
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_statistics_double.h>
 #include <spectrogramdata.h>
 #include <waveformdata.h>
 
+// number of frames processed by one task
+static const quint32 framesPerBlock = 256;
+
 
 MiscPlugin::MiscPlugin()
 {
@@ -16,11 +17,15 @@ MiscPlugin::MiscPlugin()
 
     pluginnames << "Peak Value";
     pluginnames << "Median Energy";
+    pluginnames << "Energy Percentiles";
+    pluginnames << "Total Energy";
 
     settingsLabels << "From (Hz)";
     settingsValues << 1000;
     settingsLabels << "To (Hz)";
     settingsValues << 5000;
+    settingsLabels << "Percentiles (%)";
+    settingsValues << "25 50 75 95";
 }
 
 QString MiscPlugin::name() const
@@ -44,92 +49,153 @@ MiscPlugin* MiscPlugin::copy() const
     return new MiscPlugin();
 }
 
-void MiscPlugin::settings(int i)
+void MiscPlugin::calculate(QString name, SpectrogramData *data)
 {
-    Q_UNUSED(i);
-    DataEntryDialog dew(&settingsLabels, &settingsValues, "", 0);
-    if( dew.exec() == QDialog::Accepted)
+    int index = pluginnames.indexOf(name);
+    if(index != -1)
+	calculate(index, data);
+}
+
+QList<double> MiscPlugin::percentiles() const
+{
+    QList<double> ret;
+    QStringList items = settingsValues.at(2).toString().split(QRegExp("[\\s,;]+"), QString::SkipEmptyParts);
+    for(int i=0; i<items.count(); i++)
     {
-	for(int i=0; i<settingsValues.count(); i++)
-	{
-	    settingsValues.replace(i, dew.values()->at(i));
-	}
+	bool ok;
+	double p = items.at(i).toDouble(&ok);
+	if(ok && p > 0 && p < 100)
+	    ret << p;
+	else
+	    qDebug() << "MiscPlugin: ignoring percentile" << items.at(i);
     }
+    return ret;
 }
 
-void MiscPlugin::calculate(QString name, SpectrogramData *data)
+void MiscPlugin::analyzeFrame(const double *frame, quint32 length, const double *fractions, int nFractions, double *cumulative, quint32 *peak, double *total, quint32 *percentileBins)
 {
-    int index = pluginnames.indexOf(name);
-    if(index != -1)
-	calculate(index, data);
+    // one pass: running sum and peak
+    double sum = 0;
+    double max = *frame;
+    quint32 maxIndex = 0;
+    for(quint32 j=0; j<length; j++)
+    {
+	sum += *(frame+j);
+	*(cumulative+j) = sum;
+	if( *(frame+j) > max )
+	{
+	    max = *(frame+j);
+	    maxIndex = j;
+	}
+    }
+    *peak = maxIndex;
+    *total = sum;
+
+    // the cumulative sum is nondecreasing (the values are nonnegative), so each percentile is a binary search
+    for(int p=0; p<nFractions; p++)
+    {
+	double threshold = sum * *(fractions+p);
+	const double *above = std::upper_bound(cumulative, cumulative+length, threshold);
+	*(percentileBins+p) = qMin((quint32)(above-cumulative), length-1);
+    }
 }
 
 void MiscPlugin::calculate(int index, SpectrogramData *data)
 {
-    size_t nframes = data->getNTimeSteps();
-    double *values = (double*)malloc(sizeof(double)*nframes);
-    double *times = (double*)malloc(sizeof(double)*nframes);
+    if(index < 0 || index >= pluginnames.count()) { return; }
 
-    QList<WaveformData*> ret;
+    quint32 nframes = data->getNTimeSteps();
+    quint32 nbins = data->getNFrequencyBins();
 
     quint32 startindex = data->frequencyBinBelow(settingsValues.at(0).toInt());
     quint32 length = data->frequencyBinBelow(settingsValues.at(1).toInt()) - data->frequencyBinBelow(settingsValues.at(0).toInt());
-    if(length<2)
+    if(length<2 || startindex+length > nbins)
     {
 	qDebug() << "length is less than 2 somehow";
 	return;
     }
 
-    switch(index)
-    {
-    case 0: // peak
-	for(quint32 i=0; i<nframes; i++)
+    // the median is the 50th percentile
+    QList<double> requested;
+    if(index == 1)
+	requested << 50;
+    else if(index == 2)
+	requested = percentiles();
+    if(index == 2 && requested.isEmpty()) { qDebug() << "MiscPlugin: no valid percentiles were given."; return; }
+
+    int nFractions = requested.count();
+    QVector<double> fractions(nFractions);
+    for(int p=0; p<nFractions; p++)
+	fractions[p] = requested.at(p) / 100.0;
+
+    double *peaks = (double*)malloc(sizeof(double)*nframes);
+    double *totals = (double*)malloc(sizeof(double)*nframes);
+    QList<double*> percentileValues;
+    for(int p=0; p<nFractions; p++)
+	percentileValues << (double*)malloc(sizeof(double)*nframes);
+
+    // frames are independent, so blocks of frames are analyzed in parallel; each block has its own scratch space
+    QList<quint32> blocks;
+    for(quint32 first=0; first<nframes; first += framesPerBlock)
+	blocks << first;
+
+    parallelMap(blocks, [&](const quint32 &first) {
+	quint32 count = qMin(framesPerBlock, nframes-first);
+	double *cumulative = (double*)malloc(sizeof(double)*length);
+	quint32 *bins = (quint32*)malloc(sizeof(quint32)*qMax(nFractions,1));
+	for(quint32 i=first; i<first+count; i++)
 	{
-	    *(times+i) = data->getTimeFromIndex(i);
-	    *(values+i) = data->getFrequencyFromIndex( gsl_stats_max_index( data->pdata() +  i*data->getNFrequencyBins()+startindex, 1, length ) );
-	}
-	ret << new WaveformData("Peak F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString(),times,values,nframes,0);
-	break;
-    case 1: // median
-	for(quint32 i=0; i<nframes; i++)
-	{
-	    gsl_vector *cs = gsl_vector_alloc(length);
-
-	    gsl_vector_set(cs, 0, data->dataAt(i,startindex));
-
-	    for(quint32 j=startindex+1; j<startindex+length; j++)
-		gsl_vector_set(cs, j-startindex, data->dataAt(i,j) + gsl_vector_get(cs, j-startindex-1) );
-	    double middle = gsl_vector_get(cs, length-1)/2;
-
-	    double median = 0;
-	    for(quint32 j=0; j<length; j++)
+	    quint32 peak;
+	    analyzeFrame(data->pdata() + (size_t)i*nbins + startindex, length, fractions.constData(), nFractions, cumulative, &peak, totals+i, bins);
+	    *(peaks+i) = data->getFrequencyFromIndex(startindex+peak);
+	    for(int p=0; p<nFractions; p++)
 	    {
-		if( gsl_vector_get(cs, j) > middle )
-		{
-		    if(j==0)
-			median = data->getFrequencyFromIndex(startindex+j);
-		    else
-			median = (data->getFrequencyFromIndex(startindex+j) + data->getFrequencyFromIndex(startindex+j-1))/2;
-		    break;
-		}
+		// the percentile lies between the bin where the cumulative energy passes it and the bin before
+		quint32 j = *(bins+p);
+		if(j==0)
+		    *(percentileValues.at(p)+i) = data->getFrequencyFromIndex(startindex+j);
+		else
+		    *(percentileValues.at(p)+i) = (data->getFrequencyFromIndex(startindex+j) + data->getFrequencyFromIndex(startindex+j-1))/2;
 	    }
+	}
+	free(bins);
+	free(cumulative);
+    });
 
-	    *(times+i) = data->getTimeFromIndex(i);
-	    *(values+i) = median;
+    QString range = "F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString();
 
-	    gsl_vector_free(cs);
-	}
-	emit waveformCreated( new WaveformData("Median F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString(),times,values,nframes,0) );
+    switch(index)
+    {
+    case 0: // peak
+	emit waveformCreated( new WaveformData("Peak "+range,frameTimes(data),peaks,nframes,0) );
+	peaks = 0;
+	break;
+    case 1: // median
+	emit waveformCreated( new WaveformData("Median "+range,frameTimes(data),percentileValues.takeFirst(),nframes,0) );
+	break;
+    case 2: // percentiles
+	for(int p=0; p<nFractions; p++)
+	    emit waveformCreated( new WaveformData("Percentile "+QString::number(requested.at(p))+"% "+range,frameTimes(data),percentileValues.at(p),nframes,0) );
+	percentileValues.clear();
+	break;
+    case 3: // total
+	emit waveformCreated( new WaveformData("Total Energy "+range,frameTimes(data),totals,nframes,0) );
+	totals = 0;
 	break;
     default:
 	break;
     }
+
+    free(peaks);
+    free(totals);
+    for(int p=0; p<percentileValues.count(); p++)
+	free(percentileValues.at(p));
 }
 
-void MiscPlugin::setParameter(QString label, QVariant value)
+double* MiscPlugin::frameTimes(const SpectrogramData *data)
 {
-    int index = settingsLabels.indexOf(label);
-    if(index != -1)
-	settingsValues[index] = value;
+    double *times = (double*)malloc(sizeof(double)*data->getNTimeSteps());
+    for(quint32 i=0; i<data->getNTimeSteps(); i++)
+	*(times+i) = data->getTimeFromIndex(i);
+    return times;
 }
-
@@ -15,7 +15,7 @@ class MiscPlugin : public AbstractSpectrogram2WaveformMeasure
 {
     Q_OBJECT
     Q_INTERFACES(AbstractSpectrogram2WaveformMeasure)
-    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0")
+    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0" FILE "misc.json")
 
 public:
     MiscPlugin();
@@ -25,18 +25,29 @@ public:
 public slots:
     QString name() const;
     QStringList names() const;
-    void settings(int i);
     void calculate(int index, SpectrogramData *data);
 
     void calculate(QString name, SpectrogramData *data);
-    void setParameter(QString label, QVariant value);
     QString scriptName() const;
 
 private:
     QStringList pluginnames;
 
-    QStringList settingsLabels;
-    QList<QVariant> settingsValues;
+    //! \brief Return the percentiles listed in the "Percentiles (%)" setting
+    QList<double> percentiles() const;
+
+    //! \brief Analyze the \a length values of \a frame in one pass, without allocating
+    /*!
+      \param fractions The \a nFractions fractions of the total energy (0 to 1) to find
+      \param cumulative Scratch space for \a length values; receives the cumulative energy
+      \param peak Receives the index of the largest value
+      \param total Receives the total energy
+      \param percentileBins Receives, for each fraction, the index of the first value at which the cumulative energy exceeds that fraction of the total
+      */
+    static void analyzeFrame(const double *frame, quint32 length, const double *fractions, int nFractions, double *cumulative, quint32 *peak, double *total, quint32 *percentileBins);
+
+    //! \brief Return a malloc'd array of the frame times of \a data
+    static double* frameTimes(const SpectrogramData *data);
 };
 
 #endif
@@ -1,22 +1,21 @@
 TEMPLATE = lib
-CONFIG += plugin qwt
+CONFIG += plugin
+QT = core
 INCLUDEPATH += ../..
 TARGET = $$qtLibraryTarget(aw_misc)
 DESTDIR = ..
 LIBS += -lm \
-    -L./ \
-    -lgsl \
-    -lgslcblas
+    -L./
 
 HEADERS += \
     ../../interfaces.h \
     ../../waveformdata.h \
     ../../spectrogramdata.h \
-    ../../dataentrydialog.h \
     misc.h
 
 SOURCES += \
     ../../waveformdata.cpp \
     ../../spectrogramdata.cpp \
-    ../../dataentrydialog.cpp \
     misc.cpp
+
+OTHER_FILES += misc.json
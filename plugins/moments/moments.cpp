@@ -1,23 +1,32 @@
-#include <QtGui>
+#include <QtCore>
 #include <QtDebug>
 
+
 #include "moments.h"
-#include <dataentrydialog.h>
-#include <fftw3.h>
-#include <gsl/gsl_statistics_double.h>
+#include "momentsengine.h"
 #include <waveformdata.h>
 #include <spectrogramdata.h>
 
+// number of frames processed by one task
+static const quint32 framesPerBlock = 256;
+
 MomentsPlugin::MomentsPlugin()
 {
     pluginnames << "Variance";
     pluginnames << "Skewness";
     pluginnames << "Kurtosis";
+    pluginnames << "Spectral Centroid";
+    pluginnames << "Spectral Spread";
+    pluginnames << "Spectral Skewness";
+    pluginnames << "Spectral Kurtosis";
+    pluginnames << "All Moments";
 
     settingsLabels << "From (Hz)";
     settingsValues << 1000;
     settingsLabels << "To (Hz)";
     settingsValues << 5000;
+    settingsLabels << "Weight spectral moments by power (0 or 1)";
+    settingsValues << 1;
 }
 
 QString MomentsPlugin::name() const
@@ -36,57 +45,50 @@ MomentsPlugin* MomentsPlugin::copy() const
     return new MomentsPlugin();
 }
 
-void MomentsPlugin::settings(int i)
-{
-    Q_UNUSED(i);
-    DataEntryDialog dew(&settingsLabels, &settingsValues, "", 0);
-    if( dew.exec() == QDialog::Accepted)
-    {
-	for(int i=0; i<settingsValues.count(); i++)
-	{
-	    settingsValues.replace(i, dew.values()->at(i));
-	}
-    }
-}
-
 void MomentsPlugin::calculate(int index, SpectrogramData *data)
 {
-    size_t nframes = data->getNTimeSteps();
+    if(index < 0 || index >= pluginnames.count()) { return; }
 
-    double *values = (double*)malloc(sizeof(double)*nframes);
-    double *times = (double*)malloc(sizeof(double)*nframes);
+    quint32 nframes = data->getNTimeSteps();
+    quint32 nbins = data->getNFrequencyBins();
 
     quint32 begin = data->frequencyBinBelow( settingsValues.at(0).toDouble() );
     quint32 end = data->frequencyBinAbove( settingsValues.at(1).toDouble() );
+    if(end <= begin+1 || end > nbins) { qDebug() << "MomentsPlugin: the frequency range is too small."; return; }
+
+    // every moment of every frame comes out of one pass, so they are all kept
+    QVector<FrameMoments> moments(nframes);
+    MomentsEngine engine(data->pfrequencies()+begin, end-begin, settingsValues.at(2).toInt() != 0);
+
+    QList<quint32> blocks;
+    for(quint32 first=0; first<nframes; first += framesPerBlock)
+	blocks << first;
+
+    FrameMoments *results = moments.data();
+    parallelMap(blocks, [&](const quint32 &first) {
+	quint32 count = qMin(framesPerBlock, nframes-first);
+	for(quint32 i=first; i<first+count; i++)
+	    engine.compute(data->pdata() + (size_t)i*nbins + begin, results+i);
+    });
+
+    QString range = "F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString();
+
+    // the order of pluginnames, without "All Moments"
+    double FrameMoments::*fields[] = { &FrameMoments::variance, &FrameMoments::skewness, &FrameMoments::kurtosis, &FrameMoments::centroid, &FrameMoments::spread, &FrameMoments::spectralSkewness, &FrameMoments::spectralKurtosis };
+    int nFields = sizeof(fields)/sizeof(fields[0]);
 
-    switch(index)
+    for(int m=0; m<nFields; m++)
     {
-    case 0: // variance
-	for(quint32 i=0; i<nframes; i++)
-	{
-	    *(times+i) = data->getTimeFromIndex(i);
-	    *(values+i) = gsl_stats_variance( data->pdata() + i*data->getNFrequencyBins() + begin, 1, end-begin);
-	}
-	emit waveformCreated( new WaveformData("Variance F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString(),times,values,nframes,0) );
-	break;
-    case 1: // skewness
-	for(quint32 i=0; i<nframes; i++)
-	{
-	    *(times+i) = data->getTimeFromIndex(i);
-	    *(values+i) = gsl_stats_skew( data->pdata() + i*data->getNFrequencyBins() + begin, 1, end-begin);
-	}
-	emit waveformCreated( new WaveformData("Skewness F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString(),times,values,nframes,0) );
-	break;
-    case 2: // kurtosis
+	if(index != m && index != nFields) { continue; }
+
+	double *times = (double*)malloc(sizeof(double)*nframes);
+	double *values = (double*)malloc(sizeof(double)*nframes);
 	for(quint32 i=0; i<nframes; i++)
 	{
 	    *(times+i) = data->getTimeFromIndex(i);
-	    *(values+i) = gsl_stats_kurtosis( data->pdata() + i*data->getNFrequencyBins() + begin, 1, end-begin);
+	    *(values+i) = moments.at(i).*fields[m];
 	}
-	emit waveformCreated( new WaveformData("Kurtosis F:"+settingsValues.at(0).toString() + " T:" + settingsValues.at(1).toString(),times,values,nframes,0) );
-	break;
-    default:
-	break;
+	emit waveformCreated( new WaveformData(pluginnames.at(m)+" "+range,times,values,nframes,0) );
     }
 }
 
@@ -101,11 +103,3 @@ void MomentsPlugin::calculate(QString name, SpectrogramData *data)
     if(index != -1)
 	calculate(index, data);
 }
-
-void MomentsPlugin::setParameter(QString label, QVariant value)
-{
-    int index = settingsLabels.indexOf(label);
-    if(index != -1)
-	settingsValues[index] = value;
-}
-
@@ -1,22 +1,23 @@
 TEMPLATE = lib
-CONFIG += plugin qwt
+CONFIG += plugin
+QT = core
 INCLUDEPATH += ../..
 TARGET = $$qtLibraryTarget(aw_moments)
 DESTDIR = ..
 LIBS += -lm \
-    -L./ \
-    -lgsl \
-    -lgslcblas
+    -L./
 
 HEADERS += \
     ../../interfaces.h \
     ../../waveformdata.h \
     ../../spectrogramdata.h \
-    ../../dataentrydialog.h \
-    moments.h
+    moments.h \
+    momentsengine.h
 
 SOURCES += \
     ../../waveformdata.cpp \
     ../../spectrogramdata.cpp \
-    ../../dataentrydialog.cpp \
-    moments.cpp
+    moments.cpp \
+    momentsengine.cpp
+
+OTHER_FILES += moments.json
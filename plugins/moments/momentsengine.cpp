@@ -0,0 +1,96 @@
+#include "momentsengine.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+MomentsEngine::MomentsEngine(const double *frequencies, quint32 length, bool powerWeighted) : mLength(length), mPowerWeighted(powerWeighted)
+{
+    mCenter = ( *frequencies + *(frequencies+mLength-1) ) / 2;
+    mHalfWidth = ( *(frequencies+mLength-1) - *frequencies ) / 2;
+    if(mHalfWidth <= 0)
+	mHalfWidth = 1;
+
+    mScaled = (double*)malloc(sizeof(double)*mLength);
+    for(quint32 j=0; j<mLength; j++)
+	*(mScaled+j) = ( *(frequencies+j) - mCenter ) / mHalfWidth;
+}
+
+MomentsEngine::~MomentsEngine()
+{
+    free(mScaled);
+}
+
+void MomentsEngine::compute(const double *frame, FrameMoments *out) const
+{
+    // running central sums of the values
+    double mean = 0, M2 = 0, M3 = 0, M4 = 0;
+    // running weighted power sums of the scaled frequencies
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+    double maxValue = *frame;
+
+    for(quint32 j=0; j<mLength; j++)
+    {
+	double x = *(frame+j);
+
+	double n1 = j;
+	double n = j + 1;
+	double delta = x - mean;
+	double delta_n = delta / n;
+	double delta_n2 = delta_n * delta_n;
+	double term1 = delta * delta_n * n1;
+	mean += delta_n;
+	M4 += term1 * delta_n2 * (n*n - 3*n + 3) + 6 * delta_n2 * M2 - 4 * delta_n * M3;
+	M3 += term1 * delta_n * (n - 2) - 3 * delta_n * M2;
+	M2 += term1;
+
+	double w;
+	if(mPowerWeighted)
+	{
+	    if(x > maxValue)
+	    {
+		// rescale what has been summed so far to the new maximum
+		double r = exp(maxValue - x);
+		s0 *= r; s1 *= r; s2 *= r; s3 *= r; s4 *= r;
+		maxValue = x;
+	    }
+	    w = exp(x - maxValue);
+	}
+	else
+	{
+	    w = x;
+	}
+	double u = *(mScaled+j);
+	double wu = w * u;
+	s0 += w;
+	s1 += wu;
+	s2 += wu * u;
+	s3 += wu * u * u;
+	s4 += wu * u * u * u;
+    }
+
+    double n = mLength;
+    out->variance = n > 1 ? M2 / (n - 1) : 0;
+    double sd = sqrt(out->variance);
+    out->skewness = sd > 0 ? (M3 / n) / (sd*sd*sd) : 0;
+    out->kurtosis = sd > 0 ? (M4 / n) / (out->variance*out->variance) - 3 : 0;
+
+    if(s0 == 0)
+    {
+	out->centroid = out->spread = out->spectralSkewness = out->spectralKurtosis = 0;
+	return;
+    }
+
+    // central moments of the scaled frequency from its raw moments
+    double m1 = s1 / s0;
+    double r2 = s2 / s0, r3 = s3 / s0, r4 = s4 / s0;
+    double c2 = r2 - m1*m1;
+    double c3 = r3 - 3*m1*r2 + 2*m1*m1*m1;
+    double c4 = r4 - 4*m1*r3 + 6*m1*m1*r2 - 3*m1*m1*m1*m1;
+    if(c2 < 0)
+	c2 = 0;
+
+    out->centroid = mCenter + mHalfWidth * m1;
+    out->spread = mHalfWidth * sqrt(c2);
+    out->spectralSkewness = c2 > 0 ? c3 / pow(c2, 1.5) : 0;
+    out->spectralKurtosis = c2 > 0 ? c4 / (c2*c2) - 3 : 0;
+}
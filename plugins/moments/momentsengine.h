@@ -0,0 +1,50 @@
+/*!
+  \class MomentsEngine
+  \ingroup Plugin
+  \brief Computes the moments of spectrogram frames in one streaming pass per frame.
+
+  Two kinds of moments are computed together:
+  - the moments of the bin values themselves (variance, skewness and excess kurtosis, with the same definitions as gsl_stats_variance, gsl_stats_skew and gsl_stats_kurtosis), updated value by value with Terriberry's extension of Welford's method;
+  - the spectral moments, i.e., the moments of frequency weighted by the bin values (centroid, spread, skewness and excess kurtosis).
+
+  Spectrogram values are log powers. When power weighting is on, the weights are exp(value) rescaled on the fly to the largest value seen so far, so they cannot overflow. Frequencies are mapped to [-1, 1] across the band before the weighted power sums are taken, which keeps the fourth moment well-conditioned.
+*/
+
+#ifndef MOMENTSENGINE_H
+#define MOMENTSENGINE_H
+
+#include <QtGlobal>
+
+//! \brief The moments of one frame
+struct FrameMoments
+{
+    double variance;
+    double skewness;
+    double kurtosis;
+    double centroid;
+    double spread;
+    double spectralSkewness;
+    double spectralKurtosis;
+};
+
+class MomentsEngine
+{
+public:
+    //! \brief Prepare to compute moments over the \a length frequencies \a frequencies
+    /*!
+      \param powerWeighted If true the spectral moments are weighted by exp(value), otherwise by the values themselves
+      */
+    MomentsEngine(const double *frequencies, quint32 length, bool powerWeighted);
+    ~MomentsEngine();
+
+    //! \brief Compute all of the moments of the \a length values starting at \a frame
+    void compute(const double *frame, FrameMoments *out) const;
+
+private:
+    quint32 mLength;
+    bool mPowerWeighted;
+    double mCenter, mHalfWidth;
+    double *mScaled;
+};
+
+#endif // MOMENTSENGINE_H
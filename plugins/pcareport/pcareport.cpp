@@ -1,4 +1,4 @@
-#include <QtWidgets>
+#include <QtCore>
 #include <QtDebug>
 #include <QVariant>
 
@@ -12,7 +12,6 @@
 #include <gsl/gsl_blas.h>
 
 #include "pcareport.h"
-#include <dataentrydialog.h>
 
 #include <waveformdata.h>
 #include <spectrogramdata.h>
@@ -46,19 +45,6 @@ PcaReportPlugin* PcaReportPlugin::copy() const
     return new PcaReportPlugin();
 }
 
-void PcaReportPlugin::settings(int i)
-{
-    Q_UNUSED(i);
-    DataEntryDialog dew(&settingsLabels, &settingsValues, "", 0);
-    if( dew.exec() == QDialog::Accepted)
-    {
-	for(int i=0; i<settingsValues.count(); i++)
-	{
-	    settingsValues.replace(i, dew.values()->at(i));
-	}
-    }
-}
-
 void PcaReportPlugin::calculate(QString name, SpectrogramData *data)
 {
     int index = pluginnames.indexOf(name);
@@ -153,19 +139,10 @@ void PcaReportPlugin::calculate(int index, SpectrogramData *data)
 	emit waveformCreated( new WaveformData(tr("PC ")+QString::number(i+1),x,y,nrow,0) );
     }
 
-    QDialog *dlg = new QDialog;
-    QVBoxLayout *layout = new QVBoxLayout;
-    QTextEdit *edit = new QTextEdit;
-    layout->addWidget(edit);
     QString reportText("Parameter\t% Variance\tCum. Sum\n");
     for(quint32 j=0; j<ncol; j++)
 	reportText += QString::number(j+1) + "\t" + QString::number(*(variances+j)) + "\t" + QString::number(*(cumulative_sum+j)) + "\n";
-    edit->setText(reportText);
-    dlg->setLayout(layout);
-    dlg->setWindowTitle(tr("PCA Report"));
-//    dlg->exec();
-//    dlg->setModal(true);
-    dlg->show();
+    emit reportCreated(tr("PCA Report"), reportText);
 
     gsl_eigen_symmv_free(eigenWorkspace);
     gsl_matrix_free(eigenvectors);
@@ -177,11 +154,3 @@ void PcaReportPlugin::calculate(int index, SpectrogramData *data)
     free(matrix);
     free(cov);
 }
-
-void PcaReportPlugin::setParameter(QString label, QVariant value)
-{
-    int index = settingsLabels.indexOf(label);
-    if(index != -1)
-	settingsValues[index] = value;
-}
-
@@ -5,6 +5,7 @@ TEMPLATE = subdirs
 SUBDIRS = centroid \
         cepstrum \
         cepstrum_spectrogram \
+        delta \
         linear \
         misc \
         moments \
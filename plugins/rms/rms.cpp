@@ -1,10 +1,29 @@
-#include <QtGui>
+#include <QtCore>
 #include <QtDebug>
 
 #include "rms.h"
-#include "dataentrydialog.h"
 #include <waveformdata.h>
 
+#include <string.h>
+
+namespace {
+
+//! \brief The state of a run of the RMS measure on a stream
+class RmsBlockState : public BlockState
+{
+public:
+    BlockSink *output;
+    double windowLength, timeStep;
+    qint64 windowLengthInSamples, timeStepInSamples;
+
+    //! \brief Samples that later frames still need; the first of them is sample number pendingStart of the stream
+    QVector<double> pending;
+    qint64 pendingStart;
+    qint64 nextFrame;
+};
+
+}
+
 RmsPlugin::RmsPlugin()
 {
 //    sound = data;
@@ -36,19 +55,6 @@ RmsPlugin* RmsPlugin::copy() const
     return new RmsPlugin();
 }
 
-void RmsPlugin::settings(int i)
-{
-    Q_UNUSED(i);
-    DataEntryDialog dew(&settingsLabels, &settingsValues, "", 0);
-    if( dew.exec() == QDialog::Accepted)
-    {
-	for(int i=0; i<settingsValues.count(); i++)
-	{
-	    settingsValues.replace(i, dew.values()->at(i));
-	}
-    }
-}
-
 void RmsPlugin::calculate(int i, WaveformData *data)
 {
     Q_UNUSED(i);
@@ -96,10 +102,80 @@ void RmsPlugin::calculate(QString name, WaveformData *data)
 	calculate(index, data);
 }
 
-void RmsPlugin::setParameter(QString label, QVariant value)
+BlockState* RmsPlugin::begin(int i, const BlockFormat &input, BlockSink *output)
 {
-    int index = settingsLabels.indexOf(label);
-    if(index != -1)
-	settingsValues[index] = value;
+    Q_UNUSED(i);
+    if( input.width != 1 || input.frameRate <= 0 ) { qDebug() << "RmsPlugin: the input of a block run must be a waveform."; return 0; }
+
+    RmsBlockState *state = new RmsBlockState;
+    state->output = output;
+    state->windowLength = settingsValues.at(0).toDouble()/1000.0f;
+    state->timeStep = settingsValues.at(1).toDouble() / 1000.0f;
+    state->windowLengthInSamples = qMax( (qint64)1, (qint64)( state->windowLength * input.frameRate ) );
+    state->timeStepInSamples = qMax( (qint64)1, (qint64)( state->timeStep * input.frameRate ) );
+    state->pendingStart = 0;
+    state->nextFrame = 0;
+
+    BlockFormat format;
+    format.frameRate = 1.0 / state->timeStep;
+    format.name = "RMS WL:" + settingsValues.at(0).toString() + " TS:" + settingsValues.at(1).toString();
+    output->setFormat(format);
+
+    return state;
+}
+
+qint64 RmsPlugin::lookahead(const BlockState *state) const
+{
+    const RmsBlockState *s = static_cast<const RmsBlockState*>(state);
+    // the frames are centred in their windows
+    return s->windowLengthInSamples - s->windowLengthInSamples/2;
+}
+
+qint64 RmsPlugin::latency(const BlockState *state) const
+{
+    // the first sample of a window waits for the last
+    return static_cast<const RmsBlockState*>(state)->windowLengthInSamples - 1;
+}
+
+void RmsPlugin::processBlock(BlockState *state, const FrameBlock &input)
+{
+    RmsBlockState *s = static_cast<RmsBlockState*>(state);
+
+    int size = s->pending.size();
+    s->pending.resize( size + input.count );
+    memcpy( s->pending.data() + size, input.values, sizeof(double)*input.count );
+
+    // every frame whose window has been filled
+    QVector<double> frameTimes, frameValues;
+    while( s->nextFrame * s->timeStepInSamples + s->windowLengthInSamples <= s->pendingStart + s->pending.size() )
+    {
+        const double *samples = s->pending.constData() + ( s->nextFrame * s->timeStepInSamples - s->pendingStart );
+        double rms = 0.0f;
+        for(qint64 j=0; j<s->windowLengthInSamples; j++)
+            rms += samples[j] * samples[j];
+
+        frameTimes << s->windowLength/2 + s->nextFrame*s->timeStep;
+        frameValues << sqrt(rms/s->windowLengthInSamples);
+        s->nextFrame++;
+    }
+
+    qint64 consumed = qMin( (qint64)s->pending.size(), s->nextFrame * s->timeStepInSamples - s->pendingStart );
+    if( consumed > 0 )
+    {
+        s->pending.remove(0, consumed);
+        s->pendingStart += consumed;
+    }
+
+    if( frameTimes.isEmpty() ) { return; }
+    FrameBlock block;
+    block.times = frameTimes.constData();
+    block.values = frameValues.constData();
+    block.count = frameTimes.count();
+    s->output->write(block);
 }
 
+void RmsPlugin::finish(BlockState *state)
+{
+    // as in calculate(), a window that runs past the end of the sound is not measured
+    Q_UNUSED(state);
+}
@@ -10,11 +10,11 @@
 
 class WaveformData;
 
-class RmsPlugin : public AbstractWaveform2WaveformMeasure
+class RmsPlugin : public AbstractWaveform2WaveformMeasure, public AbstractBlockMeasure
 {
     Q_OBJECT
-    Q_INTERFACES(AbstractWaveform2WaveformMeasure)
-    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractwaveform2waveformmeasure/1.0")
+    Q_INTERFACES(AbstractWaveform2WaveformMeasure AbstractBlockMeasure)
+    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractwaveform2waveformmeasure/1.0" FILE "rms.json")
 
 public:
     RmsPlugin();
@@ -28,19 +28,21 @@ public:
 public slots:
     QString name() const;
     QStringList names() const;
-    void settings(int i);
     void calculate(int i, WaveformData *data);
 
     void calculate(QString name, WaveformData *data);
-    void setParameter(QString label, QVariant value);
     QString scriptName() const;
 
+public:
+    BlockState* begin(int i, const BlockFormat &input, BlockSink *output);
+    qint64 lookahead(const BlockState *state) const;
+    qint64 latency(const BlockState *state) const;
+    void processBlock(BlockState *state, const FrameBlock &input);
+    void finish(BlockState *state);
+
 private:
     QStringList pluginnames;
 
-    QStringList settingsLabels;
-    QList<QVariant> settingsValues;
-
     size_t nframes;
     double *times;
     double *values;
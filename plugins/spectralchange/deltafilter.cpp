@@ -0,0 +1,61 @@
+#include "deltafilter.h"
+#include "interfaces.h"
+
+#include <QList>
+#include <QPair>
+
+// number of frames processed by one task
+static const quint32 framesPerBlock = 256;
+
+DeltaFilter::DeltaFilter(int N) : mN(N)
+{
+    double denominator = 0;
+    for(int k=1; k<=mN; k++)
+	denominator += 2*k*k;
+
+    mWeights = (double*)malloc(sizeof(double)*qMax(mN,1));
+    for(int k=1; k<=mN; k++)
+	*(mWeights+k-1) = k / denominator;
+}
+
+DeltaFilter::~DeltaFilter()
+{
+    free(mWeights);
+}
+
+int DeltaFilter::span() const
+{
+    return mN;
+}
+
+void DeltaFilter::apply(const double *in, quint32 nFrames, quint32 nCols, quint32 fromCol, quint32 toCol, quint32 first, quint32 count, double *out) const
+{
+    quint32 width = toCol - fromCol + 1;
+    qint64 last = (qint64)nFrames - 1;
+
+    for(quint32 r=0; r<count; r++)
+    {
+	double *dest = out + (size_t)r*width;
+	for(quint32 c=0; c<width; c++)
+	    *(dest+c) = 0;
+
+	qint64 n = first + r;
+	for(int k=1; k<=mN; k++)
+	{
+	    const double *ahead = in + (size_t)qMin(n+k, last)*nCols + fromCol;
+	    const double *behind = in + (size_t)qMax(n-k, (qint64)0)*nCols + fromCol;
+	    double w = *(mWeights+k-1);
+	    for(quint32 c=0; c<width; c++)
+		*(dest+c) += w * ( *(ahead+c) - *(behind+c) );
+	}
+    }
+}
+
+void DeltaFilter::forEachBlock(quint32 nFrames, std::function<void(quint32,quint32)> function)
+{
+    QList< QPair<quint32,quint32> > blocks;
+    for(quint32 first=0; first<nFrames; first += framesPerBlock)
+	blocks << qMakePair(first, qMin(framesPerBlock, nFrames-first));
+
+    parallelMap(blocks, [&function](const QPair<quint32,quint32> &block) { function(block.first, block.second); });
+}
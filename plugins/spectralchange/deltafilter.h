@@ -0,0 +1,46 @@
+/*!
+  \class DeltaFilter
+  \ingroup Plugin
+  \brief Computes regression (delta) coefficients along the time axis of a spectrogram.
+
+  The delta of frame n is the least-squares slope over frames n-N to n+N, sum_k k (c[n+k] - c[n-k]) / (2 sum_k k^2). The filter is separable: it runs along time and is the same for every column. The weights are computed once, when the filter is constructed. Rows of the row-major spectrogram storage are read whole, so the inner loop runs over contiguous memory.
+
+  The filter is shared by the spectral change and delta plugins.
+*/
+
+#ifndef DELTAFILTER_H
+#define DELTAFILTER_H
+
+#include <QtGlobal>
+#include <functional>
+
+class DeltaFilter
+{
+public:
+    //! \brief Create a filter spanning \a N frames on either side of the current frame
+    DeltaFilter(int N);
+    ~DeltaFilter();
+
+    //! \brief Return N, the number of frames on either side of the current frame
+    int span() const;
+
+    //! \brief Compute the deltas of frames \a first to \a first + \a count - 1 of \a in, for columns \a fromCol to \a toCol
+    /*!
+      \param in A row-major matrix of \a nFrames rows and \a nCols columns
+      \param out Receives \a count rows of \a toCol - \a fromCol + 1 values
+      Frames before the start or past the end of \a in are taken to be copies of the first or last frame.
+      */
+    void apply(const double *in, quint32 nFrames, quint32 nCols, quint32 fromCol, quint32 toCol, quint32 first, quint32 count, double *out) const;
+
+    //! \brief Split \a nFrames frames into blocks and call \a function(first, count) for each block, in parallel
+    /*!
+      The blocks are small enough that the frames a block reads stay in cache.
+      */
+    static void forEachBlock(quint32 nFrames, std::function<void(quint32,quint32)> function);
+
+private:
+    int mN;
+    double *mWeights;
+};
+
+#endif // DELTAFILTER_H
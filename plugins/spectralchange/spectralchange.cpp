@@ -1,12 +1,11 @@
-#include <QtGui>
+#include <QtCore>
 #include <QtDebug>
 
 #include <waveformdata.h>
 #include <spectrogramdata.h>
 
 #include "spectralchange.h"
-#include <dataentrydialog.h>
-#include <fftw3.h>
+#include "deltafilter.h"
 
 SpectralChangePlugin::SpectralChangePlugin()
 {
@@ -48,19 +47,6 @@ SpectralChangePlugin* SpectralChangePlugin::copy() const
     return new SpectralChangePlugin();
 }
 
-void SpectralChangePlugin::settings(int i)
-{
-    Q_UNUSED(i);
-    DataEntryDialog dew(&settingsLabels, &settingsValues, "", 0);
-    if( dew.exec() == QDialog::Accepted)
-    {
-	for(int i=0; i<settingsValues.count(); i++)
-	{
-	    settingsValues.replace(i, dew.values()->at(i));
-	}
-    }
-}
-
 void SpectralChangePlugin::calculate(QString name, SpectrogramData *data)
 {
     int index = pluginnames.indexOf(name);
@@ -75,53 +61,38 @@ void SpectralChangePlugin::calculate(int index, SpectrogramData *data)
     int fromCC = settingsValues.at(0).toInt();
     int toCC = settingsValues.at(1).toInt();
     int N = settingsValues.at(2).toInt();
-    int nFrames = data->getNTimeSteps() - 2*N;
-
-    QList<WaveformData*> retval;
 
     if(data->getNTimeSteps() <  (unsigned)(2*N + 1)) { return; }
+    if(fromCC < 0 || toCC < fromCC || (unsigned)toCC >= data->getNFrequencyBins()) { qDebug() << "SpectralChangePlugin: coefficients" << fromCC << "to" << toCC << "are out of range."; return; }
+
+    quint32 nFrames = data->getNTimeSteps() - 2*N;
+    quint32 width = toCC - fromCC + 1;
 
     double *times = (double*)malloc(sizeof(double)*nFrames);
     double *values = (double*)malloc(sizeof(double)*nFrames);
+    if(times==NULL || values==NULL) { qDebug() << "Memory allocation error (times & values)."; free(times); free(values); return; }
 
-    // waste a few bytes to keep things pretty
-    double *a = (double*)malloc(sizeof(double)*toCC);
-    for(int i=0; i<nFrames; i++)
-    {
+    for(quint32 i=0; i<nFrames; i++)
 	*(times+i) = data->getTimeFromIndex(N+i); // was timeAt
 
-	for(int j=fromCC; j<=toCC; j++) // for each cepstral coefficient
+    // only frames with N frames on either side are measured, so output frame i is spectrogram frame N+i
+    DeltaFilter filter(N);
+    DeltaFilter::forEachBlock(nFrames, [&](quint32 first, quint32 count) {
+	double *delta = (double*)malloc(sizeof(double)*count*width);
+	if(delta==NULL) { qDebug() << "Memory allocation error (delta)."; return; }
+	filter.apply(data->pdata(), data->getNTimeSteps(), data->getNFrequencyBins(), fromCC, toCC, N+first, count, delta);
+	for(quint32 r=0; r<count; r++)
 	{
-	    *(a + j) = 0;
-	    double denominator = 0;
-	    for(int k= -1*N; k <= N; k++) // over the span of the window
-	    {
-		*(a + j) +=  data->dataAt(i+N+k,j)*k; // Ci(n) * n
-		denominator += k*k;
-	    }
-	    *(a + j) /= denominator;
+	    double sum = 0;
+	    for(quint32 c=0; c<width; c++)
+		sum += *(delta + r*width + c) * *(delta + r*width + c);
+	    *(values+first+r) = sum / width;
 	}
-
-	*(values+i) = 0;
-	for(int j=fromCC; j<=toCC; j++)
-	    *(values+i) += *(a+j) * *(a+j);
-	*(values+i) /= toCC-fromCC+1;
-    }
-    free(a);
+	free(delta);
+    });
 
     QString suggestedName = "Furui86 CC" + settingsValues.at(0).toString() + "-" + settingsValues.at(1).toString() + " N:" + settingsValues.at(2).toString();
     double samplingFreq = 1 / (data->getTimeFromIndex(1)-data->getTimeFromIndex(0));
-/*
-    retval << new WaveformData(suggestedName, times, values, nFrames, samplingFreq);
-    return retval;
-*/
-    emit waveformCreated(new WaveformData(suggestedName, times, values, nFrames, samplingFreq));
-}
 
-void SpectralChangePlugin::setParameter(QString label, QVariant value)
-{
-    int index = settingsLabels.indexOf(label);
-    if(index != -1)
-	settingsValues[index] = value;
+    emit waveformCreated(new WaveformData(suggestedName, times, values, nFrames, samplingFreq));
 }
-
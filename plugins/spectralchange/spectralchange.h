@@ -14,7 +14,7 @@ class SpectralChangePlugin : public AbstractSpectrogram2WaveformMeasure
 {
     Q_OBJECT
     Q_INTERFACES(AbstractSpectrogram2WaveformMeasure)
-    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0")
+    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractspectrogram2waveformmeasure/1.0" FILE "spectralchange.json")
 
 public:
     SpectralChangePlugin();
@@ -25,16 +25,11 @@ public slots:
     QString name() const;
     QString scriptName() const;
     QStringList names() const;
-    void settings(int i);
     void calculate(int index, SpectrogramData *data);
     void calculate(QString name, SpectrogramData *data);
-    void setParameter(QString label, QVariant value);
 
 private:
     QStringList pluginnames;
-
-    QStringList settingsLabels;
-    QList<QVariant> settingsValues;
 };
 
 #endif
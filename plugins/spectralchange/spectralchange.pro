@@ -1,5 +1,6 @@
 TEMPLATE = lib
-CONFIG += plugin qwt
+CONFIG += plugin
+QT = core
 INCLUDEPATH += ../..
 TARGET = $$qtLibraryTarget(aw_spectralchange)
 DESTDIR = ..
@@ -10,11 +11,13 @@ HEADERS += \
     ../../interfaces.h \
     ../../waveformdata.h \
     ../../spectrogramdata.h \
-    ../../dataentrydialog.h \
-    spectralchange.h
+    spectralchange.h \
+    deltafilter.h
 
 SOURCES += \
     ../../waveformdata.cpp \
     ../../spectrogramdata.cpp \
-    ../../dataentrydialog.cpp \
-    spectralchange.cpp
\ No newline at end of file
+    spectralchange.cpp \
+    deltafilter.cpp
+
+OTHER_FILES += spectralchange.json
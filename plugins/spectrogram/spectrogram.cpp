@@ -1,13 +1,15 @@
-#include <QtGui>
+#include <QtCore>
 #include <QtDebug>
-#include <QProgressDialog>
+#include <QFile>
 
 #include <waveformdata.h>
 #include <spectrogramdata.h>
 
 #include "spectrogram.h"
-#include <dataentrydialog.h>
 #include <fftw3.h>
+#include <string.h>
+
+#include "spectrogramrefiner.h"
 
 SpectrogramPlugin::SpectrogramPlugin()
 {
@@ -20,6 +22,17 @@ SpectrogramPlugin::SpectrogramPlugin()
     settingsValues << 30;
     settingsLabels << "Time step (ms)";
     settingsValues << 5;
+    // a time range with the end after the start limits the analysis to that range; otherwise the whole waveform is analysed
+    settingsLabels << "Start time (s)";
+    settingsValues << 0;
+    settingsLabels << "End time (s)";
+    settingsValues << 0;
+    // 1 to show a coarse spectrogram at once and refine it in the background (see SpectrogramRefiner)
+    settingsLabels << "Progressive";
+    settingsValues << 0;
+    // 1 to keep the spectrogram in a mapped temporary file rather than in memory, for recordings whose spectrograms do not fit in memory
+    settingsLabels << "Out of core";
+    settingsValues << 0;
 }
 
 QString SpectrogramPlugin::name() const
@@ -43,19 +56,6 @@ SpectrogramPlugin* SpectrogramPlugin::copy() const
     return new SpectrogramPlugin();
 }
 
-void SpectrogramPlugin::settings(int i)
-{
-    Q_UNUSED(i);
-    DataEntryDialog dew(&settingsLabels, &settingsValues, "", 0);
-    if( dew.exec() == QDialog::Accepted)
-    {
-	for(int i=0; i<settingsValues.count(); i++)
-	{
-	    settingsValues.replace(i, dew.values()->at(i));
-	}
-    }
-}
-
 void SpectrogramPlugin::calculate(QString name, WaveformData *data)
 {
     int index = pluginNames.indexOf(name);
@@ -76,6 +76,26 @@ void SpectrogramPlugin::calculate(int index, WaveformData *data)
     size_t windowLengthInSamples = windowLength * sound->getSamplingFrequency();
     size_t timeStepInSamples = timeStep * sound->getSamplingFrequency();
 
+    // the samples to analyse; with a time range, the windows are placed so that their centres cover the range
+    size_t firstSample = 0;
+    double regionLength = sound->length();
+    double rangeStart = settingsValues.at(2).toDouble();
+    double rangeEnd = settingsValues.at(3).toDouble();
+    bool limited = rangeEnd > rangeStart;
+    if( limited )
+    {
+	double fs = sound->getSamplingFrequency();
+	double first = qMax( 0.0, floor( (rangeStart - windowLength/2) * fs ) );
+	double last = qMin( (double)sound->getNSamples(), ceil( (rangeEnd + windowLength/2) * fs ) );
+	firstSample = (size_t)first;
+	regionLength = (last - first) / fs;
+    }
+    if( windowLengthInSamples < 2 || timeStepInSamples < 1 || regionLength < windowLength )
+    {
+	qDebug() << "SpectrogramPlugin::calculate: the window length and time step do not fit the waveform" << windowLength << timeStep << regionLength;
+	return;
+    }
+
     // BEWARE BEWARE BEWARE //
 //    windowLengthInSamples *= 2;
     // the above line is motivated by Praat's practice of using twice as long a window as is specified
@@ -83,26 +103,40 @@ void SpectrogramPlugin::calculate(int index, WaveformData *data)
     double spec_min, spec_max;
 
     // quint32 nFrames, nFreqBins
-    size_t nFrames = (quint32)floor( (sound->length()-windowLength) / timeStep );
-    if( floor( (sound->length()-windowLength) / windowLength ) == ( (sound->length()-windowLength) / windowLength )) { nFrames++; } // if there happened to be exactly one windowLenth left over
+    size_t nFrames = (quint32)floor( (regionLength-windowLength) / timeStep );
+    if( floor( (regionLength-windowLength) / windowLength ) == ( (regionLength-windowLength) / windowLength )) { nFrames++; } // if there happened to be exactly one windowLenth left over
+    if( nFrames == 0 ) { nFrames = 1; }
     size_t nFreqBins = (quint32)floor(windowLengthInSamples/2.0f);
 
 //    qDebug() << nFrames << sound->length() << windowLength << timeStep;
 
-    // Gaussian window
-    double *filter = (double*)malloc(sizeof(double)*windowLengthInSamples);
-    double wls = windowLengthInSamples;
-    for(quint32 i=0; i<windowLengthInSamples; i++)
+    // a progressive spectrogram computes every coarseStep-th frame now, and the rest in the background
+    bool progressive = settingsValues.at(4).toInt() != 0;
+    int coarseStep = progressive ? SpectrogramRefiner::coarseStep(nFrames) : 1;
+
+    // an out-of-core spectrogram is written straight into its backing file, a page of which need only be in memory while it is being written or read
+    bool outOfCore = settingsValues.at(5).toInt() != 0;
+    QFile *backing = 0;
+    uchar *mapped = 0;
+    double *times, *spec;
+    if( outOfCore )
     {
-	double n = (-1*wls/2) + i;
-	*(filter+i) = exp( -0.5 * (2.5*n / (wls/2))*(2.5*n / (wls/2)) );
+	backing = SpectrogramData::createBackingFile(nFrames, nFreqBins);
+	if( backing != 0 ) { mapped = backing->map(0, backing->size()); }
+	if( mapped == 0 ) { qDebug() << "SpectrogramPlugin::calculate: could not map a backing file for" << nFrames << "time steps"; delete backing; return; }
+	times = (double*)mapped;
+	spec = times + nFrames;
+    }
+    else
+    {
+	times = (double*)malloc(sizeof(double)*nFrames);
+	spec = (double*)malloc(sizeof(double)*nFrames*nFreqBins);
     }
 
     // time frames
-    double *times = (double*)malloc(sizeof(double)*nFrames);
     for(quint32 i=0; i<nFrames; i++)
     {
-	*(times+i) = windowLength/2 + i*timeStep;
+	*(times+i) = firstSample / (double)sound->getSamplingFrequency() + windowLength/2 + i*timeStep;
     }
 
     // frequency bins
@@ -112,38 +146,28 @@ void SpectrogramPlugin::calculate(int index, WaveformData *data)
 	*(frequencies+i) = i*(sound->getNyquistFrequency()/nFreqBins);
     }
 
-    double *spec = (double*)malloc(sizeof(double)*nFrames*nFreqBins);
-
-    double *in = (double*)fftw_malloc(sizeof(double)*windowLengthInSamples);
-    fftw_complex *out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*windowLengthInSamples);
-    fftw_plan theplan = fftw_plan_dft_r2c_1d(windowLengthInSamples, in, out, FFTW_ESTIMATE);
+    FrameAnalyser analyser(windowLengthInSamples);
 
     quint32 startSample = 0;
 
-    QProgressDialog progress("Calculating spectrogram...", QString(), 0, nFrames, 0);
-    progress.setWindowModality(Qt::WindowModal);
-
     spec_max = 0.0f;
     spec_min = 99999999999.0f;
-    for(quint32 j = 0; j < nFrames; j++)
+    for(quint32 j = 0; j < nFrames; j += coarseStep)
     {
+	emit progressChanged(j, nFrames);
 
-	progress.setValue(j);
-
-	// put a segment of waveform into in
-	startSample = j * timeStepInSamples;
-	for(quint32 i=0; i<windowLengthInSamples; i++)
-	{
-        *(in+i) = sound->yData()[startSample+i]  * *(filter+i);
-	}
-	fftw_execute(theplan);
-	// change to the absolute value, and also keep track of the minimum and maximum values
+	// the power spectrum of a segment of waveform, and also keep track of the minimum and maximum values
+	startSample = firstSample + j * timeStepInSamples;
+	analyser.analyse( sound->yData().constData() + startSample, spec + j*nFreqBins );
 	for(quint32 i=0; i<nFreqBins; i++)
 	{
-	    *(spec + j*nFreqBins + i) = (out+i)[0][0]*(out+i)[0][0] + (out+i)[0][1]*(out+i)[0][1];
 	    if( *(spec + j*nFreqBins + i) > spec_max) { spec_max = *(spec + j*nFreqBins + i); }
 	    if( *(spec + j*nFreqBins + i) < spec_min) { spec_min = *(spec + j*nFreqBins + i); }
 	}
+
+	// until they are refined, the frames that were skipped show the last one computed
+	for(quint32 k = j+1; k < j+coarseStep && k < nFrames; k++)
+	    memcpy( spec + k*nFreqBins, spec + j*nFreqBins, sizeof(double)*nFreqBins );
     }
 
     double log_spec_max = -1 * log( spec_min / spec_max );
@@ -153,9 +177,7 @@ void SpectrogramPlugin::calculate(int index, WaveformData *data)
 	*(spec+i) = log( *(spec+i) / spec_max ) + log_spec_max;
     }
 
-    fftw_free( in );
-    fftw_free( out );
-    fftw_destroy_plan(theplan);
+    emit progressChanged(nFrames, nFrames);
 
 //    qDebug() << spec << times << frequencies;
 //    qDebug() << spec_min << spec_max << windowLength << timeStep << nFrames << nFreqBins;
@@ -164,22 +186,23 @@ void SpectrogramPlugin::calculate(int index, WaveformData *data)
     fwrite(spec,sizeof(double),nFrames*nFreqBins,fid);
     fclose(fid);
 */
-    free(filter);
-
     QString suggested_label = "Spectrogram WL:" + settingsValues.at(0).toString() + " TS:" + settingsValues.at(1).toString();
+    if( limited )
+	suggested_label += " (" + QString::number(rangeStart) + "-" + QString::number(rangeEnd) + " s)";
+
+    // the values run from log(spec_min/spec_min) to log(spec_max/spec_min), which saves reading the backing file again to find them
+    SpectrogramData *spectrogram;
+    if( outOfCore )
+	spectrogram = new SpectrogramData(suggested_label, backing, mapped, nFrames, frequencies, nFreqBins, windowLength, timeStep, 0, log_spec_max);
+    else
+	spectrogram = new SpectrogramData(suggested_label, spec, times, nFrames, frequencies, nFreqBins, windowLength, timeStep);
+    if( coarseStep > 1 )
+	new SpectrogramRefiner(spectrogram, sound->samples(), firstSample, timeStepInSamples, windowLengthInSamples, coarseStep, log( spec_min ), log_spec_max);
 
-    emit spectrogramCreated(new SpectrogramData(suggested_label, spec, times, nFrames, frequencies, nFreqBins, windowLength, timeStep));
+    emit spectrogramCreated(spectrogram);
 
 //    QList<SpectrogramData*> ret;
 //    ret << new SpectrogramData(suggested_label, spec, times, nFrames, frequencies, nFreqBins, spec_min, spec_max , windowLength, timeStep);
 //    ret.last()->setBoundingRect(QwtDoubleRect( sound->tMin(), 0.0f , (sound->tMax()-sound->tMin()), (double)sound->getNyquistFrequency()  ));
 //    return ret;
 }
-
-void SpectrogramPlugin::setParameter(QString label, QVariant value)
-{
-    int index = settingsLabels.indexOf(label);
-    if(index != -1)
-	settingsValues[index] = value;
-}
-
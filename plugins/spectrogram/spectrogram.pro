@@ -1,5 +1,6 @@
 TEMPLATE = lib
-CONFIG += plugin qwt
+CONFIG += plugin
+QT = core concurrent
 INCLUDEPATH += ../..
 TARGET = $$qtLibraryTarget(aw_spectrogram)
 DESTDIR = ..
@@ -11,11 +12,13 @@ HEADERS += \
     ../../interfaces.h \
     ../../waveformdata.h \
     ../../spectrogramdata.h \
-    ../../dataentrydialog.h \
-    spectrogram.h
+    spectrogram.h \
+    spectrogramrefiner.h
 
 SOURCES += \
     ../../waveformdata.cpp \
     ../../spectrogramdata.cpp \
-    ../../dataentrydialog.cpp \
-    spectrogram.cpp
+    spectrogram.cpp \
+    spectrogramrefiner.cpp
+
+OTHER_FILES += spectrogram.json
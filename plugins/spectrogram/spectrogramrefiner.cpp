@@ -0,0 +1,221 @@
+#include "spectrogramrefiner.h"
+
+#include <spectrogramdata.h>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtDebug>
+
+#include <math.h>
+#include <stdlib.h>
+
+namespace {
+
+//! \brief FFTW plans may only be created and destroyed by one thread at a time
+QMutex *planMutex()
+{
+    static QMutex mutex;
+    return &mutex;
+}
+
+}
+
+FrameAnalyser::FrameAnalyser(size_t windowLength) :
+    mWindowLength(windowLength)
+{
+    // Gaussian window
+    mFilter = (double*)malloc(sizeof(double)*mWindowLength);
+    double wls = mWindowLength;
+    for(size_t i=0; i<mWindowLength; i++)
+    {
+        double n = (-1*wls/2) + i;
+        mFilter[i] = exp( -0.5 * (2.5*n / (wls/2))*(2.5*n / (wls/2)) );
+    }
+
+    mIn = (double*)fftw_malloc(sizeof(double)*mWindowLength);
+    mOut = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*mWindowLength);
+
+    QMutexLocker locker( planMutex() );
+    mPlan = fftw_plan_dft_r2c_1d(mWindowLength, mIn, mOut, FFTW_ESTIMATE);
+}
+
+FrameAnalyser::~FrameAnalyser()
+{
+    {
+        QMutexLocker locker( planMutex() );
+        fftw_destroy_plan(mPlan);
+    }
+    fftw_free(mIn);
+    fftw_free(mOut);
+    free(mFilter);
+}
+
+size_t FrameAnalyser::frequencyBins() const
+{
+    return mWindowLength / 2;
+}
+
+void FrameAnalyser::analyse(const double *samples, double *power)
+{
+    for(size_t i=0; i<mWindowLength; i++)
+        mIn[i] = samples[i] * mFilter[i];
+    fftw_execute(mPlan);
+    size_t bins = frequencyBins();
+    for(size_t i=0; i<bins; i++)
+        power[i] = mOut[i][0]*mOut[i][0] + mOut[i][1]*mOut[i][1];
+}
+
+SpectrogramRefiner::SpectrogramRefiner(SpectrogramData *data, const QVector<double> &samples, size_t firstSample, size_t timeStep, size_t windowLength, int coarseStep, double logMinimum, double maximum) :
+    QObject(data),
+    mData(data),
+    maSamples(samples),
+    mFirstSample(firstSample),
+    mTimeStep(timeStep),
+    mWindowLength(windowLength),
+    mFrequencyBins(windowLength / 2),
+    mFrames(data->getNTimeSteps()),
+    mCoarseStep(coarseStep),
+    mLogMinimum(logMinimum),
+    mMaximum(maximum),
+    mTasks(&mCancel)
+{
+    maDistance.resize(mFrames);
+    for(quint32 i=0; i<mFrames; i++)
+        maDistance[i] = i % mCoarseStep;
+
+    for(int step = mCoarseStep/2; step >= 1; step /= 2)
+        maCursor << step;
+
+    if( mFrequencyBins != mData->getNFrequencyBins() )
+    {
+        qDebug() << "SpectrogramRefiner: the spectrogram does not have" << mFrequencyBins << "frequency bins, so it cannot be refined";
+        return;
+    }
+
+    mData->setRefining(true);
+
+    // start once the spectrogram has reached the thread it will be drawn on
+    QMetaObject::invokeMethod(this, "next", Qt::QueuedConnection);
+}
+
+SpectrogramRefiner::~SpectrogramRefiner()
+{
+    mCancel.cancel();
+    waitForTasks(&mTasks);
+}
+
+int SpectrogramRefiner::coarseStep(size_t nFrames)
+{
+    int step = 1;
+    while( step < MaximumCoarseStep && nFrames / step > CoarseFrames )
+        step *= 2;
+    return step;
+}
+
+void SpectrogramRefiner::next()
+{
+    if( !chooseBatch() ) { mData->setRefining(false); return; }
+    QVector<quint32> batch = maBatch;
+    runTask(&mTasks, [this,batch]() {
+        maValues = analyse(batch);
+        // queued, so that apply() runs on the thread of the refiner, once the spectrogram has been moved to the GUI thread
+        QMetaObject::invokeMethod(this, "apply", Qt::QueuedConnection);
+    });
+}
+
+void SpectrogramRefiner::apply()
+{
+    QVector<double> values = maValues;
+    maValues.clear();
+    // the values will not get any better, so data computed from them need not wait
+    if( values.count() != maBatch.count() * (int)mFrequencyBins ) { mData->setRefining(false); return; }
+
+    quint32 low = mFrames, high = 0;
+    for(int k=0; k<maBatch.count(); k++)
+    {
+        const double *frame = values.constData() + k*mFrequencyBins;
+        quint32 i = maBatch.at(k);
+
+        // the frame itself, and the frames after it that show a frame further away
+        quint32 j;
+        for(j=i; j<mFrames; j++)
+        {
+            int distance = j - i;
+            if( maDistance.at(j) <= distance && j != i ) { break; }
+            maDistance[j] = distance;
+            mData->setFrame(j, frame);
+        }
+        low = qMin(low, i);
+        high = qMax(high, j-1);
+    }
+    mData->announceChange( mData->getTimeFromIndex(low), mData->getTimeFromIndex(high) );
+
+    next();
+}
+
+bool SpectrogramRefiner::chooseBatch()
+{
+    maBatch.clear();
+
+    // the region of interest first, coarsest spacing first
+    double start = mData->regionOfInterestStart();
+    double end = mData->regionOfInterestEnd();
+    double origin = mData->getTimeFromIndex(0);
+    double step = mData->getTimeStep();
+    if( end > start && step > 0 )
+    {
+        double first = floor( (start - origin) / step );
+        double last = ceil( (end - origin) / step );
+        if( last >= 0 && first < mFrames )
+        {
+            // from the computed frame that the first frame in view shows
+            quint32 from = (quint32)qMax( 0.0, first );
+            from -= from % mCoarseStep;
+            quint32 to = (quint32)qMin( (double)mFrames-1, last );
+            for(int spacing = mCoarseStep/2; spacing >= 1 && maBatch.isEmpty(); spacing /= 2)
+                collect(spacing, from, to);
+            if( !maBatch.isEmpty() ) { return true; }
+        }
+    }
+
+    // then the rest, coarsest spacing first
+    int level = 0;
+    for(int spacing = mCoarseStep/2; spacing >= 1; spacing /= 2, level++)
+    {
+        quint32 &cursor = maCursor[level];
+        while( cursor < mFrames && maBatch.count() < BatchSize )
+        {
+            if( maDistance.at(cursor) != 0 )
+                maBatch << cursor;
+            cursor += 2*spacing;
+        }
+        if( !maBatch.isEmpty() ) { return true; }
+    }
+    return false;
+}
+
+void SpectrogramRefiner::collect(int step, quint32 first, quint32 last)
+{
+    // the frames that are new at this spacing are the odd multiples of it
+    for(quint32 i = ((first + step - 1) / step) * step; i <= last && maBatch.count() < BatchSize; i += step)
+    {
+        if( (i / step) % 2 == 1 && maDistance.at(i) != 0 )
+            maBatch << i;
+    }
+}
+
+QVector<double> SpectrogramRefiner::analyse(QVector<quint32> frames) const
+{
+    FrameAnalyser analyser(mWindowLength);
+    QVector<double> values( frames.count() * mFrequencyBins );
+    for(int k=0; k<frames.count(); k++)
+    {
+        if( mCancel.isCancelled() ) { return QVector<double>(); }
+        analyser.analyse( maSamples.constData() + mFirstSample + frames.at(k) * mTimeStep, values.data() + k*mFrequencyBins );
+    }
+
+    // on the same scale as the frames computed by the plugin, and within the range they span
+    for(int i=0; i<values.count(); i++)
+        values[i] = qBound( 0.0, log( values.at(i) ) - mLogMinimum, mMaximum );
+    return values;
+}
@@ -0,0 +1,121 @@
+/*!
+  \class FrameAnalyser
+  \ingroup Plugin
+  \brief Computes the power spectrum of one Gaussian-windowed frame of a waveform at a time.
+
+  The FFTW plan is created when the object is constructed. Creating plans is not thread-safe in FFTW, so plans are created one at a time; executing them is safe, so each thread may use its own FrameAnalyser.
+*/
+
+/*!
+  \class SpectrogramRefiner
+  \ingroup Plugin
+  \brief Fills in a coarse spectrogram in the background, frame by frame, until every time step has been computed.
+
+  SpectrogramPlugin computes only every coarseStep()-th frame of a progressive spectrogram, and shows each computed frame in place of the frames that follow it. The refiner then computes the missing frames in batches, each as a task of the application's task scheduler, halving the spacing of the computed frames with each pass, so that the whole spectrogram sharpens evenly. Frames in the region of interest of the spectrogram (the part that is on display; see SpectrogramData::setRegionOfInterest()) are refined completely before any others.
+
+  Each batch is copied into the spectrogram on the GUI thread, which then announces the time range that has changed, so that only the plots that show it are redrawn. The spectrogram is marked as refining until the last batch has been copied (see SpectrogramData::setRefining()). The refiner is a child of the spectrogram, so refinement stops when the spectrogram is deleted, e.g., when its sound is closed; the batch that is being computed then is cancelled.
+*/
+
+#ifndef SPECTROGRAMREFINER_H
+#define SPECTROGRAMREFINER_H
+
+#include <QObject>
+#include <QVector>
+#include <interfaces.h>
+
+#include <fftw3.h>
+
+class SpectrogramData;
+
+class FrameAnalyser
+{
+public:
+    //! \brief Prepare to analyse frames of \a windowLength samples
+    FrameAnalyser(size_t windowLength);
+    ~FrameAnalyser();
+
+    //! \brief Return the number of frequency bins of each spectrum
+    size_t frequencyBins() const;
+
+    //! \brief Write the power spectrum of the \a windowLength samples at \a samples to \a power, which has room for frequencyBins() values
+    void analyse(const double *samples, double *power);
+
+private:
+    size_t mWindowLength;
+    double *mFilter;
+    double *mIn;
+    fftw_complex *mOut;
+    fftw_plan mPlan;
+
+    FrameAnalyser(const FrameAnalyser &);
+    FrameAnalyser &operator=(const FrameAnalyser &);
+};
+
+class SpectrogramRefiner : public QObject
+{
+    Q_OBJECT
+public:
+    //! \brief The number of frames computed on a worker thread at once
+    enum { BatchSize = 64 };
+
+    //! \brief The number of frames that are computed before a progressive spectrogram is shown
+    enum { CoarseFrames = 1024 };
+
+    //! \brief The greatest spacing of the frames computed at first
+    enum { MaximumCoarseStep = 64 };
+
+    //! \brief Refine \a data, whose every \a coarseStep-th frame has been computed
+    /*!
+      \param samples The samples of the waveform (implicitly shared, so they are not copied)
+      \param firstSample The sample at which the first frame starts
+      \param timeStep The number of samples between the starts of successive frames
+      \param windowLength The number of samples in a frame
+      \param logMinimum The logarithm of the power that has the value zero in \a data
+      \param maximum The largest value in \a data. Refined values are clamped to the range from zero to \a maximum, which the frames computed at first span, so that a frame that is quieter or louder than any of those (or silent, which would give minus infinity) does not fall outside the data range of the spectrogram.
+      */
+    SpectrogramRefiner(SpectrogramData *data, const QVector<double> &samples, size_t firstSample, size_t timeStep, size_t windowLength, int coarseStep, double logMinimum, double maximum);
+    ~SpectrogramRefiner();
+
+    //! \brief Return the spacing of the frames to compute at first for a spectrogram of \a nFrames frames: a power of two that leaves no more than CoarseFrames frames, or 1 if the spectrogram is small enough to compute at once
+    static int coarseStep(size_t nFrames);
+
+private slots:
+    //! \brief Start computing the next batch of frames, if any are left
+    void next();
+
+    //! \brief Copy the batch that has been computed into the spectrogram
+    void apply();
+
+private:
+    //! \brief Choose the next frames to compute, and put them in maBatch. Return false if every frame has been computed.
+    bool chooseBatch();
+
+    //! \brief Add the frames of spacing \a step between \a first and \a last (inclusive) that have not been computed to maBatch
+    void collect(int step, quint32 first, quint32 last);
+
+    //! \brief Return the values of the frames \a frames, one frame after another, or fewer values if the refinement is cancelled. This runs on a worker thread.
+    QVector<double> analyse(QVector<quint32> frames) const;
+
+    SpectrogramData *mData;
+    QVector<double> maSamples;
+    size_t mFirstSample, mTimeStep, mWindowLength, mFrequencyBins;
+    quint32 mFrames;
+    int mCoarseStep;
+    double mLogMinimum, mMaximum;
+
+    //! \brief For each frame, the distance to the computed frame whose values it has (0 for a computed frame)
+    QVector<int> maDistance;
+
+    //! \brief For each spacing, the first frame that may not have been computed yet (outside the region of interest)
+    QVector<quint32> maCursor;
+
+    QVector<quint32> maBatch;
+
+    //! \brief The values of maBatch, written by the task that computes them before it invokes apply()
+    QVector<double> maValues;
+
+    CancellationToken mCancel;
+    TaskGroup mTasks;
+};
+
+#endif // SPECTROGRAMREFINER_H
@@ -1,8 +1,7 @@
-#include <QtGui>
+#include <QtCore>
 #include <QtDebug>
 
 #include "unary.h"
-#include "dataentrydialog.h"
 
 #include <waveformdata.h>
 
@@ -40,11 +39,6 @@ UnaryPlugin* UnaryPlugin::copy() const
     return new UnaryPlugin();
 }
 
-void UnaryPlugin::settings(int i)
-{
-    Q_UNUSED(i);
-}
-
 void UnaryPlugin::calculate(QString name, WaveformData *data)
 {
     int index = pluginnames.indexOf(name);
@@ -91,10 +85,3 @@ void UnaryPlugin::calculate(int index, WaveformData *data)
 
     emit waveformCreated(new WaveformData(suggested_label, times, values, nframes, samplingFreq));
 }
-
-void UnaryPlugin::setParameter(QString label, QVariant value)
-{
-    Q_UNUSED(label);
-    Q_UNUSED(value);
-}
-
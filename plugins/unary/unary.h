@@ -14,7 +14,7 @@ class UnaryPlugin : public AbstractWaveform2WaveformMeasure
 {
     Q_OBJECT
     Q_INTERFACES(AbstractWaveform2WaveformMeasure)
-    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractwaveform2spectrogrammeasure/1.0")
+    Q_PLUGIN_METADATA(IID "acousticworkspace.qt.abstractwaveform2waveformmeasure/1.0" FILE "unary.json")
 
 public:
     UnaryPlugin();
@@ -24,18 +24,13 @@ public slots:
     QString name() const;
     QString scriptName() const;
     QStringList names() const;
-    void settings(int i);
     void calculate(int index, WaveformData *data);
     void calculate(QString name, WaveformData *data);
-    void setParameter(QString label, QVariant value);
 
 private:
     WaveformData *sound;
 
     QStringList pluginnames;
-
-    QStringList settingsLabels;
-    QList<QVariant> settingsValues;
 };
 
 #endif
@@ -0,0 +1,191 @@
+#include "projectwriter.h"
+#include "interfaces.h"
+
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QXmlStreamReader>
+#include <QtDebug>
+
+#include <limits>
+
+ProjectWriter::ProjectWriter(const QString &filename, QObject *parent) :
+    QObject(parent),
+    mFilename(filename),
+    mCompression(BlockCodec::Uncompressed),
+    mCompleted(0)
+{
+    // never write over the binary file that the project on disk refers to
+    QString base = QFileInfo(filename).completeBaseName();
+    mPreviousBinaryFileName = referencedBinaryFile(filename);
+    if( mPreviousBinaryFileName == base + ".bin" )
+        mBinaryFileName = base + ".1.bin";
+    else
+        mBinaryFileName = base + ".bin";
+}
+
+ProjectWriter::~ProjectWriter()
+{
+    waitForTasks(&mTasks);
+}
+
+QString ProjectWriter::binaryFileName() const
+{
+    return mBinaryFileName;
+}
+
+void ProjectWriter::addBlock(const QList<QVector<double> > &arrays)
+{
+    Block block;
+    block.arrays = arrays;
+    block.ok = true;
+    block.values = 0;
+    block.count = 0;
+    maBlocks << block;
+}
+
+void ProjectWriter::addBlock(const double *values, quint64 n, const QSharedPointer<QObject> &owner)
+{
+    Block block;
+    block.ok = true;
+    block.values = values;
+    block.count = n;
+    block.owner = owner;
+    maBlocks << block;
+}
+
+void ProjectWriter::setCompression(BlockCodec::Compression compression)
+{
+    mCompression = compression;
+}
+
+void ProjectWriter::setXml(const QByteArray &xml)
+{
+    mXml = xml;
+}
+
+void ProjectWriter::start()
+{
+    runTask(&mTasks, [this]() {
+        bool success = write();
+        QMetaObject::invokeMethod(this, "done", Qt::QueuedConnection, Q_ARG(bool, success));
+    });
+}
+
+QString ProjectWriter::referencedBinaryFile(const QString &filename)
+{
+    QFile file(filename);
+    if( !file.open(QFile::ReadOnly | QFile::Text) )
+        return QString();
+
+    // the reference is an attribute of the root element, so only the start of the file is read
+    QXmlStreamReader xml(&file);
+    while( !xml.atEnd() )
+    {
+        if( xml.readNext() == QXmlStreamReader::StartElement )
+        {
+            QString name = xml.attributes().value("binary-file").toString();
+            if( name.isEmpty() ) // projects from before the attribute was introduced
+                name = QFileInfo(filename).completeBaseName() + ".bin";
+            return name;
+        }
+    }
+    return QString();
+}
+
+bool ProjectWriter::serialise(Block &block, BlockCodec::Compression compression)
+{
+    if( block.values != 0 ) { return true; }
+
+    bool ok = true;
+    for(int i=0; i<block.arrays.count() && ok; i++)
+    {
+        QByteArray bytes = BlockCodec::encode( block.arrays.at(i).constData(), block.arrays.at(i).count(), compression, &ok );
+        // a QByteArray holds less than 2 GB
+        if( ok && (qint64)block.bytes.size() + bytes.size() > std::numeric_limits<int>::max() ) { ok = false; }
+        if( ok ) { block.bytes.append(bytes); }
+    }
+
+    // the arrays are not needed anymore; release this writer's reference to them
+    block.arrays.clear();
+    if( !ok ) { block.bytes.clear(); }
+    return ok;
+}
+
+void ProjectWriter::stepCompleted()
+{
+    // every block is serialised and then written, and the two files are committed
+    int total = 2 * maBlocks.count() + 2;
+    emit progress( 100 * (mCompleted.fetchAndAddRelaxed(1) + 1) / total );
+}
+
+bool ProjectWriter::write()
+{
+    QDir directory = QFileInfo(mFilename).absoluteDir();
+
+    parallelMap(maBlocks, [this](Block &block) {
+        block.ok = ProjectWriter::serialise(block, mCompression);
+        stepCompleted();
+    });
+    for(int i=0; i<maBlocks.count(); i++)
+    {
+        if( !maBlocks.at(i).ok )
+        {
+            mError = tr("Some of the data take up more than 2 GB in the binary file, which is more than can be written at once. Saving with compression may help.");
+            return false;
+        }
+    }
+
+    QSaveFile binaryfile( directory.filePath(mBinaryFileName) );
+    if( !binaryfile.open(QIODevice::WriteOnly) )
+    {
+        mError = tr("The file %1 could not be opened for writing: %2").arg(binaryfile.fileName()).arg(binaryfile.errorString());
+        return false;
+    }
+    for(int i=0; i<maBlocks.count(); i++)
+    {
+        const Block &block = maBlocks.at(i);
+        bool written;
+        if( block.values != 0 )
+            written = BlockCodec::encode(&binaryfile, block.values, block.count, mCompression);
+        else
+            written = binaryfile.write( block.bytes ) == block.bytes.size();
+        if( !written )
+        {
+            mError = tr("There was an error writing to %1: %2").arg(binaryfile.fileName()).arg(binaryfile.errorString());
+            binaryfile.cancelWriting();
+            return false;
+        }
+        maBlocks[i].bytes.clear();
+        maBlocks[i].owner.clear();
+        stepCompleted();
+    }
+    if( !binaryfile.commit() )
+    {
+        mError = tr("The file %1 could not be saved: %2").arg(binaryfile.fileName()).arg(binaryfile.errorString());
+        return false;
+    }
+    stepCompleted();
+
+    // committing the XML file is what switches the project over to the new binary file
+    QSaveFile xmlfile(mFilename);
+    if( !xmlfile.open(QIODevice::WriteOnly | QIODevice::Text) || xmlfile.write(mXml) != mXml.size() || !xmlfile.commit() )
+    {
+        mError = tr("The file %1 could not be saved: %2").arg(mFilename).arg(xmlfile.errorString());
+        return false;
+    }
+    stepCompleted();
+
+    if( !mPreviousBinaryFileName.isEmpty() && mPreviousBinaryFileName != mBinaryFileName )
+        QFile::remove( directory.filePath(mPreviousBinaryFileName) );
+
+    return true;
+}
+
+void ProjectWriter::done(bool success)
+{
+    if( !success )
+        qDebug() << mError;
+    emit finished(success, mError);
+    deleteLater();
+}
@@ -0,0 +1,102 @@
+/*!
+  \class ProjectWriter
+  \ingroup Data
+  \brief Writes a project (the XML file and its binary sidecar) in the background.
+
+  Sound::writeProjectToFile() builds the XML description on the GUI thread, which is quick, and hands the numerical data to a ProjectWriter as blocks of arrays. Waveform samples are held in implicitly shared QVector objects, so adding them is a reference-count increment rather than a copy; the data stay valid even if the project changes or is closed while the save is running.
+
+  The arrays may be compressed; see BlockCodec. start() serialises the blocks in parallel and then writes them, in order, to a temporary file. The values of an out-of-core spectrogram are not serialised beforehand, but are encoded a few blocks at a time while they are written, straight from the file they are mapped from. Both files are written with QSaveFile, which syncs the data to disk before renaming the temporary file into place. The binary data never overwrite the binary file that the existing project refers to: the writer alternates between two file names, and the XML file, which is committed last, names the one that belongs to it. A crash at any point therefore leaves either the old project or the new one intact.
+
+  The object deletes itself after emitting finished().
+*/
+
+#ifndef PROJECTWRITER_H
+#define PROJECTWRITER_H
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QByteArray>
+#include <QString>
+#include <QSharedPointer>
+
+#include "blockcodec.h"
+#include "interfaces.h"
+
+class ProjectWriter : public QObject
+{
+    Q_OBJECT
+public:
+    //! \brief Create a writer for the project file \a filename
+    ProjectWriter(const QString &filename, QObject *parent = 0);
+    ~ProjectWriter();
+
+    //! \brief Return the name of the binary file that the project will refer to, relative to the directory of the project file
+    QString binaryFileName() const;
+
+    //! \brief Append a block to the binary file, consisting of the arrays in \a arrays, one after another, each encoded with BlockCodec::encode()
+    void addBlock(const QList< QVector<double> > &arrays);
+
+    //! \brief Append a block to the binary file, consisting of the \a n values at \a values, which are encoded as they are written rather than copied beforehand
+    /*!
+      This is for values in a file that is mapped into memory, which may be too large to copy (see SpectrogramData::backingFile()). \a owner keeps the values valid; the writer holds a reference to it until they have been written.
+      */
+    void addBlock(const double *values, quint64 n, const QSharedPointer<QObject> &owner);
+
+    //! \brief Set how the arrays are stored in the binary file. The default is BlockCodec::Uncompressed.
+    void setCompression(BlockCodec::Compression compression);
+
+    //! \brief Set the contents of the XML file
+    void setXml(const QByteArray &xml);
+
+    //! \brief Start writing in the background, as a task of the application's task scheduler. No blocks may be added after this.
+    void start();
+
+    //! \brief Return the name of the binary file that the project file \a filename refers to, or an empty string if there is no such project file
+    static QString referencedBinaryFile(const QString &filename);
+
+signals:
+    //! \brief Reports progress of the save, in percent
+    void progress(int percent);
+
+    //! \brief Emitted when the save has finished. If \a success is false, \a error describes the problem, and the previous version of the project is unchanged.
+    void finished(bool success, const QString &error);
+
+private slots:
+    void done(bool success);
+
+private:
+    //! \brief One block of the binary file
+    struct Block
+    {
+        QList< QVector<double> > arrays;
+        QByteArray bytes;
+        bool ok;
+
+        //! \brief Values that are encoded as they are written, instead of arrays, or 0
+        const double *values;
+        quint64 count;
+        QSharedPointer<QObject> owner;
+    };
+
+    //! \brief Serialise and write everything; runs on a worker thread
+    bool write();
+
+    //! \brief Fill \a block.bytes from \a block.arrays, encoding them with \a compression. Returns false if the encoded block would be too large. Blocks of values that are encoded as they are written are left as they are.
+    static bool serialise(Block &block, BlockCodec::Compression compression);
+
+    QString mFilename;
+    QString mBinaryFileName;
+    QString mPreviousBinaryFileName;
+    QByteArray mXml;
+    BlockCodec::Compression mCompression;
+    QList<Block> maBlocks;
+    QString mError;
+    QAtomicInt mCompleted;
+    TaskGroup mTasks;
+
+    //! \brief Count one more completed step, and report the progress
+    void stepCompleted();
+};
+
+#endif // PROJECTWRITER_H
@@ -7,14 +7,17 @@
 #include <gsl/gsl_multifit.h>
 #include <gsl/gsl_statistics_double.h>
 
-#include <qwt_plot.h>
-#include <qwt_plot_curve.h>
+#include "waveformdata.h"
+#include "spectrogramdata.h"
 
-#include <QtWidgets>
 #include <QtDebug>
 #include <QTime>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QDataStream>
+#include <QTextStream>
+#include <QRegExp>
 
 InteractionEffect::InteractionEffect()
 {
@@ -66,17 +69,15 @@ void RegressionModel::setDependentSpectrogram(SpectrogramData *dep)
     mSpectrogramMode = true;
 }
 
-void RegressionModel::addDependentVariables(QList<RegressionListItem*> dep)
+void RegressionModel::addDependentVariables(const QList<WaveformData *> &dep)
 {
-    for(int i=0; i<dep.count(); i++)
-	mDependent.append(dep.at(i)->data());
+    mDependent.append(dep);
     mSpectrogramMode = false;
 }
 
-void RegressionModel::addIndependentVariables(QList<RegressionListItem*> simple, QList<RegressionInteractionListItem*> interaction)
+void RegressionModel::addIndependentVariables(const QList<WaveformData *> &simple, const QList<InteractionEffect *> &interaction)
 {
-    for(int i=0; i<simple.count(); i++)
-    mSimple.append(simple.at(i)->data());
+    mSimple.append(simple);
 
     // make sure that redundant items aren't added
     for(int i=0; i<interaction.count(); i++)
@@ -84,20 +85,22 @@ void RegressionModel::addIndependentVariables(QList<RegressionListItem*> simple,
 	bool redundant = false;
 	for(int j=0; j<mInteraction.count(); j++)
 	{
-        if( mInteraction.at(j)->members == interaction.at(i)->interaction()->members )
+        if( mInteraction.at(j)->members == interaction.at(i)->members )
 	    {
 		redundant = true;
 		break;
 	    }
 	}
 	if(!redundant)
-        mInteraction.append(interaction.at(i)->interaction());
+        mInteraction.append(interaction.at(i));
     }
 }
 
-void RegressionModel::fit()
+bool RegressionModel::fit()
 {
-    if( (!mSpectrogramMode && mDependent.count() == 0) || (mSimple.count() + mInteraction.count())==0 ) { return; }
+    mSummary.clear();
+    maRSquared.clear();
+    if( (!mSpectrogramMode && mDependent.count() == 0) || (mSimple.count() + mInteraction.count())==0 ) { return false; }
 
     int nrow;
     if(mSpectrogramMode)
@@ -166,7 +169,7 @@ void RegressionModel::fit()
 
     if(mSpectrogramMode)
     {
-	double *rsq = (double*)malloc(sizeof(double)*mDependentSpectrogram->getNFrequencyBins());
+	maRSquared.resize(mDependentSpectrogram->getNFrequencyBins());
 
 	output += "Freq.Bin\tR-squared\tRSS\tTSS\n";
 	for(quint32 i=0; i< mDependentSpectrogram->getNFrequencyBins(); i++ )
@@ -178,25 +181,10 @@ void RegressionModel::fit()
 
 	    double TSS = gsl_stats_tss(mDependentSpectrogram->pdata()+i,mDependentSpectrogram->getNFrequencyBins(),mDependentSpectrogram->getNTimeSteps());
 	    double RSS = gsl_stats_tss(residuals->data,1,nrow);
-	    *(rsq+i) = 1- RSS/TSS;
+	    maRSquared[i] = 1- RSS/TSS;
 
-	    output += QString::number(mDependentSpectrogram->getFrequencyFromIndex(i)) + "\t" + QString::number(*(rsq+i)) + "\t" + QString::number(RSS) + "\t" + QString::number(TSS) + "\n";
+	    output += QString::number(mDependentSpectrogram->getFrequencyFromIndex(i)) + "\t" + QString::number(maRSquared.at(i)) + "\t" + QString::number(RSS) + "\t" + QString::number(TSS) + "\n";
 	}
-
-	QwtPlot *qwtPlot = new QwtPlot;
-	qwtPlot->enableAxis(QwtPlot::yLeft);
-	QwtPlotCurve *waveCurve = new QwtPlotCurve("dummy");
-	waveCurve->setRenderHint(QwtPlotItem::RenderAntialiased);
-	waveCurve->setPen(QPen(Qt::blue));
-    waveCurve->setSamples(mDependentSpectrogram->pfrequencies(),rsq,mDependentSpectrogram->getNFrequencyBins());
-	waveCurve->attach(qwtPlot);
-
-	qwtPlot->setWindowTitle("R-squared values");
-	qwtPlot->setWindowFlags(Qt::Window);
-	qwtPlot->show();
-
-
-	free(rsq);
     }
     else
     {
@@ -219,20 +207,27 @@ void RegressionModel::fit()
 	}
     }
 
-    QTextEdit *edit = new QTextEdit;
-    edit->setText(output);
-    edit->setWindowTitle("Results summary");
-    edit->setWindowFlags(Qt::Window);
-    edit->show();
+    mSummary = output;
 
     gsl_matrix_free(cov);
     gsl_matrix_free(independent);
     gsl_vector_free(estimate);
     gsl_vector_free(residuals);
     gsl_multifit_linear_free(workspace);
+    return true;
 }
 
-void RegressionModel::R()
+QString RegressionModel::summary() const
+{
+    return mSummary;
+}
+
+QVector<double> RegressionModel::rSquared() const
+{
+    return maRSquared;
+}
+
+QString RegressionModel::R()
 {
     QString originalWorkingDirectory = QDir::current().absolutePath();
     QDir dir = QDir::current();
@@ -254,7 +249,7 @@ void RegressionModel::R()
 	code += mDependentSpectrogram->safeName() + " <- readBin(con='"+info.absoluteFilePath()+"', what=double(), n = "+QString::number(mDependentSpectrogram->getNTimeSteps()*mDependentSpectrogram->getNFrequencyBins())+", size = 4);\n";
 	code += mDependentSpectrogram->safeName() + " <- matrix(data = "+mDependentSpectrogram->safeName()+", nrow = "+QString::number(mDependentSpectrogram->getNFrequencyBins())+", ncol = "+QString::number(mDependentSpectrogram->getNTimeSteps())+", byrow = F);\n";
 
-	if( file.open(QIODevice::WriteOnly) == false ) { qCritical() << "Error opening " + mDependentSpectrogram->safeName(); return; }
+	if( file.open(QIODevice::WriteOnly) == false ) { qCritical() << "Error opening " + mDependentSpectrogram->safeName(); QDir::setCurrent(originalWorkingDirectory); return QString(); }
 	QDataStream out(&file);
 	out.setByteOrder(QDataStream::LittleEndian);
 	out.setFloatingPointPrecision(QDataStream::SinglePrecision);
@@ -274,7 +269,7 @@ void RegressionModel::R()
 
 	    code += mDependent.at(i)->safeName() + " <- readBin(con='"+info.absoluteFilePath()+"', what=double(), n = "+QString::number(mDependent.at(i)->getNSamples())+", size = 4);\n";
 
-	    if( file.open(QIODevice::WriteOnly) == false ) { qCritical() << "Error opening " + mDependent.at(i)->safeName(); return; }
+	    if( file.open(QIODevice::WriteOnly) == false ) { qCritical() << "Error opening " + mDependent.at(i)->safeName(); QDir::setCurrent(originalWorkingDirectory); return QString(); }
 	    QDataStream out(&file);
 	    out.setByteOrder(QDataStream::LittleEndian);
 	    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
@@ -295,7 +290,7 @@ void RegressionModel::R()
 
 	code += mSimple.at(i)->safeName() + " <- readBin(con='"+info.absoluteFilePath()+"', what=double(), n = "+QString::number(mSimple.at(i)->getNSamples())+", size = 4);\n";
 
-	if( file.open(QIODevice::WriteOnly) == false ) { qCritical() << "Error opening " + mSimple.at(i)->safeName(); return; }
+	if( file.open(QIODevice::WriteOnly) == false ) { qCritical() << "Error opening " + mSimple.at(i)->safeName(); QDir::setCurrent(originalWorkingDirectory); return QString(); }
 	QDataStream out(&file);
 	out.setByteOrder(QDataStream::LittleEndian);
 	out.setFloatingPointPrecision(QDataStream::SinglePrecision);
@@ -339,18 +334,13 @@ void RegressionModel::R()
     }
 
     QFile file("code.RCode");
-    if( file.open(QIODevice::WriteOnly) == false ) { qCritical() << "Error opening code.RCode"; return; }
+    if( file.open(QIODevice::WriteOnly) == false ) { qCritical() << "Error opening code.RCode"; QDir::setCurrent(originalWorkingDirectory); return QString(); }
     QTextStream out(&file);
     out << code;
     file.close();
 
-    QTextEdit *edit = new QTextEdit;
-    edit->setText(code);
-    edit->setWindowTitle("R Code");
-    edit->setWindowFlags(Qt::Window);
-    edit->show();
-
     QDir::setCurrent(originalWorkingDirectory);
+    return code;
 }
 
 void RegressionModel::setName(QString n)
@@ -2,13 +2,11 @@
 #define REGRESSION_H
 
 #include <QList>
-
-#include "regressiondialog.h"
+#include <QString>
+#include <QVector>
 
 class SpectrogramData;
 class WaveformData;
-class RegressionListItem;
-class RegressionInteractionListItem;
 
 /*!
   \class InteractionEffect
@@ -37,6 +35,8 @@ public:
   \brief A class for representing a linear regression model
 
   This class stores information needed for a linear regression model. The dependent variable can either be a set of WaveformData object or a SpectrogramData object. Independent variables must be WaveformData objects. fit() fits the regression model, and R() generates R code and data files for the model.
+
+  The class only computes; it shows nothing. After fit(), summary() and rSquared() hold the results, which RegressionDialog displays.
 */
 class RegressionModel
 {
@@ -64,23 +64,29 @@ public:
 
     //! \brief Add dependent variables to the regression.
     /*!
-      For convenience this function takes a list of pointers to RegressionListItem objects, which are used in the RegressionDialog class.
       \param dep A list of pointers to dependent variables.
       */
-    void addDependentVariables(QList<RegressionListItem*> dep);
+    void addDependentVariables(const QList<WaveformData*> &dep);
 
     //! \brief Add independent variables to the regression
     /*!
-      For convenience this function takes a list of pointers to RegressionListItem objects and RegressionInteractionListItem objects, which are used in the RegressionDialog class.
-      \param dep A list of pointers to dependent variables.
+      Interaction effects whose members are already in the model are not added again.
+      \param simple A list of pointers to simple effects.
+      \param interaction A list of pointers to interaction effects.
       */
-    void addIndependentVariables(QList<RegressionListItem*> simple, QList<RegressionInteractionListItem*> interaction);
+    void addIndependentVariables(const QList<WaveformData*> &simple, const QList<InteractionEffect*> &interaction);
 
-    //! \brief Fit the regression with FFTW routines, and display a brief summary of the results.
-    void fit();
+    //! \brief Fit the regression with GSL routines, and keep a brief summary of the results. Return false if the model has no variables to fit.
+    bool fit();
 
-    //! \brief Generate data files and R code to run the regressons externally.
-    void R();
+    //! \brief Return the summary of the results of the last fit(), as tab-delimited text
+    QString summary() const;
+
+    //! \brief Return the R-squared value of each frequency bin after the last fit(), if the dependent variable is a spectrogram
+    QVector<double> rSquared() const;
+
+    //! \brief Generate data files and R code to run the regressons externally, and return the code, or an empty string if a file could not be written.
+    QString R();
 
     QList<WaveformData*> mDependent;
     SpectrogramData *mDependentSpectrogram;
@@ -91,6 +97,9 @@ private:
     bool mInterceptTerm;
     bool mSpectrogramMode;
     QString mLabel;
+
+    QString mSummary;
+    QVector<double> maRSquared;
 };
 
 #endif // REGRESSION_H
@@ -6,6 +6,9 @@
 
 #include <gsl/gsl_combination.h>
 
+#include <qwt_plot.h>
+#include <qwt_plot_curve.h>
+
 #include "waveformdata.h"
 #include "regression.h"
 
@@ -262,6 +265,48 @@ void RegressionDialog::independentSimpleChanged(QListWidgetItem* item)
     }
 }
 
+QList<WaveformData *> RegressionDialog::dataOf(const QList<RegressionListItem *> &items)
+{
+    QList<WaveformData*> data;
+    for(int i=0; i<items.count(); i++)
+        data << items.at(i)->data();
+    return data;
+}
+
+QList<InteractionEffect *> RegressionDialog::interactionsOf(const QList<RegressionInteractionListItem *> &items)
+{
+    QList<InteractionEffect*> interactions;
+    for(int i=0; i<items.count(); i++)
+        interactions << items.at(i)->interaction();
+    return interactions;
+}
+
+void RegressionDialog::showResults(const RegressionModel *model)
+{
+    if( model->dependentIsSpectrogram() )
+    {
+        QVector<double> rsq = model->rSquared();
+
+        QwtPlot *qwtPlot = new QwtPlot;
+        qwtPlot->enableAxis(QwtPlot::yLeft);
+        QwtPlotCurve *waveCurve = new QwtPlotCurve("dummy");
+        waveCurve->setRenderHint(QwtPlotItem::RenderAntialiased);
+        waveCurve->setPen(QPen(Qt::blue));
+        waveCurve->setSamples(model->mDependentSpectrogram->pfrequencies(),rsq.constData(),rsq.size());
+        waveCurve->attach(qwtPlot);
+
+        qwtPlot->setWindowTitle("R-squared values");
+        qwtPlot->setWindowFlags(Qt::Window);
+        qwtPlot->show();
+    }
+
+    QTextEdit *edit = new QTextEdit;
+    edit->setText(model->summary());
+    edit->setWindowTitle("Results summary");
+    edit->setWindowFlags(Qt::Window);
+    edit->show();
+}
+
 void RegressionDialog::calculateRegression()
 {
     QList<RegressionListItem*> simple = checkedSimple();
@@ -274,7 +319,7 @@ void RegressionDialog::calculateRegression()
     QList<RegressionListItem*> dependent = checkedDependent();
     if(dependent.count() != 0)
     {
-	r->addDependentVariables(dependent);
+	r->addDependentVariables(dataOf(dependent));
     }
     else
     {
@@ -288,9 +333,10 @@ void RegressionDialog::calculateRegression()
 	    }
 	}
     }
-    r->addIndependentVariables(simple,interaction);
+    r->addIndependentVariables(dataOf(simple),interactionsOf(interaction));
 
-    r->fit();
+    if( r->fit() )
+        showResults(r);
 
     delete r;
 
@@ -309,7 +355,7 @@ void RegressionDialog::createRDataCode()
     QList<RegressionListItem*> dependent = checkedDependent();
     if(dependent.count() != 0)
     {
-	r->addDependentVariables(dependent);
+	r->addDependentVariables(dataOf(dependent));
     }
     else
     {
@@ -322,9 +368,17 @@ void RegressionDialog::createRDataCode()
 	    }
 	}
     }
-    r->addIndependentVariables(simple,interaction);
+    r->addIndependentVariables(dataOf(simple),interactionsOf(interaction));
 
-    r->R();
+    QString code = r->R();
+    if( !code.isEmpty() )
+    {
+        QTextEdit *edit = new QTextEdit;
+        edit->setText(code);
+        edit->setWindowTitle("R Code");
+        edit->setWindowFlags(Qt::Window);
+        edit->show();
+    }
 
     delete r;
 
@@ -345,7 +399,7 @@ void RegressionDialog::saveRegression()
     QList<RegressionListItem*> dependent = checkedDependent();
     if(dependent.count() != 0)
     {
-	r->addDependentVariables(dependent);
+	r->addDependentVariables(dataOf(dependent));
     }
     else
     {
@@ -358,7 +412,7 @@ void RegressionDialog::saveRegression()
 	    }
 	}
     }
-    r->addIndependentVariables(simple,interaction);
+    r->addIndependentVariables(dataOf(simple),interactionsOf(interaction));
 
     emit regressionObject(r);
 
@@ -125,6 +125,15 @@ private:
       */
     void addNWayInteractions(QList<RegressionListItem*> *list, int n);
 
+    //! \brief Return the waveforms of \a items
+    static QList<WaveformData*> dataOf(const QList<RegressionListItem*> &items);
+
+    //! \brief Return the interaction effects of \a items
+    static QList<InteractionEffect*> interactionsOf(const QList<RegressionInteractionListItem*> &items);
+
+    //! \brief Show the summary of the fitted \a model in a window, with a plot of the R-squared values if the dependent variable is a spectrogram
+    void showResults(const RegressionModel *model);
+
     QListWidget *mDependentList;
     QListWidget *mDependentSpectrogramList;
     QListWidget *mIndependentSimpleList;
@@ -0,0 +1,72 @@
+#include "replotscheduler.h"
+
+#include "plotviewwidget.h"
+#include "interfaces.h"
+
+ReplotScheduler::ReplotScheduler(QObject *parent) :
+    QObject(parent)
+{
+    mTimer.setSingleShot(true);
+    connect(&mTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    mSinceLastFrame.start();
+}
+
+void ReplotScheduler::schedule(PlotViewWidget *plot)
+{
+    if( !isPending(plot) )
+        maPending << plot;
+    wake();
+}
+
+bool ReplotScheduler::isPending(const PlotViewWidget *plot) const
+{
+    for(int i=0; i<maPending.count(); i++)
+        if( maPending.at(i) == plot )
+            return true;
+    return false;
+}
+
+void ReplotScheduler::wake()
+{
+    if( maPending.isEmpty() || mTimer.isActive() ) { return; }
+    // the first request after a pause is served at once; later ones wait for the next frame
+    mTimer.start( qMax( 0, (int)(FrameInterval - mSinceLastFrame.elapsed()) ) );
+}
+
+void ReplotScheduler::flush()
+{
+    mSinceLastFrame.restart();
+
+    QList< QPointer<PlotViewWidget> > pending = maPending;
+    maPending.clear();
+    QList<PlotViewWidget*> due;
+    for(int i=0; i<pending.count(); i++)
+    {
+        PlotViewWidget *plot = pending.at(i);
+        if( plot == 0 ) { continue; } // deleted in the meantime
+
+        if( isOnScreen(plot) )
+            due << plot;
+        else
+            maPending << plot;
+    }
+
+    // a single plot gains nothing from being drawn offscreen
+    if( due.count() > 1 )
+    {
+        for(int i=0; i<due.count(); i++)
+            due.at(i)->prepareCanvasImage();
+        parallelMap(due, [](PlotViewWidget *plot) {
+            plot->renderCanvasImage();
+        });
+    }
+
+    for(int i=0; i<due.count(); i++)
+        due.at(i)->replot();
+}
+
+bool ReplotScheduler::isOnScreen(const PlotViewWidget *plot)
+{
+    // the visible region is clipped by the parents, so it is empty for a plot outside the viewport of a scroll area
+    return plot->isVisible() && !plot->visibleRegion().isEmpty();
+}
@@ -0,0 +1,56 @@
+/*!
+  \class ReplotScheduler
+  \ingroup GUI
+  \brief Coalesces requests to replot the plots of a PlotDisplayAreaWidget, and carries them out at most once per display frame.
+
+  Dragging the time slider changes the time axis of every plot many times a second, and a synchronous replot for each change redraws each plot far more often than the screen can show. Instead, plots ask the scheduler for a replot (schedule()), which only marks them as pending. Once per frame (every FrameInterval milliseconds at most) the scheduler replots each pending plot once, with whatever axis settings it has by then.
+
+  Plots that are scrolled out of the viewport of the scroll area are not replotted; they stay pending, and are replotted when they become visible again (see wake()).
+
+  When several plots are due in the same frame, their items (curves and spectrograms) are drawn concurrently, each plot into an offscreen image as a task of the application's task scheduler (PlotViewWidget::renderCanvasImage()). The GUI thread waits for the images and then replots each plot, which composites its image onto the canvas rather than drawing the items again.
+*/
+
+#ifndef REPLOTSCHEDULER_H
+#define REPLOTSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class PlotViewWidget;
+
+class ReplotScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    //! \brief The minimum time between two rounds of replotting, in milliseconds (about 60 frames a second)
+    enum { FrameInterval = 16 };
+
+    explicit ReplotScheduler(QObject *parent = 0);
+
+    //! \brief Replot \a plot in the next frame. Requests for a plot that is already pending are merged.
+    void schedule(PlotViewWidget *plot);
+
+    //! \brief Return true if \a plot is waiting to be replotted
+    bool isPending(const PlotViewWidget *plot) const;
+
+public slots:
+    //! \brief Check again for pending plots that have become visible, e.g., after the scroll area has been scrolled
+    void wake();
+
+private slots:
+    //! \brief Replot the pending plots that are visible
+    void flush();
+
+private:
+    //! \brief Return true if some part of \a plot can be seen on the screen
+    static bool isOnScreen(const PlotViewWidget *plot);
+
+    QList< QPointer<PlotViewWidget> > maPending;
+    QTimer mTimer;
+    QElapsedTimer mSinceLastFrame;
+};
+
+#endif // REPLOTSCHEDULER_H
@@ -0,0 +1,63 @@
+#include "ringbuffer.h"
+
+#include <string.h>
+
+SampleRingBuffer::SampleRingBuffer(int capacity) :
+    mWritten(0),
+    mRead(0),
+    mDropped(0)
+{
+    uint size = 1;
+    while( size < (uint)qMax(capacity, 1) )
+        size *= 2;
+    maSamples.resize(size);
+    mMask = size - 1;
+}
+
+int SampleRingBuffer::capacity() const
+{
+    return maSamples.size();
+}
+
+int SampleRingBuffer::write(const double *samples, int count)
+{
+    uint written = mWritten.load();
+    uint read = mRead.loadAcquire();
+    int n = qMin( count, capacity() - (int)(written - read) );
+
+    // in at most two pieces, if the samples wrap around the end of the buffer
+    uint start = written & mMask;
+    int first = qMin( n, capacity() - (int)start );
+    memcpy( maSamples.data() + start, samples, sizeof(double)*first );
+    memcpy( maSamples.data(), samples + first, sizeof(double)*(n - first) );
+
+    mWritten.storeRelease( written + n );
+    if( n < count )
+        mDropped.fetchAndAddRelaxed( count - n );
+    return n;
+}
+
+int SampleRingBuffer::read(double *samples, int maxCount)
+{
+    uint written = mWritten.loadAcquire();
+    uint read = mRead.load();
+    int n = qMin( maxCount, (int)(written - read) );
+
+    uint start = read & mMask;
+    int first = qMin( n, capacity() - (int)start );
+    memcpy( samples, maSamples.constData() + start, sizeof(double)*first );
+    memcpy( samples + first, maSamples.constData(), sizeof(double)*(n - first) );
+
+    mRead.storeRelease( read + n );
+    return n;
+}
+
+int SampleRingBuffer::available() const
+{
+    return (int)( (uint)mWritten.loadAcquire() - (uint)mRead.loadAcquire() );
+}
+
+int SampleRingBuffer::dropped() const
+{
+    return mDropped.load();
+}
@@ -0,0 +1,51 @@
+/*!
+  \class SampleRingBuffer
+  \ingroup Data
+  \brief A lock-free ring buffer of samples, for one thread that writes and one thread that reads.
+
+  The buffer passes audio from a source thread (e.g., StreamSource) to the thread that analyses it (StreamingAnalyser) without either of them ever waiting for the other. Each side only advances its own counter, and publishes it with release semantics once the samples it covers have been written or read. The counters count every sample that has passed through the buffer, and wrap around harmlessly, since only their difference is used.
+
+  If the reader falls behind and the buffer fills up, the samples that do not fit are dropped, as an audio device drops them, and counted (see dropped()).
+*/
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QVector>
+#include <QAtomicInt>
+
+class SampleRingBuffer
+{
+public:
+    //! \brief Create a buffer with room for at least \a capacity samples. The capacity is rounded up to a power of two.
+    explicit SampleRingBuffer(int capacity);
+
+    //! \brief Return the number of samples the buffer can hold
+    int capacity() const;
+
+    //! \brief Write up to \a count samples from \a samples, and return the number written. Call this from the writing thread only.
+    int write(const double *samples, int count);
+
+    //! \brief Read up to \a maxCount samples into \a samples, and return the number read. Call this from the reading thread only.
+    int read(double *samples, int maxCount);
+
+    //! \brief Return the number of samples that can be read
+    int available() const;
+
+    //! \brief Return the number of samples that have been dropped because the buffer was full
+    int dropped() const;
+
+private:
+    QVector<double> maSamples;
+    uint mMask;
+
+    //! \brief The number of samples written and read so far, modulo 2^32
+    QAtomicInt mWritten, mRead;
+
+    QAtomicInt mDropped;
+
+    SampleRingBuffer(const SampleRingBuffer &);
+    SampleRingBuffer &operator=(const SampleRingBuffer &);
+};
+
+#endif // RINGBUFFER_H
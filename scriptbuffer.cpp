@@ -0,0 +1,431 @@
+#include "scriptbuffer.h"
+
+#include <QScriptEngine>
+#include <QScriptContext>
+#include <QScriptString>
+
+#include <limits>
+#include <math.h>
+
+Q_DECLARE_METATYPE(QVector<double>*)
+
+namespace {
+
+typedef double (*ElementFunction)(double);
+typedef double (*Reduction)(const double *values, int n);
+
+double square(double x) { return x * x; }
+double negate(double x) { return -x; }
+double absolute(double x) { return fabs(x); }
+double squareRoot(double x) { return sqrt(x); }
+double naturalLog(double x) { return log(x); }
+double commonLog(double x) { return log10(x); }
+double exponential(double x) { return exp(x); }
+
+//! \brief Return the native function called \a name, or 0 if there is none
+ElementFunction elementFunction(const QString &name)
+{
+    if( name == "abs" ) { return absolute; }
+    if( name == "sqrt" ) { return squareRoot; }
+    if( name == "log" ) { return naturalLog; }
+    if( name == "log10" ) { return commonLog; }
+    if( name == "exp" ) { return exponential; }
+    if( name == "square" ) { return square; }
+    if( name == "negate" ) { return negate; }
+    return 0;
+}
+
+double sumOf(const double *values, int n)
+{
+    double sum = 0;
+    for(int i=0; i<n; i++)
+        sum += values[i];
+    return sum;
+}
+
+double meanOf(const double *values, int n)
+{
+    return n > 0 ? sumOf(values, n) / n : std::numeric_limits<double>::quiet_NaN();
+}
+
+double minOf(const double *values, int n)
+{
+    if( n == 0 ) { return std::numeric_limits<double>::quiet_NaN(); }
+    double minimum = values[0];
+    for(int i=1; i<n; i++)
+        if( values[i] < minimum ) { minimum = values[i]; }
+    return minimum;
+}
+
+double maxOf(const double *values, int n)
+{
+    if( n == 0 ) { return std::numeric_limits<double>::quiet_NaN(); }
+    double maximum = values[0];
+    for(int i=1; i<n; i++)
+        if( values[i] > maximum ) { maximum = values[i]; }
+    return maximum;
+}
+
+double rmsOf(const double *values, int n)
+{
+    if( n == 0 ) { return std::numeric_limits<double>::quiet_NaN(); }
+    double sum = 0;
+    for(int i=0; i<n; i++)
+        sum += values[i] * values[i];
+    return sqrt(sum / n);
+}
+
+double varianceOf(const double *values, int n)
+{
+    double mean = meanOf(values, n);
+    double sum = 0;
+    for(int i=0; i<n; i++)
+        sum += (values[i] - mean) * (values[i] - mean);
+    return n > 0 ? sum / n : std::numeric_limits<double>::quiet_NaN();
+}
+
+//! \brief Return the native reduction called \a name, or 0 if there is none
+Reduction reduction(const QString &name)
+{
+    if( name == "sum" ) { return sumOf; }
+    if( name == "mean" ) { return meanOf; }
+    if( name == "min" ) { return minOf; }
+    if( name == "max" ) { return maxOf; }
+    if( name == "rms" ) { return rmsOf; }
+    if( name == "variance" ) { return varianceOf; }
+    return 0;
+}
+
+}
+
+ScriptBufferClass::ScriptBufferClass(QScriptEngine *engine) :
+    QObject(engine), QScriptClass(engine)
+{
+    mLength = engine->toStringHandle("length");
+
+    mPrototype = engine->newQObject(new ScriptBufferPrototype(this), QScriptEngine::QtOwnership, QScriptEngine::SkipMethodsInEnumeration | QScriptEngine::ExcludeSuperClassMethods | QScriptEngine::ExcludeSuperClassProperties);
+    mPrototype.setPrototype( engine->globalObject().property("Object").property("prototype") );
+
+    mConstructor = engine->newFunction(construct, mPrototype);
+    mConstructor.setData( engine->newQObject(this) );
+}
+
+void ScriptBufferClass::registerWithEngine(QScriptEngine *engine)
+{
+    ScriptBufferClass *bufferClass = new ScriptBufferClass(engine);
+    engine->globalObject().setProperty("Buffer", bufferClass->mConstructor);
+    qScriptRegisterMetaType< QVector<double> >(engine, toScriptValue, fromScriptValue);
+}
+
+QScriptValue ScriptBufferClass::newInstance(const QVector<double> &values)
+{
+    return engine()->newObject(this, engine()->newVariant( QVariant::fromValue(values) ));
+}
+
+QVector<double> *ScriptBufferClass::values(const QScriptValue &object)
+{
+    if( dynamic_cast<ScriptBufferClass*>(object.scriptClass()) == 0 ) { return 0; }
+    return qscriptvalue_cast< QVector<double>* >( object.data() );
+}
+
+QVector<double> ScriptBufferClass::toVector(const QScriptValue &value)
+{
+    QVector<double> *buffer = values(value);
+    if( buffer != 0 )
+        return *buffer;
+
+    if( value.isArray() )
+    {
+        int n = value.property("length").toInt32();
+        QVector<double> vector(n);
+        for(int i=0; i<n; i++)
+            vector[i] = value.property(i).toNumber();
+        return vector;
+    }
+
+    if( value.isNumber() )
+        return QVector<double>(1, value.toNumber());
+
+    return QVector<double>();
+}
+
+QScriptClass::QueryFlags ScriptBufferClass::queryProperty(const QScriptValue &object, const QScriptString &name, QueryFlags flags, uint *id)
+{
+    QVector<double> *buffer = values(object);
+    if( buffer == 0 ) { return 0; }
+
+    if( name == mLength )
+        return flags & HandlesReadAccess;
+
+    bool isIndex;
+    quint32 index = name.toArrayIndex(&isIndex);
+    if( !isIndex || index >= (quint32)buffer->size() )
+        return 0;
+    *id = index;
+    return flags;
+}
+
+QScriptValue ScriptBufferClass::property(const QScriptValue &object, const QScriptString &name, uint id)
+{
+    QVector<double> *buffer = values(object);
+    if( buffer == 0 ) { return QScriptValue(); }
+
+    if( name == mLength )
+        return buffer->size();
+    if( id < (uint)buffer->size() )
+        return buffer->at(id);
+    return QScriptValue();
+}
+
+void ScriptBufferClass::setProperty(QScriptValue &object, const QScriptString &name, uint id, const QScriptValue &value)
+{
+    Q_UNUSED(name);
+    QVector<double> *buffer = values(object);
+    // the first write copies values that are shared with a waveform; later writes are in place
+    if( buffer != 0 && id < (uint)buffer->size() )
+        (*buffer)[id] = value.toNumber();
+}
+
+QScriptValue::PropertyFlags ScriptBufferClass::propertyFlags(const QScriptValue &object, const QScriptString &name, uint id)
+{
+    Q_UNUSED(object);
+    Q_UNUSED(id);
+    if( name == mLength )
+        return QScriptValue::Undeletable | QScriptValue::ReadOnly | QScriptValue::SkipInEnumeration;
+    return QScriptValue::Undeletable;
+}
+
+QString ScriptBufferClass::name() const
+{
+    return QLatin1String("Buffer");
+}
+
+QScriptValue ScriptBufferClass::prototype() const
+{
+    return mPrototype;
+}
+
+QScriptValue ScriptBufferClass::construct(QScriptContext *context, QScriptEngine *engine)
+{
+    Q_UNUSED(engine);
+    ScriptBufferClass *bufferClass = qobject_cast<ScriptBufferClass*>( context->callee().data().toQObject() );
+    if( bufferClass == 0 ) { return QScriptValue(); }
+
+    QScriptValue argument = context->argument(0);
+    if( argument.isNumber() )
+        return bufferClass->newInstance( QVector<double>( argument.toInt32() , 0.0 ) );
+    return bufferClass->newInstance( toVector(argument) );
+}
+
+QScriptValue ScriptBufferClass::toScriptValue(QScriptEngine *engine, const QVector<double> &values)
+{
+    ScriptBufferClass *bufferClass = qobject_cast<ScriptBufferClass*>( engine->globalObject().property("Buffer").data().toQObject() );
+    if( bufferClass == 0 )
+        return engine->newVariant( QVariant::fromValue(values) );
+    return bufferClass->newInstance(values);
+}
+
+void ScriptBufferClass::fromScriptValue(const QScriptValue &value, QVector<double> &values)
+{
+    values = toVector(value);
+}
+
+ScriptBufferPrototype::ScriptBufferPrototype(QObject *parent) :
+    QObject(parent)
+{
+}
+
+double ScriptBufferPrototype::sum() const
+{
+    QVector<double> values = thisValues();
+    return sumOf(values.constData(), values.size());
+}
+
+double ScriptBufferPrototype::mean() const
+{
+    QVector<double> values = thisValues();
+    return meanOf(values.constData(), values.size());
+}
+
+double ScriptBufferPrototype::min() const
+{
+    QVector<double> values = thisValues();
+    return minOf(values.constData(), values.size());
+}
+
+double ScriptBufferPrototype::max() const
+{
+    QVector<double> values = thisValues();
+    return maxOf(values.constData(), values.size());
+}
+
+double ScriptBufferPrototype::rms() const
+{
+    QVector<double> values = thisValues();
+    return rmsOf(values.constData(), values.size());
+}
+
+QVector<double> ScriptBufferPrototype::slice(int start, int end) const
+{
+    QVector<double> values = thisValues();
+    int n = values.size();
+    if( start < 0 ) { start = qMax(n + start, 0); }
+    if( end < 0 ) { end = qMax(n + end, 0); }
+    start = qMin(start, n);
+    end = qMin(end, n);
+    if( end <= start ) { return QVector<double>(); }
+    return values.mid(start, end - start);
+}
+
+QVector<double> ScriptBufferPrototype::slice(int start) const
+{
+    return slice(start, thisValues().size());
+}
+
+QVector<double> ScriptBufferPrototype::add(const QScriptValue &other) const
+{
+    return combine(other, '+');
+}
+
+QVector<double> ScriptBufferPrototype::subtract(const QScriptValue &other) const
+{
+    return combine(other, '-');
+}
+
+QVector<double> ScriptBufferPrototype::multiply(const QScriptValue &other) const
+{
+    return combine(other, '*');
+}
+
+QVector<double> ScriptBufferPrototype::divide(const QScriptValue &other) const
+{
+    return combine(other, '/');
+}
+
+QScriptValue ScriptBufferPrototype::map(const QScriptValue &function) const
+{
+    QVector<double> values = thisValues();
+    QVector<double> result( values.size() );
+
+    if( function.isFunction() )
+    {
+        for(int i=0; i<values.size(); i++)
+            result[i] = function.call( QScriptValue(), QScriptValueList() << values.at(i) ).toNumber();
+        return engine()->toScriptValue(result);
+    }
+
+    ElementFunction f = elementFunction( function.toString() );
+    if( f == 0 )
+        return context()->throwError( QScriptContext::TypeError, QString("Buffer.map: there is no native function called %1").arg(function.toString()) );
+
+    const double *in = values.constData();
+    double *out = result.data();
+    for(int i=0; i<values.size(); i++)
+        out[i] = f(in[i]);
+    return engine()->toScriptValue(result);
+}
+
+QScriptValue ScriptBufferPrototype::reduce(const QScriptValue &function, const QScriptValue &initial) const
+{
+    QVector<double> values = thisValues();
+
+    if( function.isFunction() )
+    {
+        int i = 0;
+        QScriptValue accumulator = initial;
+        if( !accumulator.isValid() || accumulator.isUndefined() )
+        {
+            if( values.isEmpty() )
+                return context()->throwError( QScriptContext::TypeError, "Buffer.reduce: an empty buffer with no initial value" );
+            accumulator = values.at(i++);
+        }
+        for(; i<values.size(); i++)
+            accumulator = function.call( QScriptValue(), QScriptValueList() << accumulator << values.at(i) );
+        return accumulator;
+    }
+
+    Reduction r = reduction( function.toString() );
+    if( r == 0 )
+        return context()->throwError( QScriptContext::TypeError, QString("Buffer.reduce: there is no native reduction called %1").arg(function.toString()) );
+    return r( values.constData(), values.size() );
+}
+
+QScriptValue ScriptBufferPrototype::windowed(int length, int step, const QScriptValue &function) const
+{
+    if( length < 1 || step < 1 )
+        return context()->throwError( QScriptContext::RangeError, "Buffer.windowed: the length and step must be positive" );
+
+    QVector<double> values = thisValues();
+    int nWindows = values.size() >= length ? (values.size() - length) / step + 1 : 0;
+    QVector<double> result( nWindows );
+
+    if( function.isFunction() )
+    {
+        for(int k=0; k<nWindows; k++)
+            result[k] = function.call( QScriptValue(), QScriptValueList() << engine()->toScriptValue( values.mid(k*step, length) ) ).toNumber();
+        return engine()->toScriptValue(result);
+    }
+
+    Reduction r = reduction( function.toString() );
+    if( r == 0 )
+        return context()->throwError( QScriptContext::TypeError, QString("Buffer.windowed: there is no native reduction called %1").arg(function.toString()) );
+
+    const double *in = values.constData();
+    for(int k=0; k<nWindows; k++)
+        result[k] = r( in + k*step, length );
+    return engine()->toScriptValue(result);
+}
+
+QScriptValue ScriptBufferPrototype::toArray() const
+{
+    QVector<double> values = thisValues();
+    QScriptValue array = engine()->newArray( values.size() );
+    for(int i=0; i<values.size(); i++)
+        array.setProperty(i, values.at(i));
+    return array;
+}
+
+QString ScriptBufferPrototype::toString() const
+{
+    return QString("Buffer(%1)").arg( thisValues().size() );
+}
+
+QVector<double> ScriptBufferPrototype::thisValues() const
+{
+    QVector<double> *values = ScriptBufferClass::values( thisObject() );
+    return values != 0 ? *values : QVector<double>();
+}
+
+QVector<double> ScriptBufferPrototype::combine(const QScriptValue &other, char operation) const
+{
+    QVector<double> values = thisValues();
+    QVector<double> operand = ScriptBufferClass::toVector(other);
+    bool scalar = operand.size() == 1 && values.size() != 1;
+    if( !scalar && operand.size() != values.size() )
+    {
+        context()->throwError( QScriptContext::RangeError, QString("Buffer: cannot combine buffers of lengths %1 and %2").arg(values.size()).arg(operand.size()) );
+        return QVector<double>();
+    }
+
+    QVector<double> result( values.size() );
+    const double *a = values.constData();
+    const double *b = operand.constData();
+    double *out = result.data();
+    int n = values.size();
+    switch( operation )
+    {
+    case '+':
+        for(int i=0; i<n; i++) { out[i] = a[i] + b[scalar ? 0 : i]; }
+        break;
+    case '-':
+        for(int i=0; i<n; i++) { out[i] = a[i] - b[scalar ? 0 : i]; }
+        break;
+    case '*':
+        for(int i=0; i<n; i++) { out[i] = a[i] * b[scalar ? 0 : i]; }
+        break;
+    case '/':
+        for(int i=0; i<n; i++) { out[i] = a[i] / b[scalar ? 0 : i]; }
+        break;
+    }
+    return result;
+}
@@ -0,0 +1,133 @@
+/*!
+  \class ScriptBufferClass
+  \ingroup Data
+  \brief Makes arrays of numbers available to scripts as Buffer objects.
+
+  A Buffer holds an implicitly shared QVector<double>. Handing the samples of a waveform to a script (WaveformData::samples()) therefore copies no data; the samples are copied only if the script changes an element, so the waveform itself is never changed behind its back.
+
+  In a script, a Buffer behaves like an array of numbers: \c buffer.length is the number of values and \c buffer[i] reads or writes a value. Element access is for convenience; anything that touches many values should use the bulk operations of the prototype (see ScriptBufferPrototype), which run natively. New buffers are created with \c new \c Buffer(n) (n zeros) or \c new \c Buffer(array).
+
+  Once registered with an engine (see registerWithEngine()), every QVector<double> that is passed to or returned from a slot is converted to or from a Buffer automatically. JavaScript arrays are accepted wherever a Buffer is expected.
+*/
+
+/*!
+  \class ScriptBufferPrototype
+  \ingroup Data
+  \brief The prototype of the Buffer objects of ScriptBufferClass: the bulk operations available to scripts.
+
+  All operations return new buffers or numbers and leave the buffer itself unchanged. Operations that take the name of a function (e.g., \c buffer.map("log") or \c buffer.windowed(400, 160, "rms")) run entirely in native code. They also accept a script function, which is called once per value (or once per window), and is correspondingly slower.
+
+  The native element-wise functions are abs, sqrt, log, log10, exp, square and negate. The native reductions are sum, mean, min, max, rms and variance.
+*/
+
+#ifndef SCRIPTBUFFER_H
+#define SCRIPTBUFFER_H
+
+#include <QObject>
+#include <QVector>
+#include <QScriptClass>
+#include <QScriptable>
+#include <QScriptValue>
+
+class ScriptBufferClass : public QObject, public QScriptClass
+{
+    Q_OBJECT
+public:
+    ScriptBufferClass(QScriptEngine *engine);
+
+    //! \brief Install the Buffer constructor in the global object of \a engine, and register the conversions to and from QVector<double>
+    static void registerWithEngine(QScriptEngine *engine);
+
+    //! \brief Return a new Buffer that shares \a values
+    QScriptValue newInstance(const QVector<double> &values);
+
+    //! \brief Return a pointer to the values of \a object, or 0 if \a object is not a Buffer
+    static QVector<double> *values(const QScriptValue &object);
+
+    //! \brief Return the values of \a value, which may be a Buffer, an array, or a number (which becomes a buffer of length one)
+    static QVector<double> toVector(const QScriptValue &value);
+
+    QueryFlags queryProperty(const QScriptValue &object, const QScriptString &name, QueryFlags flags, uint *id);
+    QScriptValue property(const QScriptValue &object, const QScriptString &name, uint id);
+    void setProperty(QScriptValue &object, const QScriptString &name, uint id, const QScriptValue &value);
+    QScriptValue::PropertyFlags propertyFlags(const QScriptValue &object, const QScriptString &name, uint id);
+    QString name() const;
+    QScriptValue prototype() const;
+
+private:
+    static QScriptValue construct(QScriptContext *context, QScriptEngine *engine);
+    static QScriptValue toScriptValue(QScriptEngine *engine, const QVector<double> &values);
+    static void fromScriptValue(const QScriptValue &value, QVector<double> &values);
+
+    QScriptString mLength;
+    QScriptValue mPrototype;
+    QScriptValue mConstructor;
+};
+
+class ScriptBufferPrototype : public QObject, public QScriptable
+{
+    Q_OBJECT
+public:
+    ScriptBufferPrototype(QObject *parent = 0);
+
+public slots:
+    //! \brief Return the sum of the values
+    double sum() const;
+
+    //! \brief Return the mean of the values
+    double mean() const;
+
+    //! \brief Return the smallest value
+    double min() const;
+
+    //! \brief Return the largest value
+    double max() const;
+
+    //! \brief Return the root mean square of the values
+    double rms() const;
+
+    //! \brief Return the values from \a start up to, but not including, \a end. Negative indices count from the end, as in Array.slice().
+    QVector<double> slice(int start, int end) const;
+
+    //! \brief Return the values from \a start to the end
+    QVector<double> slice(int start) const;
+
+    //! \brief Return the values plus \a other, which may be a number or a buffer of the same length
+    QVector<double> add(const QScriptValue &other) const;
+
+    //! \brief Return the values minus \a other, which may be a number or a buffer of the same length
+    QVector<double> subtract(const QScriptValue &other) const;
+
+    //! \brief Return the values times \a other, which may be a number or a buffer of the same length
+    QVector<double> multiply(const QScriptValue &other) const;
+
+    //! \brief Return the values divided by \a other, which may be a number or a buffer of the same length
+    QVector<double> divide(const QScriptValue &other) const;
+
+    //! \brief Return \a function applied to each value. \a function is the name of a native function, or a script function of one argument.
+    QScriptValue map(const QScriptValue &function) const;
+
+    //! \brief Reduce the values to a single number. \a function is the name of a native reduction, or a script function (accumulator, value) that starts from \a initial.
+    QScriptValue reduce(const QScriptValue &function, const QScriptValue &initial = QScriptValue()) const;
+
+    //! \brief Apply \a function to windows of \a length values, every \a step values, and return the results
+    /*!
+      \a function is the name of a native reduction, or a script function that is passed each window as a Buffer and returns a number. Only complete windows are used.
+      */
+    QScriptValue windowed(int length, int step, const QScriptValue &function) const;
+
+    //! \brief Return the values as a script array
+    QScriptValue toArray() const;
+
+    //! \brief Return a short description of the buffer
+    QString toString() const;
+
+private:
+    //! \brief Return the values of the buffer that the slot was called on
+    QVector<double> thisValues() const;
+
+    //! \brief Combine the values with \a other by \a operation ('+', '-', '*', '/')
+    QVector<double> combine(const QScriptValue &other, char operation) const;
+};
+
+#endif // SCRIPTBUFFER_H
@@ -1,6 +1,6 @@
 #include "sound.h"
 
-#include <QtWidgets>
+#include <QtCore>
 
 #include "curveparameters.h"
 #include "spectrogramparameters.h"
@@ -10,28 +10,122 @@
 #include "regression.h"
 #include "intervalannotation.h"
 #include "interval.h"
+#include "interfaces.h"
+#include "projectwriter.h"
+#include "textgridreader.h"
+#include "pluginproxy.h"
+#include "blockpipeline.h"
+#include "blockmeasureadapter.h"
+
+namespace {
+
+//! \brief One derivation to be recomputed, and the data objects it produced
+struct DerivationJob
+{
+    Derivation *derivation;
+    QList<QObject*> outputs;
+};
+
+//! \brief Apply the recorded settings of \a derivation to \a plugin, and return the index of its measure, or -1 if \a plugin does not have it
+template<class Plugin>
+int prepareMeasure(Plugin *plugin, const Derivation *derivation)
+{
+    QStringList labels = derivation->parameterLabels();
+    QList<QVariant> values = derivation->parameterValues();
+    for(int i=0; i<labels.count(); i++)
+        plugin->setParameter(labels.at(i), values.at(i));
+
+    int index = plugin->names().indexOf(derivation->measure());
+    if(index == -1) { qDebug() << "Plugin" << derivation->pluginScriptName() << "has no measure" << derivation->measure(); }
+    return index;
+}
+
+//! \brief Move \a outputs, which may have been created in a worker thread, to the GUI thread, to which they belong
+void moveToGuiThread(const QList<QObject*> &outputs)
+{
+    for(int i=0; i<outputs.count(); i++)
+        outputs.at(i)->moveToThread(QCoreApplication::instance()->thread());
+}
+
+//! \brief Apply the recorded settings of \a derivation to \a plugin, run the measure, and collect whatever \a plugin emits through \a created
+template<class Plugin, class Source, class Output>
+QList<QObject*> runMeasure(Plugin *plugin, void (Plugin::*created)(Output*), const Derivation *derivation, Source *source)
+{
+    QList<QObject*> outputs;
+
+    int index = prepareMeasure(plugin, derivation);
+    if(index == -1) { return outputs; }
+
+    QMetaObject::Connection connection = QObject::connect(plugin, created, [&outputs](Output *data) { outputs << data; });
+    plugin->calculate(index, source);
+    QObject::disconnect(connection);
+
+    moveToGuiThread(outputs);
+    return outputs;
+}
+
+//! \brief Apply the recorded settings of \a derivation to \a plugin, which implements AbstractBlockMeasure, and run the measure on \a source through a BlockPipeline, a block of frames at a time
+QList<QObject*> runBlockMeasure(AbstractSpectrogram2WaveformMeasure *plugin, const Derivation *derivation, SpectrogramData *source)
+{
+    QList<QObject*> outputs;
+
+    int index = prepareMeasure(plugin, derivation);
+    if(index == -1) { return outputs; }
+
+    BlockPipeline pipeline;
+    pipeline.addStage(plugin, derivation->type(), index);
+    FrameCollector::send(source, &pipeline);
+    pipeline.finish();
+    if( !pipeline.succeeded() ) { return outputs; }
+
+    WaveformData *data = pipeline.output()->takeWaveform();
+    if( data != 0 )
+        outputs << data;
+
+    moveToGuiThread(outputs);
+    return outputs;
+}
+
+}
 
 Sound::Sound(const QString & filename, QObject *parent) :
     QObject(parent),
     mFilename(filename),
-    mReadState(Sound::NoAttempt)
+    mReadState(Sound::NoAttempt),
+    mSavePending(false),
+    mCompression(BlockCodec::Uncompressed)
 {
     readFromFile(mFilename);
 }
 
 Sound::Sound(WaveformData *sound, QObject *parent) :
     QObject(parent),
-    mReadState(Sound::Success)
+    mReadState(Sound::Success),
+    mSavePending(false),
+    mCompression(BlockCodec::Uncompressed)
 {
     addWaveform(sound);
 }
 
+Sound::Sound(const QList<WaveformData *> &channels, QObject *parent) :
+    QObject(parent),
+    mReadState(Sound::Success),
+    mSavePending(false),
+    mCompression(BlockCodec::Uncompressed)
+{
+    for(int i=0; i<channels.count(); i++)
+        addWaveform(channels.at(i));
+    if( channels.count() > 1 )
+        maChannels = channels;
+}
+
 Sound::~Sound()
 {
     qDeleteAll(maWaveformData);
     qDeleteAll(maSpectrogramData);
     qDeleteAll(maRegressions);
     qDeleteAll(maIntervalAnnotations);
+    qDeleteAll(maDerivations);
 }
 
 Sound::ReadState Sound::readState() const
@@ -86,11 +180,8 @@ void Sound::readFromFile(const QString & filename)
     }
     QXmlStreamReader xml(&file);
 
-    QFile binaryfile(info.completeBaseName() + ".bin");
-    binaryfile.open(QIODevice::ReadOnly);
-    QDataStream binaryin(&binaryfile);
-    binaryin.setByteOrder(QDataStream::LittleEndian);
-    binaryin.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    // the binary file is opened when the root element, which names it, has been read
+    QFile binaryfile;
 
     while (!xml.atEnd())
     {
@@ -101,7 +192,18 @@ void Sound::readFromFile(const QString & filename)
             //	qDebug() << xml.name();
             //	continue;
 
-            if( name == "interface-settings")
+            if( name == "root" )
+            {
+                QString binaryname = xml.attributes().value("binary-file").toString();
+                if( binaryname.isEmpty() ) // projects from before the attribute was introduced
+                    binaryname = info.completeBaseName() + ".bin";
+                if( QFileInfo(info.absoluteDir().filePath(binaryname)).exists() )
+                    binaryname = info.absoluteDir().filePath(binaryname);
+                mCompression = BlockCodec::compressionFromString( xml.attributes().value("binary-compression").toString() );
+                binaryfile.setFileName(binaryname);
+                binaryfile.open(QIODevice::ReadOnly);
+            }
+            else if( name == "interface-settings")
             {
                 double tMax = readXmlElement(xml,"time-max").toDouble();
                 double tMin = readXmlElement(xml,"time-min").toDouble();
@@ -122,53 +224,77 @@ void Sound::readFromFile(const QString & filename)
 
                 double *x = (double*)malloc(sizeof(double)*nsam);
                 double *y = (double*)malloc(sizeof(double)*nsam);
-                if(x==NULL || y==NULL) { qDebug() << "Memory allocation error (x & y)."; return; }
-                for(quint32 i=0; i<nsam; i++)
-                {
-                    binaryin >> *(x+i);
-                }
-                for(quint32 i=0; i<nsam; i++)
-                {
-                    binaryin >> *(y+i);
-                }
+                if(x==NULL || y==NULL) { qDebug() << "Memory allocation error (x & y)."; free(x); free(y); mReadState = Sound::Error; return; }
+                if( !BlockCodec::decode(&binaryfile, x, nsam, mCompression) || !BlockCodec::decode(&binaryfile, y, nsam, mCompression) ) { free(x); free(y); mReadState = Sound::Error; return; }
 
                 maWaveformData << new WaveformData(name, x, y, nsam, fs);
             }
             else if( name == "spectrogram" )
             {
+                bool outOfCore = xml.attributes().value("out-of-core").toString().toInt();
                 QString name = readXmlElement(xml,"label");
 
-                xml.readNextStartElement(); if(xml.name().toString() != "window-length") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                xml.readNextStartElement(); if(xml.name().toString() != "window-length") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 double windowLength = xml.readElementText().toDouble();
 
-                xml.readNextStartElement(); if(xml.name().toString() != "time-step") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                xml.readNextStartElement(); if(xml.name().toString() != "time-step") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 double timeStep = xml.readElementText().toDouble();
 
-                xml.readNextStartElement(); if(xml.name().toString() != "number-of-time-frames") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                xml.readNextStartElement(); if(xml.name().toString() != "number-of-time-frames") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 size_t nFrames = xml.readElementText().toInt();
 
-                xml.readNextStartElement(); if(xml.name().toString() != "number-of-frequency-bins") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                xml.readNextStartElement(); if(xml.name().toString() != "number-of-frequency-bins") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 size_t nFreqBins= xml.readElementText().toInt();
 
-                double *times = (double*)malloc(sizeof(double)*nFrames);
-                double *frequencies = (double*)malloc(sizeof(double)*nFreqBins);
-                double *data = (double*)malloc(sizeof(double)*nFrames*nFreqBins);
-                if(times==NULL || frequencies==NULL || data==NULL) { qDebug() << "Memory allocation error (times, frequencies, data)."; return; }
+                // a spectrogram that was out of core, or that is too large to hold in memory comfortably, is read into a backing file
+                quint64 nValues = (quint64)nFrames * nFreqBins;
+                outOfCore = outOfCore || nValues > (quint64)SpectrogramData::OutOfCoreThreshold;
 
-                for(quint32 i=0; i<nFrames; i++)
+                QFile *backing = 0;
+                uchar *mapped = 0;
+                double *times, *data;
+                if( outOfCore )
                 {
-                    binaryin >> *(times+i);
+                    backing = SpectrogramData::createBackingFile(nFrames, nFreqBins);
+                    if( backing != 0 ) { mapped = backing->map(0, backing->size()); }
+                    if( mapped == 0 ) { qDebug() << "Could not map a backing file for the spectrogram" << name; delete backing; mReadState = Sound::Error; return; }
+                    times = (double*)mapped;
+                    data = times + nFrames;
                 }
-                for(quint32 i=0; i<nFreqBins; i++)
+                else
                 {
-                    binaryin >> *(frequencies+i);
+                    times = (double*)malloc(sizeof(double)*nFrames);
+                    data = (double*)malloc(sizeof(double)*nValues);
                 }
-                for(quint32 i=0; i<nFrames*nFreqBins; i++)
+                double *frequencies = (double*)malloc(sizeof(double)*nFreqBins);
+
+                bool ok = ( outOfCore || (times != NULL && data != NULL) ) && frequencies != NULL;
+                if( !ok ) { qDebug() << "Memory allocation error (times, frequencies, data)."; }
+                ok = ok && BlockCodec::decode(&binaryfile, times, nFrames, mCompression) && BlockCodec::decode(&binaryfile, frequencies, nFreqBins, mCompression) && BlockCodec::decode(&binaryfile, data, nValues, mCompression);
+                if( !ok )
                 {
-                    binaryin >> *(data+i);
+                    free(frequencies);
+                    if( outOfCore ) { backing->unmap(mapped); delete backing; }
+                    else { free(times); free(data); }
+                    mReadState = Sound::Error;
+                    return;
                 }
 
-                maSpectrogramData << new SpectrogramData(name, data, times, nFrames, frequencies, nFreqBins, windowLength, timeStep);
+                if( outOfCore )
+                {
+                    // the other constructor finds the range itself; this reads the file once, a page at a time
+                    double minimum = nValues > 0 ? data[0] : 0, maximum = minimum;
+                    for(quint64 j=1; j<nValues; j++)
+                    {
+                        minimum = qMin(minimum, data[j]);
+                        maximum = qMax(maximum, data[j]);
+                    }
+                    maSpectrogramData << new SpectrogramData(name, backing, mapped, nFrames, frequencies, nFreqBins, windowLength, timeStep, minimum, maximum);
+                }
+                else
+                {
+                    maSpectrogramData << new SpectrogramData(name, data, times, nFrames, frequencies, nFreqBins, windowLength, timeStep);
+                }
             }
             else if( name == "plot" )
             {
@@ -189,34 +315,34 @@ void Sound::readFromFile(const QString & filename)
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
                 if(xml.name().toString() != "symbol-color") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name() << "Expecting symbol-color"; return; }
-                QColor symbolColor( xml.attributes().value("r").toString().toInt(), xml.attributes().value("g").toString().toInt() , xml.attributes().value("b").toString().toInt() );
+                quint32 symbolColor = CurveParameters::rgb( xml.attributes().value("r").toString().toInt(), xml.attributes().value("g").toString().toInt() , xml.attributes().value("b").toString().toInt() );
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "symbol-fill-color") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
-                QColor symbolFillColor( xml.attributes().value("r").toString().toInt(), xml.attributes().value("g").toString().toInt() , xml.attributes().value("b").toString().toInt() );
+                if(xml.name().toString() != "symbol-fill-color") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
+                quint32 symbolFillColor = CurveParameters::rgb( xml.attributes().value("r").toString().toInt(), xml.attributes().value("g").toString().toInt() , xml.attributes().value("b").toString().toInt() );
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "symbol-style") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                if(xml.name().toString() != "symbol-style") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 int symbolStyle = xml.readElementText().toInt();
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "symbol-size") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                if(xml.name().toString() != "symbol-size") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 int symbolSize = xml.readElementText().toInt();
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "line-color") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
-                QColor lineColor( xml.attributes().value("r").toString().toInt(), xml.attributes().value("g").toString().toInt() , xml.attributes().value("b").toString().toInt() );
+                if(xml.name().toString() != "line-color") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
+                quint32 lineColor = CurveParameters::rgb( xml.attributes().value("r").toString().toInt(), xml.attributes().value("g").toString().toInt() , xml.attributes().value("b").toString().toInt() );
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "line-style") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                if(xml.name().toString() != "line-style") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 int lineStyle = xml.readElementText().toInt();
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "line-width") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                if(xml.name().toString() != "line-width") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 int lineWidth = xml.readElementText().toInt();
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "antialiased") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                if(xml.name().toString() != "antialiased") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 bool antialiased = xml.readElementText().toInt();
 
                 if(index >= maWaveformData.length())
@@ -228,13 +354,14 @@ void Sound::readFromFile(const QString & filename)
                 CurveParameters *cp = new CurveParameters;
                 cp->setWaveformData(maWaveformData.at(index));
                 cp->setIsSecondary(secondary);
-                cp->setPen(QPen(lineColor,lineWidth));
-                cp->setCurveStyle((QwtPlotCurve::CurveStyle)lineStyle);
+                cp->setLineColor(lineColor);
+                cp->setLineWidth(lineWidth);
+                cp->setCurveStyle(lineStyle);
                 cp->setAntialiased(antialiased);
-                cp->setSymbolBrush(QBrush(symbolFillColor));
-                cp->setSymbolPen(QPen(symbolColor));
+                cp->setSymbolFillColor(symbolFillColor);
+                cp->setSymbolColor(symbolColor);
                 cp->setSymbolSize(symbolSize);
-                cp->setSymbolStyle((QwtSymbol::Style)symbolStyle);
+                cp->setSymbolStyle(symbolStyle);
                 mSoundView.plotParameters()->last()->curveParameters()->append(cp);
             }
             else if(name=="spectrogram-plot")
@@ -243,11 +370,11 @@ void Sound::readFromFile(const QString & filename)
                 int index = xml.attributes().value("index").toString().toInt();
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "frequency-lower-bound") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                if(xml.name().toString() != "frequency-lower-bound") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 int lowerbound = xml.readElementText().toInt();
 
                 while( xml.readNext() != QXmlStreamReader::StartElement );
-                if(xml.name().toString() != "frequency-upper-bound") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); return; }
+                if(xml.name().toString() != "frequency-upper-bound") { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "File format error: " << xml.name(); mReadState = Sound::Error; return; }
                 int upperbound = xml.readElementText().toInt();
 
                 SpectrogramParameters *sp = new SpectrogramParameters;
@@ -284,14 +411,59 @@ void Sound::readFromFile(const QString & filename)
             {
                 maRegressions.last()->mInteraction.last()->members << maWaveformData.at(xml.readElementText().toInt());
             }
+            else if(name=="channel")
+            {
+                int index = xml.attributes().value("index").toString().toInt();
+                if( index >= 0 && index < maWaveformData.count() )
+                    maChannels << maWaveformData.at(index);
+                else
+                    qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "Channel waveform out of range: " << index;
+            }
+            else if(name=="derivation")
+            {
+                Derivation::Type type = Derivation::typeFromString( xml.attributes().value("type").toString() );
+                int index = xml.attributes().value("source").toString().toInt();
+                QObject *source = 0;
+                if( type == Derivation::Spectrogram2Waveform || type == Derivation::Spectrogram2Spectrogram )
+                {
+                    if( index >= 0 && index < maSpectrogramData.count() )
+                        source = maSpectrogramData.at(index);
+                }
+                else
+                {
+                    if( index >= 0 && index < maWaveformData.count() )
+                        source = maWaveformData.at(index);
+                }
+                if( source == 0 ) { qDebug() << "Line " << xml.lineNumber() << ", Column " << xml.columnNumber() << ": " << "Derivation source out of range: " << index; continue; }
+
+                maDerivations << new Derivation(type, source, 0, xml.attributes().value("plugin").toString(), xml.attributes().value("measure").toString());
+                maDerivations.last()->setStale( xml.attributes().value("stale").toString().toInt() );
+            }
+            else if(name=="parameter")
+            {
+                if( maDerivations.count() > 0 )
+                    maDerivations.last()->setParameter( xml.attributes().value("label").toString(), xml.attributes().value("value").toString() );
+            }
+            else if(name=="output")
+            {
+                if( maDerivations.count() > 0 )
+                {
+                    int index = xml.attributes().value("index").toString().toInt();
+                    if( maDerivations.last()->producesSpectrograms() && index >= 0 && index < maSpectrogramData.count() )
+                        *maDerivations.last()->outputs() << maSpectrogramData.at(index);
+                    else if( !maDerivations.last()->producesSpectrograms() && index >= 0 && index < maWaveformData.count() )
+                        *maDerivations.last()->outputs() << maWaveformData.at(index);
+                }
+            }
             else if(name=="interval-annotation")
             {
                 maIntervalAnnotations << new IntervalAnnotation;
                 maIntervalAnnotations.last()->mName = xml.attributes().value("name").toString();
+                maIntervalAnnotations.last()->mPointTier = xml.attributes().value("point-tier").toString().toInt();
             }
             else if(name=="interval")
             {
-                maIntervalAnnotations.last()->maIntervals << new Interval(xml.attributes().value("label").toString(), xml.attributes().value("left").toString().toDouble(), xml.attributes().value("right").toString().toDouble());
+                maIntervalAnnotations.last()->append( Interval(xml.attributes().value("label").toString(), xml.attributes().value("left").toString().toDouble(), xml.attributes().value("right").toString().toDouble()) );
             }
         }
     }
@@ -301,26 +473,39 @@ void Sound::readFromFile(const QString & filename)
     mReadState = Sound::Success;
 }
 
-void Sound::writeProjectToFile(const QString & filename)
+ProjectWriter *Sound::writeProjectToFile(const QString & filename)
 {
-    // open the binary file
-    QFileInfo info(filename);
-    QFile binaryfile(info.completeBaseName() + ".bin");
-    binaryfile.open(QIODevice::WriteOnly);
-    QDataStream binaryout(&binaryfile);   // we will serialize the data into the file
-    binaryout.setByteOrder(QDataStream::LittleEndian);
-    binaryout.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    if( !mWriter.isNull() )
+    {
+        qDebug() << "The project is already being saved.";
+        return 0;
+    }
+    mWriter = new ProjectWriter(filename);
 
-    // open the xml file
-    QFile xmlfile(filename);
-    xmlfile.open(QFile::WriteOnly | QFile::Text);
-    QXmlStreamWriter xs(&xmlfile);
+    // a spectrogram that is being refined, and the data computed from it, are saved once they are final
+    mSavePending = true;
+    startPendingSave();
+    return mWriter;
+}
+
+void Sound::startPendingSave()
+{
+    if( !mSavePending || isRefining() ) { return; }
+    mSavePending = false;
+    if( mWriter.isNull() ) { return; }
+
+    // the XML is small, so it is built here; the binary data are serialised by the writer
+    QByteArray xml;
+    QXmlStreamWriter xs(&xml);
 
     xs.setAutoFormatting(true);
     xs.writeStartDocument();
     xs.setCodec("UTF-8");
 
     xs.writeStartElement("root");
+    xs.writeAttribute("binary-file", mWriter->binaryFileName());
+    xs.writeAttribute("binary-compression", BlockCodec::compressionToString(mCompression));
+    mWriter->setCompression(mCompression);
 
     xs.writeStartElement("interface-settings");
 
@@ -344,23 +529,27 @@ void Sound::writeProjectToFile(const QString & filename)
 
         xs.writeEndElement(); // waveform
 
-        for(quint32 j=0; j<maWaveformData.at(i)->getNSamples(); j++)
-        {
-            binaryout << maWaveformData.at(i)->xData().at(j);
-        }
-        for(quint32 j=0; j<maWaveformData.at(i)->getNSamples(); j++)
-        {
-            binaryout << maWaveformData.at(i)->yData().at(j);
-        }
+        // implicitly shared, so this does not copy the samples
+        mWriter->addBlock( QList< QVector<double> >() << maWaveformData.at(i)->xData() << maWaveformData.at(i)->yData() );
     }
 
     xs.writeEndElement(); // waveform-data
 
+    xs.writeStartElement("channels");
+    for(int i=0; i<maChannels.count(); i++)
+    {
+        xs.writeEmptyElement("channel");
+        xs.writeAttribute("index", QString::number( maWaveformData.indexOf( maChannels.at(i) ) ) );
+    }
+    xs.writeEndElement(); // channels
+
     xs.writeStartElement("spectrogram-data");
     for(int i=0; i<maSpectrogramData.count(); i++)
     {
         xs.writeStartElement("spectrogram");
         xs.writeAttribute("id",QString::number(i));
+        if( maSpectrogramData.at(i)->isBackedByFile() )
+            xs.writeAttribute("out-of-core", "1");
 
         xs.writeTextElement("label",maSpectrogramData.at(i)->name());
 
@@ -371,20 +560,55 @@ void Sound::writeProjectToFile(const QString & filename)
 
         xs.writeEndElement(); // spectrogram
 
-        for(quint32 j=0; j<maSpectrogramData.at(i)->getNTimeSteps(); j++)
+        // spectrograms own plain arrays, which may be deleted while the save is running, so these are copied;
+        // the values of an out-of-core spectrogram are too large for that, and are streamed from its backing file, which the writer keeps mapped
+        const SpectrogramData *spectrogram = maSpectrogramData.at(i);
+        QSharedPointer<QFile> backing = spectrogram->backingFile();
+        if( backing.isNull() )
         {
-            binaryout << maSpectrogramData.at(i)->getTimeFromIndex(j);
+            mWriter->addBlock( QList< QVector<double> >() << spectrogram->times() << spectrogram->frequencies() << spectrogram->values() );
         }
-        for(quint32 j=0; j< maSpectrogramData.at(i)->getNFrequencyBins(); j++)
+        else
+        {
+            mWriter->addBlock( QList< QVector<double> >() << spectrogram->times() << spectrogram->frequencies() );
+            mWriter->addBlock( spectrogram->pdata(), (quint64)spectrogram->getNTimeSteps() * spectrogram->getNFrequencyBins(), backing );
+        }
+    }
+    xs.writeEndElement(); // spectrogram-data
+
+    xs.writeStartElement("derivations");
+    for(int i=0; i<maDerivations.count(); i++)
+    {
+        const Derivation *d = maDerivations.at(i);
+        xs.writeStartElement("derivation");
+        xs.writeAttribute("type", Derivation::typeToString(d->type()));
+        xs.writeAttribute("plugin", d->pluginScriptName());
+        xs.writeAttribute("measure", d->measure());
+        if( d->sourceIsSpectrogram() )
+            xs.writeAttribute("source", QString::number( maSpectrogramData.indexOf( qobject_cast<SpectrogramData*>(d->source()) ) ) );
+        else
+            xs.writeAttribute("source", QString::number( maWaveformData.indexOf( qobject_cast<WaveformData*>(d->source()) ) ) );
+        xs.writeAttribute("stale", QString::number( d->isStale() ) );
+
+        for(int j=0; j<d->parameterLabels().count(); j++)
         {
-            binaryout << maSpectrogramData.at(i)->getFrequencyFromIndex(j);
+            xs.writeEmptyElement("parameter");
+            xs.writeAttribute("label", d->parameterLabels().at(j));
+            xs.writeAttribute("value", d->parameterValues().at(j).toString());
         }
-        for(quint32 j=0; j<maSpectrogramData.at(i)->getNTimeSteps() * maSpectrogramData.at(i)->getNFrequencyBins(); j++)
+
+        for(int j=0; j<d->outputs()->count(); j++)
         {
-            binaryout << maSpectrogramData.at(i)->flatdata(j);
+            xs.writeEmptyElement("output");
+            if( d->producesSpectrograms() )
+                xs.writeAttribute("index", QString::number( maSpectrogramData.indexOf( qobject_cast<SpectrogramData*>(d->outputs()->at(j)) ) ) );
+            else
+                xs.writeAttribute("index", QString::number( maWaveformData.indexOf( qobject_cast<WaveformData*>(d->outputs()->at(j)) ) ) );
         }
+
+        xs.writeEndElement(); // derivation
     }
-    xs.writeEndElement(); // spectrogram-data
+    xs.writeEndElement(); // derivations
 
     /// @todo replace this functionality
     //    xs.writeStartElement("plots");
@@ -456,15 +680,16 @@ void Sound::writeProjectToFile(const QString & filename)
     for(int i=0; i<maIntervalAnnotations.count(); i++)
     {
         xs.writeStartElement("interval-annotation");
-        xs.writeAttribute("name",maIntervalAnnotations.at(0)->mName);
+        xs.writeAttribute("name",maIntervalAnnotations.at(i)->mName);
+        xs.writeAttribute("point-tier",QString::number(maIntervalAnnotations.at(i)->mPointTier));
 
-        for(int j=0; j<maIntervalAnnotations.at(0)->maIntervals.count(); j++)
+        for(int j=0; j<maIntervalAnnotations.at(i)->count(); j++)
         {
 
             xs.writeEmptyElement("interval");
-            xs.writeAttribute("label",maIntervalAnnotations.at(0)->maIntervals.at(j)->mLabel);
-            xs.writeAttribute("left",QString::number(maIntervalAnnotations.at(0)->maIntervals.at(j)->mLeft));
-            xs.writeAttribute("right",QString::number(maIntervalAnnotations.at(0)->maIntervals.at(j)->mRight));
+            xs.writeAttribute("label",maIntervalAnnotations.at(i)->at(j).mLabel);
+            xs.writeAttribute("left",QString::number(maIntervalAnnotations.at(i)->at(j).mLeft,'g',17));
+            xs.writeAttribute("right",QString::number(maIntervalAnnotations.at(i)->at(j).mRight,'g',17));
         }
         xs.writeEndElement(); // interval-annotation
     }
@@ -515,8 +740,37 @@ void Sound::writeProjectToFile(const QString & filename)
 
     xs.writeEndDocument();
 
-    xmlfile.close();
-    binaryfile.close();
+    mWriter->setXml(xml);
+    mWriter->start();
+}
+
+bool Sound::isRefining() const
+{
+    for(int i=0; i<maSpectrogramData.count(); i++)
+        if( maSpectrogramData.at(i)->isRefining() )
+            return true;
+    return false;
+}
+
+void Sound::watchRefinement(SpectrogramData *data)
+{
+    if( !data->isRefining() ) { return; }
+    connect(data, &SpectrogramData::refinementFinished, this, &Sound::spectrogramRefined);
+    // a spectrogram that is deleted before it is refined must not hold up a save
+    connect(data, &QObject::destroyed, this, &Sound::startPendingSave, Qt::QueuedConnection);
+}
+
+void Sound::spectrogramRefined()
+{
+    SpectrogramData *spectrogram = qobject_cast<SpectrogramData*>(sender());
+    if( spectrogram != 0 && maSpectrogramData.contains(spectrogram) )
+    {
+        // whatever was computed from the coarse values is out of date
+        markStale(spectrogram);
+        if( hasStaleDerivations() )
+            recalculateStale();
+    }
+    startPendingSave();
 }
 
 QString Sound::readXmlElement(QXmlStreamReader &reader, QString elementname)
@@ -555,6 +809,7 @@ void Sound::addRegression(RegressionModel *regression)
 void Sound::addSpectrogram(SpectrogramData *data)
 {
     maSpectrogramData << data;
+    watchRefinement(data);
     emit scriptDataChanged();
 }
 
@@ -567,80 +822,14 @@ void Sound::addWaveform(WaveformData *data)
 void Sound::readTextGridFromFile(const QString & fileName)
 {
     int count = maIntervalAnnotations.count();
-    QFile data(fileName);
-    bool inInterval = false;
-    if (data.open(QFile::ReadOnly))
-    {
-        QTextStream in(&data);
 
-        while( !in.atEnd() )
-        {
-            QString line = in.readLine();
-            //		qDebug() << line;
-            if( line.contains("class = \"IntervalTier\""))
-            {
-                maIntervalAnnotations << new IntervalAnnotation;
-                inInterval = true;
-            }
-            else if( line.contains("class = \"TextTier\""))
-            {
-                inInterval = false;
-            }
-            else if( line.contains("name = \""))
-            {
-                QRegExp rx("\"(.*)\"");
-                rx.indexIn(line);
-                if(rx.captureCount() < 1) { continue; }
-                if(inInterval)
-                    maIntervalAnnotations.last()->mName = rx.capturedTexts().at(1);
-            }
-            else if( line.contains(QRegExp("intervals \\[\\d*\\]:")))
-            {
-                //		    qDebug() << "Interval" << line;
-                if(inInterval)
-                    maIntervalAnnotations.last()->maIntervals << new Interval;
-            }
-            else if( line.contains("xmin = "))
-            {
-                if(inInterval && maIntervalAnnotations.count() > 0 && maIntervalAnnotations.last()->maIntervals.count() > 0)
-                {
-                    QRegExp rx("xmin = (\\d*\\.\\d*)"); // will this get the decimal?
-                    rx.indexIn(line);
-                    //			qDebug() << rx.capturedTexts();
-                    if(rx.captureCount() < 1) { continue; }
-                    QString tmp = rx.capturedTexts().at(1);
-                    //			qDebug() << tmp.toDouble();
-                    maIntervalAnnotations.last()->maIntervals.last()->mLeft = tmp.toDouble();
-                }
-            }
-            else if( line.contains("xmax = "))
-            {
-                if(inInterval && maIntervalAnnotations.count() > 0 && maIntervalAnnotations.last()->maIntervals.count() > 0)
-                {
-                    QRegExp rx("xmax = (\\d*\\.\\d*)"); // will this get the decimal?
-                    rx.indexIn(line);
-                    //			qDebug() << rx.capturedTexts() << rx.captureCount();
-                    if(rx.captureCount() < 1) { continue; }
-                    QString tmp = rx.capturedTexts().at(1);
-                    //			qDebug() << tmp.toDouble();
-                    maIntervalAnnotations.last()->maIntervals.last()->mRight = tmp.toDouble();
-                }
-            }
-            else if( line.contains("text = "))
-            {
-                if(inInterval && maIntervalAnnotations.count() > 0 && maIntervalAnnotations.last()->maIntervals.count() > 0)
-                {
-                    QRegExp rx("\"(.*)\"");
-                    rx.indexIn(line);
-                    //			qDebug() << rx.capturedTexts();
-                    if(rx.captureCount() < 1) { continue; }
-                    QString tmp = rx.capturedTexts().at(1);
-                    maIntervalAnnotations.last()->maIntervals.last()->mLabel = tmp;
-                    //			qDebug() << tmp;
-                }
-            }
-        }
+    TextGridReader reader;
+    if( !reader.read(fileName) )
+    {
+        qDebug() << "Sound::readTextGridFromFile:" << reader.errorString();
+        return;
     }
+    maIntervalAnnotations << reader.takeTiers();
 
     /// @todo Update this functionality
 //    for(int i=count; i<maIntervalAnnotations.count(); i++)
@@ -655,7 +844,458 @@ const SoundView *Sound::soundView() const
     return &mSoundView;
 }
 
+BlockCodec::Compression Sound::compression() const
+{
+    return mCompression;
+}
+
+void Sound::setCompression(BlockCodec::Compression compression)
+{
+    mCompression = compression;
+}
+
 QString Sound::filename() const
 {
     return mFilename;
 }
+
+const QList<WaveformData *> *Sound::channels() const
+{
+    return &maChannels;
+}
+
+int Sound::channelOf(const QObject *data) const
+{
+    for(int i=0; i<maChannels.count(); i++)
+        if( maChannels.at(i) == data )
+            return i;
+
+    Derivation *d = derivationOf(data);
+    if( d == 0 )
+        return -1;
+    return channelOf( d->source() );
+}
+
+QString Sound::channelLabel(int channel)
+{
+    return QString("Ch %1").arg(channel+1);
+}
+
+QObject *Sound::channelCounterpart(const QObject *data, int channel) const
+{
+    for(int i=0; i<maChannels.count(); i++)
+        if( maChannels.at(i) == data )
+            return maChannels.at(channel);
+
+    Derivation *d = derivationOf(data);
+    if( d == 0 )
+        return 0;
+
+    QObject *source = channelCounterpart( d->source(), channel );
+    if( source == 0 )
+        return 0;
+    if( source == d->source() )
+        return const_cast<QObject*>(data);
+
+    int position = d->outputs()->indexOf( const_cast<QObject*>(data) );
+    for(int i=0; i<maDerivations.count(); i++)
+    {
+        const Derivation *e = maDerivations.at(i);
+        if( e->source() == source && e->type() == d->type() && e->pluginScriptName() == d->pluginScriptName() && e->measure() == d->measure() && e->parameterValues() == d->parameterValues() && position < e->outputs()->count() )
+            return e->outputs()->at(position);
+    }
+    return 0;
+}
+
+void Sound::calculate(AbstractWaveform2WaveformMeasure *plugin, int measure, WaveformData *source)
+{
+    Derivation *derivation = new Derivation(Derivation::Waveform2Waveform, source, plugin, plugin->scriptName(), plugin->names().at(measure));
+    derivation->recordParameters(plugin);
+    calculate(derivation);
+}
+
+void Sound::calculate(AbstractWaveform2SpectrogramMeasure *plugin, int measure, WaveformData *source)
+{
+    Derivation *derivation = new Derivation(Derivation::Waveform2Spectrogram, source, plugin, plugin->scriptName(), plugin->names().at(measure));
+    derivation->recordParameters(plugin);
+    calculate(derivation);
+}
+
+void Sound::calculate(AbstractSpectrogram2WaveformMeasure *plugin, int measure, SpectrogramData *source)
+{
+    Derivation *derivation = new Derivation(Derivation::Spectrogram2Waveform, source, plugin, plugin->scriptName(), plugin->names().at(measure));
+    derivation->recordParameters(plugin);
+    calculate(derivation);
+}
+
+void Sound::calculate(AbstractSpectrogram2SpectrogramMeasure *plugin, int measure, SpectrogramData *source)
+{
+    Derivation *derivation = new Derivation(Derivation::Spectrogram2Spectrogram, source, plugin, plugin->scriptName(), plugin->names().at(measure));
+    derivation->recordParameters(plugin);
+    calculate(derivation);
+}
+
+void Sound::calculate(Derivation *derivation)
+{
+    if( channelOf( derivation->source() ) == -1 )
+    {
+        addDerivationOutputs(derivation, runDerivation(derivation, derivation->plugin()));
+        return;
+    }
+
+    // the same measure, with the same settings, on the corresponding data of every channel
+    QList<DerivationJob> jobs;
+    for(int i=0; i<maChannels.count(); i++)
+    {
+        QObject *source = channelCounterpart( derivation->source(), i );
+        if( source == 0 ) { qDebug() << "There is no data in channel" << i+1 << "that corresponds to the source; the measure is not run on that channel."; continue; }
+        DerivationJob job;
+        job.derivation = new Derivation(*derivation);
+        job.derivation->setSource(source);
+        jobs << job;
+    }
+    delete derivation;
+
+    parallelMap(jobs, [](DerivationJob &job) {
+        if( Sound::runsOnWorkerThreads(job.derivation) )
+            job.outputs = Sound::runOnCopy(job.derivation);
+    });
+    for(int i=0; i<jobs.count(); i++)
+        if( !runsOnWorkerThreads(jobs.at(i).derivation) )
+            jobs[i].outputs = runOnCopy(jobs.at(i).derivation);
+
+    for(int i=0; i<jobs.count(); i++)
+    {
+        QString label = " [" + channelLabel( channelOf( jobs.at(i).derivation->source() ) ) + "]";
+        for(int j=0; j<jobs.at(i).outputs.count(); j++)
+        {
+            WaveformData *waveform = qobject_cast<WaveformData*>(jobs.at(i).outputs.at(j));
+            SpectrogramData *spectrogram = qobject_cast<SpectrogramData*>(jobs.at(i).outputs.at(j));
+            if( waveform != 0 && !waveform->name().endsWith(label) )
+                waveform->setName( waveform->name() + label );
+            else if( spectrogram != 0 && !spectrogram->name().endsWith(label) )
+                spectrogram->setName( spectrogram->name() + label );
+        }
+        addDerivationOutputs(jobs.at(i).derivation, jobs.at(i).outputs);
+    }
+}
+
+bool Sound::runsOnWorkerThreads(const Derivation *derivation)
+{
+    // plugins with metadata do not show anything themselves; older plugins may create widgets in calculate()
+    return dynamic_cast<const PluginProxy*>( derivation->plugin() ) != 0;
+}
+
+QList<QObject *> Sound::runOnCopy(const Derivation *derivation)
+{
+    AbstractMeasurement *instance = 0;
+    switch(derivation->type())
+    {
+    case Derivation::Waveform2Waveform:
+        instance = static_cast<AbstractWaveform2WaveformMeasure*>(derivation->plugin())->copy();
+        break;
+    case Derivation::Waveform2Spectrogram:
+        instance = static_cast<AbstractWaveform2SpectrogramMeasure*>(derivation->plugin())->copy();
+        break;
+    case Derivation::Spectrogram2Waveform:
+        instance = static_cast<AbstractSpectrogram2WaveformMeasure*>(derivation->plugin())->copy();
+        break;
+    case Derivation::Spectrogram2Spectrogram:
+        instance = static_cast<AbstractSpectrogram2SpectrogramMeasure*>(derivation->plugin())->copy();
+        break;
+    }
+    // e.g., the library of the plugin could not be loaded
+    if( instance == 0 ) { return QList<QObject*>(); }
+
+    // progress and reports reach the GUI through the plugin that the user chose, which lives on the GUI thread
+    QObject::connect(instance, SIGNAL(reportCreated(QString,QString)), derivation->plugin(), SIGNAL(reportCreated(QString,QString)), Qt::QueuedConnection);
+    QObject::connect(instance, SIGNAL(progressChanged(int,int)), derivation->plugin(), SIGNAL(progressChanged(int,int)), Qt::QueuedConnection);
+
+    QList<QObject*> outputs = runDerivation(derivation, instance);
+    delete instance;
+    return outputs;
+}
+
+QList<QObject *> Sound::runDerivation(const Derivation *derivation, AbstractMeasurement *instance)
+{
+    switch(derivation->type())
+    {
+    case Derivation::Waveform2Waveform:
+        return runMeasure(static_cast<AbstractWaveform2WaveformMeasure*>(instance), &AbstractWaveform2WaveformMeasure::waveformCreated, derivation, qobject_cast<WaveformData*>(derivation->source()));
+    case Derivation::Waveform2Spectrogram:
+        return runMeasure(static_cast<AbstractWaveform2SpectrogramMeasure*>(instance), &AbstractWaveform2SpectrogramMeasure::spectrogramCreated, derivation, qobject_cast<WaveformData*>(derivation->source()));
+    case Derivation::Spectrogram2Waveform:
+    {
+        AbstractSpectrogram2WaveformMeasure *plugin = static_cast<AbstractSpectrogram2WaveformMeasure*>(instance);
+        SpectrogramData *source = qobject_cast<SpectrogramData*>(derivation->source());
+        // a spectrogram in a backing file is read once, front to back, by measures that can process it a block at a time
+        if( source != 0 && !source->backingFile().isNull() && BlockMeasureAdapter::blockMeasure(plugin) != 0 )
+            return runBlockMeasure(plugin, derivation, source);
+        return runMeasure(plugin, &AbstractSpectrogram2WaveformMeasure::waveformCreated, derivation, source);
+    }
+    case Derivation::Spectrogram2Spectrogram:
+        return runMeasure(static_cast<AbstractSpectrogram2SpectrogramMeasure*>(instance), &AbstractSpectrogram2SpectrogramMeasure::spectrogramCreated, derivation, qobject_cast<SpectrogramData*>(derivation->source()));
+    }
+    return QList<QObject*>();
+}
+
+void Sound::addDerivationOutputs(Derivation *derivation, const QList<QObject *> &outputs)
+{
+    if( outputs.isEmpty() )
+    {
+        delete derivation;
+        return;
+    }
+
+    for(int i=0; i<outputs.count(); i++)
+    {
+        if( derivation->producesSpectrograms() )
+            addSpectrogram( qobject_cast<SpectrogramData*>(outputs.at(i)) );
+        else
+            addWaveform( qobject_cast<WaveformData*>(outputs.at(i)) );
+        *derivation->outputs() << outputs.at(i);
+    }
+    maDerivations << derivation;
+}
+
+const QList<Derivation *> *Sound::derivations() const
+{
+    return &maDerivations;
+}
+
+Derivation *Sound::derivationOf(const QObject *data) const
+{
+    for(int i=0; i<maDerivations.count(); i++)
+        if( maDerivations.at(i)->outputs()->contains( const_cast<QObject*>(data) ) )
+            return maDerivations.at(i);
+    return 0;
+}
+
+void Sound::resolvePlugins(QList<AbstractWaveform2WaveformMeasure *> *w2w, QList<AbstractWaveform2SpectrogramMeasure *> *w2s, QList<AbstractSpectrogram2WaveformMeasure *> *s2w, QList<AbstractSpectrogram2SpectrogramMeasure *> *s2s)
+{
+    for(int i=0; i<maDerivations.count(); i++)
+    {
+        Derivation *d = maDerivations.at(i);
+        if( d->plugin() != 0 ) { continue; }
+
+        switch(d->type())
+        {
+        case Derivation::Waveform2Waveform:
+            for(int j=0; j<w2w->count(); j++)
+                if( w2w->at(j)->scriptName() == d->pluginScriptName() )
+                    d->setPlugin( w2w->at(j) );
+            break;
+        case Derivation::Waveform2Spectrogram:
+            for(int j=0; j<w2s->count(); j++)
+                if( w2s->at(j)->scriptName() == d->pluginScriptName() )
+                    d->setPlugin( w2s->at(j) );
+            break;
+        case Derivation::Spectrogram2Waveform:
+            for(int j=0; j<s2w->count(); j++)
+                if( s2w->at(j)->scriptName() == d->pluginScriptName() )
+                    d->setPlugin( s2w->at(j) );
+            break;
+        case Derivation::Spectrogram2Spectrogram:
+            for(int j=0; j<s2s->count(); j++)
+                if( s2s->at(j)->scriptName() == d->pluginScriptName() )
+                    d->setPlugin( s2s->at(j) );
+            break;
+        }
+
+        if( d->plugin() == 0 )
+            qDebug() << "No plugin with the script name" << d->pluginScriptName() << "is loaded; its results cannot be recomputed.";
+    }
+}
+
+void Sound::setDerivationParameters(Derivation *derivation, const QList<QVariant> &values)
+{
+    QStringList labels = derivation->parameterLabels();
+    for(int i=0; i<labels.count() && i<values.count(); i++)
+        derivation->setParameter(labels.at(i), values.at(i));
+
+    derivation->setStale(true);
+    for(int i=0; i<derivation->outputs()->count(); i++)
+        markStale( derivation->outputs()->at(i) );
+}
+
+void Sound::markStale(const QObject *data)
+{
+    for(int i=0; i<maDerivations.count(); i++)
+    {
+        Derivation *d = maDerivations.at(i);
+        if( d->source() != data || d->isStale() ) { continue; }
+        d->setStale(true);
+        for(int j=0; j<d->outputs()->count(); j++)
+            markStale( d->outputs()->at(j) );
+    }
+}
+
+bool Sound::hasStaleDerivations() const
+{
+    for(int i=0; i<maDerivations.count(); i++)
+        if( maDerivations.at(i)->isStale() )
+            return true;
+    return false;
+}
+
+void Sound::forgetData(const QObject *data)
+{
+    for(int i=0; i<maChannels.count(); i++)
+        if( maChannels.at(i) == data )
+            maChannels.removeAt(i--);
+
+    for(int i=0; i<maDerivations.count(); i++)
+    {
+        if( maDerivations.at(i)->source() == data )
+        {
+            delete maDerivations.takeAt(i);
+            i--;
+        }
+        else
+        {
+            maDerivations.at(i)->outputs()->removeAll( const_cast<QObject*>(data) );
+        }
+    }
+}
+
+bool Sound::isOutputOf(const QObject *data, const QList<Derivation *> &list)
+{
+    for(int i=0; i<list.count(); i++)
+        if( list.at(i)->outputs()->contains( const_cast<QObject*>(data) ) )
+            return true;
+    return false;
+}
+
+void Sound::recalculateStale()
+{
+    while( true )
+    {
+        QList<Derivation*> stale;
+        for(int i=0; i<maDerivations.count(); i++)
+            if( maDerivations.at(i)->isStale() )
+                stale << maDerivations.at(i);
+
+        // a derivation is ready when its source is not itself waiting to be recomputed
+        QList<DerivationJob> jobs;
+        for(int i=0; i<stale.count(); i++)
+        {
+            if( stale.at(i)->plugin() == 0 || isOutputOf( stale.at(i)->source(), stale ) ) { continue; }
+            DerivationJob job;
+            job.derivation = stale.at(i);
+            jobs << job;
+        }
+        if( jobs.isEmpty() ) { break; }
+
+        // the jobs in a wave are independent, so each runs on its own copy of the plugin
+        parallelMap(jobs, [](DerivationJob &job) {
+            if( Sound::runsOnWorkerThreads(job.derivation) )
+                job.outputs = Sound::runOnCopy(job.derivation);
+        });
+        for(int i=0; i<jobs.count(); i++)
+            if( !runsOnWorkerThreads(jobs.at(i).derivation) )
+                jobs[i].outputs = runOnCopy(jobs.at(i).derivation);
+
+        for(int i=0; i<jobs.count(); i++)
+        {
+            replaceDerivationOutputs(jobs.at(i).derivation, jobs.at(i).outputs);
+            jobs.at(i).derivation->setStale(false);
+        }
+    }
+
+    emit scriptDataChanged();
+}
+
+void Sound::replaceDerivationOutputs(Derivation *derivation, const QList<QObject *> &outputs)
+{
+    QList<QObject*> old = *derivation->outputs();
+    derivation->outputs()->clear();
+
+    for(int i=0; i<outputs.count(); i++)
+    {
+        *derivation->outputs() << outputs.at(i);
+
+        if( i >= old.count() ) // the measure produced more than last time
+        {
+            if( derivation->producesSpectrograms() )
+            {
+                maSpectrogramData << qobject_cast<SpectrogramData*>(outputs.at(i));
+                watchRefinement( maSpectrogramData.last() );
+            }
+            else
+                maWaveformData << qobject_cast<WaveformData*>(outputs.at(i));
+            continue;
+        }
+
+        replaceReferences(old.at(i), outputs.at(i));
+
+        if( derivation->producesSpectrograms() )
+        {
+            SpectrogramData *oldData = qobject_cast<SpectrogramData*>(old.at(i));
+            SpectrogramData *newData = qobject_cast<SpectrogramData*>(outputs.at(i));
+            newData->setName( oldData->name() );
+            int index = maSpectrogramData.indexOf(oldData);
+            if( index == -1 )
+                maSpectrogramData << newData;
+            else
+                maSpectrogramData[index] = newData;
+            watchRefinement(newData);
+            emit spectrogramReplaced(oldData, newData);
+            delete oldData;
+        }
+        else
+        {
+            WaveformData *oldData = qobject_cast<WaveformData*>(old.at(i));
+            WaveformData *newData = qobject_cast<WaveformData*>(outputs.at(i));
+            newData->setName( oldData->name() );
+            int index = maWaveformData.indexOf(oldData);
+            if( index == -1 )
+                maWaveformData << newData;
+            else
+                maWaveformData[index] = newData;
+            emit waveformReplaced(oldData, newData);
+            delete oldData;
+        }
+    }
+    // outputs that the measure no longer produces are left in the project, but are no longer derived
+}
+
+void Sound::replaceReferences(QObject *oldData, QObject *newData)
+{
+    for(int i=0; i<maDerivations.count(); i++)
+        if( maDerivations.at(i)->source() == oldData )
+            maDerivations.at(i)->setSource(newData);
+
+    WaveformData *oldWaveform = qobject_cast<WaveformData*>(oldData);
+    WaveformData *newWaveform = qobject_cast<WaveformData*>(newData);
+    SpectrogramData *oldSpectrogram = qobject_cast<SpectrogramData*>(oldData);
+    SpectrogramData *newSpectrogram = qobject_cast<SpectrogramData*>(newData);
+
+    for(int i=0; i<maRegressions.count(); i++)
+    {
+        RegressionModel *r = maRegressions.at(i);
+        if( oldSpectrogram != 0 && r->mDependentSpectrogram == oldSpectrogram )
+            r->mDependentSpectrogram = newSpectrogram;
+        if( oldWaveform == 0 ) { continue; }
+        for(int j=0; j<r->mSimple.count(); j++)
+            if( r->mSimple.at(j) == oldWaveform )
+                r->mSimple[j] = newWaveform;
+        for(int j=0; j<r->mDependent.count(); j++)
+            if( r->mDependent.at(j) == oldWaveform )
+                r->mDependent[j] = newWaveform;
+        for(int j=0; j<r->mInteraction.count(); j++)
+            for(int k=0; k<r->mInteraction.at(j)->members.count(); k++)
+                if( r->mInteraction.at(j)->members.at(k) == oldWaveform )
+                    r->mInteraction.at(j)->members[k] = newWaveform;
+    }
+
+    for(int i=0; i<mSoundView.plotParameters()->count(); i++)
+    {
+        PlotParameters *p = mSoundView.plotParameters()->at(i);
+        for(int j=0; j<p->curveParameters()->count(); j++)
+            if( oldWaveform != 0 && p->curveParameters()->at(j)->waveformData() == oldWaveform )
+                p->curveParameters()->at(j)->setWaveformData(newWaveform);
+        for(int j=0; j<p->spectrogramParameters()->count(); j++)
+            if( oldSpectrogram != 0 && p->spectrogramParameters()->at(j)->spectrogramData() == oldSpectrogram )
+                p->spectrogramParameters()->at(j)->setSpectrogramData(newSpectrogram);
+    }
+}
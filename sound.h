@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QString>
 #include <QList>
+#include <QPointer>
 
 class QXmlStreamReader;
 
@@ -11,6 +12,15 @@ class WaveformData;
 class SpectrogramData;
 class RegressionModel;
 class IntervalAnnotation;
+class AbstractMeasurement;
+class ProjectWriter;
+class AbstractWaveform2WaveformMeasure;
+class AbstractWaveform2SpectrogramMeasure;
+class AbstractSpectrogram2WaveformMeasure;
+class AbstractSpectrogram2SpectrogramMeasure;
+
+#include "derivation.h"
+#include "blockcodec.h"
 
 #include "soundview.h"
 
@@ -22,6 +32,9 @@ public:
 
     Sound(const QString & filename, QObject * parent = 0);
     Sound(WaveformData *sound, QObject * parent = 0);
+
+    //! \brief Create a project for a multichannel recording, with one waveform per channel in \a channels
+    Sound(const QList<WaveformData*> &channels, QObject * parent = 0);
     ~Sound();
 
     Sound::ReadState readState() const;
@@ -35,13 +48,65 @@ public:
 
     const QList<IntervalAnnotation*> * intervals() const;
 
-    void writeProjectToFile(const QString &filename);
+    //! \brief Start saving the project to \a filename in the background, and return the writer, which reports progress and completion
+    /*!
+      The project's data are captured when this is called, so the project may be changed, or closed, while the save runs. If a spectrogram is still being refined (see SpectrogramData::isRefining()), the data are captured once refinement has finished and the measures computed from the spectrogram have been recomputed, so that the saved project does not contain coarse values. Returns 0 if a save of this project is already in progress.
+      */
+    ProjectWriter * writeProjectToFile(const QString &filename);
     void readTextGridFromFile(const QString &fileName);
 
     const SoundView * soundView() const;
 
+    //! \brief Return how the binary data of the project are stored when it is saved
+    BlockCodec::Compression compression() const;
+
+    //! \brief Set how the binary data of the project are stored when it is saved
+    void setCompression(BlockCodec::Compression compression);
+
     QString filename() const;
 
+    //! \brief Return the waveforms of the channels of the recording. The list is empty for a single-channel recording.
+    const QList<WaveformData*> * channels() const;
+
+    //! \brief Return the channel (counting from zero) that \a data is, or was derived from, or -1 if it does not belong to a channel
+    int channelOf(const QObject *data) const;
+
+    //! \brief Return the label used to mark data from channel \a channel (counting from zero)
+    static QString channelLabel(int channel);
+
+    //! \brief Run measure \a measure of \a plugin on \a source, add the results to the project, and record how they were derived
+    /*!
+      If \a source belongs to a channel of a multichannel recording, the measure is run in parallel on the corresponding data of every channel. The results are added channel by channel, and labeled with their channel.
+      */
+    void calculate(AbstractWaveform2WaveformMeasure *plugin, int measure, WaveformData *source);
+    void calculate(AbstractWaveform2SpectrogramMeasure *plugin, int measure, WaveformData *source);
+    void calculate(AbstractSpectrogram2WaveformMeasure *plugin, int measure, SpectrogramData *source);
+    void calculate(AbstractSpectrogram2SpectrogramMeasure *plugin, int measure, SpectrogramData *source);
+
+    //! \brief Return the list of derivation records of the project
+    const QList<Derivation*> * derivations() const;
+
+    //! \brief Return the derivation that produced \a data, or 0 if \a data was not produced by a plugin
+    Derivation * derivationOf(const QObject *data) const;
+
+    //! \brief Fill in the plugin pointers of derivations that were read from a project file, matching on the plugins' script names
+    void resolvePlugins(QList<AbstractWaveform2WaveformMeasure*> *w2w, QList<AbstractWaveform2SpectrogramMeasure*> *w2s, QList<AbstractSpectrogram2WaveformMeasure*> *s2w, QList<AbstractSpectrogram2SpectrogramMeasure*> *s2s);
+
+    //! \brief Change the recorded settings of \a derivation to \a values (in the order of Derivation::parameterLabels()), and mark it and its descendants as stale
+    void setDerivationParameters(Derivation *derivation, const QList<QVariant> &values);
+
+    //! \brief Mark every derivation that depends, directly or indirectly, on \a data as stale
+    void markStale(const QObject *data);
+
+    //! \brief Return true if any derivation is stale
+    bool hasStaleDerivations() const;
+
+    //! \brief Remove \a data from the derivation records. Call this before \a data is deleted.
+    /*!
+      Derivations that used \a data as their source are removed; their outputs remain in the project but will no longer be recomputed.
+      */
+    void forgetData(const QObject *data);
+
 public slots:
 
     //! \brief Adds the spectrogram to the project, if the project is in a focused window.
@@ -53,11 +118,29 @@ public slots:
     //! \brief Adds \regression to the project
     void addRegression(RegressionModel *regression);
 
+    //! \brief Recompute the outputs of all stale derivations
+    /*!
+      Derivations are recomputed in waves. Each wave contains the stale derivations whose sources are up to date; the derivations in a wave are independent of one another, so they are run in parallel on copies of their plugins (except those of plugins that may create widgets, which are run on the GUI thread). The new outputs replace the old ones in place, so they keep their position and their name.
+      */
+    void recalculateStale();
+
+private slots:
+    //! \brief Recompute the derivations of the spectrogram that sent the signal, whose values have been refined, and then start a pending save
+    void spectrogramRefined();
+
+    //! \brief Capture the project's data for the save that writeProjectToFile() started, and start writing, unless a spectrogram is still being refined
+    void startPendingSave();
 
 signals:
     //! \brief This signal indicates that data pertinent to the scripting environment has changed
     void scriptDataChanged();
 
+    //! \brief Emitted when \a oldData has been recomputed as \a newData. \a oldData is deleted after the signal has been delivered.
+    void waveformReplaced(WaveformData *oldData, WaveformData *newData);
+
+    //! \brief Emitted when \a oldData has been recomputed as \a newData. \a oldData is deleted after the signal has been delivered.
+    void spectrogramReplaced(SpectrogramData *oldData, SpectrogramData *newData);
+
 private:
     QString mFilename;
     Sound::ReadState mReadState;
@@ -65,9 +148,55 @@ private:
     QList<SpectrogramData*> maSpectrogramData;
     QList<RegressionModel*> maRegressions;
     QList<IntervalAnnotation*> maIntervalAnnotations;
+    QList<Derivation*> maDerivations;
+    QList<WaveformData*> maChannels;
+    QPointer<ProjectWriter> mWriter;
+    //! \brief True if mWriter has been created, but the data have not been handed to it yet
+    bool mSavePending;
+    BlockCodec::Compression mCompression;
     SoundView mSoundView;
 
     void readFromFile(const QString & filename);
+
+    //! \brief Return true if any spectrogram of the project is still being refined
+    bool isRefining() const;
+
+    //! \brief Recompute the derivations of \a data when it has been refined, if it is being refined
+    void watchRefinement(SpectrogramData *data);
+
+    //! \brief Run \a derivation on the plugin \a instance (which may be a copy of the derivation's plugin), returning the data objects it creates
+    /*!
+      A measure of a spectrogram that is kept in a backing file is run through a BlockPipeline if the plugin implements AbstractBlockMeasure, so that the file is read once, from front to back, a block of frames at a time.
+      */
+    static QList<QObject*> runDerivation(const Derivation *derivation, AbstractMeasurement *instance);
+
+    //! \brief Add \a outputs to the project as the results of \a derivation
+    void addDerivationOutputs(Derivation *derivation, const QList<QObject*> &outputs);
+
+    //! \brief Run \a derivation on a copy of its plugin. This is safe to call from a worker thread if runsOnWorkerThreads() is true for \a derivation.
+    static QList<QObject*> runOnCopy(const Derivation *derivation);
+
+    //! \brief Return true if the plugin of \a derivation may be run on a worker thread, i.e., if it cannot create widgets
+    static bool runsOnWorkerThreads(const Derivation *derivation);
+
+    //! \brief Record and run \a derivation; if its source belongs to a channel, run it on every channel in parallel
+    void calculate(Derivation *derivation);
+
+    //! \brief Return the data in channel \a channel that corresponds to \a data, or 0 if there is none
+    /*!
+      For a channel waveform this is the waveform of channel \a channel. For derived data it is the output, at the same position, of the matching derivation from the corresponding source in channel \a channel.
+      */
+    QObject * channelCounterpart(const QObject *data, int channel) const;
+
+    //! \brief Replace the outputs of \a derivation with \a outputs
+    void replaceDerivationOutputs(Derivation *derivation, const QList<QObject*> &outputs);
+
+    //! \brief Return true if \a data is an output of one of the derivations in \a list
+    static bool isOutputOf(const QObject *data, const QList<Derivation*> &list);
+
+    //! \brief Point every reference to \a oldData (derivation sources, regressions, plot settings) at \a newData
+    void replaceReferences(QObject *oldData, QObject *newData);
+
     QString readXmlElement(QXmlStreamReader &reader, QString elementname);
 };
 
@@ -35,6 +35,10 @@
 #include "intervalannotation.h"
 #include "sound.h"
 #include "soundview.h"
+#include "scriptbuffer.h"
+#include "dataentrydialog.h"
+#include "interval.h"
+#include "streamingwidget.h"
 
 SoundWidget::SoundWidget(Sound * snd, QList<AbstractWaveform2WaveformMeasure*> *w2w, QList<AbstractWaveform2SpectrogramMeasure*> *w2s, QList<AbstractSpectrogram2WaveformMeasure*> *s2w, QList<AbstractSpectrogram2SpectrogramMeasure*> *s2s, QWidget *parent) :
     QMainWindow(parent),
@@ -50,10 +54,17 @@ SoundWidget::SoundWidget(Sound * snd, QList<AbstractWaveform2WaveformMeasure*> *
 
     connect( ui->actionData_Manager, SIGNAL(triggered()), this, SLOT(launchDataManager()) );
     connect( ui->actionPlot_Manager, SIGNAL(triggered()), this, SLOT(launchPlotManager()) );
+    connect( ui->actionRun_script, SIGNAL(triggered()), this, SLOT(runScript()) );
+    connect( ui->actionDetail_spectrogram, SIGNAL(triggered()), this, SLOT(detailSpectrogram()) );
+    connect( ui->actionLive_analysis, SIGNAL(triggered()), this, SLOT(liveAnalysis()) );
+
+    mSound->resolvePlugins(mW2wPlugins, mW2sPlugins, mS2wPlugins, mS2sPlugins);
+    connect( mSound, SIGNAL(waveformReplaced(WaveformData*,WaveformData*)), this, SLOT(replaceWaveform(WaveformData*,WaveformData*)) );
+    connect( mSound, SIGNAL(spectrogramReplaced(SpectrogramData*,SpectrogramData*)), this, SLOT(replaceSpectrogram(SpectrogramData*,SpectrogramData*)) );
 
     /// @todo Look at how much of this functionality needs to be replaced
 //    setupActions();
-//    setupScripting();
+    setupScripting();
 
     setupLayout();
 
@@ -89,15 +100,15 @@ void SoundWidget::setupLayout()
         {
             CurveParameters *cp = p->curveParameters()->at(j);
             QwtPlotCurve * curve = pvw->addCurveData( cp->waveformData(), cp->isSecondary() );
-            curve->setPen( cp->pen() );
-            curve->setStyle( cp->curveStyle() );
+            curve->setPen( QPen( QColor( (QRgb)cp->lineColor() ), cp->lineWidth() ) );
+            curve->setStyle( (QwtPlotCurve::CurveStyle)cp->curveStyle() );
             curve->setRenderHint(QwtPlotItem::RenderAntialiased, cp->antialiased() );
 
             QwtSymbol * sym = new QwtSymbol;
-            sym->setBrush(cp->symbolBrush());
-            sym->setPen(cp->symbolPen());
+            sym->setBrush( QBrush( QColor( (QRgb)cp->symbolFillColor() ) ) );
+            sym->setPen( QPen( QColor( (QRgb)cp->symbolColor() ) ) );
             sym->setSize(cp->symbolSize());
-            sym->setStyle(cp->symbolStyle());
+            sym->setStyle( (QwtSymbol::Style)cp->symbolStyle() );
             curve->setSymbol(sym);
         }
 
@@ -141,7 +152,7 @@ void SoundWidget::addAnnotationMenu(IntervalAnnotation *annotation)
 
 void SoundWidget::launchDataManager()
 {
-    DataManagerDialog *dm = new DataManagerDialog(mW2wPlugins, mW2sPlugins, mS2wPlugins, mS2sPlugins, mSound->waveformData(),mSound->spectrogramData(),this);
+    DataManagerDialog *dm = new DataManagerDialog(mW2wPlugins, mW2sPlugins, mS2wPlugins, mS2sPlugins, mSound, this);
     connect(dm, SIGNAL(removeWaveform(int)),this,SLOT(removeWaveform(int)));
     connect(dm, SIGNAL(removeSpectrogram(int)),this,SLOT(removeSpectrogram(int)));
     dm->exec();
@@ -157,6 +168,96 @@ void SoundWidget::launchPlotManager()
 //    qDebug() << "end of SoundWidget::launchPlotManager";
 }
 
+void SoundWidget::detailSpectrogram()
+{
+    // a spectrogram plugin that can analyse part of a waveform
+    AbstractWaveform2SpectrogramMeasure *plugin = 0;
+    for(int i=0; i<mW2sPlugins->count(); i++)
+    {
+        QStringList labels = mW2sPlugins->at(i)->parameterLabels();
+        if( labels.contains("Start time (s)") && labels.contains("End time (s)") )
+        {
+            plugin = mW2sPlugins->at(i);
+            break;
+        }
+    }
+    if( plugin == 0 )
+    {
+        QMessageBox::information(this, tr("Detail spectrogram"), tr("None of the loaded plugins can calculate a spectrogram of part of a sound."));
+        return;
+    }
+    if( mSound->waveformData()->isEmpty() ) { return; }
+
+    // the visible region, and the intervals that can be seen in it
+    double left = ui->plotDisplayWidget->getLeftPos();
+    double right = ui->plotDisplayWidget->getRightPos();
+    QStringList items;
+    QList< QPair<double,double> > ranges;
+    items << tr("Visible region (%1-%2 s)").arg(left).arg(right);
+    ranges << qMakePair(left, right);
+    for(int i=0; i<mSound->intervals()->count(); i++)
+    {
+        const IntervalAnnotation *tier = mSound->intervals()->at(i);
+        if( tier->mPointTier ) { continue; }
+        int first, last;
+        tier->range(left, right, &first, &last);
+        for(int j=first; j<last; j++)
+        {
+            const Interval &interval = tier->at(j);
+            if( interval.mLabel.isEmpty() || !interval.inRange(left, right) ) { continue; }
+            items << tr("%1: %2 (%3-%4 s)").arg(tier->mName).arg(interval.mLabel).arg(interval.mLeft).arg(interval.mRight);
+            ranges << qMakePair(interval.mLeft, interval.mRight);
+        }
+    }
+
+    bool ok;
+    QString item = QInputDialog::getItem(this, tr("Detail spectrogram"), tr("Region to analyse:"), items, 0, false, &ok);
+    if( !ok ) { return; }
+    QPair<double,double> range = ranges.at( items.indexOf(item) );
+
+    // suggest about one frame per pixel of the plots, but never a coarser time step than the current setting
+    QStringList labels = plugin->parameterLabels();
+    QList<QVariant> values;
+    for(int i=0; i<labels.count(); i++)
+        values << plugin->parameter(labels.at(i));
+    QList<QVariant> original = values;
+    int pixels = ui->plotDisplayWidget->plotViews()->isEmpty() ? 1000 : qMax( 100, ui->plotDisplayWidget->plotViews()->first()->canvas()->width() );
+    int step = labels.indexOf("Time step (ms)");
+    if( step != -1 )
+        values[step] = qMin( values.at(step).toDouble(), qMax( 0.1, 1000.0 * (range.second - range.first) / pixels ) );
+    values[ labels.indexOf("Start time (s)") ] = range.first;
+    values[ labels.indexOf("End time (s)") ] = range.second;
+
+    DataEntryDialog dew(&labels, &values, plugin->scriptName() + ": " + plugin->names().first(), this);
+    if( dew.exec() != QDialog::Accepted ) { return; }
+    for(int i=0; i<labels.count(); i++)
+        plugin->setParameter(labels.at(i), dew.values()->at(i));
+
+    int before = mSound->spectrogramData()->count();
+    mSound->calculate(plugin, 0, mSound->waveformData()->first());
+
+    // the plugins are shared, so the next spectrogram calculated with this one should cover the whole sound again
+    for(int i=0; i<labels.count(); i++)
+        plugin->setParameter(labels.at(i), original.at(i));
+
+    if( mSound->spectrogramData()->count() == before ) { return; }
+    SpectrogramData *spectrogram = mSound->spectrogramData()->at(before);
+    PlotViewWidget *pvw = new PlotViewWidget( spectrogram->name() );
+    pvw->addSpectrogramData( spectrogram );
+    ui->plotDisplayWidget->addPlotView( pvw, spectrogram->name() );
+    ui->plotDisplayWidget->setTimeAxes( range.first, range.second );
+    ui->plotDisplayWidget->setSliderFromWindow();
+}
+
+void SoundWidget::liveAnalysis()
+{
+    if( mSound->waveformData()->isEmpty() ) { return; }
+    StreamingWidget *streaming = new StreamingWidget( mSound->waveformData()->first(), this );
+    streaming->setWindowFlags( Qt::Window );
+    streaming->setAttribute( Qt::WA_DeleteOnClose );
+    streaming->show();
+}
+
 void SoundWidget::importTextGrid()
 {
     /// @todo replace this functionality
@@ -205,21 +306,16 @@ void SoundWidget::setupScripting()
 {
     mScriptEngine = new QScriptEngine;
 
-    // set up the connections to receive spectrograms & waveforms that plugins emit
-    // this is, technically, broader than just the scripting environment, but I want to make sure that this connection is made before the others
-    for(int i=0; i < mW2sPlugins->count(); i++ )
-    connect( mW2sPlugins->at(i), SIGNAL(spectrogramCreated(SpectrogramData*)), this, SLOT(addSpectrogram(SpectrogramData*)) );
-    for(int i=0; i < mS2sPlugins->count(); i++ )
-    connect( mS2sPlugins->at(i), SIGNAL(spectrogramCreated(SpectrogramData*)), this, SLOT(addSpectrogram(SpectrogramData*)) );
-    for(int i=0; i < mS2wPlugins->count(); i++ )
-    connect( mS2wPlugins->at(i), SIGNAL(waveformCreated(WaveformData*)), mSound, SLOT(addWaveform(WaveformData*)) );
-    for(int i=0; i < mW2wPlugins->count(); i++ )
-    connect( mW2wPlugins->at(i), SIGNAL(waveformCreated(WaveformData*)), mSound, SLOT(addWaveform(WaveformData*)) );
+    // samples are passed to scripts as Buffer objects, which share the data of the waveforms
+    ScriptBufferClass::registerWithEngine(mScriptEngine);
+
+    // the plugins are shared by all open sounds, so their output is not connected to this one; results are added through Sound::calculate()
 
     // update the script environment when the script requests it
     connect(this,SIGNAL(requestScriptDataRefresh()),this,SLOT(setupScriptEnvironment()));
 
     connect(this,SIGNAL(scriptDataChanged()),this,SLOT(setupScriptEnvironment()));
+    connect(mSound,SIGNAL(scriptDataChanged()),this,SLOT(setupScriptEnvironment()));
 }
 
 void SoundWidget::regressionMenuAction(QAction *action)
@@ -313,6 +409,106 @@ void spectrogramArrayFromScriptValue(const QScriptValue &obj, QList<SpectrogramD
     /* At this point I don't see a point to implementing this function. */
 }
 
+QScriptValue createWaveform(QScriptContext *context, QScriptEngine *engine)
+{
+    // script: createWaveform(name, times, samples)
+    Sound *sound = qobject_cast<Sound*>( context->callee().data().toQObject() );
+    if( sound == 0 ) { return QScriptValue(); }
+    if( context->argumentCount() < 3 )
+        return context->throwError(QScriptContext::SyntaxError, "createWaveform(name, times, samples): too few arguments");
+
+    QVector<double> times = ScriptBufferClass::toVector( context->argument(1) );
+    QVector<double> samples = ScriptBufferClass::toVector( context->argument(2) );
+    if( times.size() != samples.size() || times.size() < 2 )
+        return context->throwError(QScriptContext::RangeError, QString("createWaveform: there are %1 times and %2 samples").arg(times.size()).arg(samples.size()));
+
+    double span = times.last() - times.first();
+    if( !(span > 0) )
+        return context->throwError(QScriptContext::RangeError, "createWaveform: the last time must be later than the first");
+
+    size_t fs = qRound( (times.size() - 1) / span );
+    WaveformData *waveform = new WaveformData( context->argument(0).toString(), times, samples, fs );
+    sound->addWaveform(waveform);
+    return engine->newQObject(waveform);
+}
+
+//! \brief Run the measure \a measure of the plugin in \a plugins with the script name \a scriptName on \a source, through \a sound. Returns false if there is no such plugin in \a plugins.
+template<class Plugin, class Source>
+bool runScriptMeasure(const QList<Plugin*> *plugins, const QString &scriptName, const QString &measure, Source *source, const QVariantMap &settings, Sound *sound, QString *error)
+{
+    Plugin *plugin = 0;
+    for(int i=0; i<plugins->count() && plugin == 0; i++)
+        if( plugins->at(i)->scriptName() == scriptName )
+            plugin = plugins->at(i);
+    if( plugin == 0 ) { return false; }
+
+    int index = plugin->names().indexOf(measure);
+    if( index == -1 ) { *error = QString("%1 has no measure called %2").arg(scriptName).arg(measure); return true; }
+
+    // the plugins are shared, so the settings are restored afterward
+    QVariantMap original;
+    for(QVariantMap::const_iterator i = settings.constBegin(); i != settings.constEnd(); ++i)
+    {
+        if( !plugin->parameterLabels().contains(i.key()) ) { *error = QString("%1 has no setting called %2").arg(scriptName).arg(i.key()); return true; }
+        original.insert( i.key(), plugin->parameter(i.key()) );
+    }
+    for(QVariantMap::const_iterator i = settings.constBegin(); i != settings.constEnd(); ++i)
+        plugin->setParameter(i.key(), i.value());
+
+    sound->calculate(plugin, index, source);
+
+    for(QVariantMap::const_iterator i = original.constBegin(); i != original.constEnd(); ++i)
+        plugin->setParameter(i.key(), i.value());
+    return true;
+}
+
+QList<QObject*> SoundWidget::calculate(const QString &scriptName, const QString &measure, QObject *source, const QVariantMap &settings, QString *error)
+{
+    QList<QObject*> outputs;
+    int waveforms = mSound->waveformData()->count();
+    int spectrograms = mSound->spectrogramData()->count();
+
+    WaveformData *waveform = qobject_cast<WaveformData*>(source);
+    SpectrogramData *spectrogram = qobject_cast<SpectrogramData*>(source);
+    bool found;
+    if( waveform != 0 && mSound->waveformData()->contains(waveform) )
+        found = runScriptMeasure(mW2wPlugins, scriptName, measure, waveform, settings, mSound, error) || runScriptMeasure(mW2sPlugins, scriptName, measure, waveform, settings, mSound, error);
+    else if( spectrogram != 0 && mSound->spectrogramData()->contains(spectrogram) )
+        found = runScriptMeasure(mS2wPlugins, scriptName, measure, spectrogram, settings, mSound, error) || runScriptMeasure(mS2sPlugins, scriptName, measure, spectrogram, settings, mSound, error);
+    else
+    {
+        *error = "the source is not a waveform or spectrogram of this sound";
+        return outputs;
+    }
+    if( !found ) { *error = QString("there is no plugin called %1 that takes this kind of data").arg(scriptName); return outputs; }
+
+    // new data are added at the end
+    for(int i=waveforms; i<mSound->waveformData()->count(); i++)
+        outputs << mSound->waveformData()->at(i);
+    for(int i=spectrograms; i<mSound->spectrogramData()->count(); i++)
+        outputs << mSound->spectrogramData()->at(i);
+    return outputs;
+}
+
+QScriptValue calculateMeasure(QScriptContext *context, QScriptEngine *engine)
+{
+    // script: calculate(pluginScriptName, measure, source, settings), where settings is optional, e.g. { "Time step (ms)": 2 }
+    SoundWidget *widget = qobject_cast<SoundWidget*>( context->callee().data().toQObject() );
+    if( widget == 0 ) { return QScriptValue(); }
+    if( context->argumentCount() < 3 )
+        return context->throwError(QScriptContext::SyntaxError, "calculate(plugin, measure, source, settings): too few arguments");
+
+    QString error;
+    QList<QObject*> outputs = widget->calculate( context->argument(0).toString(), context->argument(1).toString(), context->argument(2).toQObject(), context->argument(3).toVariant().toMap(), &error );
+    if( !error.isEmpty() )
+        return context->throwError(QScriptContext::RangeError, "calculate: " + error);
+
+    QScriptValue array = engine->newArray( outputs.count() );
+    for(int i=0; i<outputs.count(); i++)
+        array.setProperty(i, engine->newQObject( outputs.at(i) ));
+    return array;
+}
+
 void SoundWidget::runScript()
 {
     QString fileName;
@@ -349,58 +545,33 @@ void SoundWidget::executeCode(QString code)
 
 void SoundWidget::setupScriptEnvironment()
 {
-    /// @todo Replace this functionality
-//    qScriptRegisterMetaType(mScriptEngine, waveformArrayToScriptValue, waveformArrayFromScriptValue);
-//    qScriptRegisterMetaType(mScriptEngine, spectrogramArrayToScriptValue, spectrogramArrayFromScriptValue);
-
-//    QStringList waveformNames;
-//    for(int i=0; i< mSound->waveformData()->count(); i++)
-//    waveformNames << mSound->waveformData()->at(i)->name();
-//    mScriptEngine->globalObject().setProperty("waveformNames", mScriptEngine->toScriptValue(waveformNames));
-
-//    QStringList spectrogramNames;
-//    for(int i=0; i< mSound->spectrogramData()->count(); i++)
-//    spectrogramNames << mSound->spectrogramData()->at(i)->name();
-//    mScriptEngine->globalObject().setProperty("spectrogramNames", mScriptEngine->toScriptValue(spectrogramNames));
-
-//    mScriptEngine->globalObject().setProperty("waveforms", mScriptEngine->toScriptValue(mSound->waveformData()));
-//    mScriptEngine->globalObject().setProperty("spectrograms", mScriptEngine->toScriptValue(mSound->waveformData()));
+    if( mScriptEngine == 0 ) { return; }
+    QScriptValue global = mScriptEngine->globalObject();
 
-//    mScriptEngine->globalObject().setProperty("widget", mScriptEngine->newQObject(this));
+    QStringList waveformNames;
+    for(int i=0; i< mSound->waveformData()->count(); i++)
+        waveformNames << mSound->waveformData()->at(i)->name();
+    global.setProperty("waveformNames", qScriptValueFromSequence(mScriptEngine, waveformNames));
 
-//    // add the w2s plugins as objects
-//    for(int i=0; i<mW2sPlugins->count(); i++)
-//    {
-//    QObject *someObject = mW2sPlugins->at(i);
-//	QScriptValue objectValue = mScriptEngine->newQObject(someObject);
-//    mScriptEngine->globalObject().setProperty(mW2sPlugins->at(i)->scriptName(), objectValue);
-//    }
+    QStringList spectrogramNames;
+    for(int i=0; i< mSound->spectrogramData()->count(); i++)
+        spectrogramNames << mSound->spectrogramData()->at(i)->name();
+    global.setProperty("spectrogramNames", qScriptValueFromSequence(mScriptEngine, spectrogramNames));
 
-//    // add the w2w plugins as objects
-//    for(int i=0; i<mW2wPlugins->count(); i++)
-//    {
-//    QObject *someObject = mW2wPlugins->at(i);
-//	QScriptValue objectValue = mScriptEngine->newQObject(someObject);
-//    mScriptEngine->globalObject().setProperty(mW2wPlugins->at(i)->scriptName(), objectValue);
-//    }
+    // waveforms[i].samples() and waveforms[i].times() return Buffer objects
+    global.setProperty("waveforms", waveformArrayToScriptValue(mScriptEngine, *mSound->waveformData()));
+    global.setProperty("spectrograms", spectrogramArrayToScriptValue(mScriptEngine, *mSound->spectrogramData()));
 
-//    // add the s2s plugins as objects
-//    for(int i=0; i<mS2sPlugins->count(); i++)
-//    {
-//    QObject *someObject = mS2sPlugins->at(i);
-//	QScriptValue objectValue = mScriptEngine->newQObject(someObject);
-//    mScriptEngine->globalObject().setProperty(mS2sPlugins->at(i)->scriptName(), objectValue);
-//    }
+    QScriptValue create = mScriptEngine->newFunction(createWaveform, 3);
+    create.setData( mScriptEngine->newQObject(mSound) );
+    global.setProperty("createWaveform", create);
 
-//    // add the s2w plugins as objects
-//    for(int i=0; i<mS2wPlugins->count(); i++)
-//    {
-//    QObject *someObject = mS2wPlugins->at(i);
-//	QScriptValue objectValue = mScriptEngine->newQObject(someObject);
-//    mScriptEngine->globalObject().setProperty(mS2wPlugins->at(i)->scriptName(), objectValue);
+    global.setProperty("widget", mScriptEngine->newQObject(this));
 
-////        qDebug() << "added" << mainWnd->s2w()->at(i)->scriptName() << engine->globalObject().property(mainWnd->s2w()->at(i)->scriptName()).isQObject();
-//    }
+    // the plugins are shared by all open sounds and do not add their output to any of them, so scripts run measures through the sound
+    QScriptValue calculate = mScriptEngine->newFunction(calculateMeasure, 4);
+    calculate.setData( mScriptEngine->newQObject(this) );
+    global.setProperty("calculate", calculate);
 }
 
 void SoundWidget::removeWaveform(int index)
@@ -419,6 +590,7 @@ void SoundWidget::removeWaveform(int index)
 	}
     }
     // then delete the data itself
+    mSound->forgetData( mSound->waveformData()->at(index) );
     delete mSound->waveformData()->takeAt(index);
 }
 
@@ -438,5 +610,18 @@ void SoundWidget::removeSpectrogram(int index)
 	}
     }
     // then delete the data itself
+    mSound->forgetData( mSound->spectrogramData()->at(index) );
     delete mSound->spectrogramData()->takeAt(index);
 }
+
+void SoundWidget::replaceWaveform(WaveformData *oldData, WaveformData *newData)
+{
+    for(int i=0; i<ui->plotDisplayWidget->plotViews()->count(); i++)
+        ui->plotDisplayWidget->plotViews()->at(i)->replaceCurveData(oldData, newData);
+}
+
+void SoundWidget::replaceSpectrogram(SpectrogramData *oldData, SpectrogramData *newData)
+{
+    for(int i=0; i<ui->plotDisplayWidget->plotViews()->count(); i++)
+        ui->plotDisplayWidget->plotViews()->at(i)->replaceSpectrogramData(oldData, newData);
+}
@@ -10,6 +10,7 @@
 #define SOUNDWIDGET_H
 
 #include <QMainWindow>
+#include <QVariant>
 #include <qwt_slider.h>
 
 class QVBoxLayout;
@@ -51,6 +52,12 @@ public:
 
     Sound * sound();
 
+    //! \brief Run the measure \a measure of the plugin with the script name \a scriptName on \a source (a WaveformData or SpectrogramData of the sound), with the settings in \a settings changed for this run only
+    /*!
+      The measure is run with Sound::calculate(), so its outputs are added to the sound and recorded as derived from \a source. Returns the new data objects; if the measure cannot be run, \a error receives the reason.
+      */
+    QList<QObject*> calculate(const QString &scriptName, const QString &measure, QObject *source, const QVariantMap &settings, QString *error);
+
 signals:
     //! \brief Emitted whenever the horizontal scale (e.g., sliders & buttons) changes
     void horizontalScaleUpdated(double left, double right);
@@ -68,6 +75,12 @@ public slots:
     //! \brief Remove the \a index-th spectrogram, if \a index is a valid index
     void removeSpectrogram(int index);
 
+    //! \brief Show \a newData wherever \a oldData is plotted
+    void replaceWaveform(WaveformData *oldData, WaveformData *newData);
+
+    //! \brief Show \a newData wherever \a oldData is plotted
+    void replaceSpectrogram(SpectrogramData *oldData, SpectrogramData *newData);
+
 private slots:
     //! \brief Launches a DataManagerDialog
     void launchDataManager();
@@ -78,6 +91,12 @@ private slots:
     //! \brief Launches a PlotManagerDialog
     void launchPlotManager();
 
+    //! \brief Calculates a spectrogram of only the visible region, or of an interval in it, at a finer resolution, and shows it in a new plot
+    void detailSpectrogram();
+
+    //! \brief Plays the sound into a StreamingWidget, which analyses it and displays the results as they arrive
+    void liveAnalysis();
+
     //! \brief Prompts the user to select a TextGrid file, and calls readTextGridFromFile
     void importTextGrid();
 
@@ -1,48 +1,96 @@
-#include <qwt_raster_data.h>
-
 #include <math.h>
+#include <string.h>
+#include <stdlib.h>
 
 #include "spectrogramdata.h"
 
 #include <QtDebug>
 #include <QTime>
 #include <QRegExp>
+#include <QDir>
+#include <QTemporaryFile>
 
-SpectrogramData::SpectrogramData() : mData(0), mTimes(0), mFrequencies(0), mWindowLength(-1.0f), mTimeStep(-1.0f)
+SpectrogramData::SpectrogramData() : mData(0), mTimes(0), mFrequencies(0), mWindowLength(-1.0f), mTimeStep(-1.0f), mMinimum(0), mMaximum(0), mRegionOfInterestStart(0), mRegionOfInterestEnd(0), mRefining(false), mMapped(0)
 {
 }
 
 SpectrogramData::SpectrogramData(QString n, double *data, double *times, size_t nFrames, double *frequencies, size_t nFreqBins , double windowLength, double timeStep)
-     : mLabel(n), mData(data), mTimes(times), mFrequencies(frequencies), mWindowLength(windowLength), mTimeStep(timeStep), mNFrames(nFrames), mNFreqBins(nFreqBins)
+     : mLabel(n), mData(data), mTimes(times), mFrequencies(frequencies), mWindowLength(windowLength), mTimeStep(timeStep), mNFrames(nFrames), mNFreqBins(nFreqBins), mRegionOfInterestStart(0), mRegionOfInterestEnd(0), mRefining(false), mMapped(0)
 {
     mSafeLabel = n;
     mSafeLabel.replace(QRegExp("[\\W]*"),"");
-    setInterval( Qt::XAxis, QwtInterval( getTimeFromIndex(0), getTimeFromIndex(mNFrames-1) ) );
-    setInterval( Qt::YAxis, QwtInterval( getFrequencyFromIndex(0), getFrequencyFromIndex(mNFreqBins-1) ) );
 
-    double min=999999, max=-999999;
-    for(quint32 i=0; i<mNFrames*mNFreqBins; i++)
+    mMinimum = 999999;
+    mMaximum = -999999;
+    for(size_t i=0; i<(size_t)mNFrames*mNFreqBins; i++)
     {
-        if( mData[i] < min )
-            min = mData[i];
-        if( mData[i] > max )
-            max = mData[i];
+        if( mData[i] < mMinimum )
+            mMinimum = mData[i];
+        if( mData[i] > mMaximum )
+            mMaximum = mData[i];
     }
-    setInterval( Qt::ZAxis, QwtInterval( min, max ) );
+}
+
+SpectrogramData::SpectrogramData(QString n, QFile *backing, uchar *mapped, size_t nFrames, double *frequencies, size_t nFreqBins, double windowLength, double timeStep, double minimum, double maximum)
+     : mLabel(n), mFrequencies(frequencies), mWindowLength(windowLength), mTimeStep(timeStep), mNFrames(nFrames), mNFreqBins(nFreqBins), mMinimum(minimum), mMaximum(maximum), mRegionOfInterestStart(0), mRegionOfInterestEnd(0), mRefining(false), mMapped(mapped)
+{
+    mSafeLabel = n;
+    mSafeLabel.replace(QRegExp("[\\W]*"),"");
+
+    mBackingFile = QSharedPointer<QFile>( backing, [mapped](QFile *file) { file->unmap(mapped); delete file; } );
+
+    mTimes = (double*)mMapped;
+    mData = mTimes + mNFrames;
 }
 
 SpectrogramData::~SpectrogramData()
 {
-    if(mData) { free(mData); }
-    if(mTimes){ free(mTimes); }
+    // a backing file is released by mBackingFile
+    if(!mMapped)
+    {
+        if(mData) { free(mData); }
+        if(mTimes){ free(mTimes); }
+    }
     if(mFrequencies) { free(mFrequencies); }
 }
 
+QFile* SpectrogramData::createBackingFile(size_t nFrames, size_t nFreqBins)
+{
+    QTemporaryFile *file = new QTemporaryFile( QDir::tempPath() + "/AcousticWorkspace-spectrogram-XXXXXX" );
+    if( !file->open() || !file->resize( sizeof(double) * ( nFrames + nFrames*nFreqBins ) ) )
+    {
+        qDebug() << "SpectrogramData::createBackingFile: could not create a file of" << nFrames << "time steps in" << QDir::tempPath();
+        delete file;
+        return 0;
+    }
+    return file;
+}
+
+QSharedPointer<QFile> SpectrogramData::backingFile() const
+{
+    return mBackingFile;
+}
+
+bool SpectrogramData::isBackedByFile() const
+{
+    return mMapped != 0;
+}
+
 QRectF SpectrogramData::boundingRect() const
 {
     return QRectF( getTimeFromIndex(0) , getFrequencyFromIndex(0), getTimeFromIndex(mNFrames-1)-getTimeFromIndex(0), getFrequencyFromIndex(mNFreqBins-1)-getFrequencyFromIndex(0) );
 }
 
+double SpectrogramData::minimum() const
+{
+    return mMinimum;
+}
+
+double SpectrogramData::maximum() const
+{
+    return mMaximum;
+}
+
 SpectrogramData* SpectrogramData::copy() const
 {
     SpectrogramData *copy = new SpectrogramData;
@@ -55,9 +103,8 @@ SpectrogramData* SpectrogramData::copy() const
     copy->mNFreqBins = mNFreqBins;
     copy->mSafeLabel = mSafeLabel;
 
-    copy->setInterval(Qt::XAxis, interval(Qt::XAxis) );
-    copy->setInterval(Qt::YAxis, interval(Qt::YAxis) );
-    copy->setInterval(Qt::ZAxis, interval(Qt::ZAxis) );
+    copy->mMinimum = mMinimum;
+    copy->mMaximum = mMaximum;
 
     quint32 i;
     copy->mTimes = (double*)malloc(sizeof(double)*mNFrames);
@@ -73,9 +120,9 @@ SpectrogramData* SpectrogramData::copy() const
     }
 
     copy->mData = (double*)malloc(sizeof(double)*mNFreqBins*mNFrames);
-    for(i=0; i<mNFreqBins*mNFrames; i++)
+    for(size_t j=0; j<(size_t)mNFreqBins*mNFrames; j++)
     {
-	*(copy->mData+i) = *(mData+i);
+	*(copy->mData+j) = *(mData+j);
     }
 
     return copy;
@@ -84,7 +131,7 @@ SpectrogramData* SpectrogramData::copy() const
 double SpectrogramData::dataAt(quint32 t, quint32 f) const
 {
     Q_CHECK_PTR(mData);
-    return *(mData + t*mNFreqBins + f);
+    return *(mData + (size_t)t*mNFreqBins + f);
 }
 
 double SpectrogramData::flatdata(quint32 i) const
@@ -105,6 +152,27 @@ double* SpectrogramData::pfrequencies() const
     return mFrequencies;
 }
 
+QVector<double> SpectrogramData::values() const
+{
+    QVector<double> values( mNFrames * mNFreqBins );
+    if( mData != 0 ) { memcpy( values.data(), mData, sizeof(double) * values.size() ); }
+    return values;
+}
+
+QVector<double> SpectrogramData::times() const
+{
+    QVector<double> times( mNFrames );
+    if( mTimes != 0 ) { memcpy( times.data(), mTimes, sizeof(double) * times.size() ); }
+    return times;
+}
+
+QVector<double> SpectrogramData::frequencies() const
+{
+    QVector<double> frequencies( mNFreqBins );
+    if( mFrequencies != 0 ) { memcpy( frequencies.data(), mFrequencies, sizeof(double) * frequencies.size() ); }
+    return frequencies;
+}
+
 
 bool SpectrogramData::inTimeRange(double t) const
 {
@@ -240,3 +308,70 @@ double SpectrogramData::getFrequencyFromIndex(int i) const
 {
     return *(mFrequencies+i);
 }
+
+void SpectrogramData::setFrame(quint32 index, const double *values)
+{
+    if( index >= mNFrames ) { return; }
+    memcpy( mData + (size_t)index*mNFreqBins, values, sizeof(double)*mNFreqBins );
+}
+
+void SpectrogramData::appendFrames(const double *times, const double *values, quint32 count)
+{
+    if( count == 0 ) { return; }
+    if( mMapped ) { qDebug() << "SpectrogramData::appendFrames: a spectrogram in a backing file cannot grow."; return; }
+
+    double *data = (double*)realloc( mData, sizeof(double)*(mNFrames+count)*mNFreqBins );
+    if( data == 0 ) { qDebug() << "SpectrogramData::appendFrames: memory allocation error."; return; }
+    mData = data;
+    double *newTimes = (double*)realloc( mTimes, sizeof(double)*(mNFrames+count) );
+    if( newTimes == 0 ) { qDebug() << "SpectrogramData::appendFrames: memory allocation error."; return; }
+    mTimes = newTimes;
+
+    memcpy( mTimes + mNFrames, times, sizeof(double)*count );
+    memcpy( mData + (size_t)mNFrames*mNFreqBins, values, sizeof(double)*count*mNFreqBins );
+
+    for(size_t i=0; i<(size_t)count*mNFreqBins; i++)
+    {
+        if( values[i] < mMinimum )
+            mMinimum = values[i];
+        if( values[i] > mMaximum )
+            mMaximum = values[i];
+    }
+    mNFrames += count;
+
+    emit framesChanged( times[0], times[count-1] );
+}
+
+void SpectrogramData::announceChange(double fromTime, double toTime)
+{
+    emit framesChanged(fromTime, toTime);
+}
+
+void SpectrogramData::setRegionOfInterest(double left, double right)
+{
+    mRegionOfInterestStart = left;
+    mRegionOfInterestEnd = right;
+}
+
+double SpectrogramData::regionOfInterestStart() const
+{
+    return mRegionOfInterestStart;
+}
+
+double SpectrogramData::regionOfInterestEnd() const
+{
+    return mRegionOfInterestEnd;
+}
+
+bool SpectrogramData::isRefining() const
+{
+    return mRefining;
+}
+
+void SpectrogramData::setRefining(bool refining)
+{
+    bool finished = mRefining && !refining;
+    mRefining = refining;
+    if( finished )
+        emit refinementFinished();
+}
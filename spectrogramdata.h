@@ -3,25 +3,36 @@
   \ingroup Data
   \brief A data class for spectrogram-like data.
 
-  This class subclasses QwtRasterData, offering added tools that are helpful for storing spectrogram-like data.
+  This class stores the values of a spectrogram, one time step after another, offering added tools that are helpful for storing spectrogram-like data. It depends on QtCore only, so that it can be used without a display; plots show it through a SpectrogramRaster.
 
   The class is a subclass of QObject so that SpectrogramData objects can be used by the scripting interface.
+
+  The values of a spectrogram may be replaced after it has been created, e.g., by a plugin that shows a coarse spectrogram at once and refines it in the background (see setFrame()), and marks it as refining until every value is final (see setRefining()). Such a plugin refines the region of interest first, which the plots that display the spectrogram set to their visible time range.
+
+  The times and values of a spectrogram that is too large for memory can be kept in a backing file (see createBackingFile()), which is mapped into memory. The rest of the class uses them as it would arrays in memory, and the operating system reads and writes the pages of the file as they are used, so that plots and plugins that read the spectrogram frame by frame stream through it.
 */
 
 #ifndef SPECTROGRAMDATA_H
 #define SPECTROGRAMDATA_H
 
-#include <qwt_raster_data.h>
-
 #include <math.h>
 
+#include <QObject>
 #include <QtDebug>
 #include <QTime>
+#include <QVector>
+#include <QRectF>
+#include <QSharedPointer>
 
-class SpectrogramData: public QObject, public QwtRasterData
+class QFile;
+
+class SpectrogramData: public QObject
 {
     Q_OBJECT
 public:
+    //! \brief The number of values above which a spectrogram that is read from a project is kept in a backing file, even if it was in memory when it was saved (2^27 values, i.e., 1 GB)
+    enum { OutOfCoreThreshold = 1 << 27 };
+
     //! \brief A bare-bones constructor
     SpectrogramData();
 
@@ -41,12 +52,30 @@ public:
     */
     SpectrogramData(QString n, double *data, double *times, size_t nFrames, double *frequencies, size_t nFreqBins, double windowLength, double timeStep);
 
+    //! \brief Construct a SpectrogramData object whose times and values are in the backing file \a backing, mapped at \a mapped
+    /*!
+      The file must have been created by createBackingFile() with the same \a nFrames and \a nFreqBins, and filled. The object takes ownership of the file and the mapping, and \a frequencies must be malloc'd, as in the other constructor. \a minimum and \a maximum are the range of the values, which would otherwise have to be read from the whole file.
+    */
+    SpectrogramData(QString n, QFile *backing, uchar *mapped, size_t nFrames, double *frequencies, size_t nFreqBins, double windowLength, double timeStep, double minimum, double maximum);
+
     ~SpectrogramData();
 
+    //! \brief Return the backing file, or a null pointer if the values are in memory
+    /*!
+      The file stays mapped, and the pointers returned by pdata() stay valid, for as long as a reference to it is kept, even after the spectrogram has been deleted. This lets a save stream the values from the file rather than copy them.
+      */
+    QSharedPointer<QFile> backingFile() const;
+
 public slots:
-    //! \brief Return the bounding rectangle of the data. Reimplemented from QwtRasterData
+    //! \brief Return the bounding rectangle of the data, in time and frequency
     QRectF boundingRect() const;
 
+    //! \brief Return the smallest value of the spectrogram
+    double minimum() const;
+
+    //! \brief Return the largest value of the spectrogram
+    double maximum() const;
+
     //! \brief Create a copy of the object. Performs a deep copy of the data structures
     virtual SpectrogramData* copy() const;
 
@@ -62,6 +91,15 @@ public slots:
     //! \brief Return a pointer to the frequency vector
     double* pfrequencies() const;
 
+    //! \brief Return a copy of the spectrogram data, one time step after another (for scripts)
+    QVector<double> values() const;
+
+    //! \brief Return a copy of the times of the time steps (for scripts)
+    QVector<double> times() const;
+
+    //! \brief Return a copy of the frequencies of the frequency bins (for scripts)
+    QVector<double> frequencies() const;
+
     //! \brief Check if \a t is within the time range of the spectrogram
     bool inTimeRange(double t) const;
 
@@ -80,7 +118,7 @@ public slots:
     //! \brief Return the index of the frequency bin below \a t
     quint32 frequencyBinBelow(double t) const;
 
-    //! \brief Return the interpolated value at time \a x, frequency \a y. Reimplemented from QwtRasterData
+    //! \brief Return the value of the time step and frequency bin that contain time \a x, frequency \a y
     double value(double x, double y) const;
 
     //! \brief Return the bilinearly interpolated value at time \a x, frequency \a y
@@ -113,6 +151,49 @@ public slots:
     //! \brief Return the frequency at bin \a i
     double getFrequencyFromIndex(int i) const;
 
+    //! \brief Replace the values of time step \a index with the getNFrequencyBins() values at \a values
+    /*!
+      The spectrogram is drawn on the GUI thread, so this must only be called on the GUI thread. Plots are not told about the change until announceChange() is called.
+      */
+    void setFrame(quint32 index, const double *values);
+
+    //! \brief Add \a count time steps, with the times \a times and the values \a values (\a count times getNFrequencyBins() values), to the end of the spectrogram
+    /*!
+      This is for spectrograms that grow as a stream is analysed. As with setFrame(), it must only be called on the GUI thread. framesChanged() is emitted for the new time steps.
+      */
+    void appendFrames(const double *times, const double *values, quint32 count);
+
+    //! \brief Return true if the times and values are kept in a backing file rather than in memory
+    bool isBackedByFile() const;
+
+    //! \brief Create a temporary backing file with room for \a nFrames time steps of \a nFreqBins values, or return 0 if it cannot be created. The file holds the times, followed by the values of one time step after another.
+    static QFile* createBackingFile(size_t nFrames, size_t nFreqBins);
+
+    //! \brief Emit framesChanged() for the time steps from \a fromTime to \a toTime, after their values have been replaced with setFrame()
+    void announceChange(double fromTime, double toTime);
+
+    //! \brief Record that the times from \a left to \a right are on display
+    void setRegionOfInterest(double left, double right);
+
+    //! \brief Return the start of the region of interest. If the start is not before the end, there is no region of interest.
+    double regionOfInterestStart() const;
+
+    //! \brief Return the end of the region of interest
+    double regionOfInterestEnd() const;
+
+    //! \brief Return true if the values are still being refined, i.e., if they are not yet final
+    bool isRefining() const;
+
+    //! \brief Record whether the values are still being refined. refinementFinished() is emitted when this changes from true to false.
+    void setRefining(bool refining);
+
+signals:
+    //! \brief Emitted when the values of the time steps from \a fromTime to \a toTime have been replaced
+    void framesChanged(double fromTime, double toTime);
+
+    //! \brief Emitted when the values have been refined completely, so that data computed from the coarse values can be recomputed
+    void refinementFinished();
+
 private:
     QString mLabel;
     QString mSafeLabel;
@@ -127,6 +208,16 @@ private:
     quint32 mTimeStepInSamples;
 
     quint32 mNFrames, mNFreqBins;
+
+    double mMinimum, mMaximum;
+
+    double mRegionOfInterestStart, mRegionOfInterestEnd;
+
+    bool mRefining;
+
+    //! \brief The backing file and its mapping, in which mTimes and mData lie, or 0 if they are in memory. The file is unmapped and deleted when the last reference to it is released.
+    QSharedPointer<QFile> mBackingFile;
+    uchar *mMapped;
 };
 
 // Q_DECLARE_METATYPE(SpectrogramData)
@@ -0,0 +1,26 @@
+#include "spectrogramraster.h"
+
+#include "spectrogramdata.h"
+
+SpectrogramRaster::SpectrogramRaster(const SpectrogramData *data) : mData(data)
+{
+    updateIntervals();
+}
+
+const SpectrogramData *SpectrogramRaster::spectrogramData() const
+{
+    return mData;
+}
+
+void SpectrogramRaster::updateIntervals()
+{
+    QRectF r = mData->boundingRect();
+    setInterval( Qt::XAxis, QwtInterval( r.left(), r.right() ) );
+    setInterval( Qt::YAxis, QwtInterval( r.top(), r.bottom() ) );
+    setInterval( Qt::ZAxis, QwtInterval( mData->minimum(), mData->maximum() ) );
+}
+
+double SpectrogramRaster::value(double x, double y) const
+{
+    return mData->value(x, y);
+}
@@ -0,0 +1,37 @@
+/*!
+  \class SpectrogramRaster
+  \ingroup Display
+  \brief Presents a SpectrogramData object to a QwtPlotSpectrogram.
+
+  SpectrogramData does not depend on Qwt, so a spectrogram item is given one of these instead. The ranges of time, frequency and value are copied from the spectrogram when the raster is created; updateIntervals() copies them again after the spectrogram has grown.
+
+  A spectrogram item deletes its raster when it is deleted or given another, but the raster does not own the spectrogram.
+*/
+
+#ifndef SPECTROGRAMRASTER_H
+#define SPECTROGRAMRASTER_H
+
+#include <qwt_raster_data.h>
+
+class SpectrogramData;
+
+class SpectrogramRaster : public QwtRasterData
+{
+public:
+    //! \brief Present \a data
+    SpectrogramRaster(const SpectrogramData *data);
+
+    //! \brief Return the spectrogram that is presented
+    const SpectrogramData* spectrogramData() const;
+
+    //! \brief Copy the ranges of time, frequency and value from the spectrogram
+    void updateIntervals();
+
+    //! \brief Return the value at time \a x, frequency \a y. Reimplemented from QwtRasterData
+    double value(double x, double y) const;
+
+private:
+    const SpectrogramData *mData;
+};
+
+#endif // SPECTROGRAMRASTER_H
@@ -0,0 +1,243 @@
+#include "streaminganalyser.h"
+
+#include "ringbuffer.h"
+#include "waveformdata.h"
+#include "spectrogramdata.h"
+
+#include <QtDebug>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+StreamingAnalyser::StreamingAnalyser(SampleRingBuffer *buffer, double samplingFrequency, double windowLength, double timeStep, QObject *parent) :
+    QObject(parent),
+    mBuffer(buffer),
+    mSamplingFrequency(samplingFrequency),
+    mWindowLength(windowLength),
+    mPendingStart(0),
+    mNextFrame(0),
+    mCentroidFrom(1000),
+    mCentroidTo(5000),
+    mRmsCreated(false),
+    mCentroidCreated(false),
+    mChangeCreated(false),
+    mSpectrogramCreated(false)
+{
+    mWindowLengthInSamples = qMax( 2, (int)(windowLength * samplingFrequency) );
+    mTimeStepInSamples = qMax( 1, (int)(timeStep * samplingFrequency) );
+    mFrequencyBins = mWindowLengthInSamples / 2;
+
+    // Gaussian window, as in the spectrogram plugin
+    mFilter = (double*)malloc(sizeof(double)*mWindowLengthInSamples);
+    double wls = mWindowLengthInSamples;
+    for(int i=0; i<mWindowLengthInSamples; i++)
+    {
+        double n = (-1*wls/2) + i;
+        mFilter[i] = exp( -0.5 * (2.5*n / (wls/2))*(2.5*n / (wls/2)) );
+    }
+
+    mIn = (double*)fftw_malloc(sizeof(double)*mWindowLengthInSamples);
+    mOut = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*mWindowLengthInSamples);
+    mPlan = fftw_plan_dft_r2c_1d(mWindowLengthInSamples, mIn, mOut, FFTW_ESTIMATE);
+    maPower.resize(mFrequencyBins);
+
+    // the defaults of the spectral change plugin
+    setSpectralChangeParameters(1, 10, 5);
+
+    mTimer.setInterval(PollInterval);
+    connect(&mTimer, SIGNAL(timeout()), this, SLOT(poll()));
+}
+
+StreamingAnalyser::~StreamingAnalyser()
+{
+    fftw_destroy_plan(mPlan);
+    fftw_free(mIn);
+    fftw_free(mOut);
+    free(mFilter);
+}
+
+double StreamingAnalyser::time() const
+{
+    return ( mPendingStart + maPending.size() ) / mSamplingFrequency;
+}
+
+void StreamingAnalyser::setCentroidRange(double from, double to)
+{
+    mCentroidFrom = from;
+    mCentroidTo = to;
+}
+
+void StreamingAnalyser::setSpectralChangeParameters(int from, int to, int N)
+{
+    mFromCoefficient = qMax(0, from);
+    mToCoefficient = qMax(mFromCoefficient, to);
+    mDeltaSpan = qMax(1, N);
+
+    int width = mToCoefficient - mFromCoefficient + 1;
+    maCosines.resize( width * mFrequencyBins );
+    for(int k=0; k<width; k++)
+        for(int j=0; j<mFrequencyBins; j++)
+            maCosines[k*mFrequencyBins + j] = cos( M_PI * (mFromCoefficient + k) * (j + 0.5) / mFrequencyBins ) / mFrequencyBins;
+
+    maCepstra.clear();
+    maCepstrumTimes.clear();
+}
+
+void StreamingAnalyser::start()
+{
+    mTimer.start();
+}
+
+void StreamingAnalyser::stop()
+{
+    mTimer.stop();
+}
+
+void StreamingAnalyser::poll()
+{
+    int available = mBuffer->available();
+    if( available == 0 ) { return; }
+
+    int size = maPending.size();
+    maPending.resize( size + available );
+    maPending.resize( size + mBuffer->read( maPending.data() + size, available ) );
+
+    // every frame whose samples have all arrived
+    while( mNextFrame * mTimeStepInSamples + mWindowLengthInSamples <= mPendingStart + maPending.size() )
+    {
+        qint64 first = mNextFrame * mTimeStepInSamples;
+        analyseFrame( maPending.constData() + (first - mPendingStart), (first + mWindowLengthInSamples/2.0) / mSamplingFrequency );
+        mNextFrame++;
+    }
+
+    // keep only the samples that the next frame needs
+    int consumed = qMin( (qint64)maPending.size(), mNextFrame * mTimeStepInSamples - mPendingStart );
+    if( consumed > 0 )
+    {
+        maPending.remove(0, consumed);
+        mPendingStart += consumed;
+    }
+
+    flushOutput();
+    emit advanced( time() );
+}
+
+void StreamingAnalyser::analyseFrame(const double *samples, double time)
+{
+    double sumOfSquares = 0;
+    for(int i=0; i<mWindowLengthInSamples; i++)
+    {
+        sumOfSquares += samples[i] * samples[i];
+        mIn[i] = samples[i] * mFilter[i];
+    }
+    maRmsTimes << time;
+    maRms << sqrt( sumOfSquares / mWindowLengthInSamples );
+
+    fftw_execute(mPlan);
+
+    double nyquist = floor( mSamplingFrequency / 2 );
+    double weighted = 0, total = 0;
+    int frame = maSpectra.size();
+    maSpectra.resize( frame + mFrequencyBins );
+    double *logPower = maSpectra.data() + frame;
+    for(int i=0; i<mFrequencyBins; i++)
+    {
+        double power = mOut[i][0]*mOut[i][0] + mOut[i][1]*mOut[i][1];
+        double frequency = i * (nyquist / mFrequencyBins);
+        if( frequency >= mCentroidFrom && frequency < mCentroidTo )
+        {
+            weighted += frequency * power;
+            total += power;
+        }
+        // silence would otherwise give minus infinity
+        logPower[i] = log( power + 1e-300 );
+    }
+    maSpectrumTimes << time;
+
+    maCentroidTimes << time;
+    maCentroid << ( total > 0 ? weighted / total : 0 );
+
+    // the cepstrum of this frame, and the spectral change of the frame mDeltaSpan frames back
+    int width = mToCoefficient - mFromCoefficient + 1;
+    QVector<double> cepstrum(width, 0.0);
+    for(int k=0; k<width; k++)
+    {
+        const double *cosines = maCosines.constData() + k*mFrequencyBins;
+        for(int j=0; j<mFrequencyBins; j++)
+            cepstrum[k] += cosines[j] * logPower[j];
+    }
+    maCepstra << cepstrum;
+    maCepstrumTimes << time;
+
+    if( maCepstra.count() == 2*mDeltaSpan + 1 )
+    {
+        double denominator = 0;
+        for(int n=1; n<=mDeltaSpan; n++)
+            denominator += 2*n*n;
+
+        double sum = 0;
+        for(int k=0; k<width; k++)
+        {
+            double delta = 0;
+            for(int n=1; n<=mDeltaSpan; n++)
+                delta += n * ( maCepstra.at(mDeltaSpan+n).at(k) - maCepstra.at(mDeltaSpan-n).at(k) ) / denominator;
+            sum += delta * delta;
+        }
+        maChangeTimes << maCepstrumTimes.at(mDeltaSpan);
+        maChange << sum / width;
+
+        maCepstra.removeFirst();
+        maCepstrumTimes.removeFirst();
+    }
+}
+
+void StreamingAnalyser::flushOutput()
+{
+    appendTo(&mRms, &mRmsCreated, tr("RMS (live)"), &maRmsTimes, &maRms);
+    appendTo(&mCentroid, &mCentroidCreated, tr("Centroid (live)"), &maCentroidTimes, &maCentroid);
+    appendTo(&mChange, &mChangeCreated, tr("Spectral change (live)"), &maChangeTimes, &maChange);
+
+    int frames = maSpectrumTimes.size();
+    if( frames == 0 ) { return; }
+    if( mSpectrogram != 0 )
+    {
+        mSpectrogram->appendFrames( maSpectrumTimes.constData(), maSpectra.constData(), frames );
+    }
+    else if( !mSpectrogramCreated )
+    {
+        // SpectrogramData takes ownership of malloc'd arrays
+        double *times = (double*)malloc(sizeof(double)*frames);
+        double *values = (double*)malloc(sizeof(double)*frames*mFrequencyBins);
+        double *frequencies = (double*)malloc(sizeof(double)*mFrequencyBins);
+        if( times == 0 || values == 0 || frequencies == 0 ) { qDebug() << "StreamingAnalyser: memory allocation error."; free(times); free(values); free(frequencies); return; }
+        memcpy( times, maSpectrumTimes.constData(), sizeof(double)*frames );
+        memcpy( values, maSpectra.constData(), sizeof(double)*frames*mFrequencyBins );
+        double nyquist = floor( mSamplingFrequency / 2 );
+        for(int i=0; i<mFrequencyBins; i++)
+            frequencies[i] = i * (nyquist / mFrequencyBins);
+
+        mSpectrogram = new SpectrogramData( tr("Spectrogram (live)"), values, times, frames, frequencies, mFrequencyBins, mWindowLength, mTimeStepInSamples / mSamplingFrequency );
+        mSpectrogramCreated = true;
+        emit spectrogramCreated(mSpectrogram);
+    }
+    maSpectrumTimes.clear();
+    maSpectra.clear();
+}
+
+void StreamingAnalyser::appendTo(QPointer<WaveformData> *data, bool *created, const QString &name, QVector<double> *times, QVector<double> *values)
+{
+    if( times->isEmpty() ) { return; }
+    if( *data != 0 )
+    {
+        (*data)->append(*times, *values);
+    }
+    else if( !*created )
+    {
+        *data = new WaveformData( name, *times, *values, (size_t)qRound( mSamplingFrequency / mTimeStepInSamples ) );
+        *created = true;
+        emit waveformCreated(*data);
+    }
+    times->clear();
+    values->clear();
+}
@@ -0,0 +1,119 @@
+/*!
+  \class StreamingAnalyser
+  \ingroup Data
+  \brief Analyses a stream of samples as it arrives, and appends the results to growing waveforms and a growing spectrogram.
+
+  The measures are incremental versions of those of the RMS, spectrogram, centroid and spectral change plugins, computed on one grid of Gaussian-windowed frames. Each time the analyser polls its SampleRingBuffer (every PollInterval milliseconds) it analyses every frame whose samples have all arrived, and appends the results with WaveformData::append() and SpectrogramData::appendFrames(). Only the samples that later frames still need are kept, so the memory used for samples does not grow with the length of the stream.
+
+  The output objects are created once their first values are known, and announced with waveformCreated() and spectrogramCreated(). Whoever displays them takes ownership; the analyser stops appending to an object once it has been deleted.
+
+  The measures differ from their plugin counterparts in ways that a stream requires:
+  - The spectrogram holds the logarithm of the power. The plugin subtracts the logarithm of the smallest power in the whole recording, which is not known until the stream ends.
+  - The centroid is weighted by power rather than by the values of the spectrogram, for the same reason.
+  - The spectral change is computed from the first cepstral coefficients of each frame (a cosine transform of the log spectrum), and lags by the span of the delta filter.
+*/
+
+#ifndef STREAMINGANALYSER_H
+#define STREAMINGANALYSER_H
+
+#include <QObject>
+#include <QVector>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+
+#include <fftw3.h>
+
+class SampleRingBuffer;
+class WaveformData;
+class SpectrogramData;
+
+class StreamingAnalyser : public QObject
+{
+    Q_OBJECT
+public:
+    //! \brief The time between two polls of the buffer, in milliseconds (about one display frame)
+    enum { PollInterval = 16 };
+
+    //! \brief Analyse the samples that arrive in \a buffer, recorded at \a samplingFrequency, in windows of \a windowLength seconds every \a timeStep seconds
+    StreamingAnalyser(SampleRingBuffer *buffer, double samplingFrequency, double windowLength = 0.030, double timeStep = 0.005, QObject *parent = 0);
+    ~StreamingAnalyser();
+
+    //! \brief Return the time of the last sample received
+    double time() const;
+
+    //! \brief Set the frequency range of the spectral centroid to \a from to \a to Hz
+    void setCentroidRange(double from, double to);
+
+    //! \brief Set the cepstral coefficients used for spectral change to \a from to \a to, and the span of the delta filter to \a N frames
+    void setSpectralChangeParameters(int from, int to, int N);
+
+public slots:
+    //! \brief Start polling the buffer
+    void start();
+
+    //! \brief Stop polling the buffer
+    void stop();
+
+    //! \brief Analyse the samples that have arrived since the last poll
+    void poll();
+
+signals:
+    //! \brief Emitted when the waveform \a data has been created. The receiver takes ownership.
+    void waveformCreated(WaveformData *data);
+
+    //! \brief Emitted when the spectrogram \a data has been created. The receiver takes ownership.
+    void spectrogramCreated(SpectrogramData *data);
+
+    //! \brief Emitted after each poll in which samples arrived; \a time is the time of the last sample received
+    void advanced(double time);
+
+private:
+    //! \brief Analyse the frame whose first sample is at \a samples, and add its results to the pending output
+    void analyseFrame(const double *samples, double time);
+
+    //! \brief Append the pending output to the output objects, creating them if need be
+    void flushOutput();
+
+    //! \brief Append \a times and \a values to \a *data, or create it with the name \a name if it has not been created yet. \a times and \a values are cleared.
+    void appendTo(QPointer<WaveformData> *data, bool *created, const QString &name, QVector<double> *times, QVector<double> *values);
+
+    SampleRingBuffer *mBuffer;
+    double mSamplingFrequency;
+    double mWindowLength;
+    int mWindowLengthInSamples, mTimeStepInSamples, mFrequencyBins;
+
+    //! \brief Samples that have arrived but are still needed; the first of them is sample number mPendingStart of the stream
+    QVector<double> maPending;
+    qint64 mPendingStart;
+    qint64 mNextFrame;
+
+    double *mFilter;
+    double *mIn;
+    fftw_complex *mOut;
+    fftw_plan mPlan;
+    QVector<double> maPower;
+
+    double mCentroidFrom, mCentroidTo;
+
+    int mFromCoefficient, mToCoefficient, mDeltaSpan;
+    //! \brief The cosine transform that takes a log spectrum to cepstral coefficients mFromCoefficient to mToCoefficient
+    QVector<double> maCosines;
+    //! \brief The cepstra and times of the most recent frames, as many as the delta filter spans
+    QList< QVector<double> > maCepstra;
+    QList<double> maCepstrumTimes;
+
+    //! \brief Results waiting to be appended
+    QVector<double> maRmsTimes, maRms;
+    QVector<double> maCentroidTimes, maCentroid;
+    QVector<double> maChangeTimes, maChange;
+    QVector<double> maSpectrumTimes, maSpectra;
+
+    QPointer<WaveformData> mRms, mCentroid, mChange;
+    QPointer<SpectrogramData> mSpectrogram;
+    bool mRmsCreated, mCentroidCreated, mChangeCreated, mSpectrogramCreated;
+
+    QTimer mTimer;
+};
+
+#endif // STREAMINGANALYSER_H
@@ -0,0 +1,69 @@
+#include "streamingwidget.h"
+
+#include "waveformdata.h"
+#include "spectrogramdata.h"
+#include "plotviewwidget.h"
+#include "ringbuffer.h"
+#include "streamsource.h"
+#include "streaminganalyser.h"
+
+StreamingWidget::StreamingWidget(const WaveformData *waveform, QWidget *parent) :
+    PlotDisplayAreaWidget(parent)
+{
+    setWindowTitle( tr("%1 (live)").arg( waveform->name() ) );
+
+    // a second of sound: far more than is needed between two polls
+    mBuffer = new SampleRingBuffer( (int)waveform->getSamplingFrequency() );
+    mSource = new StreamSource( waveform->samples(), waveform->getSamplingFrequency(), mBuffer, this );
+    mAnalyser = new StreamingAnalyser( mBuffer, waveform->getSamplingFrequency(), 0.030, 0.005, this );
+
+    connect( mAnalyser, SIGNAL(waveformCreated(WaveformData*)), this, SLOT(addWaveform(WaveformData*)) );
+    connect( mAnalyser, SIGNAL(spectrogramCreated(SpectrogramData*)), this, SLOT(addSpectrogram(SpectrogramData*)) );
+    connect( mAnalyser, SIGNAL(advanced(double)), this, SLOT(follow(double)) );
+    connect( mSource, SIGNAL(finished()), this, SLOT(sourceFinished()) );
+
+    setTimeMinMax( 0, DisplaySpan );
+    mAnalyser->start();
+    mSource->start();
+}
+
+StreamingWidget::~StreamingWidget()
+{
+    mAnalyser->stop();
+    mSource->stop();
+    mSource->wait();
+    delete mBuffer;
+}
+
+void StreamingWidget::addWaveform(WaveformData *data)
+{
+    data->setParent(this);
+    PlotViewWidget *pvw = new PlotViewWidget( data->name() );
+    pvw->addCurveData( data );
+    addPlotView( pvw, data->name() );
+}
+
+void StreamingWidget::addSpectrogram(SpectrogramData *data)
+{
+    data->setParent(this);
+    PlotViewWidget *pvw = new PlotViewWidget( data->name() );
+    pvw->addSpectrogramData( data );
+    addPlotView( pvw, data->name() );
+}
+
+void StreamingWidget::follow(double time)
+{
+    setTimeAxes( qMax( 0.0, time - DisplaySpan ), qMax( (double)DisplaySpan, time ) );
+}
+
+void StreamingWidget::sourceFinished()
+{
+    // whatever arrived after the last poll
+    mAnalyser->poll();
+    mAnalyser->stop();
+
+    double end = mAnalyser->time();
+    setTimeMinMax( 0, end );
+    setTimeAxes( qMax( 0.0, end - DisplaySpan ), qMax( (double)DisplaySpan, end ) );
+    setSliderFromWindow();
+}
@@ -0,0 +1,52 @@
+/*!
+  \class StreamingWidget
+  \ingroup Display
+  \brief A window that analyses a sound as it plays, and scrolls the results live.
+
+  The samples of a waveform are played into a SampleRingBuffer at real-time rate by a StreamSource, which stands in for an audio input. A StreamingAnalyser takes them from the buffer once per display frame, and each of its growing outputs is shown in a plot of its own. After every poll the time axis is moved so that the last DisplaySpan seconds are in view. Together with the ReplotScheduler, this bounds the time from a sample's arrival to its display to a few display frames.
+
+  The window owns the data it shows, so the results are discarded when it is closed.
+*/
+
+#ifndef STREAMINGWIDGET_H
+#define STREAMINGWIDGET_H
+
+#include "plotdisplayareawidget.h"
+
+class WaveformData;
+class SpectrogramData;
+class SampleRingBuffer;
+class StreamSource;
+class StreamingAnalyser;
+
+class StreamingWidget : public PlotDisplayAreaWidget
+{
+    Q_OBJECT
+public:
+    //! \brief The number of seconds shown while the stream is running
+    enum { DisplaySpan = 5 };
+
+    //! \brief Start streaming the samples of \a waveform
+    StreamingWidget(const WaveformData *waveform, QWidget *parent = 0);
+    ~StreamingWidget();
+
+private slots:
+    //! \brief Show the growing waveform \a data in a new plot
+    void addWaveform(WaveformData *data);
+
+    //! \brief Show the growing spectrogram \a data in a new plot
+    void addSpectrogram(SpectrogramData *data);
+
+    //! \brief Scroll the plots so that \a time is at the right edge
+    void follow(double time);
+
+    //! \brief Stop polling once the source has delivered its last sample, and let the plots be scrolled freely
+    void sourceFinished();
+
+private:
+    SampleRingBuffer *mBuffer;
+    StreamSource *mSource;
+    StreamingAnalyser *mAnalyser;
+};
+
+#endif // STREAMINGWIDGET_H
@@ -0,0 +1,44 @@
+#include "streamsource.h"
+
+#include "ringbuffer.h"
+
+#include <QElapsedTimer>
+
+StreamSource::StreamSource(const QVector<double> &samples, double samplingFrequency, SampleRingBuffer *buffer, QObject *parent) :
+    QThread(parent),
+    maSamples(samples),
+    mSamplingFrequency(samplingFrequency),
+    mBuffer(buffer),
+    mStopped(0)
+{
+}
+
+double StreamSource::samplingFrequency() const
+{
+    return mSamplingFrequency;
+}
+
+void StreamSource::stop()
+{
+    mStopped.storeRelease(1);
+}
+
+void StreamSource::run()
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    qint64 sent = 0;
+    qint64 total = maSamples.size();
+    while( !mStopped.loadAcquire() && sent < total )
+    {
+        qint64 due = qMin( total, (qint64)( clock.elapsed() * mSamplingFrequency / 1000.0 ) );
+        if( due > sent )
+        {
+            // samples that do not fit in the buffer are lost, as they would be from a device
+            mBuffer->write( maSamples.constData() + sent, due - sent );
+            sent = due;
+        }
+        msleep(BlockInterval);
+    }
+}
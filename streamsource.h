@@ -0,0 +1,46 @@
+/*!
+  \class StreamSource
+  \ingroup Data
+  \brief Plays the samples of a waveform into a SampleRingBuffer at the rate at which they were recorded.
+
+  This stands in for a live audio input: a thread of its own delivers samples in small blocks, as an audio device would, for as long as real time has passed since start(). Whatever reads the buffer therefore sees exactly what it would see from a microphone, and must keep up with it.
+*/
+
+#ifndef STREAMSOURCE_H
+#define STREAMSOURCE_H
+
+#include <QThread>
+#include <QVector>
+#include <QAtomicInt>
+
+class SampleRingBuffer;
+
+class StreamSource : public QThread
+{
+    Q_OBJECT
+public:
+    //! \brief The time between two deliveries of samples, in milliseconds
+    enum { BlockInterval = 5 };
+
+    //! \brief Prepare to play \a samples, recorded at \a samplingFrequency, into \a buffer. The samples are implicitly shared, not copied.
+    StreamSource(const QVector<double> &samples, double samplingFrequency, SampleRingBuffer *buffer, QObject *parent = 0);
+
+    //! \brief Return the sampling frequency of the stream
+    double samplingFrequency() const;
+
+public slots:
+    //! \brief Stop delivering samples. The thread finishes shortly afterwards.
+    void stop();
+
+protected:
+    //! \brief Deliver the samples. Reimplemented from QThread
+    void run();
+
+private:
+    QVector<double> maSamples;
+    double mSamplingFrequency;
+    SampleRingBuffer *mBuffer;
+    QAtomicInt mStopped;
+};
+
+#endif // STREAMSOURCE_H
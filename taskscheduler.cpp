@@ -0,0 +1,255 @@
+#include "taskscheduler.h"
+
+#include <QCoreApplication>
+#include <QVariant>
+#include <QMutexLocker>
+
+namespace {
+
+//! \brief The worker that is the current thread, if it is one
+thread_local void *currentWorkerThread = 0;
+
+}
+
+TaskScheduler::Deque::Deque() :
+    mTop(0),
+    mBottom(0)
+{
+    for(int i=0; i<DequeCapacity; i++)
+        maTasks[i].store(0, std::memory_order_relaxed);
+}
+
+bool TaskScheduler::Deque::push(Task *task)
+{
+    qint64 bottom = mBottom.load(std::memory_order_relaxed);
+    qint64 top = mTop.load(std::memory_order_acquire);
+    if( bottom - top >= DequeCapacity ) { return false; }
+
+    maTasks[bottom & (DequeCapacity-1)].store(task, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+TaskScheduler::Task* TaskScheduler::Deque::take()
+{
+    qint64 bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    qint64 top = mTop.load(std::memory_order_relaxed);
+
+    if( top > bottom )
+    {
+        // empty
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    Task *task = maTasks[bottom & (DequeCapacity-1)].load(std::memory_order_relaxed);
+    if( top == bottom )
+    {
+        // the last task, which a thief may be stealing at the same moment
+        if( !mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) )
+            task = 0;
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+TaskScheduler::Task* TaskScheduler::Deque::steal()
+{
+    qint64 top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    qint64 bottom = mBottom.load(std::memory_order_acquire);
+    if( top >= bottom ) { return 0; }
+
+    Task *task = maTasks[top & (DequeCapacity-1)].load(std::memory_order_acquire);
+    if( !mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) )
+        return 0;
+    return task;
+}
+
+TaskScheduler::Worker::Worker(TaskScheduler *scheduler, int index) :
+    scheduler(scheduler),
+    index(index)
+{
+}
+
+void TaskScheduler::Worker::run()
+{
+    currentWorkerThread = this;
+    while( true )
+    {
+        Task *task = scheduler->findTask(this);
+        if( task != 0 )
+        {
+            scheduler->execute(task);
+            continue;
+        }
+
+        // sleep until a task is queued; notify() counts the task before it looks for sleepers, and a worker counts itself as sleeping before it looks for tasks, so neither can miss the other
+        QMutexLocker locker(&scheduler->mSleepMutex);
+        if( scheduler->mStopping.load() ) { break; }
+        scheduler->mSleeping.fetch_add(1);
+        if( scheduler->mQueued.load() == 0 )
+            scheduler->mWakeUp.wait(&scheduler->mSleepMutex);
+        scheduler->mSleeping.fetch_sub(1);
+    }
+    currentWorkerThread = 0;
+}
+
+TaskScheduler::TaskScheduler(int concurrency, QObject *parent) :
+    QObject(parent),
+    mQueued(0),
+    mSleeping(0),
+    mStopping(false)
+{
+    for(int i=0; i<qMax(1, concurrency); i++)
+        maWorkers << new Worker(this, i);
+    for(int i=0; i<maWorkers.count(); i++)
+        maWorkers.at(i)->start();
+
+    if( QCoreApplication::instance() != 0 )
+        QCoreApplication::instance()->setProperty("taskScheduler", QVariant::fromValue<QObject*>(this));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    if( QCoreApplication::instance() != 0 && QCoreApplication::instance()->property("taskScheduler").value<QObject*>() == this )
+        QCoreApplication::instance()->setProperty("taskScheduler", QVariant());
+
+    mSleepMutex.lock();
+    mStopping.store(true);
+    mWakeUp.wakeAll();
+    mSleepMutex.unlock();
+
+    for(int i=0; i<maWorkers.count(); i++)
+        maWorkers.at(i)->wait();
+    qDeleteAll(maWorkers);
+    qDeleteAll(maShared);
+}
+
+int TaskScheduler::concurrency() const
+{
+    return maWorkers.count();
+}
+
+TaskScheduler::Worker* TaskScheduler::currentWorker() const
+{
+    Worker *worker = static_cast<Worker*>(currentWorkerThread);
+    return worker != 0 && worker->scheduler == this ? worker : 0;
+}
+
+void TaskScheduler::run(TaskGroup *group, const std::function<void()> &function)
+{
+    Task *task = new Task;
+    task->function = function;
+    task->group = group;
+    group->taskQueued();
+
+    Worker *self = currentWorker();
+    if( self != 0 )
+    {
+        if( !self->deque.push(task) )
+        {
+            // a full deque means that there is plenty of work for the others already
+            execute(task);
+            return;
+        }
+    }
+    else
+    {
+        QMutexLocker locker(&mSharedMutex);
+        maShared.enqueue(task);
+    }
+    notify();
+}
+
+void TaskScheduler::wait(TaskGroup *group)
+{
+    Worker *self = currentWorker();
+    while( !group->isDone() )
+    {
+        Task *task = self != 0 ? findTask(self) : findTask(group);
+        if( task != 0 )
+            execute(task);
+        else if( self != 0 )
+            QThread::yieldCurrentThread();
+        else
+            break; // the rest of the group is running on the workers, so there is nothing to do but sleep
+    }
+    group->waitUntilDone();
+}
+
+void TaskScheduler::parallelFor(qint64 begin, qint64 end, qint64 grain, const std::function<void(qint64,qint64)> &body, CancellationToken *token)
+{
+    if( end <= begin ) { return; }
+    // a few ranges per thread, so that the load can be balanced by stealing
+    if( grain < 1 ) { grain = qMax( (qint64)1, (end - begin) / (4 * concurrency()) ); }
+
+    if( end - begin <= grain )
+    {
+        if( token == 0 || !token->isCancelled() )
+            body(begin, end);
+        return;
+    }
+
+    TaskGroup group(token);
+    for(qint64 first=begin; first<end; first += grain)
+    {
+        qint64 last = qMin(end, first + grain);
+        run(&group, [&body, first, last]() { body(first, last); });
+    }
+    wait(&group);
+}
+
+void TaskScheduler::notify()
+{
+    mQueued.fetch_add(1);
+    if( mSleeping.load() > 0 )
+    {
+        QMutexLocker locker(&mSleepMutex);
+        mWakeUp.wakeOne();
+    }
+}
+
+TaskScheduler::Task* TaskScheduler::findTask(Worker *self)
+{
+    Task *task = self->deque.take();
+
+    for(int i=1; task == 0 && i<maWorkers.count(); i++)
+        task = maWorkers.at( (self->index + i) % maWorkers.count() )->deque.steal();
+
+    if( task == 0 )
+    {
+        QMutexLocker locker(&mSharedMutex);
+        if( !maShared.isEmpty() )
+            task = maShared.dequeue();
+    }
+
+    if( task != 0 )
+        mQueued.fetch_sub(1);
+    return task;
+}
+
+TaskScheduler::Task* TaskScheduler::findTask(TaskGroup *group)
+{
+    QMutexLocker locker(&mSharedMutex);
+    for(int i=0; i<maShared.count(); i++)
+    {
+        if( maShared.at(i)->group == group )
+        {
+            mQueued.fetch_sub(1);
+            return maShared.takeAt(i);
+        }
+    }
+    return 0;
+}
+
+void TaskScheduler::execute(Task *task)
+{
+    if( !task->group->isCancelled() )
+        task->function();
+    task->group->taskFinished();
+    delete task;
+}
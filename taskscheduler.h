@@ -0,0 +1,112 @@
+/*!
+  \class TaskScheduler
+  \ingroup Data
+  \brief The application's work-stealing task scheduler (see AbstractTaskScheduler).
+
+  Each of the concurrency() worker threads has a deque of tasks. A worker queues the tasks it creates at the bottom of its own deque and takes them back from there, newest first, so that nested work stays with the thread whose caches hold its data. An idle worker steals the oldest task from the top of another worker's deque. The deques are lock-free (after Chase and Lev, "Dynamic circular work-stealing deque"), and only their owner ever pushes, so queueing and taking one's own tasks involves no lock.
+
+  Threads that are not workers (e.g., the GUI thread, or a thread that writes a project) queue their tasks in a shared queue, which is protected by a mutex. While such a thread waits for a group, it runs only tasks of that group from the shared queue, so that the GUI thread is never held up by unrelated work, and once there are none left it sleeps until the last task of the group has finished (see TaskGroup::waitUntilDone()). A worker that waits for a group runs any task it can find.
+
+  Workers that find no task sleep until a task is queued. The scheduler registers itself as the "taskScheduler" property of the application, where taskScheduler() in interfaces.h finds it.
+*/
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <QObject>
+#include <QThread>
+#include <QList>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include "interfaces.h"
+
+class TaskScheduler : public QObject, public AbstractTaskScheduler
+{
+    Q_OBJECT
+    Q_INTERFACES(AbstractTaskScheduler)
+public:
+    //! \brief The number of tasks a worker's deque can hold; a task queued on a full deque is run at once instead
+    enum { DequeCapacity = 4096 };
+
+    //! \brief Start \a concurrency worker threads, and register the scheduler with the application
+    explicit TaskScheduler(int concurrency = QThread::idealThreadCount(), QObject *parent = 0);
+
+    //! \brief Stop the worker threads, once they have finished the tasks they are running
+    ~TaskScheduler();
+
+    int concurrency() const;
+    void run(TaskGroup *group, const std::function<void()> &task);
+    void wait(TaskGroup *group);
+    void parallelFor(qint64 begin, qint64 end, qint64 grain, const std::function<void(qint64,qint64)> &body, CancellationToken *token = 0);
+
+private:
+    struct Task
+    {
+        std::function<void()> function;
+        TaskGroup *group;
+    };
+
+    //! \brief A fixed-size work-stealing deque of tasks, which only its owner pushes onto and takes from at the bottom
+    class Deque
+    {
+    public:
+        Deque();
+
+        //! \brief Push \a task at the bottom, or return false if the deque is full
+        bool push(Task *task);
+
+        //! \brief Take the newest task from the bottom, or return 0
+        Task* take();
+
+        //! \brief Steal the oldest task from the top, or return 0 if the deque is empty or another thread got there first
+        Task* steal();
+
+    private:
+        std::atomic<qint64> mTop, mBottom;
+        std::atomic<Task*> maTasks[DequeCapacity];
+    };
+
+    class Worker : public QThread
+    {
+    public:
+        Worker(TaskScheduler *scheduler, int index);
+        void run();
+
+        TaskScheduler *scheduler;
+        int index;
+        Deque deque;
+    };
+
+    //! \brief Return the worker of this scheduler that is the current thread, or 0
+    Worker* currentWorker() const;
+
+    //! \brief Count a queued task, and wake a sleeping worker to run it
+    void notify();
+
+    //! \brief Find a task for the worker \a self: its own newest, another's oldest, or one from the shared queue
+    Task* findTask(Worker *self);
+
+    //! \brief Take a task of \a group from the shared queue, for a thread that is not a worker
+    Task* findTask(TaskGroup *group);
+
+    //! \brief Run \a task (unless its group has been cancelled), and delete it
+    void execute(Task *task);
+
+    QList<Worker*> maWorkers;
+
+    QMutex mSharedMutex;
+    QQueue<Task*> maShared;
+
+    //! \brief The number of tasks that are queued and have not been taken
+    std::atomic<int> mQueued;
+    std::atomic<int> mSleeping;
+    std::atomic<bool> mStopping;
+    QMutex mSleepMutex;
+    QWaitCondition mWakeUp;
+};
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,21 @@
+# -------------------------------------------------
+# Checks that block measures run through a BlockPipeline give the same
+# frames as the plugins' calculate(). It uses the plugins that are built
+# in the plugins folder of the build.
+# -------------------------------------------------
+TARGET = tst_blockpipeline
+TEMPLATE = app
+QT = core concurrent testlib
+CONFIG += testcase console
+CONFIG -= app_bundle
+INCLUDEPATH += ../..
+DEFINES += PLUGINS_DIR=\\\"$$OUT_PWD/../../plugins\\\"
+SOURCES += tst_blockpipeline.cpp
+LIBS += -L$$OUT_PWD/../../core \
+    -lawcore
+LIBS += -L./ \
+    -llibsndfile-1 \
+    -lfftw3 \
+    -lfftw3_threads \
+    -lm \
+    -lgsl
@@ -0,0 +1,187 @@
+#include <QtTest>
+#include <QDir>
+#include <QStandardPaths>
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "interfaces.h"
+#include "pluginhost.h"
+#include "pluginproxy.h"
+#include "blockpipeline.h"
+#include "framecollector.h"
+#include "waveformdata.h"
+#include "spectrogramdata.h"
+
+class TestBlockPipeline : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void rmsMatchesCalculate_data();
+    void rmsMatchesCalculate();
+    void centroidMatchesCalculate_data();
+    void centroidMatchesCalculate();
+
+private:
+    //! \brief Return the loaded plugin behind the plugin of \a plugins with the script name \a scriptName, or 0
+    template<class Plugin>
+    static Plugin* loadedPlugin(QList<Plugin*> *plugins, const QString &scriptName);
+
+    //! \brief Run measure 0 of \a plugin on \a source with calculate(), and return the waveform it creates, or 0. The caller takes ownership.
+    template<class Plugin, class Source>
+    static WaveformData* calculated(Plugin *plugin, Source *source);
+
+    //! \brief Run measure 0 of \a plugin on \a source through a BlockPipeline, in blocks of \a blockSize frames, and return the waveform it creates, or 0. The caller takes ownership.
+    template<class Source>
+    static WaveformData* streamed(AbstractMeasurement *plugin, Derivation::Type type, const Source *source, qint64 blockSize);
+
+    //! \brief Return a waveform of \a n samples at \a samplingFrequency: a tone whose amplitude rises and falls
+    static WaveformData* tone(int n, double samplingFrequency);
+
+    //! \brief Return a spectrogram of \a nFrames frames of \a nBins bins, from 0 to 4000 Hz, whose peak moves up from frame to frame
+    static SpectrogramData* sweep(int nFrames, int nBins);
+
+    PluginHost *mHost;
+};
+
+void TestBlockPipeline::initTestCase()
+{
+    // keep the index of the test apart from the application's
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY2( QDir(PLUGINS_DIR).exists(), "the plugins have not been built" );
+
+    mHost = new PluginHost(this);
+    mHost->loadPlugins( QDir(PLUGINS_DIR) );
+}
+
+void TestBlockPipeline::rmsMatchesCalculate_data()
+{
+    QTest::addColumn<qint64>("blockSize");
+    QTest::newRow("one block") << (qint64)FrameCollector::DefaultBlockSize;
+    QTest::newRow("blocks shorter than a window") << (qint64)37;
+    QTest::newRow("one sample at a time") << (qint64)1;
+}
+
+void TestBlockPipeline::rmsMatchesCalculate()
+{
+    QFETCH(qint64, blockSize);
+
+    AbstractWaveform2WaveformMeasure *plugin = loadedPlugin(mHost->w2w(), "rmsLibrary");
+    QVERIFY( plugin != 0 );
+    plugin->setParameter("Window length (ms)", 10);
+    plugin->setParameter("Time step (ms)", 5);
+
+    QScopedPointer<WaveformData> source( tone(4000, 8000) );
+    QScopedPointer<WaveformData> expected( calculated(plugin, source.data()) );
+    QScopedPointer<WaveformData> actual( streamed(plugin, Derivation::Waveform2Waveform, source.data(), blockSize) );
+    QVERIFY( !expected.isNull() );
+    QVERIFY( !actual.isNull() );
+
+    // calculate() counts its frames from the duration of the sound, which is a sample shorter than the samples span, so it stops a frame or two before the end
+    QVERIFY( actual->getNSamples() >= expected->getNSamples() );
+    QVERIFY( actual->getNSamples() <= expected->getNSamples() + 2 );
+    for(size_t i=0; i<expected->getNSamples(); i++)
+    {
+        QCOMPARE( actual->xData().at(i), expected->xData().at(i) );
+        QCOMPARE( actual->yData().at(i), expected->yData().at(i) );
+    }
+    QCOMPARE( actual->name(), expected->name() );
+}
+
+void TestBlockPipeline::centroidMatchesCalculate_data()
+{
+    QTest::addColumn<qint64>("blockSize");
+    QTest::newRow("one block") << (qint64)FrameCollector::DefaultBlockSize;
+    QTest::newRow("uneven blocks") << (qint64)7;
+}
+
+void TestBlockPipeline::centroidMatchesCalculate()
+{
+    QFETCH(qint64, blockSize);
+
+    AbstractSpectrogram2WaveformMeasure *plugin = loadedPlugin(mHost->s2w(), "centroidLibrary");
+    QVERIFY( plugin != 0 );
+    plugin->setParameter("From (Hz)", 500);
+    plugin->setParameter("To (Hz)", 3000);
+
+    QScopedPointer<SpectrogramData> source( sweep(50, 64) );
+    QScopedPointer<WaveformData> expected( calculated(plugin, source.data()) );
+    QScopedPointer<WaveformData> actual( streamed(plugin, Derivation::Spectrogram2Waveform, source.data(), blockSize) );
+    QVERIFY( !expected.isNull() );
+    QVERIFY( !actual.isNull() );
+
+    QCOMPARE( actual->getNSamples(), expected->getNSamples() );
+    for(size_t i=0; i<expected->getNSamples(); i++)
+    {
+        QCOMPARE( actual->xData().at(i), expected->xData().at(i) );
+        QCOMPARE( actual->yData().at(i), expected->yData().at(i) );
+    }
+    QCOMPARE( actual->name(), expected->name() );
+}
+
+template<class Plugin>
+Plugin* TestBlockPipeline::loadedPlugin(QList<Plugin*> *plugins, const QString &scriptName)
+{
+    foreach(Plugin *plugin, *plugins)
+    {
+        if( plugin->scriptName() != scriptName ) { continue; }
+        PluginProxy *proxy = dynamic_cast<PluginProxy*>(plugin);
+        return proxy != 0 ? qobject_cast<Plugin*>( proxy->instance() ) : plugin;
+    }
+    return 0;
+}
+
+template<class Plugin, class Source>
+WaveformData* TestBlockPipeline::calculated(Plugin *plugin, Source *source)
+{
+    WaveformData *output = 0;
+    QMetaObject::Connection connection = QObject::connect(plugin, &Plugin::waveformCreated, [&output](WaveformData *data) { output = data; });
+    plugin->calculate(0, source);
+    QObject::disconnect(connection);
+    return output;
+}
+
+template<class Source>
+WaveformData* TestBlockPipeline::streamed(AbstractMeasurement *plugin, Derivation::Type type, const Source *source, qint64 blockSize)
+{
+    BlockPipeline pipeline;
+    pipeline.addStage(plugin, type, 0);
+    FrameCollector::send(source, &pipeline, blockSize);
+    pipeline.finish();
+    if( !pipeline.succeeded() ) { return 0; }
+    return pipeline.output()->takeWaveform();
+}
+
+WaveformData* TestBlockPipeline::tone(int n, double samplingFrequency)
+{
+    QVector<double> times(n), samples(n);
+    for(int i=0; i<n; i++)
+    {
+        times[i] = i / samplingFrequency;
+        samples[i] = sin( M_PI * i / n ) * sin( 2 * M_PI * 440 * times.at(i) );
+    }
+    return new WaveformData("tone", times, samples, (size_t)samplingFrequency);
+}
+
+SpectrogramData* TestBlockPipeline::sweep(int nFrames, int nBins)
+{
+    // SpectrogramData takes ownership of malloc'd arrays
+    double *values = (double*)malloc(sizeof(double)*nFrames*nBins);
+    double *times = (double*)malloc(sizeof(double)*nFrames);
+    double *frequencies = (double*)malloc(sizeof(double)*nBins);
+    for(int j=0; j<nBins; j++)
+        frequencies[j] = j * 4000.0 / nBins;
+    for(int i=0; i<nFrames; i++)
+    {
+        times[i] = 0.015 + i * 0.005;
+        double peak = 500 + i * 2500.0 / nFrames;
+        for(int j=0; j<nBins; j++)
+            values[i*nBins + j] = 1 + exp( -0.5 * pow( (frequencies[j] - peak) / 300, 2 ) );
+    }
+    return new SpectrogramData("sweep", values, times, nFrames, frequencies, nBins, 0.030, 0.005);
+}
+
+QTEST_GUILESS_MAIN(TestBlockPipeline)
+
+#include "tst_blockpipeline.moc"
@@ -0,0 +1,19 @@
+# -------------------------------------------------
+# Checks DtwAligner against alignments of short feature tracks that
+# were worked out by hand.
+# -------------------------------------------------
+TARGET = tst_dtwaligner
+TEMPLATE = app
+QT = core concurrent testlib
+CONFIG += testcase console
+CONFIG -= app_bundle
+INCLUDEPATH += ../..
+SOURCES += tst_dtwaligner.cpp
+LIBS += -L$$OUT_PWD/../../core \
+    -lawcore
+LIBS += -L./ \
+    -llibsndfile-1 \
+    -lfftw3 \
+    -lfftw3_threads \
+    -lm \
+    -lgsl
@@ -0,0 +1,162 @@
+#include <QtTest>
+
+#include "dtwaligner.h"
+#include "timewarp.h"
+
+typedef QVector< QPair<int,int> > Path;
+Q_DECLARE_METATYPE(Path)
+
+class TestDtwAligner : public QObject
+{
+    Q_OBJECT
+private slots:
+    void alignsShortTracks_data();
+    void alignsShortTracks();
+    void bandKeepsPathNearDiagonal();
+    void coarseLevelsFindStretch();
+    void warpMapsOntoMeanTime();
+    void rejectsMismatchedDimensions();
+
+private:
+    //! \brief Return a one-dimensional track of \a values, one frame every 10 ms, without normalising it
+    static DtwAligner::Features track(const QVector<double> &values);
+
+    //! \brief Return the path from \a cells, which are given as from, to, from, to, ...
+    static Path path(const QVector<int> &cells);
+
+    //! \brief Compare \a actual with \a expected time by time, allowing for rounding
+    static void compareTimes(const QVector<double> &actual, const QVector<double> &expected);
+};
+
+void TestDtwAligner::alignsShortTracks_data()
+{
+    QTest::addColumn< QVector<double> >("from");
+    QTest::addColumn< QVector<double> >("to");
+    QTest::addColumn<Path>("expected");
+    QTest::addColumn<double>("distance");
+
+    QTest::newRow("identical") << (QVector<double>() << 0 << 1 << 2 << 3) << (QVector<double>() << 0 << 1 << 2 << 3)
+                               << path(QVector<int>() << 0 << 0 << 1 << 1 << 2 << 2 << 3 << 3) << 0.0;
+    // the repeated frame of the first track is matched with the same frame of the second
+    QTest::newRow("repeated frame") << (QVector<double>() << 0 << 1 << 1 << 2) << (QVector<double>() << 0 << 1 << 2)
+                                    << path(QVector<int>() << 0 << 0 << 1 << 1 << 2 << 1 << 3 << 2) << 0.0;
+    // both frames are 1 from the only frame of the second track; 2 over 3 frames
+    QTest::newRow("one frame") << (QVector<double>() << 0 << 2) << (QVector<double>() << 1)
+                               << path(QVector<int>() << 0 << 0 << 1 << 0) << 2.0/3;
+    // without a band, the path runs along the edges, where every frame matches
+    QTest::newRow("edges") << (QVector<double>() << 0 << 1 << 1 << 1 << 1 << 1 << 1 << 1) << (QVector<double>() << 0 << 0 << 0 << 0 << 0 << 0 << 0 << 1)
+                           << path(QVector<int>() << 0 << 0 << 0 << 1 << 0 << 2 << 0 << 3 << 0 << 4 << 0 << 5 << 0 << 6
+                                   << 1 << 7 << 2 << 7 << 3 << 7 << 4 << 7 << 5 << 7 << 6 << 7 << 7 << 7) << 0.0;
+}
+
+void TestDtwAligner::alignsShortTracks()
+{
+    QFETCH(QVector<double>, from);
+    QFETCH(QVector<double>, to);
+    QFETCH(Path, expected);
+    QFETCH(double, distance);
+
+    DtwAligner aligner;
+    aligner.setBandWidth(1);
+    QVERIFY( aligner.setFeatures( track(from), track(to) ) );
+
+    double actualDistance = -1;
+    QCOMPARE( aligner.path(&actualDistance), expected );
+    QCOMPARE( actualDistance, distance );
+}
+
+void TestDtwAligner::bandKeepsPathNearDiagonal()
+{
+    // the tracks of the "edges" row above, in a band of one frame on either side of the diagonal
+    DtwAligner aligner;
+    aligner.setBandWidth(0.125);
+    QVERIFY( aligner.setFeatures( track(QVector<double>() << 0 << 1 << 1 << 1 << 1 << 1 << 1 << 1), track(QVector<double>() << 0 << 0 << 0 << 0 << 0 << 0 << 0 << 1) ) );
+
+    double distance = -1;
+    Path actual = aligner.path(&distance);
+    for(int k=0; k<actual.count(); k++)
+        QVERIFY2( qAbs( actual.at(k).second - actual.at(k).first ) <= 1, qPrintable( QString("(%1, %2) is outside the band").arg(actual.at(k).first).arg(actual.at(k).second) ) );
+
+    // five frames of the first track, 1 to 5, cannot be matched with a 1 of the second; 5 over 16 frames
+    QCOMPARE( actual, path(QVector<int>() << 0 << 0 << 0 << 1 << 1 << 2 << 2 << 3 << 3 << 4 << 4 << 5 << 5 << 6 << 6 << 7 << 7 << 7) );
+    QCOMPARE( distance, 5.0/16 );
+}
+
+void TestDtwAligner::coarseLevelsFindStretch()
+{
+    // the second track is the first played at half speed; with a radius of 1 the tracks are coarsened three times
+    QVector<double> from, to;
+    Path expected;
+    for(int i=0; i<20; i++)
+    {
+        from << i;
+        to << i << i;
+        expected << qMakePair(i, 2*i) << qMakePair(i, 2*i+1);
+    }
+
+    DtwAligner aligner;
+    aligner.setRadius(1);
+    QVERIFY( aligner.setFeatures( track(from), track(to) ) );
+
+    double distance = -1;
+    QCOMPARE( aligner.path(&distance), expected );
+    QCOMPARE( distance, 0.0 );
+}
+
+void TestDtwAligner::warpMapsOntoMeanTime()
+{
+    DtwAligner aligner;
+    aligner.setBandWidth(1);
+    QVERIFY( aligner.setFeatures( track(QVector<double>() << 0 << 1 << 1 << 2), track(QVector<double>() << 0 << 1 << 2) ) );
+
+    QVector<double> times = QVector<double>() << 0 << 0.01 << 0.02 << 0.03;
+
+    // one frame matched with several is mapped onto their mean time
+    compareTimes( aligner.warp( path(QVector<int>() << 0 << 0 << 1 << 1 << 1 << 2 << 2 << 2 << 3 << 2) ).map(times), QVector<double>() << 0 << 0.015 << 0.02 << 0.02 );
+
+    // the frames of the path found
+    TimeWarp warp = aligner.warp();
+    QCOMPARE( warp.knotCount(), 4 );
+    compareTimes( warp.map(times), QVector<double>() << 0 << 0.01 << 0.01 << 0.02 );
+}
+
+void TestDtwAligner::rejectsMismatchedDimensions()
+{
+    DtwAligner::Features twoDimensions;
+    twoDimensions.dims = 2;
+    twoDimensions.values << 0 << 1;
+    twoDimensions.times << 0;
+
+    DtwAligner aligner;
+    QVERIFY( !aligner.setFeatures( track(QVector<double>() << 0), twoDimensions ) );
+    QVERIFY( aligner.path().isEmpty() );
+}
+
+DtwAligner::Features TestDtwAligner::track(const QVector<double> &values)
+{
+    DtwAligner::Features features;
+    features.dims = 1;
+    features.values = values;
+    for(int i=0; i<values.count(); i++)
+        features.times << i * 0.01;
+    return features;
+}
+
+Path TestDtwAligner::path(const QVector<int> &cells)
+{
+    Path p;
+    for(int k=0; k+1<cells.count(); k+=2)
+        p << qMakePair( cells.at(k), cells.at(k+1) );
+    return p;
+}
+
+void TestDtwAligner::compareTimes(const QVector<double> &actual, const QVector<double> &expected)
+{
+    QCOMPARE( actual.count(), expected.count() );
+    for(int i=0; i<actual.count(); i++)
+        QVERIFY2( qAbs( actual.at(i) - expected.at(i) ) < 1e-12, qPrintable( QString("time %1 is %2 rather than %3").arg(i).arg(actual.at(i)).arg(expected.at(i)) ) );
+}
+
+QTEST_GUILESS_MAIN(TestDtwAligner)
+
+#include "tst_dtwaligner.moc"
@@ -0,0 +1,20 @@
+# -------------------------------------------------
+# Checks that PluginHost loads plugins with metadata lazily. It uses the
+# plugins that are built in the plugins folder of the build.
+# -------------------------------------------------
+TARGET = tst_pluginhost
+TEMPLATE = app
+QT = core concurrent testlib
+CONFIG += testcase console
+CONFIG -= app_bundle
+INCLUDEPATH += ../..
+DEFINES += PLUGINS_DIR=\\\"$$OUT_PWD/../../plugins\\\"
+SOURCES += tst_pluginhost.cpp
+LIBS += -L$$OUT_PWD/../../core \
+    -lawcore
+LIBS += -L./ \
+    -llibsndfile-1 \
+    -lfftw3 \
+    -lfftw3_threads \
+    -lm \
+    -lgsl
@@ -0,0 +1,118 @@
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+#include "interfaces.h"
+#include "pluginhost.h"
+#include "pluginlibrary.h"
+#include "pluginproxy.h"
+
+class TestPluginHost : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void proxiesDoNotLoadLibraries_data();
+    void proxiesDoNotLoadLibraries();
+    void proxyDescribesPluginFromMetadata();
+    void proxyLoadsLibraryWhenUsed();
+
+private:
+    //! \brief Return every plugin of \a host, of whichever interface
+    static QList<QObject*> allPlugins(PluginHost *host);
+
+    //! \brief Return the waveform-to-waveform plugin of \a host with the script name \a scriptName, or 0
+    static AbstractWaveform2WaveformMeasure* w2wPlugin(PluginHost *host, const QString &scriptName);
+};
+
+void TestPluginHost::initTestCase()
+{
+    // keep the index of the test apart from the application's
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY2( QDir(PLUGINS_DIR).exists(), "the plugins have not been built" );
+}
+
+void TestPluginHost::proxiesDoNotLoadLibraries_data()
+{
+    QTest::addColumn<bool>("fromIndex");
+    QTest::newRow("metadata read from the files") << false;
+    QTest::newRow("metadata read from the index") << true;
+}
+
+void TestPluginHost::proxiesDoNotLoadLibraries()
+{
+    QFETCH(bool, fromIndex);
+    // the first row writes the index that the second reads
+    if( fromIndex )
+        QVERIFY( QFile::exists( PluginHost::indexFileName() ) );
+    else
+        QFile::remove( PluginHost::indexFileName() );
+
+    PluginHost host;
+    host.loadPlugins( QDir(PLUGINS_DIR) );
+
+    QList<QObject*> plugins = allPlugins(&host);
+    QVERIFY( !plugins.isEmpty() );
+    foreach(QObject *plugin, plugins)
+    {
+        PluginProxy *proxy = dynamic_cast<PluginProxy*>(plugin);
+        QVERIFY2( proxy != 0, qPrintable( plugin->metaObject()->className() + QString(" was loaded instead of being put behind a proxy") ) );
+        QVERIFY2( !proxy->library()->isLoaded(), qPrintable( proxy->library()->fileName() ) );
+    }
+}
+
+void TestPluginHost::proxyDescribesPluginFromMetadata()
+{
+    PluginHost host;
+    host.loadPlugins( QDir(PLUGINS_DIR) );
+
+    AbstractWaveform2WaveformMeasure *plugin = w2wPlugin(&host, "unaryOperationsLibrary");
+    QVERIFY( plugin != 0 );
+    QCOMPARE( plugin->name(), QString("Unary Operations Library") );
+    QCOMPARE( plugin->names(), QStringList() << "Log10" << "Ln" << "Negative" );
+    QVERIFY( !dynamic_cast<PluginProxy*>(plugin)->library()->isLoaded() );
+}
+
+void TestPluginHost::proxyLoadsLibraryWhenUsed()
+{
+    PluginHost host;
+    host.loadPlugins( QDir(PLUGINS_DIR) );
+
+    AbstractWaveform2WaveformMeasure *plugin = w2wPlugin(&host, "unaryOperationsLibrary");
+    QVERIFY( plugin != 0 );
+    PluginProxy *proxy = dynamic_cast<PluginProxy*>(plugin);
+    QVERIFY( proxy != 0 );
+
+    QObject *instance = proxy->instance();
+    QVERIFY( instance != 0 );
+    QVERIFY( proxy->library()->isLoaded() );
+    QVERIFY( qobject_cast<AbstractWaveform2WaveformMeasure*>(instance) != 0 );
+    QVERIFY( dynamic_cast<PluginProxy*>(instance) == 0 );
+}
+
+QList<QObject*> TestPluginHost::allPlugins(PluginHost *host)
+{
+    QList<QObject*> plugins;
+    foreach(AbstractWaveform2WaveformMeasure *plugin, *host->w2w())
+        plugins << plugin;
+    foreach(AbstractWaveform2SpectrogramMeasure *plugin, *host->w2s())
+        plugins << plugin;
+    foreach(AbstractSpectrogram2WaveformMeasure *plugin, *host->s2w())
+        plugins << plugin;
+    foreach(AbstractSpectrogram2SpectrogramMeasure *plugin, *host->s2s())
+        plugins << plugin;
+    return plugins;
+}
+
+AbstractWaveform2WaveformMeasure* TestPluginHost::w2wPlugin(PluginHost *host, const QString &scriptName)
+{
+    foreach(AbstractWaveform2WaveformMeasure *plugin, *host->w2w())
+        if( plugin->scriptName() == scriptName )
+            return plugin;
+    return 0;
+}
+
+QTEST_GUILESS_MAIN(TestPluginHost)
+
+#include "tst_pluginhost.moc"
@@ -0,0 +1,7 @@
+# -------------------------------------------------
+# Tests of the core library. Run them with "make check".
+# -------------------------------------------------
+TEMPLATE = subdirs
+SUBDIRS = pluginhost \
+    blockpipeline \
+    dtwaligner
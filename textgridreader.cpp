@@ -0,0 +1,405 @@
+#include "textgridreader.h"
+
+#include "intervalannotation.h"
+#include "interval.h"
+
+#include <QFile>
+#include <QTextCodec>
+#include <QtEndian>
+#include <QtDebug>
+
+#include <string.h>
+
+namespace {
+
+/*!
+  Tokenizer for Praat's text formats. The only tokens are numbers, quoted strings and flags (<exists>); anything else is a label, and is skipped.
+  */
+class TextTokenizer
+{
+public:
+    TextTokenizer(const char *begin, const char *end) : p(begin), e(end) {}
+
+    //! \brief Read a number into \a value. Returns false if the next token is not a number.
+    bool number(double *value)
+    {
+        if( next() != Number ) { return false; }
+        *value = mNumber;
+        return true;
+    }
+
+    //! \brief Read an integer into \a value. Returns false if the next token is not a number.
+    bool integer(int *value)
+    {
+        if( next() != Number ) { return false; }
+        *value = (int)mNumber;
+        return true;
+    }
+
+    //! \brief Read a string into \a value. Returns false if the next token is not a string.
+    bool string(QString *value)
+    {
+        if( next() != String ) { return false; }
+        *value = mString;
+        return true;
+    }
+
+    //! \brief Read a flag (the text between the angle brackets) into \a value. Returns false if the next token is not a flag.
+    bool flag(QByteArray *value)
+    {
+        if( next() != Flag ) { return false; }
+        *value = mFlag;
+        return true;
+    }
+
+private:
+    enum Type { Number, String, Flag, End };
+
+    Type next()
+    {
+        while( p < e )
+        {
+            char c = *p;
+            if( c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v' )
+            {
+                p++;
+            }
+            else if( c == '!' ) // comment
+            {
+                while( p < e && *p != '\n' ) { p++; }
+            }
+            else if( c == '"' )
+            {
+                readString();
+                return String;
+            }
+            else if( c == '<' )
+            {
+                const char *start = ++p;
+                while( p < e && *p != '>' ) { p++; }
+                mFlag = QByteArray::fromRawData(start, p - start);
+                if( p < e ) { p++; }
+                return Flag;
+            }
+            else if( c == '[' ) // an index, as in "intervals [3]:"
+            {
+                while( p < e && *p != ']' ) { p++; }
+                if( p < e ) { p++; }
+            }
+            else
+            {
+                const char *start = p;
+                while( p < e && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r' ) { p++; }
+                if( (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' )
+                {
+                    // QByteArray::toDouble() does not depend on the locale, unlike strtod()
+                    bool ok;
+                    mNumber = QByteArray::fromRawData(start, p - start).toDouble(&ok);
+                    if( ok ) { return Number; }
+                }
+                // otherwise it is a label
+            }
+        }
+        return End;
+    }
+
+    void readString()
+    {
+        const char *start = ++p;
+        bool escaped = false;
+        while( p < e )
+        {
+            if( *p == '"' )
+            {
+                if( p+1 < e && *(p+1) == '"' ) // a doubled quote stands for a quote
+                {
+                    escaped = true;
+                    p += 2;
+                    continue;
+                }
+                break;
+            }
+            p++;
+        }
+        mString = QString::fromUtf8(start, p - start);
+        if( escaped ) { mString.replace("\"\"", "\""); }
+        if( p < e ) { p++; }
+    }
+
+    const char *p, *e;
+    double mNumber;
+    QString mString;
+    QByteArray mFlag;
+};
+
+/*!
+  Reader for the big-endian values of Praat's binary format. After an attempt to read past the end, ok() returns false and all further values are zero.
+  */
+class BinaryStream
+{
+public:
+    BinaryStream(const char *begin, const char *end) : p((const uchar*)begin), e((const uchar*)end), mOk(true) {}
+
+    bool ok() const { return mOk; }
+
+    quint8 byte()
+    {
+        if( !available(1) ) { return 0; }
+        return *p++;
+    }
+
+    quint16 uint16()
+    {
+        if( !available(2) ) { return 0; }
+        quint16 value = qFromBigEndian<quint16>(p);
+        p += 2;
+        return value;
+    }
+
+    qint32 int32()
+    {
+        if( !available(4) ) { return 0; }
+        qint32 value = qFromBigEndian<qint32>(p);
+        p += 4;
+        return value;
+    }
+
+    double real()
+    {
+        if( !available(8) ) { return 0; }
+        quint64 bits = qFromBigEndian<quint64>(p);
+        p += 8;
+        double value;
+        memcpy(&value, &bits, sizeof(double));
+        return value;
+    }
+
+    //! \brief A string with a one-byte length, as used for class names
+    QString shortString()
+    {
+        int length = byte();
+        if( !available(length) ) { return QString(); }
+        QString value = QString::fromLatin1((const char*)p, length);
+        p += length;
+        return value;
+    }
+
+    //! \brief A string with a two-byte length. If the length is 0xFFFF, a second length follows and the string is UTF-16.
+    QString w16String()
+    {
+        int length = uint16();
+        if( length != 0xFFFF )
+        {
+            if( !available(length) ) { return QString(); }
+            QString value = QString::fromLatin1((const char*)p, length);
+            p += length;
+            return value;
+        }
+
+        length = uint16();
+        if( !available(2*length) ) { return QString(); }
+        QString value(length, Qt::Uninitialized);
+        for(int i=0; i<length; i++)
+            value[i] = QChar( qFromBigEndian<quint16>(p + 2*i) );
+        p += 2*length;
+        return value;
+    }
+
+private:
+    bool available(int n)
+    {
+        if( e - p < n ) { mOk = false; p = e; }
+        return mOk;
+    }
+
+    const uchar *p, *e;
+    bool mOk;
+};
+
+}
+
+TextGridReader::TextGridReader() :
+    mXmin(0), mXmax(0)
+{
+}
+
+TextGridReader::~TextGridReader()
+{
+    qDeleteAll(maTiers);
+}
+
+bool TextGridReader::read(const QString &fileName)
+{
+    QFile file(fileName);
+    if( !file.open(QIODevice::ReadOnly) )
+        return fail( QString("The file %1 could not be opened: %2").arg(fileName).arg(file.errorString()) );
+    return readData( file.readAll() );
+}
+
+bool TextGridReader::readData(const QByteArray &data)
+{
+    qDeleteAll(maTiers);
+    maTiers.clear();
+    mError.clear();
+
+    if( data.startsWith("ooBinaryFile") )
+        return readBinary(data);
+
+    // text files with non-ASCII labels are written by Praat as UTF-16
+    QTextCodec *codec = QTextCodec::codecForUtfText(data, 0);
+    if( codec != 0 )
+        return readText( codec->toUnicode(data).toUtf8() );
+
+    return readText(data);
+}
+
+bool TextGridReader::readText(const QByteArray &data)
+{
+    TextTokenizer in(data.constData(), data.constData() + data.size());
+
+    QString fileType, objectClass;
+    if( !in.string(&fileType) || !fileType.startsWith("ooTextFile") )
+        return fail("This is not a Praat text file.");
+    if( !in.string(&objectClass) || objectClass != "TextGrid" )
+        return fail("This is not a TextGrid file.");
+    if( !in.number(&mXmin) || !in.number(&mXmax) )
+        return fail("The TextGrid has no time domain.");
+
+    QByteArray exists;
+    if( !in.flag(&exists) )
+        return fail("The TextGrid file is incomplete.");
+    if( exists != "exists" )
+        return true; // no tiers
+
+    int nTiers;
+    if( !in.integer(&nTiers) )
+        return fail("The number of tiers is missing.");
+
+    for(int i=0; i<nTiers; i++)
+    {
+        QString tierClass, name;
+        double tierXmin, tierXmax;
+        int count;
+        if( !in.string(&tierClass) || !in.string(&name) || !in.number(&tierXmin) || !in.number(&tierXmax) || !in.integer(&count) )
+            return fail( QString("The header of tier %1 is incomplete.").arg(i+1) );
+
+        IntervalAnnotation *tier = new IntervalAnnotation;
+        tier->mName = name;
+        maTiers << tier;
+
+        if( tierClass == "IntervalTier" )
+        {
+            tier->reserve(count);
+            for(int j=0; j<count; j++)
+            {
+                double left, right;
+                QString label;
+                if( !in.number(&left) || !in.number(&right) || !in.string(&label) )
+                    return fail( QString("Interval %1 of tier %2 is incomplete.").arg(j+1).arg(i+1) );
+                tier->append( Interval(label, left, right) );
+            }
+        }
+        else if( tierClass == "TextTier" )
+        {
+            tier->mPointTier = true;
+            tier->reserve(count);
+            for(int j=0; j<count; j++)
+            {
+                double time;
+                QString mark;
+                if( !in.number(&time) || !in.string(&mark) )
+                    return fail( QString("Point %1 of tier %2 is incomplete.").arg(j+1).arg(i+1) );
+                tier->append( Interval(mark, time, time) );
+            }
+        }
+        else
+        {
+            return fail( QString("Tier %1 has the unknown class %2.").arg(i+1).arg(tierClass) );
+        }
+    }
+
+    return true;
+}
+
+bool TextGridReader::readBinary(const QByteArray &data)
+{
+    BinaryStream in(data.constData() + strlen("ooBinaryFile"), data.constData() + data.size());
+
+    if( in.shortString() != "TextGrid" )
+        return fail("This is not a TextGrid file.");
+    mXmin = in.real();
+    mXmax = in.real();
+    if( in.byte() == 0 )
+        return in.ok() ? true : fail("The TextGrid file is incomplete.");
+
+    int nTiers = in.int32();
+    for(int i=0; i<nTiers && in.ok(); i++)
+    {
+        QString tierClass = in.shortString();
+        IntervalAnnotation *tier = new IntervalAnnotation;
+        tier->mName = in.w16String();
+        in.real(); // the time domain of the tier
+        in.real();
+        int count = in.int32();
+        maTiers << tier;
+
+        if( tierClass == "IntervalTier" )
+        {
+            tier->reserve(count);
+            for(int j=0; j<count && in.ok(); j++)
+            {
+                double left = in.real();
+                double right = in.real();
+                tier->append( Interval(in.w16String(), left, right) );
+            }
+        }
+        else if( tierClass == "TextTier" )
+        {
+            tier->mPointTier = true;
+            tier->reserve(count);
+            for(int j=0; j<count && in.ok(); j++)
+            {
+                double time = in.real();
+                tier->append( Interval(in.w16String(), time, time) );
+            }
+        }
+        else if( in.ok() )
+        {
+            return fail( QString("Tier %1 has the unknown class %2.").arg(i+1).arg(tierClass) );
+        }
+    }
+
+    if( !in.ok() )
+        return fail("The TextGrid file is incomplete.");
+    return true;
+}
+
+QList<IntervalAnnotation *> TextGridReader::takeTiers()
+{
+    QList<IntervalAnnotation*> tiers = maTiers;
+    maTiers.clear();
+    return tiers;
+}
+
+QString TextGridReader::errorString() const
+{
+    return mError;
+}
+
+double TextGridReader::xmin() const
+{
+    return mXmin;
+}
+
+double TextGridReader::xmax() const
+{
+    return mXmax;
+}
+
+bool TextGridReader::fail(const QString &error)
+{
+    qDeleteAll(maTiers);
+    maTiers.clear();
+    mError = error;
+    return false;
+}
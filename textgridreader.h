@@ -0,0 +1,59 @@
+/*! \class TextGridReader
+    \ingroup Annotation
+    \brief Reads the tiers of a Praat TextGrid file.
+
+    The reader handles the three formats that Praat writes: the long text format, the short text format, and the binary format. Text files may be UTF-8 or UTF-16 (with a byte order mark).
+
+    Text files are read in a single pass by a tokenizer that recognizes the only things Praat's text formats contain: numbers, quoted strings, and flags such as \<exists\>. Everything else (e.g., "xmin =", "intervals [3]:", or comments after "!") is a label, and is skipped. This is the same rule that Praat itself uses, and it is why one parser serves both the long and the short format.
+
+    Interval tiers become IntervalAnnotation objects. Point tiers ("TextTier") become IntervalAnnotation objects that are marked as point tiers, with each point stored as an Interval whose left and right edges are both at the time of the point.
+
+    The class uses only QtCore, so it can be used without a GUI.
+  */
+
+#ifndef TEXTGRIDREADER_H
+#define TEXTGRIDREADER_H
+
+#include <QList>
+#include <QString>
+#include <QByteArray>
+
+class IntervalAnnotation;
+
+class TextGridReader
+{
+public:
+    TextGridReader();
+    ~TextGridReader();
+
+    //! \brief Read the TextGrid file \a fileName. Returns false, and sets errorString(), if the file cannot be read.
+    bool read(const QString &fileName);
+
+    //! \brief Read a TextGrid from the contents of a file, \a data. Returns false, and sets errorString(), if the data cannot be read.
+    bool readData(const QByteArray &data);
+
+    //! \brief Return the tiers that were read, and give up ownership of them. Subsequent calls return an empty list until another file is read.
+    QList<IntervalAnnotation*> takeTiers();
+
+    //! \brief Return a description of the last error
+    QString errorString() const;
+
+    //! \brief Return the start time of the TextGrid
+    double xmin() const;
+
+    //! \brief Return the end time of the TextGrid
+    double xmax() const;
+
+private:
+    bool readText(const QByteArray &data);
+    bool readBinary(const QByteArray &data);
+
+    //! \brief Delete the tiers read so far, set the error string to \a error, and return false
+    bool fail(const QString &error);
+
+    QList<IntervalAnnotation*> maTiers;
+    QString mError;
+    double mXmin, mXmax;
+};
+
+#endif // TEXTGRIDREADER_H
@@ -0,0 +1,133 @@
+#include "timewarp.h"
+
+#include "intervalannotation.h"
+#include "waveformdata.h"
+
+#include <algorithm>
+#include <string.h>
+
+TimeWarp::TimeWarp()
+{
+}
+
+TimeWarp TimeWarp::fromIntervals(const IntervalAnnotation *from, const IntervalAnnotation *to)
+{
+    TimeWarp warp;
+    int count = qMin(from->count(), to->count());
+    warp.maFrom.reserve(2*count);
+    warp.maTo.reserve(2*count);
+    for(int j=0; j<count; j++)
+    {
+        warp.addKnot( from->at(j).mLeft, to->at(j).mLeft );
+        warp.addKnot( from->at(j).mRight, to->at(j).mRight );
+    }
+    return warp;
+}
+
+TimeWarp TimeWarp::fromAccumulatedChange(const IntervalAnnotation *from, const IntervalAnnotation *to, const WaveformData *change)
+{
+    TimeWarp warp;
+    const QVector<double> &x = change->xData();
+    const QVector<double> &y = change->yData();
+
+    int count = qMin(from->count(), to->count());
+    for(int j=0; j<count; j++)
+    {
+        const Interval &source = from->at(j);
+        const Interval &target = to->at(j);
+
+        warp.addKnot( source.mLeft, target.mLeft );
+
+        // the samples of the change curve strictly inside the source interval
+        int first = std::upper_bound(x.constBegin(), x.constEnd(), source.mLeft) - x.constBegin();
+        int last = std::lower_bound(x.constBegin(), x.constEnd(), source.mRight) - x.constBegin();
+
+        double total = 0;
+        for(int k=first; k<last; k++)
+            total += y.at(k);
+
+        if( total > 0 )
+        {
+            double accumulated = 0;
+            double length = target.mRight - target.mLeft;
+            for(int k=first; k<last; k++)
+            {
+                accumulated += y.at(k);
+                warp.addKnot( x.at(k), target.mLeft + (accumulated/total)*length );
+            }
+        }
+
+        warp.addKnot( source.mRight, target.mRight );
+    }
+    return warp;
+}
+
+void TimeWarp::addKnot(double from, double to)
+{
+    if( !maFrom.isEmpty() && from <= maFrom.last() ) { return; }
+    maFrom.append(from);
+    maTo.append(to);
+}
+
+int TimeWarp::knotCount() const
+{
+    return maFrom.count();
+}
+
+double TimeWarp::map(double time) const
+{
+    int n = maFrom.count();
+    if( n == 0 ) { return time; }
+
+    int j = std::upper_bound(maFrom.constBegin(), maFrom.constEnd(), time) - maFrom.constBegin();
+    if( j == 0 )
+        return time + maTo.first() - maFrom.first();
+    if( j == n )
+        return time + maTo.last() - maFrom.last();
+    double slope = (maTo.at(j) - maTo.at(j-1)) / (maFrom.at(j) - maFrom.at(j-1));
+    return maTo.at(j-1) + (time - maFrom.at(j-1)) * slope;
+}
+
+void TimeWarp::map(const double *times, double *out, int n) const
+{
+    int nKnots = maFrom.count();
+    if( nKnots == 0 )
+    {
+        if( out != times ) { memcpy(out, times, sizeof(double)*n); }
+        return;
+    }
+
+    const double *from = maFrom.constData();
+    const double *to = maTo.constData();
+
+    // before the first knot
+    int i = 0;
+    double shift = to[0] - from[0];
+    for(; i<n && times[i] < from[0]; i++)
+        out[i] = times[i] + shift;
+
+    // one segment at a time; times are only read ahead of where they are written, so out may be times
+    for(int k=0; k+1<nKnots && i<n; k++)
+    {
+        int end = i;
+        while( end < n && times[end] < from[k+1] ) { end++; }
+
+        double slope = (to[k+1] - to[k]) / (from[k+1] - from[k]);
+        double origin = from[k];
+        double offset = to[k];
+        for(; i<end; i++)
+            out[i] = offset + (times[i] - origin) * slope;
+    }
+
+    // after the last knot
+    shift = to[nKnots-1] - from[nKnots-1];
+    for(; i<n; i++)
+        out[i] = times[i] + shift;
+}
+
+QVector<double> TimeWarp::map(const QVector<double> &times) const
+{
+    QVector<double> out(times.count());
+    map(times.constData(), out.data(), times.count());
+    return out;
+}
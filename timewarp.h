@@ -0,0 +1,53 @@
+/*! \class TimeWarp
+    \ingroup Data
+    \brief A piecewise-linear mapping from the time axis of one sound to that of another.
+
+    The mapping is defined by knots: pairs of times (from, to), with strictly increasing from-times. Between knots times are interpolated linearly. Before the first knot and after the last one, times are shifted so that they continue at the same rate as the original.
+
+    A TimeWarp is built once per sound, e.g., from the interval boundaries of two annotations (fromIntervals()), and is then applied to the time vector of each curve. Because the times of a curve are sorted, map() walks through the knots and the times together in a single pass; within each segment the mapping is a multiply and an add, which the compiler can vectorise.
+  */
+
+#ifndef TIMEWARP_H
+#define TIMEWARP_H
+
+#include <QVector>
+
+class IntervalAnnotation;
+class WaveformData;
+
+class TimeWarp
+{
+public:
+    //! \brief Create the identity mapping
+    TimeWarp();
+
+    //! \brief Return a warp that maps each interval of \a from linearly onto the corresponding interval of \a to
+    static TimeWarp fromIntervals(const IntervalAnnotation *from, const IntervalAnnotation *to);
+
+    //! \brief Return a warp that maps each interval of \a from onto the corresponding interval of \a to so that time advances in proportion to the accumulated values of \a change (e.g., spectral change, after Furui 1986)
+    /*!
+      Intervals in which \a change accumulates nothing are mapped linearly.
+      */
+    static TimeWarp fromAccumulatedChange(const IntervalAnnotation *from, const IntervalAnnotation *to, const WaveformData *change);
+
+    //! \brief Add a knot mapping \a from to \a to. Knots must be added in order of \a from; a knot whose from-time is not greater than the previous one is ignored.
+    void addKnot(double from, double to);
+
+    //! \brief Return the number of knots
+    int knotCount() const;
+
+    //! \brief Return the time to which \a time is mapped. The knots are found with a binary search.
+    double map(double time) const;
+
+    //! \brief Map the \a n sorted times in \a times to \a out in a single pass. \a out may be the same as \a times.
+    void map(const double *times, double *out, int n) const;
+
+    //! \brief Return the sorted times \a times, mapped
+    QVector<double> map(const QVector<double> &times) const;
+
+private:
+    QVector<double> maFrom;
+    QVector<double> maTo;
+};
+
+#endif // TIMEWARP_H
@@ -1,11 +1,34 @@
 #include "waveformdata.h"
 
-#include <QMessageBox>
 #include <QFileInfo>
 #include <QtDebug>
 
+#include <algorithm>
+#include <string.h>
+
 WaveformData::WaveformData(QString name, double *x, double *y, size_t nsam, size_t fs) :
-    QObject(), QwtPointArrayData(x, y, nsam),
+    QObject(),
+    maX(nsam), maY(nsam),
+    mLabel(name),
+    mFs(fs)
+{
+    if( nsam > 0 )
+    {
+        memcpy(maX.data(), x, sizeof(double)*nsam);
+        memcpy(maY.data(), y, sizeof(double)*nsam);
+    }
+
+    mSafeLabel = mLabel;
+    mSafeLabel.replace(QRegExp("[\\W]*"),"");
+
+    mPeriod = 1.0 / fs;
+
+    calculateMinMax();
+}
+
+WaveformData::WaveformData(QString name, const QVector<double> &x, const QVector<double> &y, size_t fs) :
+    QObject(),
+    maX(x), maY(y),
     mLabel(name),
     mFs(fs)
 {
@@ -17,8 +40,8 @@ WaveformData::WaveformData(QString name, double *x, double *y, size_t nsam, size
     calculateMinMax();
 }
 
-WaveformData::WaveformData(const WaveformData& other) : QObject(), QwtPointArrayData(other),
-    mLabel(other.mLabel), mSafeLabel(other.mSafeLabel), mFs(other.mFs), mPeriod(other.mPeriod), mTimes(0), mMinimum(other.mMinimum), mMaximum(other.mMaximum)
+WaveformData::WaveformData(const WaveformData& other) : QObject(),
+    maX(other.maX), maY(other.maY), mLabel(other.mLabel), mSafeLabel(other.mSafeLabel), mFs(other.mFs), mPeriod(other.mPeriod), mMinimum(other.mMinimum), mMaximum(other.mMaximum)
 {
 }
 
@@ -45,9 +68,40 @@ size_t WaveformData::size() const
 
 void WaveformData::setXData(double *x)
 {
-    // TODO this is out of date. It's only used in comparisonwidget.cpp, so I don't know if that can be gotten around.
-    if(mTimes != 0) { free(mTimes); }
-    mTimes = x;
+    QVector<double> times(xData().size());
+    memcpy(times.data(), x, sizeof(double)*times.size());
+    free(x);
+    setTimes(times);
+}
+
+void WaveformData::setTimes(const QVector<double> &times)
+{
+    if( times.size() != maY.size() ) { qDebug() << "WaveformData::setTimes: expected" << maY.size() << "times, but got" << times.size(); return; }
+
+    maX = times;
+}
+
+void WaveformData::append(const QVector<double> &times, const QVector<double> &values)
+{
+    if( times.size() != values.size() ) { qDebug() << "WaveformData::append: got" << times.size() << "times but" << values.size() << "values"; return; }
+
+    maX += times;
+    maY += values;
+    for(int i=0; i<values.size(); i++)
+    {
+        if( values.at(i) < mMinimum ) { mMinimum = values.at(i); }
+        if( values.at(i) > mMaximum ) { mMaximum = values.at(i); }
+    }
+}
+
+QVector<double> WaveformData::samples() const
+{
+    return yData();
+}
+
+QVector<double> WaveformData::times() const
+{
+    return xData();
 }
 
 quint32 WaveformData::getNSamples() const
@@ -80,14 +134,12 @@ double WaveformData::getNyquistFrequency() const
     return floor((double)mFs/2);
 }
 
-size_t WaveformData::getSampleFromTime(double time)
+size_t WaveformData::getSampleFromTime(double time) const
 {
     if( time <= tMin() ) { return 0; }
     if( time >= tMax() ) { return xData().size()-1-1; }
-    for(int i=0; i<xData().size()-1; i++)
-        if( xData().at(i+1) > time )
-            return i;
-    return 99999999;
+    // the first sample after time, less one
+    return std::upper_bound(xData().constBegin(), xData().constEnd(), time) - xData().constBegin() - 1;
 }
 
 QRectF WaveformData::boundingRect() const
@@ -3,7 +3,7 @@
   \ingroup Data
   \brief A data class for periodic waveform data.
 
-  This class subclasses QwtPointArrayData, offering added tools that are helpful for storing spectrogram-like data.
+  This class stores the times and values of a waveform, offering added tools that are helpful for storing waveform data. It depends on QtCore only, so that it can be used without a display; plots show it through a WaveformSeries.
 
   The class is a subclass of QObject so that WaveformData objects can be used by the scripting interface.
 */
@@ -12,11 +12,13 @@
 #define WAVEFORMDATA_H
 
 #include <QObject>
-#include <qwt_point_data.h>
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
 
 class QString;
 
-class WaveformData : public QObject, public QwtPointArrayData
+class WaveformData : public QObject
 {
     Q_OBJECT
 public:
@@ -27,24 +29,51 @@ public:
       \param y Pointer to the y-data
       \param nsam Number of samples in the waveform
       \param fs Sampling frequency of the waveform
+
+      The values are copied; the caller keeps ownership of \a x and \a y.
     */
     WaveformData(QString name, double *x, double *y, size_t nsam, size_t mFs);
 
+    //! \brief Construct the object from the times \a x and values \a y, which are implicitly shared rather than copied
+    WaveformData(QString name, const QVector<double> &x, const QVector<double> &y, size_t fs);
+
     //! \brief Copy constructor. Performs a deep copy of the data structures
     WaveformData(const WaveformData& other);
 
 public slots:
+    //! \brief Return the time and value of sample \a i
     QPointF sample (size_t i) const;
 
-    //! \brief Return the number of samples in the data. Reimplemented from QwtPointArrayData
+    //! \brief Return the number of samples in the data
     size_t size() const;
 
-    //! \brief Set the pointer to the x-data
+    //! \brief Return the times of the samples. They are changed only through setXData(), setTimes() and append().
+    const QVector<double> &xData() const { return maX; }
+
+    //! \brief Return the values of the samples. They are changed only through append().
+    const QVector<double> &yData() const { return maY; }
+
+    //! \brief Replace the x-data with the values pointed to by \a x
     /*!
-      The pointer to the current x-data is deallocated if non-null.
+      The values are copied, and \a x is deallocated.
       */
     void setXData(double *x);
 
+    //! \brief Replace the x-data with \a times, which must have one value for each sample
+    /*!
+      The vector is implicitly shared, so several waveforms on the same time grid can be given the same warped times without copying them.
+      */
+    void setTimes(const QVector<double> &times);
+
+    //! \brief Add samples with the times \a times and values \a values to the end of the waveform, e.g., as they arrive from a stream
+    void append(const QVector<double> &times, const QVector<double> &values);
+
+    //! \brief Return the values of the samples. The vector is implicitly shared, so no data are copied.
+    QVector<double> samples() const;
+
+    //! \brief Return the times of the samples. The vector is implicitly shared, so no data are copied.
+    QVector<double> times() const;
+
     //! \brief Return the number of samples in the waveform
     size_t getNSamples() const;
 
@@ -68,9 +97,9 @@ public slots:
 
     //! \brief Return the sample index before \a time
     /*!
-      If \a time is outside of the range, the first or last sample index is returned, as appropriate.
+      If \a time is outside of the range, the first or last sample index is returned, as appropriate. The times are searched with a binary search.
       */
-    size_t getSampleFromTime(double time);
+    size_t getSampleFromTime(double time) const;
 
     //! \brief Return the name of the waveform
     QString name() const { return mLabel; }
@@ -81,18 +110,19 @@ public slots:
     //! \brief Set the name of the waveform
     void setName(QString n);
 
-    //! \brief Return the bounding rectangle of the data. Reimplemented from QwtRasterData
+    //! \brief Return the bounding rectangle of the data
     QRectF boundingRect() const;
 
     //! \brief Calcuate minimum and maximum values of y-data
     void calculateMinMax();
 
 private:
+    QVector<double> maX;
+    QVector<double> maY;
     QString mLabel;
     QString mSafeLabel;
     size_t mFs;
     double mPeriod;
-    double *mTimes;
     double mMinimum;
     double mMaximum;
 };
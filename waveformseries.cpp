@@ -0,0 +1,28 @@
+#include "waveformseries.h"
+
+#include "waveformdata.h"
+
+WaveformSeries::WaveformSeries(const WaveformData *data) : mData(data)
+{
+}
+
+const WaveformData *WaveformSeries::waveformData() const
+{
+    return mData;
+}
+
+size_t WaveformSeries::size() const
+{
+    return mData->size();
+}
+
+QPointF WaveformSeries::sample(size_t i) const
+{
+    return QPointF( mData->xData().at(i), mData->yData().at(i) );
+}
+
+QRectF WaveformSeries::boundingRect() const
+{
+    // the waveform keeps its range up to date as it grows, so nothing is cached here
+    return mData->boundingRect();
+}
@@ -0,0 +1,40 @@
+/*!
+  \class WaveformSeries
+  \ingroup Display
+  \brief Presents a WaveformData object to a QwtPlotCurve.
+
+  WaveformData does not depend on Qwt, so a curve is given one of these instead. The series reads the times and values of the waveform each time it is drawn, so a waveform that grows, or whose times are replaced, is shown as it is.
+
+  A curve deletes its series when it is deleted or given another, but the series does not own the waveform.
+*/
+
+#ifndef WAVEFORMSERIES_H
+#define WAVEFORMSERIES_H
+
+#include <qwt_series_data.h>
+
+class WaveformData;
+
+class WaveformSeries : public QwtSeriesData<QPointF>
+{
+public:
+    //! \brief Present \a data
+    WaveformSeries(const WaveformData *data);
+
+    //! \brief Return the waveform that is presented
+    const WaveformData* waveformData() const;
+
+    //! \brief Return the number of samples of the waveform. Reimplemented from QwtSeriesData
+    size_t size() const;
+
+    //! \brief Return the time and value of sample \a i. Reimplemented from QwtSeriesData
+    QPointF sample(size_t i) const;
+
+    //! \brief Return the bounding rectangle of the waveform. Reimplemented from QwtSeriesData
+    QRectF boundingRect() const;
+
+private:
+    const WaveformData *mData;
+};
+
+#endif // WAVEFORMSERIES_H